@@ -88,13 +88,14 @@ struct StructDesc {
 
 struct StructDesc MemoryAccessDesc {
     sizeof(struct MemoryAccess),
-    5,
+    6,
     {
         offsetof(struct MemoryAccess, instAddress),
         offsetof(struct MemoryAccess, accessAddress),
         offsetof(struct MemoryAccess, value),
         offsetof(struct MemoryAccess, size),
-        offsetof(struct MemoryAccess, type)
+        offsetof(struct MemoryAccess, type),
+        offsetof(struct MemoryAccess, flags)
     }
 };
 
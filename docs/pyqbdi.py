@@ -40,6 +40,18 @@ class vm():
         """
         pass
 
+    def runWithBudget(start, stop, budget, type=None):
+        """Start the execution by the DBI and stop it once a budget of instructions or basic blocks has been executed (only supported under X86_64). The PC of the GPR state is then the next instruction to execute.
+
+            :param start: Address of the first instruction to execute.
+            :param stop: Stop the execution when this instruction is reached.
+            :param budget: The maximum number of instructions or basic blocks to execute.
+            :param type: The unit of the budget, :py:const:`pyqbdi.BUDGET_INSTRUCTIONS` (default) or :py:const:`pyqbdi.BUDGET_BASIC_BLOCKS`.
+
+            :returns: A tuple (ran, executed): True if at least one block has been executed and the number of instructions or basic blocks executed.
+        """
+        pass
+
     def call(function, args):
         """Call a function using the DBI (and its current state).
 
@@ -50,12 +62,14 @@ class vm():
         """
         pass
 
-    def addCodeCB(pos, cbk, data):
+    def addCodeCB(pos, cbk, data, predicate=None):
         """Register a callback event for a specific instruction event.
 
             :param pos: Relative position of the event callback (:py:const:`pyqbdi.PREINST` / :py:const:`pyqbdi.POSTINST`).
             :param cbk: A function pointer to the callback.
             :param data: User defined data passed to the callback.
+            :param predicate: An optional inline predicate: a list of ``(combine, type, operand, mask, value, limit)`` tuples
+                evaluated before leaving the instrumented code (see :cpp:class:`QBDI::Predicate`).
 
             :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
         """
@@ -73,7 +87,7 @@ class vm():
         """
         pass
 
-    def addCodeRangeCB(start, end, pos, cbk, data):
+    def addCodeRangeCB(start, end, pos, cbk, data, predicate=None):
         """Register a callback for when a specific address range is executed.
 
             :param start: Start of the address range which will trigger the callback.
@@ -81,23 +95,118 @@ class vm():
             :param pos: Relative position of the event callback (:py:const:`pyqbdi.PREINST` / :py:const:`pyqbdi.POSTINST`).
             :param cbk: A function pointer to the callback.
             :param data: User defined data passed to the callback.
+            :param predicate: An optional inline predicate: a list of ``(combine, type, operand, mask, value, limit)`` tuples
+                evaluated before leaving the instrumented code (see :cpp:class:`QBDI::Predicate`).
 
             :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
         """
         pass
 
-    def addMnemonicCB(mnemonic, pos, cbk, data):
+    def addMnemonicCB(mnemonic, pos, cbk, data, predicate=None):
         """Register a callback event if the instruction matches the mnemonic.
 
             :param mnemonic: Mnemonic to match.
             :param pos: Relative position of the event callback (:py:const:`pyqbdi.PREINST` / :py:const:`pyqbdi.POSTINST`).
             :param cbk: A function pointer to the callback.
             :param data: User defined data passed to the callback.
+            :param predicate: An optional inline predicate: a list of ``(combine, type, operand, mask, value, limit)`` tuples
+                evaluated before leaving the instrumented code (see :cpp:class:`QBDI::Predicate`).
+
+            :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
+        """
+        pass
+
+    def addSampledCodeCB(pos, cbk, data, period, randomized=False, predicate=None):
+        """Register a sampled callback event for every instruction executed. The callback is only called once every period executions.
+
+            :param pos: Relative position of the event callback (:py:const:`pyqbdi.PREINST` / :py:const:`pyqbdi.POSTINST`).
+            :param cbk: A function pointer to the callback.
+            :param data: User defined data passed to the callback.
+            :param period: The sampling period, in executions.
+            :param randomized: Draw each interval uniformly between 1 and 2 * period - 1.
+            :param predicate: An optional inline predicate, only the executions where it holds are counted.
+
+            :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
+        """
+        pass
+
+    def addSampledCodeRangeCB(start, end, pos, cbk, data, period, randomized=False, predicate=None):
+        """Register a sampled callback for when a specific address range is executed. The callback is only called once every period executions.
+
+            :param start: Start of the address range which will trigger the callback.
+            :param end: End of the address range which will trigger the callback.
+            :param pos: Relative position of the event callback (:py:const:`pyqbdi.PREINST` / :py:const:`pyqbdi.POSTINST`).
+            :param cbk: A function pointer to the callback.
+            :param data: User defined data passed to the callback.
+            :param period: The sampling period, in executions.
+            :param randomized: Draw each interval uniformly between 1 and 2 * period - 1.
+            :param predicate: An optional inline predicate, only the executions where it holds are counted.
+
+            :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
+        """
+        pass
+
+    def addCodeCounter(counter, atomic=False):
+        """Register an inline counter incremented before every instruction executed.
+
+            :param counter: Address of a user allocated 64 bits counter (for instance obtained with :py:func:`pyqbdi.alignedAlloc`).
+            :param atomic: Use an atomic increment (only needed if the counter is shared between threads).
+
+            :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
+        """
+        pass
+
+    def addCodeAddrCounter(address, counter, atomic=False):
+        """Register an inline counter incremented each time a specific address is executed.
+
+            :param address: Code address which will increment the counter.
+            :param counter: Address of a user allocated 64 bits counter.
+            :param atomic: Use an atomic increment (only needed if the counter is shared between threads).
+
+            :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
+        """
+        pass
+
+    def addCodeRangeCounter(start, end, counter, atomic=False):
+        """Register an inline counter incremented for every instruction executed in an address range.
+
+            :param start: Start of the address range which will increment the counter.
+            :param end: End of the address range which will increment the counter.
+            :param counter: Address of a user allocated 64 bits counter.
+            :param atomic: Use an atomic increment (only needed if the counter is shared between threads).
 
             :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
         """
         pass
 
+    def addMnemonicCounter(mnemonic, counter, atomic=False):
+        """Register an inline counter incremented for every instruction executed matching the mnemonic.
+
+            :param mnemonic: Mnemonic to match.
+            :param counter: Address of a user allocated 64 bits counter.
+            :param atomic: Use an atomic increment (only needed if the counter is shared between threads).
+
+            :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
+        """
+        pass
+
+    def getCounters():
+        """Obtain a snapshot of the values of all the registered inline counters.
+
+            :returns: A list of (id, value) tuples.
+        """
+        pass
+
+    def setEdgeCoverage(bitmap, size):
+        """Enable an AFL style edge coverage instrumentation, computed inline at the start of every basic block: the byte of the bitmap indexed by the hash of the previous and current basic block addresses is incremented (only supported under X86_64).
+
+            :param bitmap: Address of the coverage bitmap, or 0 to disable the edge coverage.
+            :param size: The size of the bitmap in bytes, which must be a power of two.
+
+            :returns: True if the edge coverage has been enabled (or disabled).
+        """
+        pass
+
     def deleteInstrumentation(id):
         """Remove an instrumentation.
 
@@ -112,8 +221,18 @@ class vm():
         """
         pass
 
+    def setInstrumentationEnabled(id, enable):
+        """Enable or disable an instrumentation without flushing the translation cache. A disabled callback is skipped by an inline switch, the first call for a callback instrumenting code adds this switch and translates again its instrumented range once, the following calls have a constant cost (only supported under X86_64 for the code callbacks). The inline instrumentations which never break to the host (counters, countdowns, ...) cannot be switched and have to be deleted instead.
+
+            :param id: The id of the instrumentation.
+            :param enable: Whether the instrumentation should be enabled.
+
+            :returns: :py:const:`pyqbdi.SWITCH_UPDATED` if the instrumentation has been updated, :py:const:`pyqbdi.SWITCH_INVALID_ID` if no instrumentation has this id, :py:const:`pyqbdi.SWITCH_UNSUPPORTED` if the instrumentation cannot be switched.
+        """
+        pass
+
     def addMemAddrCB(address, type, cbk, data):
-        """Add a virtual callback which is triggered for any memory access at a specific address matching the access type. Virtual callbacks are called via callback forwarding by a gate callback triggered on every memory access. This incurs a high performance cost.
+        """Add a virtual callback which is triggered for any memory access at a specific address matching the access type. Virtual callbacks are called via callback forwarding by a gate callback, only triggered when an inline check finds the access may hit a range.
 
             :param address: Code address which will trigger the callback.
             :param type: A mode bitfield: either :py:const:`pyqbdi.MEMORY_READ`, :py:const:`pyqbdi.MEMORY_WRITE` or both (:py:const:`pyqbdi.MEMORY_READ_WRITE`).
@@ -125,7 +244,7 @@ class vm():
         pass
 
     def addMemRangeCB(start, end, type, cbk, data):
-        """Add a virtual callback which is triggered for any memory access in a specific address range matching the access type. Virtual callbacks are called via callback forwarding by a gate callback triggered on every memory access. This incurs a high performance cost.
+        """Add a virtual callback which is triggered for any memory access in a specific address range matching the access type. Virtual callbacks are called via callback forwarding by a gate callback, only triggered when an inline check finds the access may hit a range.
 
             :param start: Start of the address range which will trigger the callback.
             :param end: End of the address range which will trigger the callback.
@@ -180,6 +299,97 @@ class vm():
         """
         pass
 
+    def getMemoryAccessValue(access):
+        """Obtain the complete value of a memory access of the current basic block which is larger than a rword (flagged with :py:const:`pyqbdi.MEMORY_PARTIAL_VALUE`).
+
+            :param access: A MemoryAccess returned by getInstMemoryAccess() or getBBMemoryAccess().
+
+            :returns: The value as bytes, or None if it was not recorded.
+        """
+        pass
+
+    def setMemoryTrace(type, cbk, data, batchSize=4096):
+        """Stream the memory accesses to a callback. The accesses are appended by inline instrumentation to a trace buffer owned by the VM and are delivered in batches once the buffer holds at least batchSize records and at the end of each run (only supported under X86_64).
+
+            :param type: Memory mode bitfield to trace: either pyqbdi.MEMORY_READ, pyqbdi.MEMORY_WRITE or both (pyqbdi.MEMORY_READ_WRITE). 0 disables the memory trace.
+            :param cbk: A function called with (vm, accesses, data) where accesses is a list of MemoryAccess.
+            :param data: User defined data passed to the callback.
+            :param batchSize: The number of records triggering a delivery.
+
+            :returns: True if the memory trace has been enabled (or disabled).
+        """
+        pass
+
+    def flushMemoryTrace():
+        """Deliver immediately the pending memory trace records to the trace callback.
+        """
+        pass
+
+    def setSyscallTrace(cbk, data, batchSize=256):
+        """Stream the executed syscalls to a callback. Their number, arguments and return value are recorded by inline instrumentation in a ring buffer owned by the VM and are delivered in batches once the buffer holds at least batchSize records, at the end of each run and before the syscalls which do not return (only supported under X86_64).
+
+            :param cbk: A function called with (vm, records, data) where records is a list of (number, args, ret) tuples, or None to disable the syscall trace.
+            :param data: User defined data passed to the callback.
+            :param batchSize: The number of records triggering a delivery.
+
+            :returns: True if the syscall trace has been enabled (or disabled).
+        """
+        pass
+
+    def flushSyscallTrace():
+        """Deliver immediately the pending syscall trace records to the trace callback.
+        """
+        pass
+
+    def setTaintTracking(enable):
+        """Enable or disable the byte-level taint tracking. The taint labels are propagated inline through the data flow of the instructions, but not through the flags, the control flow and the addresses of the memory accesses (only supported under X86_64 Linux and macOS).
+
+            :param enable: True to enable the taint tracking, False to disable it.
+
+            :returns: True if the taint tracking has been enabled (or disabled).
+        """
+        pass
+
+    def setMemoryTaint(start, size, label):
+        """Set the taint label of a memory range. The taint tracking needs to be enabled.
+
+            :param start: Start address of the range.
+            :param size: Size of the range in bytes.
+            :param label: The taint label (between 0 and 255) of the range bytes, 0 to untaint them.
+
+            :returns: True if the label has been set.
+        """
+        pass
+
+    def getMemoryTaint(start, size):
+        """Get the taint of a memory range.
+
+            :param start: Start address of the range.
+            :param size: Size of the range in bytes.
+
+            :returns: The union of the taint labels of the range bytes.
+        """
+        pass
+
+    def setRegisterTaint(gpr, label):
+        """Set the taint label of every byte of a general purpose register. The stack and instruction pointers can not be tainted.
+
+            :param gpr: The GPR index.
+            :param label: The taint label (between 0 and 255) of the register bytes, 0 to untaint them.
+
+            :returns: True if the label has been set.
+        """
+        pass
+
+    def getRegisterTaint(gpr):
+        """Get the taint of a general purpose register.
+
+            :param gpr: The GPR index.
+
+            :returns: The union of the taint labels of the register bytes.
+        """
+        pass
+
     def precacheBasicBlock(pc):
         """Pre-cache a known basic block
 
@@ -213,6 +423,82 @@ class vm():
         """
         pass
 
+    def addSampledVMEventCB(mask, cbk, data, period, randomized=False):
+        """Register a sampled callback event for a specific VM event. The callback is only called once every period events.
+
+            :param mask: A mask of VM event type which will trigger the callback.
+            :param cbk: A function pointer to the callback.
+            :param data: User defined data passed to the callback.
+            :param period: The sampling period, in events.
+            :param randomized: Draw each interval uniformly between 1 and 2 * period - 1.
+
+            :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
+        """
+        pass
+
+    def setCallStackTracking(enable):
+        """Enable or disable the shadow call stack, maintained inline by the code simulating the call and return instructions. It is enabled automatically when a callback is registered for the :py:const:`pyqbdi.FUNCTION_ENTRY` or :py:const:`pyqbdi.FUNCTION_EXIT` events (only supported under X86_64).
+
+            :param enable: True to enable the call stack tracking, False to disable it.
+
+            :returns: True if the call stack tracking has been enabled (or disabled).
+        """
+        pass
+
+    def getCallStack():
+        """Obtain the current call stack, from the shadow call stack.
+
+            :returns: A list of (callSite, returnAddress, target, stackPointer) tuples, from the innermost to the outermost frame.
+        """
+        pass
+
+    def setBranchProfiling(enable):
+        """Enable or disable the profiling of the targets of the indirect jumps and calls. Each site counts inline the executions going to its first four targets and only breaks to the host for the other ones. Enabling it again starts a new profile (only supported under X86_64).
+
+            :param enable: True to enable the branch profiling, False to disable it.
+
+            :returns: True if the branch profiling has been enabled (or disabled).
+        """
+        pass
+
+    def getBranchSites():
+        """Obtain the addresses of the indirect branch sites executed since the branch profiling was enabled.
+
+            :returns: A list of branch instruction addresses, in increasing order.
+        """
+        pass
+
+    def getBranchTargets(site):
+        """Obtain the targets observed at an indirect branch site.
+
+            :param site: The address of the branch instruction.
+
+            :returns: A list of (target, count) tuples, from the most to the least frequent target.
+        """
+        pass
+
+    def replaceFunction(target, replacement):
+        """Replace a function by another one. The replacement receives the original arguments and returns directly to the caller, it is executed natively if it is not instrumented.
+
+            :param target: The entry address of the replaced function.
+            :param replacement: The address of the replacement function, with the same prototype.
+
+            :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
+        """
+        pass
+
+    def wrapFunction(target, pre, post, data):
+        """Wrap a function with callbacks called when it is entered and when it returns to its caller. The function is skipped if the pre callback changes the value of PC.
+
+            :param target: The entry address of the wrapped function.
+            :param pre: The callback called on the entry of the function, or None.
+            :param post: The callback called on the return of the function, or None.
+            :param data: User defined data passed to the callbacks.
+
+            :returns: The id of the registered instrumentation (or :py:const:`pyqbdi.INVALID_EVENTID` in case of failure).
+        """
+        pass
+
     def addInstrumentedModule(name):
         """Add the executable address ranges of a module to the set of instrumented address ranges.
 
@@ -240,6 +526,13 @@ class vm():
         """
         pass
 
+    def addInstrumentedRanges(ranges):
+        """Add several address ranges to the set of instrumented address ranges at once.
+
+            :param ranges: A list of (start, end) tuples, the start being included and the end excluded.
+        """
+        pass
+
     def instrumentAllExecutableMaps():
         """Adds all the executable memory maps to the instrumented range set.
 
@@ -278,6 +571,22 @@ class vm():
         """
         pass
 
+    def removeInstrumentedRanges(ranges):
+        """Remove several address ranges from the set of instrumented address ranges at once.
+
+            :param ranges: A list of (start, end) tuples, the start being included and the end excluded.
+        """
+        pass
+
+    def setFastNativeCalls(enable):
+        """Enable or disable the native calls. A call whose target is known at translation time and outside of the instrumented ranges, including through the PLT or the GOT, is then performed natively and returns straight into the rest of the basic block, without signaling the execution transfer events (only supported under X86_64).
+
+            :param enable: True to enable the native calls, False to disable them.
+
+            :returns: True if the native calls have been enabled (or disabled).
+        """
+        pass
+
 
 # PyQBDI module functions
 def alignedAlloc(size, align):
@@ -18,6 +18,8 @@
 #ifndef _CALLBACK_H_
 #define _CALLBACK_H_
 
+#include <stddef.h>
+
 #include "Platform.h"
 #include "State.h"
 #include "Bitmask.h"
@@ -76,9 +78,13 @@ typedef enum {
     _QBDI_EI(BASIC_BLOCK_NEW)       = 1<<4, /*!< Triggered when the execution enters a new (~unknown) basic block.*/
     _QBDI_EI(EXEC_TRANSFER_CALL)    = 1<<5, /*!< Triggered when the ExecBroker executes an execution transfer.*/
     _QBDI_EI(EXEC_TRANSFER_RETURN)  = 1<<6, /*!< Triggered when the ExecBroker returns from an execution transfer.*/
-    _QBDI_EI(SYSCALL_ENTRY)         = 1<<7, /*!< Not implemented.*/
-    _QBDI_EI(SYSCALL_EXIT)          = 1<<8, /*!< Not implemented.*/
+    _QBDI_EI(SYSCALL_ENTRY)         = 1<<7, /*!< Triggered before a syscall instruction is executed (X86_64 only).*/
+    _QBDI_EI(SYSCALL_EXIT)          = 1<<8, /*!< Triggered after a syscall instruction is executed (X86_64 only).*/
     _QBDI_EI(SIGNAL)                = 1<<9, /*!< Not implemented.*/
+    _QBDI_EI(FUNCTION_ENTRY)        = 1<<10, /*!< Triggered after a call, when the execution enters the called function (requires the call stack tracking).*/
+    _QBDI_EI(FUNCTION_EXIT)         = 1<<11, /*!< Triggered after a return, when the execution exits from a function (requires the call stack tracking).*/
+    _QBDI_EI(MODULE_LOAD)           = 1<<12, /*!< Triggered when the VM notices that a module has been loaded (Linux only).*/
+    _QBDI_EI(MODULE_UNLOAD)         = 1<<13, /*!< Triggered when the VM notices that a module has been unloaded (Linux only).*/
 } VMEvent;
 
 _QBDI_ENABLE_BITMASK_OPERATORS(VMEvent)
@@ -93,6 +99,11 @@ struct VMState {
     rword basicBlockStart;   /*!< The current basic block start address which can also be the execution transfer destination.*/
     rword basicBlockEnd;     /*!< The current basic block end address which can also be the execution transfer destination.*/
     rword lastSignal;        /*!< Not implemented.*/
+    rword syscallNumber;     /*!< The syscall number, for the SYSCALL_ENTRY and SYSCALL_EXIT events.*/
+    rword syscallArgs[6];    /*!< The syscall arguments, for the SYSCALL_ENTRY and SYSCALL_EXIT events.*/
+    rword syscallReturn;     /*!< The syscall return value, for the SYSCALL_EXIT event.*/
+    rword moduleStart;       /*!< The start address of the module, for the MODULE_LOAD and MODULE_UNLOAD events.*/
+    rword moduleEnd;         /*!< The end address of the module, for the MODULE_LOAD and MODULE_UNLOAD events.*/
 };
 
 /*! VM callback function type.
@@ -123,16 +134,126 @@ typedef enum {
 
 _QBDI_ENABLE_BITMASK_OPERATORS(MemoryAccessType);
 
+/*! Memory access flags
+ */
+typedef enum {
+    _QBDI_EI(MEMORY_NO_FLAGS)      = 0,    /*!< No flags */
+    _QBDI_EI(MEMORY_UNKNOWN_VALUE) = 1,    /*!< The value of the access was not captured (string operations) */
+    _QBDI_EI(MEMORY_PARTIAL_VALUE) = 1<<1  /*!< The access is larger than a rword and the value only holds its first bytes */
+} MemoryAccessFlags;
+
+_QBDI_ENABLE_BITMASK_OPERATORS(MemoryAccessFlags);
+
 /*! Describe a memory access
  */
 struct MemoryAccess {
-    rword instAddress;     /*!< Address of instruction making the access */
-    rword accessAddress;   /*!< Address of accessed memory */
-    rword value;           /*!< Value read from / written to memory */
-    uint8_t size;          /*!< Size of memory access (in bytes) */
-    MemoryAccessType type; /*!< Memory access type (READ / WRITE) */
+    rword instAddress;       /*!< Address of instruction making the access */
+    rword accessAddress;     /*!< Address of accessed memory */
+    rword value;             /*!< Value read from / written to memory */
+    rword size;              /*!< Size of memory access (in bytes) */
+    MemoryAccessType type;   /*!< Memory access type (READ / WRITE) */
+    MemoryAccessFlags flags; /*!< Memory access flags */
+};
+
+/*! Memory trace callback function type. Receives, in execution order, a batch of the memory 
+ * accesses recorded by the memory trace.
+ *
+ * @param[in] vm            VM instance of the callback.
+ * @param[in] accesses      An array of memory accesses, only valid until the callback returns.
+ * @param[in] size          The number of memory accesses in the array.
+ * @param[in] data          User defined data which can be defined when enabling the memory trace.
+ *
+ * @return                  The callback result used to signal subsequent actions the VM needs to 
+ *                          take (STOP stops the execution).
+ */
+typedef VMAction (*MemoryTraceCallback)(VMInstanceRef vm, const struct MemoryAccess *accesses, size_t size, void *data);
+
+/*! Record of an executed syscall
+ */
+struct SyscallRecord {
+    rword number;  /*!< Syscall number */
+    rword args[6]; /*!< Syscall arguments */
+    rword ret;     /*!< Syscall return value (0 for a syscall delivered before its execution) */
+};
+
+/*! Syscall trace callback function type. Receives, in execution order, a batch of the syscalls 
+ * recorded by the syscall trace.
+ *
+ * @param[in] vm            VM instance of the callback.
+ * @param[in] records       An array of syscall records, only valid until the callback returns.
+ * @param[in] size          The number of syscall records in the array.
+ * @param[in] data          User defined data which can be defined when enabling the syscall trace.
+ *
+ * @return                  The callback result used to signal subsequent actions the VM needs to 
+ *                          take (STOP stops the execution).
+ */
+typedef VMAction (*SyscallTraceCallback)(VMInstanceRef vm, const struct SyscallRecord *records, size_t size, void *data);
+
+/*! Value of an inline counter
+ */
+struct CounterValue {
+    uint32_t id;    /*!< Id of the counter instrumentation */
+    uint64_t value; /*!< Value of the counter */
 };
 
+/*! Type of a term of an inline predicate.
+ */
+typedef enum {
+    _QBDI_EI(PREDICATE_REG_EQUAL)     = 0, /*!< (register & mask) == value */
+    _QBDI_EI(PREDICATE_REG_NOT_EQUAL) = 1, /*!< (register & mask) != value */
+    _QBDI_EI(PREDICATE_REG_IN_RANGE)  = 2, /*!< value <= register < limit (unsigned) */
+    _QBDI_EI(PREDICATE_MEM_IN_RANGE)  = 3, /*!< value <= access address < limit (unsigned) */
+    _QBDI_EI(PREDICATE_MEM_MASK)      = 4, /*!< (access address & mask) == value */
+} PredicateType;
+
+/*! Combination of a term of an inline predicate with the previous ones.
+ */
+typedef enum {
+    _QBDI_EI(PREDICATE_AND) = 0, /*!< The term is added to the current conjunction */
+    _QBDI_EI(PREDICATE_OR)  = 1, /*!< The term starts a new conjunction */
+} PredicateCombine;
+
+/*! Term of an inline predicate. A predicate is a list of terms read as a disjunction of 
+ *  conjunctions: PREDICATE_AND binds tighter than PREDICATE_OR and the combination of the first 
+ *  term is ignored.
+ */
+struct Predicate {
+    PredicateCombine combine; /*!< Combination with the previous terms */
+    PredicateType    type;    /*!< Type of the term */
+    uint32_t         operand; /*!< GPR index for the register terms (as used by QBDI_GPR_GET), 
+                               *   MEMORY_READ or MEMORY_WRITE for the memory access terms */
+    rword            mask;    /*!< Mask applied before an equality comparison */
+    rword            value;   /*!< Compared value, or start of the range */
+    rword            limit;   /*!< End of the range (not included) */
+};
+
+/*! Frame of the shadow call stack
+ */
+struct CallFrame {
+    rword callSite;      /*!< Address of the call instruction */
+    rword returnAddress; /*!< Address the function returns to */
+    rword target;        /*!< Address of the called function */
+    rword stackPointer;  /*!< Value of the stack pointer after the call (address of the return address) */
+};
+
+/*! Target observed at an indirect branch site
+ */
+struct BranchTarget {
+    rword    target; /*!< Address of the target */
+    uint64_t count;  /*!< Number of times the branch went to this target */
+};
+
+/*! Unit of an execution budget
+ */
+typedef enum {
+    _QBDI_EI(BUDGET_INSTRUCTIONS) = 0, /*!< The budget counts the executed instructions */
+    _QBDI_EI(BUDGET_BASIC_BLOCKS) = 1, /*!< The budget counts the executed basic blocks */
+} BudgetType;
+
+/*! Taint label of a byte. The labels are combined with a bitwise OR, 0 means untainted.
+ */
+typedef uint8_t TaintLabel;
+
 #ifdef __cplusplus
 } // QBDI::
 #endif
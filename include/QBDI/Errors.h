@@ -30,6 +30,15 @@ typedef enum {
     _QBDI_EI(INVALID_EVENTID) = 0xffffffff,  /*!< Mark a returned event id as invalid */
 } VMError;
 
+/*! Result of an instrumentation switch
+ */
+typedef enum {
+    _QBDI_EI(SWITCH_UPDATED) = 0,      /*!< The instrumentation has been enabled or disabled */
+    _QBDI_EI(SWITCH_INVALID_ID) = 1,   /*!< No instrumentation is registered with this id */
+    _QBDI_EI(SWITCH_UNSUPPORTED) = 2,  /*!< The instrumentation does not break to the host and 
+                                        *   cannot be skipped by an inline switch */
+} SwitchStatus;
+
 #ifdef __cplusplus
 }
 #endif
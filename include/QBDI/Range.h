@@ -18,6 +18,7 @@
 #ifndef _RANGE_H_
 #define _RANGE_H_
 
+#include <algorithm>
 #include <vector>
 #include <ostream>
 
@@ -84,8 +85,17 @@ template<typename T> class RangeSet {
 
 private:
     
+    // Sorted, disjoint and non adjacent ranges
     std::vector<Range<T>> ranges;
 
+    /*! Index of the first range starting after a value, the only range which can contain the 
+     *  value is the previous one.
+     */
+    size_t upperBound(T t) const {
+        return std::upper_bound(ranges.begin(), ranges.end(), t,
+            [](T v, const Range<T>& r) { return v < r.start; }) - ranges.begin();
+    }
+
 public:
 
     RangeSet() {
@@ -102,143 +112,120 @@ public:
     }
 
     bool contains(T t) const {
-        for(const Range<T> &r : ranges) {
-            if(r.contains(t)) {
-                return true;
-            }
-            if(r.start > t) {
-                return false;
-            }
-        }
-        return false;
+        size_t i = upperBound(t);
+        return i > 0 && ranges[i - 1].contains(t);
     }
 
     bool contains(Range<T> t) const {
-        for(const Range<T> &r : ranges) {
-            if(r.contains(t)) {
-                return true;
-            }
-            if(r.start > t.end) {
-                return false;
-            }
-        }
-        return false;
+        size_t i = upperBound(t.start);
+        return i > 0 && ranges[i - 1].contains(t);
     }
 
     bool overlaps(Range<T> t) const {
-        for(const Range<T> &r : ranges) {
-            if(r.overlaps(t)) {
-                return true;
-            }
-            if(r.end < t.start) {
-                return false;
-            }
-        }
-        return false;
+        // Only the range containing t.start and the first range after it can overlap t
+        size_t i = upperBound(t.start);
+        return (i > 0 && ranges[i - 1].overlaps(t)) || (i < ranges.size() && ranges[i].overlaps(t));
     }
 
     void add(Range<T> t) {
-        size_t i = 0;
-        size_t r = 0;
-
         // Exception for empty ranges
         if(t.end <= t.start) {
             return;
         }
-        
-        // Find start in sorted range list
-        for(i = 0; i < ranges.size(); i++) {
-            if(ranges[i].end >= t.start) {
-                // Add a new range before ranges[i]
-                if(ranges[i].start > t.start) {
-                    ranges.insert(ranges.begin() + i, t);
-                }
-                // else extend ranges[i]
-                r = i;
-                break;
-            }
-        }
-        // If no range to extend or insert before was found
-        if(i == ranges.size()) {
-            ranges.push_back(t);
+        // The ranges [first, last) overlap or touch t and are merged with it
+        size_t first = std::lower_bound(ranges.begin(), ranges.end(), t.start,
+            [](const Range<T>& r, T v) { return r.end < v; }) - ranges.begin();
+        size_t last = upperBound(t.end);
+        if(first == last) {
+            ranges.insert(ranges.begin() + first, t);
             return;
         }
-        // Determine range [r+1,i] of blocks that are covered by t and will be deleted
-        for(i = r; i < ranges.size() && t.end >= ranges[i].end; i++);
-        // If t.end is inside another range, merge it
-        if(i < ranges.size() && t.end >= ranges[i].start) {
-            ranges[r].end = ranges[i].end;
-            if(i > r) {
-                ranges.erase(ranges.begin() + r + 1, ranges.begin() + i + 1);
-            }
+        if(ranges[first].start < t.start) {
+            t.start = ranges[first].start;
         }
-        // Else finish normally
-        else {
-            ranges[r].end = t.end;
-            if(i > r + 1) {
-                ranges.erase(ranges.begin() + r + 1, ranges.begin() + i);
-            }
+        if(ranges[last - 1].end > t.end) {
+            t.end = ranges[last - 1].end;
         }
+        ranges[first] = t;
+        ranges.erase(ranges.begin() + first + 1, ranges.begin() + last);
     }
 
+    /*! Add a set of ranges at once, in a time linear in the number of ranges of both sets.
+     */
     void add(const RangeSet<T>& t) {
-        for(Range<T> r: t.getRanges()) {
-            add(r);
+        const std::vector<Range<T>>& others = t.getRanges();
+        std::vector<Range<T>> merged;
+        size_t i = 0, j = 0;
+
+        merged.reserve(ranges.size() + others.size());
+        while(i < ranges.size() || j < others.size()) {
+            const Range<T>& r = (j == others.size() || (i < ranges.size() && ranges[i].start < others[j].start)) ?
+                                ranges[i++] : others[j++];
+            if(merged.size() > 0 && merged.back().end >= r.start) {
+                if(merged.back().end < r.end) {
+                    merged.back().end = r.end;
+                }
+            }
+            else {
+                merged.push_back(r);
+            }
         }
+        ranges.swap(merged);
     }
 
     void remove(Range<T> t) {
-        size_t i = 0;
-        size_t r = 0;
-
         // Exception for empty ranges
         if(t.end <= t.start) {
             return;
         }
-        
-        // Find deletion start
-        for(i = 0; i < ranges.size(); i++) {
-            if(ranges[i].end >= t.start) {
-                // start inside a range
-                if(ranges[i].start < t.start) {
-                    // Split a range
-                    if(t.end < ranges[i].end) {
-                        ranges.insert(ranges.begin() + i, Range<T>(ranges[i].start, t.start));
-                        ranges[i+1].start = t.end;
-                        return;
-                    }
-                    // Truncate a range
-                    else {
-                        ranges[i].end = t.start;
-                        r = i + 1;
-                        break;
-                    }
-                }
-                // start before a range
-                r = i;
-                break;
-            }
-        }
-        // If no range to delete was found
-        if(i == ranges.size()) {
+        // The ranges [first, last) share at least one value with t
+        size_t first = std::upper_bound(ranges.begin(), ranges.end(), t.start,
+            [](T v, const Range<T>& r) { return v < r.end; }) - ranges.begin();
+        size_t last = std::lower_bound(ranges.begin(), ranges.end(), t.end,
+            [](const Range<T>& r, T v) { return r.start < v; }) - ranges.begin();
+        if(first == last) {
             return;
         }
-        // Determine set of ranges contained inside t which will be deleted
-        for(i = r; i < ranges.size() && t.end >= ranges[i].end; i++);
-        // Truncate a range
-        if(i < ranges.size() && t.end >= ranges[i].start) {
-            ranges[i].start = t.end;
+        // Keep the parts of the first and last ranges outside of t
+        std::vector<Range<T>> kept;
+        if(ranges[first].start < t.start) {
+            kept.push_back(Range<T>(ranges[first].start, t.start));
         }
-        // Delete covered range
-        if(i > r) {
-            ranges.erase(ranges.begin() + r, ranges.begin() + i);
+        if(ranges[last - 1].end > t.end) {
+            kept.push_back(Range<T>(t.end, ranges[last - 1].end));
         }
+        ranges.erase(ranges.begin() + first, ranges.begin() + last);
+        ranges.insert(ranges.begin() + first, kept.begin(), kept.end());
     }
 
+    /*! Remove a set of ranges at once, in a time linear in the number of ranges of both sets.
+     */
     void remove(const RangeSet<T>& t) {
-        for(Range<T> r: t.getRanges()) {
-            remove(r);
+        const std::vector<Range<T>>& others = t.getRanges();
+        std::vector<Range<T>> remaining;
+        size_t j = 0;
+
+        remaining.reserve(ranges.size() + others.size());
+        for(Range<T> r : ranges) {
+            // Skip the removed ranges ending before r
+            while(j < others.size() && others[j].end <= r.start) {
+                j++;
+            }
+            // Cut r by the removed ranges overlapping it
+            for(size_t k = j; k < others.size() && others[k].start < r.end; k++) {
+                if(r.start < others[k].start) {
+                    remaining.push_back(Range<T>(r.start, others[k].start));
+                }
+                r.start = others[k].end;
+                if(r.end <= r.start) {
+                    break;
+                }
+            }
+            if(r.start < r.end) {
+                remaining.push_back(r);
+            }
         }
+        ranges.swap(remaining);
     }
 
     void intersect(const RangeSet<T>& t) {
@@ -28,6 +28,7 @@
 #include "Errors.h"
 #include "State.h"
 #include "InstAnalysis.h"
+#include "Range.h"
 
 namespace QBDI {
 
@@ -35,18 +36,26 @@ namespace QBDI {
 class Engine;
 // Foward declaration of (currently) private InstrRule
 class InstrRule;
-// Forward declaration of private memCBInfo
-struct MemCBInfo;
+// Forward declaration of private MemWatch
+class MemWatch;
+// Forward declaration of private Sampler
+class Sampler;
 
 class QBDI_EXPORT VM {
     private:
     // Private internal engine
     Engine*     engine;
     uint8_t  memoryLoggingLevel;
-    std::vector<std::pair<uint32_t, MemCBInfo>>* memCBInfos;
+    MemWatch*   memWatch;
     uint32_t memCBID;
     uint32_t memReadGateCBID;
     uint32_t memWriteGateCBID;
+    std::vector<std::pair<uint32_t, uint64_t*>>* counters;
+    std::vector<std::pair<uint32_t, Sampler*>>* samplers;
+
+    uint32_t addCounterRule(InstrRule rule, uint64_t* counter);
+
+    void releaseSamplers();
 
     public:
     /*! Construct a new VM for a given CPU with specific attributes
@@ -89,6 +98,13 @@ class QBDI_EXPORT VM {
      */
     void         addInstrumentedRange(rword start, rword end);
 
+    /*! Add a set of address ranges to the set of instrumented address ranges at once. This is 
+     *  linear in the number of ranges, instead of adding them one by one.
+     *
+     * @param[in] ranges  The address ranges.
+     */
+    void         addInstrumentedRanges(const RangeSet<rword>& ranges);
+
     /*! Add the executable address ranges of a module to the set of instrumented address ranges.
      *
      * @param[in] name  The module's name.
@@ -118,6 +134,12 @@ class QBDI_EXPORT VM {
      */
     void         removeInstrumentedRange(rword start, rword end);
 
+    /*! Remove a set of address ranges from the set of instrumented address ranges at once.
+     *
+     * @param[in] ranges  The address ranges.
+     */
+    void         removeInstrumentedRanges(const RangeSet<rword>& ranges);
+
     /*! Remove the executable address ranges of a module from the set of instrumented address ranges.
      *
      * @param[in] name  The module's name.
@@ -139,6 +161,20 @@ class QBDI_EXPORT VM {
      */
     void         removeAllInstrumentedRanges();
 
+    /*! Enable or disable the native calls. When enabled, a call whose target is known at 
+     *  translation time and outside of the instrumented ranges (a direct call, a call to a PLT stub 
+     *  or through a RIP relative pointer) is performed natively: the callee returns straight into 
+     *  the rest of the basic block, without any execution transfer. The callee thus sees a return 
+     *  address inside the VM, no EXEC_TRANSFER_CALL and EXEC_TRANSFER_RETURN events are 
+     *  signaled and the stack write of the call is reported after it returned. The callee must 
+     *  follow the calling convention as R11 is used to hold the target. Only available on X86_64.
+     *
+     * @param[in] enable  True to enable the native calls, false to disable them.
+     *
+     * @return True if the native calls have been enabled (or disabled).
+     */
+    bool         setFastNativeCalls(bool enable);
+
     /*! Start the execution by the DBI.
      *
      * @param[in] start  Address of the first instruction to execute.
@@ -148,6 +184,24 @@ class QBDI_EXPORT VM {
      */
     bool        run(rword start, rword stop);
 
+    /*! Start the execution by the DBI and stop it once a budget of instructions or basic blocks
+     *  has been executed. The budget is consumed by an inline countdown at the entry of each 
+     *  basic block, the last one being completed up to the exact instruction. When the budget is 
+     *  exhausted, the PC of the GPR state is the next instruction to execute and the execution 
+     *  can be resumed from it. Only available on X86_64.
+     *
+     * @param[in]  start     Address of the first instruction to execute.
+     * @param[in]  stop      Stop the execution when this instruction is reached.
+     * @param[in]  budget    The maximum number of instructions or basic blocks to execute.
+     * @param[in]  type      The unit of the budget.
+     * @param[out] executed  The number of instructions or basic blocks executed (optional). The
+     *                       basic block of the stop address is counted as a whole.
+     *
+     * @return  True if at least one block has been executed.
+     */
+    bool        runWithBudget(rword start, rword stop, uint64_t budget, BudgetType type = BUDGET_INSTRUCTIONS,
+                              uint64_t* executed = nullptr);
+
     /*! Call a function using the DBI (and its current state).
      *
      * @param[in] [retval]   Pointer to the returned value (optional).
@@ -207,47 +261,173 @@ class QBDI_EXPORT VM {
      * @param[in] pos        Relative position of the event callback (PREINST / POSTINST).
      * @param[in] cbk        A function pointer to the callback.
      * @param[in] data       User defined data passed to the callback.
+     * @param[in] predicate  An optional inline predicate. The callback is only called when it 
+     *                       holds, the predicate being evaluated by the instrumentation itself 
+     *                       without breaking to the host.
      *
      * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
      * in case of failure).
      */
-    uint32_t addMnemonicCB(const char* mnemonic, InstPosition pos, InstCallback cbk, void *data);
+    uint32_t addMnemonicCB(const char* mnemonic, InstPosition pos, InstCallback cbk, void *data,
+                           const std::vector<Predicate>& predicate = {});
 
     /*! Register a callback event for every instruction executed.
      *
-     * @param[in] pos   Relative position of the event callback (PREINST / POSTINST).
-     * @param[in] cbk   A function pointer to the callback.
-     * @param[in] data  User defined data passed to the callback.
+     * @param[in] pos        Relative position of the event callback (PREINST / POSTINST).
+     * @param[in] cbk        A function pointer to the callback.
+     * @param[in] data       User defined data passed to the callback.
+     * @param[in] predicate  An optional inline predicate. The callback is only called when it 
+     *                       holds, the predicate being evaluated by the instrumentation itself 
+     *                       without breaking to the host.
      *
      * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
      * in case of failure).
      */
-    uint32_t    addCodeCB(InstPosition pos, InstCallback cbk, void *data);
+    uint32_t    addCodeCB(InstPosition pos, InstCallback cbk, void *data,
+                          const std::vector<Predicate>& predicate = {});
 
      /*! Register a callback for when a specific address is executed.
      *
-     * @param[in] address  Code address which will trigger the callback.
-     * @param[in] pos      Relative position of the callback (PREINST / POSTINST).
-     * @param[in] cbk      A function pointer to the callback.
-     * @param[in] data     User defined data passed to the callback.
+     * @param[in] address    Code address which will trigger the callback.
+     * @param[in] pos        Relative position of the callback (PREINST / POSTINST).
+     * @param[in] cbk        A function pointer to the callback.
+     * @param[in] data       User defined data passed to the callback.
+     * @param[in] predicate  An optional inline predicate. The callback is only called when it 
+     *                       holds, the predicate being evaluated by the instrumentation itself 
+     *                       without breaking to the host.
      *
      * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
      * in case of failure).
      */
-    uint32_t    addCodeAddrCB(rword address, InstPosition pos, InstCallback cbk, void *data);
+    uint32_t    addCodeAddrCB(rword address, InstPosition pos, InstCallback cbk, void *data,
+                              const std::vector<Predicate>& predicate = {});
 
     /*! Register a callback for when a specific address range is executed.
      *
-     * @param[in] start    Start of the address range which will trigger the callback.
-     * @param[in] end      End of the address range which will trigger the callback.
-     * @param[in] pos     Relative position of the callback (PREINST / POSTINST).
-     * @param[in] cbk     A function pointer to the callback.
-     * @param[in] data    User defined data passed to the callback.
+     * @param[in] start      Start of the address range which will trigger the callback.
+     * @param[in] end        End of the address range which will trigger the callback.
+     * @param[in] pos        Relative position of the callback (PREINST / POSTINST).
+     * @param[in] cbk        A function pointer to the callback.
+     * @param[in] data       User defined data passed to the callback.
+     * @param[in] predicate  An optional inline predicate. The callback is only called when it 
+     *                       holds, the predicate being evaluated by the instrumentation itself 
+     *                       without breaking to the host.
+     *
+     * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
+     * in case of failure).
+     */
+    uint32_t    addCodeRangeCB(rword start, rword end, InstPosition pos, InstCallback cbk, void *data,
+                               const std::vector<Predicate>& predicate = {});
+
+    /*! Register a sampled callback event for every instruction executed. The callback is only 
+     *  called once every period executions, the countdown being decremented by the 
+     *  instrumentation itself without breaking to the host.
+     *
+     * @param[in] pos         Relative position of the event callback (PREINST / POSTINST).
+     * @param[in] cbk         A function pointer to the callback.
+     * @param[in] data        User defined data passed to the callback.
+     * @param[in] period      The sampling period, in executions.
+     * @param[in] randomized  Draw each interval uniformly between 1 and 2 * period - 1 instead
+     *                        of using a fixed one, which avoids aliasing with periodic code.
+     * @param[in] predicate   An optional inline predicate. Only the executions where it holds
+     *                        are sampled.
+     *
+     * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
+     * in case of failure).
+     */
+    uint32_t    addSampledCodeCB(InstPosition pos, InstCallback cbk, void *data, uint32_t period,
+                                 bool randomized = false, const std::vector<Predicate>& predicate = {});
+
+    /*! Register a sampled callback for when a specific address range is executed. The callback 
+     *  is only called once every period executions, the countdown being decremented by the 
+     *  instrumentation itself without breaking to the host.
+     *
+     * @param[in] start       Start of the address range which will trigger the callback.
+     * @param[in] end         End of the address range which will trigger the callback.
+     * @param[in] pos         Relative position of the callback (PREINST / POSTINST).
+     * @param[in] cbk         A function pointer to the callback.
+     * @param[in] data        User defined data passed to the callback.
+     * @param[in] period      The sampling period, in executions.
+     * @param[in] randomized  Draw each interval uniformly between 1 and 2 * period - 1 instead
+     *                        of using a fixed one, which avoids aliasing with periodic code.
+     * @param[in] predicate   An optional inline predicate. Only the executions where it holds
+     *                        are sampled.
+     *
+     * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
+     * in case of failure).
+     */
+    uint32_t    addSampledCodeRangeCB(rword start, rword end, InstPosition pos, InstCallback cbk, void *data,
+                                      uint32_t period, bool randomized = false,
+                                      const std::vector<Predicate>& predicate = {});
+
+    /*! Register an inline counter incremented before every instruction executed. Counting is 
+     *  done directly in the instrumented code and does not break to the host.
+     *
+     * @param[in] counter  Pointer to a user allocated 64 bits counter.
+     * @param[in] atomic   Use an atomic increment (slower, only needed if the counter is shared 
+     *                     between threads).
+     *
+     * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
+     * in case of failure).
+     */
+    uint32_t    addCodeCounter(uint64_t* counter, bool atomic = false);
+
+    /*! Register an inline counter incremented each time a specific address is executed. Using the
+     *  start address of a basic block counts the executions of this basic block.
+     *
+     * @param[in] address  Code address which will increment the counter.
+     * @param[in] counter  Pointer to a user allocated 64 bits counter.
+     * @param[in] atomic   Use an atomic increment (slower, only needed if the counter is shared 
+     *                     between threads).
+     *
+     * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
+     * in case of failure).
+     */
+    uint32_t    addCodeAddrCounter(rword address, uint64_t* counter, bool atomic = false);
+
+    /*! Register an inline counter incremented for every instruction executed in an address range.
+     *
+     * @param[in] start    Start of the address range which will increment the counter.
+     * @param[in] end      End of the address range which will increment the counter.
+     * @param[in] counter  Pointer to a user allocated 64 bits counter.
+     * @param[in] atomic   Use an atomic increment (slower, only needed if the counter is shared 
+     *                     between threads).
+     *
+     * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
+     * in case of failure).
+     */
+    uint32_t    addCodeRangeCounter(rword start, rword end, uint64_t* counter, bool atomic = false);
+
+    /*! Register an inline counter incremented for every instruction executed matching the mnemonic.
+     *
+     * @param[in] mnemonic Mnemonic to match.
+     * @param[in] counter  Pointer to a user allocated 64 bits counter.
+     * @param[in] atomic   Use an atomic increment (slower, only needed if the counter is shared 
+     *                     between threads).
      *
      * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
      * in case of failure).
      */
-    uint32_t    addCodeRangeCB(rword start, rword end, InstPosition pos, InstCallback cbk, void *data);
+    uint32_t    addMnemonicCounter(const char* mnemonic, uint64_t* counter, bool atomic = false);
+
+    /*! Obtain a snapshot of the values of all the registered inline counters.
+     *
+     * @return List of the counter values associated with their instrumentation id.
+     */
+    std::vector<CounterValue> getCounters() const;
+
+    /*! Enable an AFL style edge coverage instrumentation, computed inline at the start of every 
+     * basic block: the byte of the bitmap indexed by the hash of the (previous, current) basic 
+     * block pair is incremented. The previous location is reset at the start of each run. 
+     * Only available on X86_64.
+     *
+     * @param[in] bitmap  The coverage bitmap (for example an AFL shared memory area), or NULL 
+     *                    to disable the edge coverage.
+     * @param[in] size    The size of the bitmap in bytes, which must be a power of two.
+     *
+     * @return True if the edge coverage has been enabled (or disabled).
+     */
+    bool        setEdgeCoverage(uint8_t* bitmap, size_t size);
 
     /*! Register a callback event for every memory access matching the type bitfield made by the instructions.
      *
@@ -263,7 +443,7 @@ class QBDI_EXPORT VM {
     
     /*! Add a virtual callback which is triggered for any memory access at a specific address 
      *  matching the access type. Virtual callbacks are called via callback forwarding by a 
-     *  gate callback triggered on every memory access. This incurs a high performance cost.
+     *  gate callback, only triggered when an inline check finds the access may hit a range.
      *
      * @param[in] address  Code address which will trigger the callback.
      * @param[in] type     A mode bitfield: either QBDI::MEMORY_READ, QBDI::MEMORY_WRITE or both
@@ -278,7 +458,7 @@ class QBDI_EXPORT VM {
 
     /*! Add a virtual callback which is triggered for any memory access in a specific address range 
      *  matching the access type. Virtual callbacks are called via callback forwarding by a 
-     *  gate callback triggered on every memory access. This incurs a high performance cost.
+     *  gate callback, only triggered when an inline check finds the access may hit a range.
      *
      * @param[in] start    Start of the address range which will trigger the callback.
      * @param[in] end      End of the address range which will trigger the callback.
@@ -304,6 +484,50 @@ class QBDI_EXPORT VM {
      */
     uint32_t    addVMEventCB(VMEvent mask, VMCallback cbk, void *data);
 
+    /*! Register a sampled callback event for a specific VM event. The callback is only called 
+     *  once every period events.
+     *
+     * @param[in] mask        A mask of VM event type which will trigger the callback.
+     * @param[in] cbk         A function pointer to the callback.
+     * @param[in] data        User defined data passed to the callback.
+     * @param[in] period      The sampling period, in events.
+     * @param[in] randomized  Draw each interval uniformly between 1 and 2 * period - 1 instead
+     *                        of using a fixed one.
+     *
+     * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
+     * in case of failure).
+     */
+    uint32_t    addSampledVMEventCB(VMEvent mask, VMCallback cbk, void *data, uint32_t period, 
+                                    bool randomized = false);
+
+    /*! Replace a function by another one. When the execution reaches the entry of the target, it 
+     *  is redirected to the replacement which receives the original arguments and returns 
+     *  directly to the caller. A replacement which is not instrumented is executed natively, 
+     *  through an execution transfer, without any callback.
+     *
+     * @param[in] target       The entry address of the replaced function.
+     * @param[in] replacement  The address of the replacement function, with the same prototype.
+     *
+     * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
+     * in case of failure).
+     */
+    uint32_t    replaceFunction(rword target, rword replacement);
+
+    /*! Wrap a function with callbacks called when it is entered and when it returns to its 
+     *  caller. They receive the arguments and the return value in the guest state. The function
+     *  is skipped if the pre callback changes the value of PC, the post callback is then not 
+     *  called. Neither the registration nor the deletion flushes the translation cache.
+     *
+     * @param[in] target  The entry address of the wrapped function.
+     * @param[in] pre     The callback called on the entry of the function (can be NULL).
+     * @param[in] post    The callback called on the return of the function (can be NULL).
+     * @param[in] data    User defined data passed to the callbacks.
+     *
+     * @return The id of the registered instrumentation (or VMError::INVALID_EVENTID
+     * in case of failure).
+     */
+    uint32_t    wrapFunction(rword target, InstCallback pre, InstCallback post, void *data);
+
    /*! Remove an instrumentation.
      *
      * @param[in] id The id of the instrumentation to remove.
@@ -312,6 +536,23 @@ class QBDI_EXPORT VM {
      */
     bool        deleteInstrumentation(uint32_t id);
 
+    /*! Enable or disable an instrumentation without flushing the translation cache. A disabled
+     *  callback is skipped by an inline switch, the first call for a callback instrumenting code 
+     *  adds this switch and translates again its instrumented range once, the following calls 
+     *  have a constant cost. Only the instrumentations calling a callback can be switched: the 
+     *  switch is read by the gate of the callback, the inline instrumentations which never break 
+     *  to the host (counters, countdowns, taint propagation, ...) have no such gate and have to 
+     *  be deleted instead. Instrumentation switches are only supported under X86_64.
+     *
+     * @param[in] id      The id of the instrumentation.
+     * @param[in] enable  Whether the instrumentation should be enabled.
+     *
+     * @return  SWITCH_UPDATED if the instrumentation has been updated, SWITCH_INVALID_ID if no 
+     *          instrumentation has this id, SWITCH_UNSUPPORTED if the instrumentation cannot be 
+     *          switched.
+     */
+    SwitchStatus setInstrumentationEnabled(uint32_t id, bool enable);
+
     /*! Remove all the registered instrumentations.
      *
      */
@@ -351,7 +592,159 @@ class QBDI_EXPORT VM {
      */
     std::vector<MemoryAccess> getBBMemoryAccess() const;
 
-    /*! Pre-cache a known basic block
+    /*! Obtain the complete value of a memory access of the current basic block which is larger 
+     *  than a rword (flagged with QBDI::MEMORY_PARTIAL_VALUE). The access has to come from 
+     *  getInstMemoryAccess() or getBBMemoryAccess(); the value of string operations 
+     *  (flagged with QBDI::MEMORY_UNKNOWN_VALUE) is not recorded.
+     *
+     * @param[in]  access  The memory access.
+     * @param[out] buffer  The buffer receiving the value.
+     * @param[in]  size    The size of the buffer, at most the size of the access is copied.
+     *
+     * @return True if the value has been copied, False if it was not recorded.
+     */
+    bool getMemoryAccessValue(const MemoryAccess& access, void* buffer, size_t size) const;
+
+    /*! Stream the memory accesses to a callback. The accesses are appended by inline 
+     *  instrumentation to a trace buffer owned by the VM, without breaking to the host, and are 
+     *  delivered in batches once the buffer holds at least batchSize records and at the end of 
+     *  each run. Only available on X86_64.
+     *
+     * @param[in] type       Memory mode bitfield to trace: either QBDI::MEMORY_READ, 
+     *                       QBDI::MEMORY_WRITE or both (QBDI::MEMORY_READ_WRITE). 0 disables 
+     *                       the memory trace.
+     * @param[in] cbk        The callback receiving the batches of memory accesses (NULL disables 
+     *                       the memory trace).
+     * @param[in] data       User defined data passed to the callback.
+     * @param[in] batchSize  The number of records triggering a delivery.
+     *
+     * @return True if the memory trace has been enabled (or disabled).
+     */
+    bool setMemoryTrace(MemoryAccessType type, MemoryTraceCallback cbk, void *data, size_t batchSize = 4096);
+
+    /*! Deliver immediately the pending memory trace records to the trace callback.
+     */
+    void flushMemoryTrace();
+
+    /*! Stream the executed syscalls to a callback. Their number, arguments and return value are 
+     *  appended by inline instrumentation to a ring buffer owned by the VM, without breaking to 
+     *  the host, and are delivered in batches once the buffer holds at least batchSize records 
+     *  and at the end of each run. The syscalls which do not return (exit, exit_group, execve) 
+     *  are delivered before their execution, with a zero return value. Only available on X86_64.
+     *
+     * @param[in] cbk        The callback receiving the batches of syscalls (NULL disables the 
+     *                       syscall trace).
+     * @param[in] data       User defined data passed to the callback.
+     * @param[in] batchSize  The number of records triggering a delivery.
+     *
+     * @return True if the syscall trace has been enabled (or disabled).
+     */
+    bool setSyscallTrace(SyscallTraceCallback cbk, void *data, size_t batchSize = 256);
+
+    /*! Deliver immediately the pending syscall trace records to the trace callback.
+     */
+    void flushSyscallTrace();
+
+    /*! Enable or disable the shadow call stack. It is maintained inline, without breaking to the 
+     *  host, by the code simulating the call and return instructions. The functions left without 
+     *  an instrumented return (non instrumented code, longjmp) are popped from it once the 
+     *  execution comes back to the VM. It is enabled automatically when a callback is registered 
+     *  for the FUNCTION_ENTRY or FUNCTION_EXIT events. Only available on X86_64.
+     *
+     * @param[in] enable  True to enable the call stack tracking, false to disable it.
+     *
+     * @return True if the call stack tracking has been enabled (or disabled).
+     */
+    bool setCallStackTracking(bool enable);
+
+    /*! Obtain the current call stack, from the shadow call stack. The call stack tracking needs to 
+     *  be enabled. The frames entered before the start of the current run are also reported.
+     *
+     * @return The call frames, from the innermost to the outermost one.
+     */
+    std::vector<CallFrame> getCallStack() const;
+
+    /*! Enable or disable the profiling of the targets of the indirect jumps and calls. Each site 
+     *  counts inline the executions going to its first four targets and only breaks to the host 
+     *  for the other targets, which are counted by the host. Enabling it again starts a new 
+     *  profile. Only available on X86_64.
+     *
+     * @param[in] enable  True to enable the branch profiling, false to disable it.
+     *
+     * @return True if the branch profiling has been enabled (or disabled).
+     */
+    bool setBranchProfiling(bool enable);
+
+    /*! Obtain the addresses of the indirect branch sites executed since the branch profiling was 
+     *  enabled.
+     *
+     * @return The addresses of the branch instructions, in increasing order.
+     */
+    std::vector<rword> getBranchSites() const;
+
+    /*! Obtain the targets observed at an indirect branch site.
+     *
+     * @param[in] site  The address of the branch instruction.
+     *
+     * @return The targets with their counts, from the most to the least frequent one.
+     */
+    std::vector<BranchTarget> getBranchTargets(rword site) const;
+
+    /*! Enable or disable the byte-level taint tracking. Every byte of the general purpose 
+     *  registers and of the memory carries a TaintLabel which is propagated inline through the 
+     *  data flow of the instructions: the result bytes of a move or a bitwise operation get the 
+     *  labels of the source bytes at the same position, the other instructions give the union of 
+     *  all their source labels to every result byte. The flags, the control flow and the 
+     *  addresses used by the memory accesses do not propagate the taint. Vector registers carry a 
+     *  label per 8 bytes lane. A partial register write keeps the labels of the bytes it does not 
+     *  reach, unless it zeroes them like a 32 bits write. The memory labels are kept in a shadow which aliases the addresses modulo 
+     *  2^36. Only available on X86_64 Linux and macOS.
+     *
+     * @param[in] enable  True to enable the taint tracking, false to disable it.
+     *
+     * @return True if the taint tracking has been enabled (or disabled).
+     */
+    bool setTaintTracking(bool enable);
+
+    /*! Set the taint label of a memory range. The taint tracking needs to be enabled.
+     *
+     * @param[in] start  Start address of the range.
+     * @param[in] size   Size of the range in bytes.
+     * @param[in] label  The taint label of the range bytes, 0 to untaint them.
+     *
+     * @return True if the label has been set.
+     */
+    bool setMemoryTaint(rword start, rword size, TaintLabel label);
+
+    /*! Get the taint of a memory range.
+     *
+     * @param[in] start  Start address of the range.
+     * @param[in] size   Size of the range in bytes.
+     *
+     * @return The union of the taint labels of the range bytes.
+     */
+    TaintLabel getMemoryTaint(rword start, rword size) const;
+
+    /*! Set the taint label of every byte of a general purpose register.
+     *
+     * @param[in] gpr    The GPR index (as used by QBDI_GPR_GET). The stack and instruction 
+     *                   pointers can not be tainted.
+     * @param[in] label  The taint label of the register bytes, 0 to untaint them.
+     *
+     * @return True if the label has been set.
+     */
+    bool setRegisterTaint(unsigned int gpr, TaintLabel label);
+
+    /*! Get the taint of a general purpose register.
+     *
+     * @param[in] gpr  The GPR index (as used by QBDI_GPR_GET).
+     *
+     * @return The union of the taint labels of the register bytes.
+     */
+    TaintLabel getRegisterTaint(unsigned int gpr) const;
+
+    /*! Pre-cache a known basic block. The cache flushes queued by the instrumentation changes
+     *  are applied first when called outside of a run.
      *
      * @param[in] pc   Start address of a basic block
      *
@@ -359,7 +752,8 @@ class QBDI_EXPORT VM {
      */
     bool precacheBasicBlock(rword pc);
 
-    /*! Clear a specific address range from the translation cache.
+    /*! Clear a specific address range from the translation cache. Its code is disassembled again
+     *  on the next execution, this needs to be called when the instrumented code is modified.
      *
      * @param[in] start Start of the address range to clear from the cache.
      * @param[in] end   End of the address range to clear from the cache.
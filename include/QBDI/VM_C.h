@@ -57,6 +57,16 @@ QBDI_EXPORT void qbdi_terminateVM(VMInstanceRef instance);
  */
 QBDI_EXPORT void qbdi_addInstrumentedRange(VMInstanceRef instance, rword start, rword end);
 
+/*! Add several address ranges to the set of instrumented address ranges at once. This is linear
+ *  in the number of ranges, instead of adding them one by one.
+ *
+ * @param[in] instance  VM instance.
+ * @param[in] starts    Start addresses of the ranges (included).
+ * @param[in] ends      End addresses of the ranges (excluded).
+ * @param[in] size      Number of ranges.
+ */
+QBDI_EXPORT void qbdi_addInstrumentedRanges(VMInstanceRef instance, const rword* starts, const rword* ends, size_t size);
+
 /*! Add the executable address ranges of a module to the set of instrumented address ranges.
  *
  * @param[in] instance VM instance.
@@ -92,6 +102,15 @@ QBDI_EXPORT bool qbdi_instrumentAllExecutableMaps(VMInstanceRef instance);
  */
 QBDI_EXPORT void qbdi_removeInstrumentedRange(VMInstanceRef instance, rword start, rword end);
 
+/*! Remove several address ranges from the set of instrumented address ranges at once.
+ *
+ * @param[in] instance  VM instance.
+ * @param[in] starts    Start addresses of the ranges (included).
+ * @param[in] ends      End addresses of the ranges (excluded).
+ * @param[in] size      Number of ranges.
+ */
+QBDI_EXPORT void qbdi_removeInstrumentedRanges(VMInstanceRef instance, const rword* starts, const rword* ends, size_t size);
+
 /*! Remove the executable address ranges of a module from the set of instrumented address ranges.
  *
  * @param[in] instance  VM instance.
@@ -117,6 +136,20 @@ QBDI_EXPORT bool qbdi_removeInstrumentedModuleFromAddr(VMInstanceRef instance, r
  */
 QBDI_EXPORT void qbdi_removeAllInstrumentedRanges(VMInstanceRef instance);
 
+/*! Enable or disable the native calls. When enabled, a call whose target is known at translation 
+ *  time and outside of the instrumented ranges (a direct call, a call to a PLT stub or through a 
+ *  RIP relative pointer) is performed natively: the callee returns straight into the rest of the 
+ *  basic block, without any execution transfer. The callee thus sees a return address inside the 
+ *  VM, no EXEC_TRANSFER_CALL and EXEC_TRANSFER_RETURN events are signaled and the stack write of 
+ *  the call is reported after it returned. Only available on X86_64.
+ *
+ * @param[in] instance  VM instance.
+ * @param[in] enable    True to enable the native calls, false to disable them.
+ *
+ * @return True if the native calls have been enabled (or disabled).
+ */
+QBDI_EXPORT bool qbdi_setFastNativeCalls(VMInstanceRef instance, bool enable);
+
 /*! Start the execution by the DBI from a given address (and stop when another is reached).
  *
  * @param[in] instance  VM instance.
@@ -127,6 +160,21 @@ QBDI_EXPORT void qbdi_removeAllInstrumentedRanges(VMInstanceRef instance);
  */
 QBDI_EXPORT bool qbdi_run(VMInstanceRef instance, rword start, rword stop);
 
+/*! Start the execution by the DBI and stop it once a budget of instructions or basic blocks has 
+ *  been executed. When the budget is exhausted, the PC of the GPR state is the next instruction 
+ *  to execute and the execution can be resumed from it. Only available on X86_64.
+ *
+ * @param[in]  instance  VM instance.
+ * @param[in]  start     Address of the first instruction to execute.
+ * @param[in]  stop      Stop the execution when this instruction is reached.
+ * @param[in]  budget    The maximum number of instructions or basic blocks to execute.
+ * @param[in]  type      The unit of the budget.
+ * @param[out] executed  The number of instructions or basic blocks executed (can be NULL).
+ *
+ * @return  True if at least one block has been executed.
+ */
+QBDI_EXPORT bool qbdi_runWithBudget(VMInstanceRef instance, rword start, rword stop, uint64_t budget, BudgetType type, uint64_t* executed);
+
 /*! Call a function using the DBI (and its current state).
  *
  * @param[in] instance   VM instance.
@@ -220,7 +268,7 @@ QBDI_EXPORT uint32_t qbdi_addMemAccessCB(VMInstanceRef instance, MemoryAccessTyp
 
 /*! Add a virtual callback which is triggered for any memory access at a specific address 
  *  matching the access type. Virtual callbacks are called via callback forwarding by a 
- *  gate callback triggered on every memory access. This incurs a high performance cost.
+ *  gate callback, only triggered when an inline check finds the access may hit a range.
  *
  * @param[in] instance  VM instance.
  * @param[in] address  Code address which will trigger the callback.
@@ -235,7 +283,7 @@ QBDI_EXPORT uint32_t qbdi_addMemAddrCB(VMInstanceRef instance, rword address, Me
 
 /*! Add a virtual callback which is triggered for any memory access in a specific address range 
  *  matching the access type. Virtual callbacks are called via callback forwarding by a 
- *  gate callback triggered on every memory access. This incurs a high performance cost.
+ *  gate callback, only triggered when an inline check finds the access may hit a range.
  *
  * @param[in] instance  VM instance.
  * @param[in] start    Start of the address range which will trigger the callback.
@@ -301,6 +349,165 @@ QBDI_EXPORT uint32_t qbdi_addCodeAddrCB(VMInstanceRef instance, rword address, I
  */
 QBDI_EXPORT uint32_t qbdi_addCodeRangeCB(VMInstanceRef instance, rword start, rword end, InstPosition pos, InstCallback cbk, void *data);
 
+/*! Register a callback event for a specific instruction event, only called when an inline 
+ *  predicate holds. The predicate is evaluated by the instrumentation itself without breaking to 
+ *  the host.
+ *
+ * @param[in] instance   VM instance.
+ * @param[in] pos        Relative position of the event callback (QBDI_PREINST / QBDI_POSTINST).
+ * @param[in] cbk        A function pointer to the callback.
+ * @param[in] data       User defined data passed to the callback.
+ * @param[in] predicate  An array of predicate terms.
+ * @param[in] size       The number of predicate terms.
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID
+ * in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_addPredicatedCodeCB(VMInstanceRef instance, InstPosition pos, InstCallback cbk, void *data, const struct Predicate* predicate, size_t size);
+
+/*! Register a callback for when a specific address range is executed, only called when an inline 
+ *  predicate holds.
+ *
+ * @param[in] instance   VM instance.
+ * @param[in] start      Start of the address range which will trigger the callback.
+ * @param[in] end        End of the address range which will trigger the callback.
+ * @param[in] pos        Relative position of the callback (QBDI_PREINST / QBDI_POSTINST).
+ * @param[in] cbk        A function pointer to the callback.
+ * @param[in] data       User defined data passed to the callback.
+ * @param[in] predicate  An array of predicate terms.
+ * @param[in] size       The number of predicate terms.
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID
+ * in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_addPredicatedCodeRangeCB(VMInstanceRef instance, rword start, rword end, InstPosition pos, InstCallback cbk, void *data, const struct Predicate* predicate, size_t size);
+
+/*! Register a callback event if the instruction matches the mnemonic, only called when an inline 
+ *  predicate holds.
+ *
+ * @param[in] instance   VM instance.
+ * @param[in] mnemonic   Mnemonic to match.
+ * @param[in] pos        Relative position of the event callback (QBDI_PREINST / QBDI_POSTINST).
+ * @param[in] cbk        A function pointer to the callback.
+ * @param[in] data       User defined data passed to the callback.
+ * @param[in] predicate  An array of predicate terms.
+ * @param[in] size       The number of predicate terms.
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID
+ * in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_addPredicatedMnemonicCB(VMInstanceRef instance, const char* mnemonic, InstPosition pos, InstCallback cbk, void *data, const struct Predicate* predicate, size_t size);
+
+/*! Register a sampled callback event for every instruction executed. The callback is only called 
+ *  once every period executions, the countdown being decremented by the instrumentation itself 
+ *  without breaking to the host.
+ *
+ * @param[in] instance    VM instance.
+ * @param[in] pos         Relative position of the event callback (QBDI_PREINST / QBDI_POSTINST).
+ * @param[in] cbk         A function pointer to the callback.
+ * @param[in] data        User defined data passed to the callback.
+ * @param[in] period      The sampling period, in executions.
+ * @param[in] randomized  Draw each interval uniformly between 1 and 2 * period - 1 instead of 
+ *                        using a fixed one.
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID
+ * in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_addSampledCodeCB(VMInstanceRef instance, InstPosition pos, InstCallback cbk, void *data, uint32_t period, bool randomized);
+
+/*! Register a sampled callback for when a specific address range is executed. The callback is 
+ *  only called once every period executions, the countdown being decremented by the 
+ *  instrumentation itself without breaking to the host.
+ *
+ * @param[in] instance    VM instance.
+ * @param[in] start       Start of the address range which will trigger the callback.
+ * @param[in] end         End of the address range which will trigger the callback.
+ * @param[in] pos         Relative position of the callback (QBDI_PREINST / QBDI_POSTINST).
+ * @param[in] cbk         A function pointer to the callback.
+ * @param[in] data        User defined data passed to the callback.
+ * @param[in] period      The sampling period, in executions.
+ * @param[in] randomized  Draw each interval uniformly between 1 and 2 * period - 1 instead of 
+ *                        using a fixed one.
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID
+ * in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_addSampledCodeRangeCB(VMInstanceRef instance, rword start, rword end, InstPosition pos, InstCallback cbk, void *data, uint32_t period, bool randomized);
+
+/*! Register an inline counter incremented before every instruction executed. Counting is done 
+ *  directly in the instrumented code and does not break to the host.
+ *
+ * @param[in] instance  VM instance.
+ * @param[in] counter   Pointer to a user allocated 64 bits counter.
+ * @param[in] atomic    Use an atomic increment (slower, only needed if the counter is shared 
+ *                      between threads).
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID
+ * in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_addCodeCounter(VMInstanceRef instance, uint64_t* counter, bool atomic);
+
+/*! Register an inline counter incremented each time a specific address is executed.
+ *
+ * @param[in] instance  VM instance.
+ * @param[in] address   Code address which will increment the counter.
+ * @param[in] counter   Pointer to a user allocated 64 bits counter.
+ * @param[in] atomic    Use an atomic increment (slower, only needed if the counter is shared 
+ *                      between threads).
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID
+ * in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_addCodeAddrCounter(VMInstanceRef instance, rword address, uint64_t* counter, bool atomic);
+
+/*! Register an inline counter incremented for every instruction executed in an address range.
+ *
+ * @param[in] instance  VM instance.
+ * @param[in] start     Start of the address range which will increment the counter.
+ * @param[in] end       End of the address range which will increment the counter.
+ * @param[in] counter   Pointer to a user allocated 64 bits counter.
+ * @param[in] atomic    Use an atomic increment (slower, only needed if the counter is shared 
+ *                      between threads).
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID
+ * in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_addCodeRangeCounter(VMInstanceRef instance, rword start, rword end, uint64_t* counter, bool atomic);
+
+/*! Register an inline counter incremented for every instruction executed matching the mnemonic.
+ *
+ * @param[in] instance  VM instance.
+ * @param[in] mnemonic  Mnemonic to match.
+ * @param[in] counter   Pointer to a user allocated 64 bits counter.
+ * @param[in] atomic    Use an atomic increment (slower, only needed if the counter is shared 
+ *                      between threads).
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID
+ * in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_addMnemonicCounter(VMInstanceRef instance, const char* mnemonic, uint64_t* counter, bool atomic);
+
+/*! Obtain a snapshot of the values of all the registered inline counters.
+ *  Return NULL and a size of 0 if no counter is registered.
+ *
+ *  @param[in]  instance     VM instance.
+ *  @param[out] size         Will be set to the number of elements in the returned array.
+ *
+ * @return An array of counter values, to be freed by the caller.
+ */
+QBDI_EXPORT struct CounterValue* qbdi_getCounters(VMInstanceRef instance, size_t* size);
+
+/*! Enable an AFL style edge coverage instrumentation, computed inline at the start of every 
+ *  basic block. Only available on X86_64.
+ *
+ *  @param[in] instance  VM instance.
+ *  @param[in] bitmap    The coverage bitmap, or NULL to disable the edge coverage.
+ *  @param[in] size      The size of the bitmap in bytes, which must be a power of two.
+ *
+ *  @return True if the edge coverage has been enabled (or disabled).
+ */
+QBDI_EXPORT bool qbdi_setEdgeCoverage(VMInstanceRef instance, uint8_t* bitmap, size_t size);
+
 /*! Register a callback event for a specific VM event.
  *
  * @param[in] instance  VM instance.
@@ -313,6 +520,47 @@ QBDI_EXPORT uint32_t qbdi_addCodeRangeCB(VMInstanceRef instance, rword start, rw
  */
 QBDI_EXPORT uint32_t qbdi_addVMEventCB(VMInstanceRef instance, VMEvent mask, VMCallback cbk, void *data);
 
+/*! Register a sampled callback event for a specific VM event. The callback is only called once 
+ *  every period events.
+ *
+ * @param[in] instance    VM instance.
+ * @param[in] mask        A mask of VM event type which will trigger the callback.
+ * @param[in] cbk         A function pointer to the callback.
+ * @param[in] data        User defined data passed to the callback.
+ * @param[in] period      The sampling period, in events.
+ * @param[in] randomized  Draw each interval uniformly between 1 and 2 * period - 1 instead of 
+ *                        using a fixed one.
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID
+ * in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_addSampledVMEventCB(VMInstanceRef instance, VMEvent mask, VMCallback cbk, void *data, uint32_t period, bool randomized);
+
+/*! Replace a function by another one. When the execution reaches the entry of the target, it is 
+ * redirected to the replacement which receives the original arguments and returns directly to 
+ * the caller. A replacement which is not instrumented is executed natively.
+ *
+ * @param[in] instance     VM instance.
+ * @param[in] target       The entry address of the replaced function.
+ * @param[in] replacement  The address of the replacement function, with the same prototype.
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_replaceFunction(VMInstanceRef instance, rword target, rword replacement);
+
+/*! Wrap a function with callbacks called when it is entered and when it returns to its caller.
+ * The function is skipped if the pre callback changes the value of PC.
+ *
+ * @param[in] instance  VM instance.
+ * @param[in] target    The entry address of the wrapped function.
+ * @param[in] pre       The callback called on the entry of the function (can be NULL).
+ * @param[in] post      The callback called on the return of the function (can be NULL).
+ * @param[in] data      User defined data passed to the callbacks.
+ *
+ * @return The id of the registered instrumentation (or QBDI_INVALID_EVENTID in case of failure).
+ */
+QBDI_EXPORT uint32_t qbdi_wrapFunction(VMInstanceRef instance, rword target, InstCallback pre, InstCallback post, void *data);
+
 /*! Remove an instrumentation.
  *
  * @param[in] instance  VM instance.
@@ -322,6 +570,22 @@ QBDI_EXPORT uint32_t qbdi_addVMEventCB(VMInstanceRef instance, VMEvent mask, VMC
  */
 QBDI_EXPORT bool qbdi_deleteInstrumentation(VMInstanceRef instance, uint32_t id);
 
+/*! Enable or disable an instrumentation without flushing the translation cache. A disabled
+ * callback is skipped by an inline switch, the first call for a callback instrumenting code adds
+ * this switch and translates again its instrumented range once, the following calls have a 
+ * constant cost. Only the instrumentations calling a callback can be switched, the inline 
+ * instrumentations which never break to the host have to be deleted instead.
+ *
+ * @param[in] instance  VM instance.
+ * @param[in] id        The id of the instrumentation.
+ * @param[in] enable    Whether the instrumentation should be enabled.
+ *
+ * @return  QBDI_SWITCH_UPDATED if the instrumentation has been updated, QBDI_SWITCH_INVALID_ID 
+ *          if no instrumentation has this id, QBDI_SWITCH_UNSUPPORTED if the instrumentation 
+ *          cannot be switched.
+ */
+QBDI_EXPORT SwitchStatus qbdi_setInstrumentationEnabled(VMInstanceRef instance, uint32_t id, bool enable);
+
 /*! Remove all the registered instrumentations.
  *
  * @param[in] instance  VM instance.
@@ -370,6 +634,174 @@ QBDI_EXPORT struct MemoryAccess* qbdi_getInstMemoryAccess(VMInstanceRef instance
  */
 QBDI_EXPORT struct MemoryAccess* qbdi_getBBMemoryAccess(VMInstanceRef instance, size_t* size);
 
+/*! Obtain the complete value of a memory access of the current basic block which is larger than 
+ *  a rword (flagged with MEMORY_PARTIAL_VALUE). The access has to come from 
+ *  qbdi_getInstMemoryAccess() or qbdi_getBBMemoryAccess(); the value of string operations 
+ *  (flagged with MEMORY_UNKNOWN_VALUE) is not recorded.
+ *
+ *  @param[in]  instance  VM instance.
+ *  @param[in]  access    The memory access.
+ *  @param[out] buffer    The buffer receiving the value.
+ *  @param[in]  size      The size of the buffer, at most the size of the access is copied.
+ *
+ *  @return True if the value has been copied, False if it was not recorded.
+ */
+QBDI_EXPORT bool qbdi_getMemoryAccessValue(VMInstanceRef instance, const struct MemoryAccess* access, void* buffer, size_t size);
+
+/*! Stream the memory accesses to a callback. The accesses are appended by inline 
+ *  instrumentation to a trace buffer owned by the VM and are delivered in batches once the 
+ *  buffer holds at least batchSize records and at the end of each run. Only available on X86_64.
+ *
+ *  @param[in] instance   VM instance.
+ *  @param[in] type       Memory mode bitfield to trace: either MEMORY_READ, MEMORY_WRITE or both 
+ *                        (MEMORY_READ_WRITE). 0 disables the memory trace.
+ *  @param[in] cbk        The callback receiving the batches of memory accesses (NULL disables the 
+ *                        memory trace).
+ *  @param[in] data       User defined data passed to the callback.
+ *  @param[in] batchSize  The number of records triggering a delivery.
+ *
+ *  @return True if the memory trace has been enabled (or disabled).
+ */
+QBDI_EXPORT bool qbdi_setMemoryTrace(VMInstanceRef instance, MemoryAccessType type, MemoryTraceCallback cbk, void *data, size_t batchSize);
+
+/*! Deliver immediately the pending memory trace records to the trace callback.
+ *
+ *  @param[in] instance   VM instance.
+ */
+QBDI_EXPORT void qbdi_flushMemoryTrace(VMInstanceRef instance);
+
+/*! Stream the executed syscalls to a callback. Their number, arguments and return value are 
+ *  appended by inline instrumentation to a ring buffer owned by the VM and are delivered in 
+ *  batches once the buffer holds at least batchSize records and at the end of each run. The 
+ *  syscalls which do not return (exit, exit_group, execve) are delivered before their 
+ *  execution, with a zero return value. Only available on X86_64.
+ *
+ *  @param[in] instance   VM instance.
+ *  @param[in] cbk        The callback receiving the batches of syscalls (NULL disables the 
+ *                        syscall trace).
+ *  @param[in] data       User defined data passed to the callback.
+ *  @param[in] batchSize  The number of records triggering a delivery.
+ *
+ *  @return True if the syscall trace has been enabled (or disabled).
+ */
+QBDI_EXPORT bool qbdi_setSyscallTrace(VMInstanceRef instance, SyscallTraceCallback cbk, void *data, size_t batchSize);
+
+/*! Deliver immediately the pending syscall trace records to the trace callback.
+ *
+ *  @param[in] instance   VM instance.
+ */
+QBDI_EXPORT void qbdi_flushSyscallTrace(VMInstanceRef instance);
+
+/*! Enable or disable the shadow call stack, maintained inline by the code simulating the call 
+ *  and return instructions. It is enabled automatically when a callback is registered for the 
+ *  FUNCTION_ENTRY or FUNCTION_EXIT events. Only available on X86_64.
+ *
+ *  @param[in] instance  VM instance.
+ *  @param[in] enable    True to enable the call stack tracking, false to disable it.
+ *
+ *  @return True if the call stack tracking has been enabled (or disabled).
+ */
+QBDI_EXPORT bool qbdi_setCallStackTracking(VMInstanceRef instance, bool enable);
+
+/*! Obtain the current call stack, from the shadow call stack.
+ *  Return NULL and a size of 0 if the call stack is empty or not tracked.
+ *
+ *  @param[in]  instance     VM instance.
+ *  @param[out] size         Will be set to the number of elements in the returned array.
+ *
+ * @return An array of call frames, from the innermost to the outermost one, to be freed by the 
+ *         caller.
+ */
+QBDI_EXPORT struct CallFrame* qbdi_getCallStack(VMInstanceRef instance, size_t* size);
+
+/*! Enable or disable the profiling of the targets of the indirect jumps and calls. Each site 
+ *  counts inline the executions going to its first four targets and only breaks to the host for 
+ *  the other targets, which are counted by the host. Enabling it again starts a new profile. 
+ *  Only available on X86_64.
+ *
+ *  @param[in] instance  VM instance.
+ *  @param[in] enable    True to enable the branch profiling, false to disable it.
+ *
+ *  @return True if the branch profiling has been enabled (or disabled).
+ */
+QBDI_EXPORT bool qbdi_setBranchProfiling(VMInstanceRef instance, bool enable);
+
+/*! Obtain the addresses of the indirect branch sites executed since the branch profiling was 
+ *  enabled. Return NULL and a size of 0 if there are none.
+ *
+ *  @param[in]  instance     VM instance.
+ *  @param[out] size         Will be set to the number of elements in the returned array.
+ *
+ * @return An array of branch instruction addresses, in increasing order, to be freed by the 
+ *         caller.
+ */
+QBDI_EXPORT rword* qbdi_getBranchSites(VMInstanceRef instance, size_t* size);
+
+/*! Obtain the targets observed at an indirect branch site.
+ *  Return NULL and a size of 0 if the site has not been executed.
+ *
+ *  @param[in]  instance     VM instance.
+ *  @param[in]  site         The address of the branch instruction.
+ *  @param[out] size         Will be set to the number of elements in the returned array.
+ *
+ * @return An array of targets, from the most to the least frequent one, to be freed by the 
+ *         caller.
+ */
+QBDI_EXPORT struct BranchTarget* qbdi_getBranchTargets(VMInstanceRef instance, rword site, size_t* size);
+
+/*! Enable or disable the byte-level taint tracking. The labels are propagated inline through 
+ *  the data flow of the instructions, but not through the flags, the control flow and the 
+ *  addresses of the memory accesses. The memory labels are kept in a shadow which aliases the 
+ *  addresses modulo 2^36. Only available on X86_64 Linux and macOS.
+ *
+ *  @param[in] instance  VM instance.
+ *  @param[in] enable    True to enable the taint tracking, false to disable it.
+ *
+ *  @return True if the taint tracking has been enabled (or disabled).
+ */
+QBDI_EXPORT bool qbdi_setTaintTracking(VMInstanceRef instance, bool enable);
+
+/*! Set the taint label of a memory range. The taint tracking needs to be enabled.
+ *
+ *  @param[in] instance  VM instance.
+ *  @param[in] start     Start address of the range.
+ *  @param[in] size      Size of the range in bytes.
+ *  @param[in] label     The taint label of the range bytes, 0 to untaint them.
+ *
+ *  @return True if the label has been set.
+ */
+QBDI_EXPORT bool qbdi_setMemoryTaint(VMInstanceRef instance, rword start, rword size, TaintLabel label);
+
+/*! Get the taint of a memory range.
+ *
+ *  @param[in] instance  VM instance.
+ *  @param[in] start     Start address of the range.
+ *  @param[in] size      Size of the range in bytes.
+ *
+ *  @return The union of the taint labels of the range bytes.
+ */
+QBDI_EXPORT TaintLabel qbdi_getMemoryTaint(VMInstanceRef instance, rword start, rword size);
+
+/*! Set the taint label of every byte of a general purpose register.
+ *
+ *  @param[in] instance  VM instance.
+ *  @param[in] gpr       The GPR index (as used by QBDI_GPR_GET). The stack and instruction 
+ *                       pointers can not be tainted.
+ *  @param[in] label     The taint label of the register bytes, 0 to untaint them.
+ *
+ *  @return True if the label has been set.
+ */
+QBDI_EXPORT bool qbdi_setRegisterTaint(VMInstanceRef instance, uint32_t gpr, TaintLabel label);
+
+/*! Get the taint of a general purpose register.
+ *
+ *  @param[in] instance  VM instance.
+ *  @param[in] gpr       The GPR index (as used by QBDI_GPR_GET).
+ *
+ *  @return The union of the taint labels of the register bytes.
+ */
+QBDI_EXPORT TaintLabel qbdi_getRegisterTaint(VMInstanceRef instance, uint32_t gpr);
+
 /*! Pre-cache a known basic block
  *
  *  @param[in]  instance     VM instance.
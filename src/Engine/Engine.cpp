@@ -15,7 +15,11 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
 #include <bitset>
+#include <cstring>
+#include <limits>
+#include <set>
 
 #include "Engine.h"
 #include "Errors.h"
@@ -42,16 +46,44 @@
 #include "Patch/InstInfo.h"
 #include "Utility/Assembly.h"
 #include "Utility/LogSys.h"
+#include "Utility/ModuleRegistry.h"
 #include "Utility/System.h"
 
+#if defined(QBDI_OS_LINUX) || defined(QBDI_OS_ANDROID) || defined(QBDI_OS_DARWIN)
+#include <sys/mman.h>
+#endif
+
 
 // Mask to identify VM events
 #define EVENTID_VM_MASK  (1UL << 30)
+// Size of the taint shadow, the guest addresses alias modulo this size
+#define TAINT_SHADOW_SIZE  (1ULL << 36)
+// The last shadow bytes of an access can overflow the masked address by the access size
+#define TAINT_SHADOW_GUARD 64
+// Number of basic blocks whose patches are kept, the least recently used half is dropped beyond
+#define PATCH_CACHE_SIZE 16384
 
 namespace QBDI {
 
+#if defined(QBDI_ARCH_X86_64)
+// The syscalls after which the execution does not come back: exit and execve, plus exit_group and
+// execveat under Linux
+#if defined(QBDI_OS_DARWIN)
+static const rword NORETURN_SYSCALLS[] = {0x2000001, 0x200003B};
+#else
+static const rword NORETURN_SYSCALLS[] = {60, 231, 59, 322};
+#endif
+#endif
+
 Engine::Engine(const std::string& _cpu, const std::vector<std::string>& _mattrs, VMInstanceRef vminstance)
-    : cpu(_cpu), mattrs(_mattrs), vminstance(vminstance), instrRulesCounter(0), vmCallbacksCounter(0) {
+    : cpu(_cpu), mattrs(_mattrs), vminstance(vminstance), instrRulesCounter(0), ruleIndexValid(false), vmCallbacksCounter(0),
+      coverageBitmap(0), traceThreshold(0), traceReserve(0), traceCbk(nullptr), traceData(nullptr),
+      taintShadow(nullptr), callStack(nullptr), callStackEnabled(false), 
+      budget(std::numeric_limits<int64_t>::max()), budgetEntry(0), budgetType(BUDGET_INSTRUCTIONS), budgetEnabled(false),
+      budgetStop(0), branchProfiling(false), fastNativeCalls(false), syscallEvents(false), lastSyscall(SyscallRecord {0, {0}, 0}),
+      moduleEvents(false), lastModule(0, 0), syscallRing(SyscallRing {0, 0, 0, 0, 0}), syscallDelivered(0), 
+      syscallThreshold(0), syscallReserve(0), syscallCbk(nullptr), syscallData(nullptr), patchCacheClock(0),
+      patchCacheEpoch(0) {
 
     std::string          error;
     std::string          featuresStr;
@@ -111,37 +143,54 @@ Engine::Engine(const std::string& _cpu, const std::vector<std::string>& _mattrs,
     MCE = std::unique_ptr<llvm::MCCodeEmitter>(
        processTarget->createMCCodeEmitter(*MCII, *MRI, *MCTX)
     );
+    // Allocate the guest context shared by all the exec blocks of this VM
+    std::error_code ec;
+    contextBlock = QBDI::allocateMappedMemory(sizeof(Context), nullptr,
+                                              llvm::sys::Memory::MF_READ | llvm::sys::Memory::MF_WRITE, ec);
+    RequireAction("Engine::Engine", contextBlock.base() != nullptr, abort());
+    context = (Context*) contextBlock.base();
     // Allocate QBDI classes
     assembly = new Assembly(*MCTX, *MAB, *MCII, *processTarget, *MSTI);
-    blockManager = new ExecBlockManager(*MCII, *MRI, *assembly, vminstance);
-    execBroker = new ExecBroker(*assembly, vminstance);
+    blockManager = new ExecBlockManager(*MCII, *MRI, *assembly, vminstance, context);
+    execBroker = new ExecBroker(*assembly, vminstance, context);
+    moduleRegistry = new ModuleRegistry();
 
     // Get default Patch rules for this architecture
     patchRules = getDefaultPatchRules();
+    buildPatchRuleIndex();
 
-    gprState = std::unique_ptr<GPRState>(new GPRState);
-    fprState = std::unique_ptr<FPRState>(new FPRState);
-    curGPRState = gprState.get();
-    curFPRState = fprState.get();
+    gprState = &context->gprState;
+    fprState = &context->fprState;
+    curGPRState = gprState;
+    curFPRState = fprState;
 
     initGPRState();
     initFPRState();
 
     curExecBlock = nullptr;
+    running = false;
 }
 
 Engine::~Engine() {
     delete assembly;
     delete blockManager;
     delete execBroker;
+    delete moduleRegistry;
+    QBDI::releaseMappedMemory(contextBlock);
+    delete callStack;
+#if defined(QBDI_OS_LINUX) || defined(QBDI_OS_ANDROID) || defined(QBDI_OS_DARWIN)
+    if(taintShadow != nullptr) {
+        munmap(taintShadow, TAINT_SHADOW_SIZE + TAINT_SHADOW_GUARD);
+    }
+#endif
 }
 
 void Engine::initGPRState() {
-    memset(gprState.get(), 0, sizeof(GPRState));
+    memset(gprState, 0, sizeof(GPRState));
 }
 
 void Engine::initFPRState() {
-    memset(fprState.get(), 0, sizeof(FPRState));
+    memset(fprState, 0, sizeof(FPRState));
 
 #if defined(QBDI_ARCH_X86_64)
     fprState->rfcw = 0x37F;
@@ -179,39 +228,108 @@ bool Engine::isPreInst() const {
     return curExecBlock->getInstAddress(instID) == QBDI_GPR_GET(getGPRState(), REG_PC);
 }
 
+// The native calls already translated may target the ranges added
 void Engine::addInstrumentedRange(rword start, rword end) {
     execBroker->addInstrumentedRange(Range<rword>(start, end));
+    if(fastNativeCalls) {
+        queueNativeCallsFlush();
+    }
+}
+
+void Engine::addInstrumentedRanges(const RangeSet<rword>& ranges) {
+    execBroker->addInstrumentedRanges(ranges);
+    if(fastNativeCalls) {
+        queueNativeCallsFlush();
+    }
 }
 
 bool Engine::addInstrumentedModule(const std::string& name) {
-    return execBroker->addInstrumentedModule(name);
+    updateModules();
+    bool added = execBroker->addInstrumentedModule(name, *moduleRegistry);
+    if(added && fastNativeCalls) {
+        queueNativeCallsFlush();
+    }
+    return added;
 }
 
 bool Engine::addInstrumentedModuleFromAddr(rword addr) {
-    return execBroker->addInstrumentedModuleFromAddr(addr);
+    updateModules();
+    bool added = execBroker->addInstrumentedModuleFromAddr(addr, *moduleRegistry);
+    if(added && fastNativeCalls) {
+        queueNativeCallsFlush();
+    }
+    return added;
 }
 
 bool Engine::instrumentAllExecutableMaps() {
-    return execBroker->instrumentAllExecutableMaps();
+    bool added = execBroker->instrumentAllExecutableMaps();
+    if(added && fastNativeCalls) {
+        queueNativeCallsFlush();
+    }
+    return added;
 }
 
 void Engine::removeInstrumentedRange(rword start, rword end) {
     execBroker->removeInstrumentedRange(Range<rword>(start, end));
 }
 
+void Engine::removeInstrumentedRanges(const RangeSet<rword>& ranges) {
+    execBroker->removeInstrumentedRanges(ranges);
+}
+
 bool Engine::removeInstrumentedModule(const std::string& name) {
-    return execBroker->removeInstrumentedModule(name);
+    updateModules();
+    return execBroker->removeInstrumentedModule(name, *moduleRegistry);
 }
 
 bool Engine::removeInstrumentedModuleFromAddr(rword addr) {
-    return execBroker->removeInstrumentedModuleFromAddr(addr);
+    updateModules();
+    return execBroker->removeInstrumentedModuleFromAddr(addr, *moduleRegistry);
 }
 
 void Engine::removeAllInstrumentedRanges() {
     execBroker->removeAllInstrumentedRanges();
 }
 
+void Engine::buildPatchRuleIndex() {
+    patchRulesByOpcode.clear();
+    genericPatchRules.clear();
+
+    for(uint32_t j = 0; j < patchRules.size(); j++) {
+        std::set<unsigned int> opcodes;
+        if(patchRules[j]->affectedOpcodes(MCII.get(), opcodes)) {
+            for(unsigned int op : opcodes) {
+                patchRulesByOpcode[op].push_back(j);
+            }
+        }
+        else {
+            genericPatchRules.push_back(j);
+        }
+    }
+    // The remaining dynamic conditions of the generic rules are still tested for the indexed 
+    // opcodes, in the rule order.
+    for(auto& item : patchRulesByOpcode) {
+        std::vector<uint32_t>& candidates = item.second;
+        candidates.insert(candidates.end(), genericPatchRules.begin(), genericPatchRules.end());
+        std::sort(candidates.begin(), candidates.end());
+    }
+}
+
 std::vector<Patch> Engine::patch(rword start) {
+    // The instrumentation is only applied to a copy
+    auto cached = patchCache.find(start);
+    if(cached != patchCache.end()) {
+        PatchCacheEntry& entry = cached->second;
+        // The guest code can have been modified without the cache being cleared
+        if(memcmp(entry.code.data(), (const void*) start, entry.code.size()) == 0) {
+            LogDebug("Engine::patch", "Reusing the patches of basic block at address 0x%" PRIRWORD, start);
+            entry.lastUse = ++patchCacheClock;
+            return entry.basicBlock;
+        }
+        LogDebug("Engine::patch", "Basic block at address 0x%" PRIRWORD " modified, patching it again", start);
+        patchCache.erase(cached);
+    }
+
     std::vector<Patch> basicBlock;
     const llvm::ArrayRef<uint8_t> code((uint8_t*) start, (size_t) -1);
     bool basicBlockEnd = false;
@@ -239,20 +357,37 @@ std::vector<Patch> Engine::patch(rword start) {
                 disassOs.flush();
                 fprintf(log, "Patching 0x%" PRIRWORD " %s", address, disass.c_str());
             });
-            // Patch & merge
-            for(uint32_t j = 0; j < patchRules.size(); j++) {
-                if(patchRules[j]->canBeApplied(&inst, address, instSize, MCII.get())) {
-                    LogDebug("Engine::patch", "Patch rule %" PRIu32 " applied", j);
-                    if(patch.insts.size() == 0) {
-                        patch = patchRules[j]->generate(&inst, address, instSize, MCII.get(), MRI.get());
-                    }
-                    else {
-                        LogDebug("Engine::patch", "Previous instruction merged");
-                        patch = patchRules[j]->generate(&inst, address, instSize, MCII.get(), MRI.get(), &patch);
+            // A call performed natively takes precedence over the patch rules
+            std::shared_ptr<PatchRule> rule;
+            if(fastNativeCalls) {
+                rule = getNativeCall(&inst, address, instSize);
+            }
+            if(rule == nullptr) {
+                // Test only the rules which can apply to this opcode, the last rule always applies
+                const std::vector<uint32_t>* candidates = &genericPatchRules;
+                auto it = patchRulesByOpcode.find(inst.getOpcode());
+                if(it != patchRulesByOpcode.end()) {
+                    candidates = &it->second;
+                }
+                for(uint32_t j : *candidates) {
+                    if(patchRules[j]->canBeApplied(&inst, address, instSize, MCII.get())) {
+                        LogDebug("Engine::patch", "Patch rule %" PRIu32 " applied", j);
+                        rule = patchRules[j];
+                        break;
                     }
-                    break;
                 }
             }
+            else {
+                LogDebug("Engine::patch", "Native call rule applied");
+            }
+            // Patch & merge
+            if(patch.insts.size() == 0) {
+                patch = rule->generate(&inst, address, instSize, MCII.get(), MRI.get());
+            }
+            else {
+                LogDebug("Engine::patch", "Previous instruction merged");
+                patch = rule->generate(&inst, address, instSize, MCII.get(), MRI.get(), &patch);
+            }
             i += instSize;
         } while(patch.metadata.merge);
         LogDebug("Engine::patch", "Patch of size %" PRIu32 " generated", patch.metadata.patchSize);
@@ -265,13 +400,160 @@ std::vector<Patch> Engine::patch(rword start) {
         basicBlock.push_back(patch);
     }
 
+    // Flags liveness analysis, walking the basic block backward. As the successors are unknown,
+    // flags are considered live at the end of the basic block.
+    bool flagsLive = true;
+    for(auto it = basicBlock.rbegin(); it != basicBlock.rend(); ++it) {
+        bool flagsLiveOut = flagsLive;
+        if(overwriteFlags(&it->metadata.inst, MCII.get())) {
+            flagsLive = false;
+        }
+        if(readFlags(&it->metadata.inst, MCII.get())) {
+            flagsLive = true;
+        }
+        it->setFlagsLiveness(flagsLive, flagsLiveOut);
+    }
+
+    if(patchCache.size() >= PATCH_CACHE_SIZE) {
+        std::vector<uint64_t> uses;
+        for(const auto& item : patchCache) {
+            uses.push_back(item.second.lastUse);
+        }
+        std::nth_element(uses.begin(), uses.begin() + uses.size() / 2, uses.end());
+        evictPatchCache(uses[uses.size() / 2]);
+    }
+    PatchCacheEntry& entry = patchCache[start];
+    entry.basicBlock = basicBlock;
+    entry.code.assign((const uint8_t*) start, (const uint8_t*) basicBlock.back().metadata.endAddress());
+    entry.lastUse = ++patchCacheClock;
     return basicBlock;
 }
 
-void Engine::instrument(std::vector<Patch> &basicBlock) {
+void Engine::evictPatchCache(uint64_t before) {
+    for(auto it = patchCache.begin(); it != patchCache.end(); ) {
+        if(it->second.lastUse < before) {
+            it = patchCache.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void Engine::commitCacheFlush() {
+    blockManager->flushCommit();
+    // The flushed basic blocks which are executed again are translated again before the next 
+    // commit, the others are not reused
+    evictPatchCache(patchCacheEpoch);
+    patchCacheEpoch = patchCacheClock;
+}
+
+void Engine::buildRuleIndex() {
+    opcodeRules.clear();
+    rangeRules.clear();
+    rangeRulesMaxEnd.clear();
+    genericRules.clear();
+
+    for(size_t i = 0; i < instrRules.size(); i++) {
+        const std::shared_ptr<InstrRule>& rule = instrRules[i].second;
+        std::set<unsigned int> opcodes;
+        if(rule->affectedOpcodes(MCII.get(), opcodes)) {
+            for(unsigned int op : opcodes) {
+                opcodeRules[op].push_back(i);
+            }
+            continue;
+        }
+        RangeSet<rword> ranges = rule->affectedRange();
+        if(ranges.size() == (rword) -1) {
+            genericRules.push_back(i);
+            continue;
+        }
+        for(const Range<rword>& r : ranges.getRanges()) {
+            rangeRules.push_back(std::make_pair(r, i));
+        }
+    }
+    // Sort the ranges by start, with the maximum end of the preceding ranges, so the ranges
+    // containing an address are found by a binary search and a backward walk.
+    std::sort(rangeRules.begin(), rangeRules.end(), 
+        [](const std::pair<Range<rword>, size_t>& a, const std::pair<Range<rword>, size_t>& b) {
+            return a.first.start < b.first.start;
+        });
+    rangeRulesMaxEnd.resize(rangeRules.size());
+    for(size_t i = 0; i < rangeRules.size(); i++) {
+        rword end = rangeRules[i].first.end;
+        rangeRulesMaxEnd[i] = (i > 0 && rangeRulesMaxEnd[i - 1] > end) ? rangeRulesMaxEnd[i - 1] : end;
+    }
+    ruleIndexValid = true;
+    LogDebug("Engine::buildRuleIndex", "Indexed %zu opcodes, %zu ranges and %zu generic rules",
+             opcodeRules.size(), rangeRules.size(), genericRules.size());
+}
+
+void Engine::selectInstrRules(const Patch &patch, std::vector<size_t> &candidates) {
+    rword address = patch.metadata.address;
+
+    candidates = genericRules;
+    auto it = opcodeRules.find(patch.metadata.inst.getOpcode());
+    if(it != opcodeRules.end()) {
+        candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+    }
+    size_t n = std::partition_point(rangeRules.begin(), rangeRules.end(), 
+        [address](const std::pair<Range<rword>, size_t>& r) {
+            return r.first.start <= address;
+        }) - rangeRules.begin();
+    for(size_t i = n; i-- > 0 && rangeRulesMaxEnd[i] > address; ) {
+        if(rangeRules[i].first.end > address) {
+            candidates.push_back(rangeRules[i].second);
+        }
+    }
+    // Restore the registration order, a rule with several ranges may have been selected twice
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+}
+
+static VMAction budgetGate(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
+    return ((Engine*) data)->budgetExhausted(gprState);
+}
+
+static VMAction budgetTailStop(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
+    return STOP;
+}
+
+static VMAction branchProfileGate(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
+    return ((Engine*) data)->branchTargetChanged(gprState);
+}
+
+static VMAction syscallEntryGate(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
+    return ((Engine*) data)->signalSyscall(SYSCALL_ENTRY, gprState, fprState);
+}
+
+static VMAction syscallExitGate(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
+    return ((Engine*) data)->signalSyscall(SYSCALL_EXIT, gprState, fprState);
+}
+
+// The syscall is already recorded and is executed whatever the callback returns
+static VMAction syscallFlushGate(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
+    ((Engine*) data)->flushSyscallTrace();
+    return CONTINUE;
+}
+
+void Engine::instrument(std::vector<Patch> &basicBlock, size_t length) {
+    const uint32_t allRegs = (1U << AVAILABLE_GPR) - 1;
+    std::vector<std::vector<InstrRule*>> preRules(basicBlock.size());
+    std::vector<std::vector<InstrRule*>> postRules(basicBlock.size());
+    std::vector<uint32_t> liveIn(basicBlock.size());
+    std::vector<uint32_t> liveOut(basicBlock.size());
+    std::vector<size_t> candidates;
+
     LogDebug("Engine::instrument", "Instrumenting basic block [0x%" PRIRWORD ", 0x%" PRIRWORD "]",
              basicBlock.front().metadata.address, basicBlock.back().metadata.address);
-    for(Patch& patch : basicBlock) {
+    // Select the rules applying to each patch, in the order their code will be laid out: PREINST
+    // instrumentations are prepended one after the other, so in the reverse order. Only the rules
+    // indexed under the opcode or address of the patch are tested.
+    if(ruleIndexValid == false) {
+        buildRuleIndex();
+    }
+    for(size_t i = 0; i < basicBlock.size(); i++) {
+        Patch& patch = basicBlock[i];
         LogCallback(LogPriority::DEBUG, "Engine::instrument", [&] (FILE *log) -> void {
             std::string disass;
             llvm::raw_string_ostream disassOs(disass);
@@ -279,15 +561,174 @@ void Engine::instrument(std::vector<Patch> &basicBlock) {
             disassOs.flush();
             fprintf(log, "Instrumenting 0x%" PRIRWORD " %s", patch.metadata.address, disass.c_str());
         });
-        // Instrument
-        for (const auto& item: instrRules) {
+        selectInstrRules(patch, candidates);
+        for (size_t c : candidates) {
+            const auto& item = instrRules[c];
             const std::shared_ptr<InstrRule>& rule = item.second;
             if (rule->canBeApplied(patch, MCII.get())) { // Push MCII
-                rule->instrument(patch, MCII.get(), MRI.get());
+                if(rule->getPosition() == PREINST) {
+                    preRules[i].insert(preRules[i].begin(), rule.get());
+                }
+                else {
+                    postRules[i].push_back(rule.get());
+                }
                 LogDebug("Engine::instrument", "Instrumentation rule %" PRIu32 " applied", item.first);
             }
         }
     }
+    // The edge coverage is recorded before any other instrumentation of the basic block entry
+    if(coverageRule) {
+        preRules[0].insert(preRules[0].begin(), coverageRule.get());
+    }
+    // The budget is consumed before anything else, an exhausted budget stops the execution at 
+    // the basic block entry. Only the instructions written are charged, a cached tail charges its
+    // own at its entry.
+    std::shared_ptr<InstrRule> budgetRule;
+#if defined(QBDI_ARCH_X86_64)
+    if(budgetEnabled) {
+        budgetRule = std::make_shared<InstrRule>(
+            True(),
+            getCallbackGenerator(budgetGate, this),
+            PREINST,
+            true,
+            PatchGenerator::SharedPtrVec({
+                DecrementCountdown(Temp(0), Temp(1), Temp(2), Constant((rword) &budget),
+                                   (budgetType == BUDGET_INSTRUCTIONS) ? length : 1, false,
+                                   Constant((rword) &budgetEntry))
+            })
+        );
+        preRules[0].insert(preRules[0].begin(), budgetRule.get());
+    }
+    // An indirect branch ending the basic block is profiled before the callbacks following it, 
+    // the host is only reached by the targets which do not fit in the table of the site
+    std::shared_ptr<InstrRule> profileRule;
+    const Patch& lastPatch = basicBlock.back();
+    if(branchProfiling && Or({
+            OpIs(llvm::X86::JMP64r), OpIs(llvm::X86::JMP64m), OpIs(llvm::X86::CALL64r), OpIs(llvm::X86::CALL64m)
+        }).test(&lastPatch.metadata.inst, lastPatch.metadata.address, lastPatch.metadata.instSize, MCII.get())) {
+        profileRule = std::make_shared<InstrRule>(
+            True(),
+            getCallbackGenerator(branchProfileGate, this),
+            POSTINST,
+            true,
+            PatchGenerator::SharedPtrVec({
+                ProfileBranch(Temp(0), Temp(1), Temp(2), Temp(3), Constant((rword) &branchSites[lastPatch.metadata.address]),
+                              BRANCH_SITE_ENTRIES, lastPatch.metadata.flagsLiveOut)
+            })
+        );
+        postRules.back().insert(postRules.back().begin(), profileRule.get());
+    }
+    // The syscall events surround the syscall instruction and its trace records, which thus 
+    // observe the changes made by the callbacks
+    std::shared_ptr<InstrRule> syscallEntryRule, syscallExitRule;
+    size_t syscallRecords = 0;
+    if(syscallEvents || syscallCbk != nullptr) {
+        for(size_t i = 0; i < basicBlock.size(); i++) {
+            const Patch& patch = basicBlock[i];
+            if(patch.metadata.inst.getOpcode() != llvm::X86::SYSCALL) {
+                continue;
+            }
+            if(syscallEvents) {
+                if(!syscallEntryRule) {
+                    syscallEntryRule = std::make_shared<InstrRule>(
+                        True(), getCallbackGenerator(syscallEntryGate, this), PREINST, true);
+                    syscallExitRule = std::make_shared<InstrRule>(
+                        True(), getCallbackGenerator(syscallExitGate, this), POSTINST, true);
+                }
+                preRules[i].push_back(syscallEntryRule.get());
+                postRules[i].insert(postRules[i].begin(), syscallExitRule.get());
+            }
+            if(syscallCbk != nullptr) {
+                preRules[i].push_back(syscallTraceRules[0].get());
+                preRules[i].push_back(syscallTraceRules[2].get());
+                postRules[i].insert(postRules[i].begin(), syscallTraceRules[1].get());
+                syscallRecords++;
+            }
+        }
+    }
+#endif
+    // The memory trace is recorded closest to the instruction. The trace threshold is only 
+    // checked between sequences, every record of a basic block must fit in the buffer reserve.
+    size_t traceRecords = 0;
+    for(size_t i = 0; i < basicBlock.size(); i++) {
+        for(const auto& rule : traceRules) {
+            if(rule->canBeApplied(basicBlock[i], MCII.get())) {
+                if(rule->getPosition() == PREINST) {
+                    preRules[i].push_back(rule.get());
+                }
+                else {
+                    postRules[i].insert(postRules[i].begin(), rule.get());
+                }
+                traceRecords++;
+            }
+        }
+    }
+    // The taint is propagated last, after the callbacks which could have changed the labels. The 
+    // guest flags are only preserved around the propagation where they are live.
+#if defined(QBDI_ARCH_X86_64)
+    std::shared_ptr<InstrRule> propagateRules[2];
+#endif
+    for(size_t i = 0; i < basicBlock.size() && taintRules.size() > 0; i++) {
+#if defined(QBDI_ARCH_X86_64)
+        bool saveFlags = basicBlock[i].metadata.flagsLiveIn;
+        std::shared_ptr<InstrRule>& propagateRule = propagateRules[saveFlags];
+        if(!propagateRule) {
+            propagateRule = std::make_shared<InstrRule>(
+                Not(IsStringAccess()),
+                PatchGenerator::SharedPtrVec({
+                    PropagateTaint(Temp(0), Temp(1), Temp(2), Temp(3), Temp(4),
+                                   Constant((rword) context->hostState.taintRegs), Constant((rword) taintShadow),
+                                   Constant(TAINT_SHADOW_SIZE - 1), saveFlags)
+                }),
+                PREINST,
+                false
+            );
+        }
+        if(propagateRule->canBeApplied(basicBlock[i], MCII.get())) {
+            preRules[i].push_back(propagateRule.get());
+        }
+#endif
+        for(const auto& rule : taintRules) {
+            if(rule->canBeApplied(basicBlock[i], MCII.get())) {
+                preRules[i].push_back(rule.get());
+            }
+        }
+    }
+    if(traceRecords > traceReserve) {
+        size_t pending = (context->hostState.traceCursor - (rword) traceBuffer.data()) / sizeof(MemoryAccess);
+        traceReserve = traceRecords;
+        traceBuffer.resize(traceThreshold + traceReserve);
+        context->hostState.traceCursor = (rword) (traceBuffer.data() + pending);
+    }
+    if(syscallRecords > syscallReserve) {
+        syscallReserve = syscallRecords;
+        resizeSyscallRing(syscallThreshold + syscallReserve);
+    }
+
+    // Register liveness analysis, walking the basic block backward. All the registers are
+    // considered live at the end of the basic block and where the instrumentation breaks to the
+    // host, as callbacks can observe them.
+    uint32_t live = allRegs;
+    for(size_t i = basicBlock.size(); i-- > 0; ) {
+        const llvm::MCInst* inst = &basicBlock[i].metadata.inst;
+        for(InstrRule* rule : postRules[i]) {
+            if(rule->doesBreakToHost()) live = allRegs;
+        }
+        liveOut[i] = live;
+        live = (live & ~getOverwrittenRegs(inst, MCII.get(), MRI.get())) | getReadRegs(inst, MCII.get(), MRI.get());
+        for(InstrRule* rule : preRules[i]) {
+            if(rule->doesBreakToHost()) live = allRegs;
+        }
+        liveIn[i] = live;
+    }
+
+    // Instrument. Registers restored by the POSTINST instrumentation of a patch still hold their
+    // context value at the start of the PREINST instrumentation of the next one.
+    uint32_t savedRegs = 0;
+    for(size_t i = 0; i < basicBlock.size(); i++) {
+        InstrRule::instrument(basicBlock[i], preRules[i], ~liveIn[i] & allRegs, savedRegs, MCII.get(), MRI.get());
+        savedRegs = InstrRule::instrument(basicBlock[i], postRules[i], ~liveOut[i] & allRegs, 0, MCII.get(), MRI.get());
+    }
 }
 
 
@@ -295,13 +736,18 @@ void Engine::handleNewBasicBlock(rword pc) {
     // disassemble and patch new basic block
     Patch::Vec basicBlock = patch(pc);
     // instrument it
-    instrument(basicBlock);
+    instrument(basicBlock, blockManager->getWriteLength(basicBlock));
     // Write it in the cache
     blockManager->writeBasicBlock(basicBlock);
 }
 
 
 bool Engine::precacheBasicBlock(rword pc) {
+    // The flushes queued by the instrumentation changes are committed as a run would do before
+    // looking up the cache, the blocks being executed are only flushed once back in the run loop
+    if(running == false && blockManager->isFlushPending()) {
+        commitCacheFlush();
+    }
     if (blockManager->getExecBlock(pc) != nullptr) {
         // already in cache
         return false;
@@ -314,16 +760,44 @@ bool Engine::precacheBasicBlock(rword pc) {
 bool Engine::run(rword start, rword stop) {
     rword         currentPC = start;
     bool          hasRan = false;
-    curGPRState = gprState.get();
-    curFPRState = fprState.get();
+    curGPRState = gprState;
+    curFPRState = fprState;
+    // Each run starts a new edge coverage trace
+    context->hostState.edgeLocation = coverageBitmap;
+    // The function started by this run is entered without a call, the call stack is restored 
+    // once it returns
+    uint16_t callStackBase = callStack ? callStack->depth : 0;
 
     // Start address is out of range
     if (!execBroker->isInstrumented(start)) {
         return false;
     }
+    // The modules loaded or unloaded since the last run are checked before executing anything
+    curExecBlock = nullptr;
+    running = true;
+    checkModules(currentPC);
 
     // Execute basic block per basic block
     do {
+        // The wrapped and replaced functions are intercepted before their execution
+        if(interceptions.size() > 0 || pendingReturns.size() > 0) {
+            QBDI_GPR_SET(curGPRState, REG_PC, currentPC);
+            if(interceptCall(currentPC) == STOP) {
+                syncState();
+                flushMemoryTrace();
+                flushSyscallTrace();
+                if(callStack) {
+                    callStack->depth = callStackBase;
+                }
+                running = false;
+                return hasRan;
+            }
+            // A redirection restarts from its destination, which can be the stop address
+            if(QBDI_GPR_GET(curGPRState, REG_PC) != currentPC) {
+                currentPC = QBDI_GPR_GET(curGPRState, REG_PC);
+                continue;
+            }
+        }
         // If this PC is not instrumented try to transfer execution
         if(execBroker->isInstrumented(currentPC) == false &&
            execBroker->canTransferExecution(curGPRState)) {
@@ -333,32 +807,39 @@ bool Engine::run(rword start, rword stop) {
             signalEvent(EXEC_TRANSFER_CALL, currentPC, curGPRState, curFPRState);
             execBroker->transferExecution(currentPC, curGPRState, curFPRState);
             signalEvent(EXEC_TRANSFER_RETURN, currentPC, curGPRState, curFPRState);
+            // The native code is where the modules are usually loaded and unloaded
+            checkModules(currentPC);
         }
         // Else execute through DBI
         else {
             bool newBasicBlock = false;
+            uint16_t callDepth = callStack ? callStack->depth : 0;
             LogDebug("Engine::run", "Executing 0x%" PRIRWORD " through DBI", currentPC);
             // Is cache flush pending?
             if(blockManager->isFlushPending()) {
                 // Backup fprState and gprState
-                *gprState = *curGPRState;
-                *fprState = *curFPRState;
-                curGPRState = gprState.get();
-                curFPRState = fprState.get();
+                syncState();
                 // Commit the flush
-                blockManager->flushCommit();
+                commitCacheFlush();
             }
             // Test if we have it in cache
             curExecBlock = blockManager->getExecBlock(currentPC);
             if(curExecBlock == nullptr) {
                 LogDebug("Engine::run", "Cache miss for 0x%" PRIRWORD ", patching & instrumenting new basic block", currentPC);
+                // The instrumented code can also load modules, they are noticed on the cache misses
+                checkModules(currentPC);
+                if(blockManager->isFlushPending()) {
+                    syncState();
+                    commitCacheFlush();
+                }
                 handleNewBasicBlock(currentPC);
                 // Used to signal the event
                 newBasicBlock = true;
                 // Set new basic block as current
                 curExecBlock = blockManager->getExecBlock(currentPC);
             }
-            // Set context if necessary
+            // Set context if necessary. Exec blocks normally share the VM context and no copy 
+            // happens, only those which could not reach it have a private one.
             if(&(curExecBlock->getContext()->gprState) != curGPRState) {
                 curExecBlock->getContext()->gprState = *curGPRState;
             }
@@ -367,6 +848,19 @@ bool Engine::run(rword start, rword stop) {
             }
             curGPRState = &(curExecBlock->getContext()->gprState);
             curFPRState = &(curExecBlock->getContext()->fprState);
+            // The countdown of a basic block is only executed when it is entered at its start
+            if(budgetEnabled && (curExecBlock->getSeqType(curExecBlock->getCurrentSeqID()) & SeqType::Split) &&
+               chargeSplitSequence() == STOP) {
+                QBDI_GPR_SET(curGPRState, REG_PC, currentPC);
+                syncState();
+                flushMemoryTrace();
+                flushSyscallTrace();
+                if(callStack) {
+                    callStack->depth = callStackBase;
+                }
+                running = false;
+                return hasRan;
+            }
             // Signal events
             if(newBasicBlock) {
                 signalEvent(BASIC_BLOCK_NEW, currentPC, curGPRState, curFPRState);
@@ -382,10 +876,13 @@ bool Engine::run(rword start, rword stop) {
                 case BREAK_TO_VM:
                     break;
                 case STOP:
-                    *gprState = *curGPRState;
-                    *fprState = *curFPRState;
-                    curGPRState = gprState.get();
-                    curFPRState = fprState.get();
+                    syncState();
+                    flushMemoryTrace();
+                    flushSyscallTrace();
+                    if(callStack) {
+                        callStack->depth = callStackBase;
+                    }
+                    running = false;
                     return hasRan;
             }
             // Signal events
@@ -393,25 +890,62 @@ bool Engine::run(rword start, rword stop) {
                 signalEvent(BASIC_BLOCK_EXIT, currentPC, curGPRState, curFPRState);
             }
             signalEvent(SEQUENCE_EXIT, currentPC, curGPRState, curFPRState);
+            if(callStackEnabled) {
+                signalCallStackEvents(callDepth, currentPC);
+            }
+        }
+        // Functions left through an execution transfer or a longjmp are popped
+        if(callStackEnabled) {
+            uint16_t callDepth = callStack->depth;
+            unwindCallStack(QBDI_GPR_GET(curGPRState, REG_SP));
+            signalCallStackEvents(callDepth, currentPC);
+        }
+        // Deliver the memory trace once enough accesses have been recorded
+        if(checkMemoryTrace() == STOP || checkSyscallTrace() == STOP) {
+            syncState();
+            if(callStack) {
+                callStack->depth = callStackBase;
+            }
+            running = false;
+            return hasRan;
         }
         // Get next block PC
         currentPC = QBDI_GPR_GET(curGPRState, REG_PC);
         LogDebug("Engine::run", "Next address to execute is 0x%" PRIRWORD, currentPC);
     } while(currentPC != stop);
 
+    // The function started by this run can be wrapped and have returned to the stop address
+    if(pendingReturns.size() > 0) {
+        interceptReturn(currentPC);
+    }
     // Copy final context
-    *gprState = *curGPRState;
-    *fprState = *curFPRState;
-    curGPRState = gprState.get();
-    curFPRState = fprState.get();
+    syncState();
+    flushMemoryTrace();
+    flushSyscallTrace();
+    if(callStack) {
+        callStack->depth = callStackBase;
+    }
+    running = false;
 
     return hasRan;
 }
 
+void Engine::syncState() {
+    if(curGPRState != gprState) {
+        *gprState = *curGPRState;
+        curGPRState = gprState;
+    }
+    if(curFPRState != fprState) {
+        *fprState = *curFPRState;
+        curFPRState = fprState;
+    }
+}
+
 uint32_t Engine::addInstrRule(InstrRule rule) {
     uint32_t id = instrRulesCounter++;
     RequireAction("Engine::addInstrRule", id < EVENTID_VM_MASK, return VMError::INVALID_EVENTID);
     blockManager->clearCache(rule.affectedRange());
+    ruleIndexValid = false;
     switch(rule.getPosition()) {
         case InstPosition::PREINST:
             instrRules.insert(instrRules.begin(), std::make_pair(id, (InstrRule::SharedPtr) rule));
@@ -423,15 +957,739 @@ uint32_t Engine::addInstrRule(InstrRule rule) {
     return id;
 }
 
+bool Engine::setEdgeCoverage(uint8_t* bitmap, size_t size) {
+    if(bitmap == nullptr) {
+        if(coverageRule) {
+            queueCacheFlush();
+        }
+        coverageRule.reset();
+        coverageBitmap = 0;
+        return true;
+    }
+    RequireAction("Engine::setEdgeCoverage", size > 1 && (size & (size - 1)) == 0, return false);
+    RequireAction("Engine::setEdgeCoverage", size <= (1UL << 31), return false);
+#if defined(QBDI_ARCH_X86_64)
+    coverageRule = std::make_shared<InstrRule>(
+        True(),
+        PatchGenerator::SharedPtrVec({
+            EdgeCoverage(Temp(0), Temp(1), Constant((rword) &context->hostState.edgeLocation),
+                         Constant((rword) bitmap), Constant(size - 1))
+        }),
+        PREINST,
+        false
+    );
+    coverageBitmap = (rword) bitmap;
+    context->hostState.edgeLocation = coverageBitmap;
+    queueCacheFlush();
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Engine::setMemoryTrace(MemoryAccessType type, MemoryTraceCallback cbk, void* data, size_t batchSize) {
+    // Deliver the accesses recorded with the previous configuration
+    flushMemoryTrace();
+    if(traceRules.size() > 0) {
+        queueCacheFlush();
+    }
+    // The buffer is kept as the current sequence could still append to it until the flush
+    traceRules.clear();
+    traceThreshold = 0;
+    traceReserve = 0;
+    traceCbk = nullptr;
+    traceData = nullptr;
+    context->hostState.traceCursor = (rword) traceBuffer.data();
+    if((type & MEMORY_READ_WRITE) == 0 || cbk == nullptr) {
+        return true;
+    }
+    RequireAction("Engine::setMemoryTrace", batchSize > 0, return false);
+#if defined(QBDI_ARCH_X86_64)
+    Constant cursor((rword) &context->hostState.traceCursor);
+    if(type & MEMORY_READ) {
+        traceRules.push_back(std::make_shared<InstrRule>(
+            DoesReadAccess(),
+            PatchGenerator::SharedPtrVec({AppendMemoryAccess(Temp(0), Temp(1), Temp(2), Temp(3), cursor, MEMORY_READ)}),
+            PREINST,
+            false
+        ));
+    }
+    if(type & MEMORY_WRITE) {
+        traceRules.push_back(std::make_shared<InstrRule>(
+            And({
+                DoesWriteAccess(),
+                Not(IsStringAccess()),
+            }),
+            PatchGenerator::SharedPtrVec({AppendMemoryAccess(Temp(0), Temp(1), Temp(2), Temp(3), cursor, MEMORY_WRITE)}),
+            POSTINST,
+            false
+        ));
+        // String operations update their index registers, their write is recorded before them
+        traceRules.push_back(std::make_shared<InstrRule>(
+            And({
+                DoesWriteAccess(),
+                IsStringAccess(),
+            }),
+            PatchGenerator::SharedPtrVec({AppendMemoryAccess(Temp(0), Temp(1), Temp(2), Temp(3), cursor, MEMORY_WRITE)}),
+            PREINST,
+            false
+        ));
+    }
+    traceThreshold = batchSize;
+    traceBuffer.resize(std::max(traceBuffer.size(), traceThreshold));
+    traceCbk = cbk;
+    traceData = data;
+    context->hostState.traceCursor = (rword) traceBuffer.data();
+    queueCacheFlush();
+    return true;
+#else
+    return false;
+#endif
+}
+
+VMAction Engine::checkMemoryTrace() {
+    if(traceCbk != nullptr && 
+       context->hostState.traceCursor >= (rword) (traceBuffer.data() + traceThreshold)) {
+        return flushMemoryTrace();
+    }
+    return CONTINUE;
+}
+
+VMAction Engine::flushMemoryTrace() {
+    if(traceCbk == nullptr) {
+        return CONTINUE;
+    }
+    size_t size = (context->hostState.traceCursor - (rword) traceBuffer.data()) / sizeof(MemoryAccess);
+    // Rewind before the delivery so a run started by the callback does not deliver them again
+    context->hostState.traceCursor = (rword) traceBuffer.data();
+    if(size == 0) {
+        return CONTINUE;
+    }
+    return traceCbk(vminstance, traceBuffer.data(), size, traceData);
+}
+
+bool Engine::setSyscallTrace(SyscallTraceCallback cbk, void* data, size_t batchSize) {
+    // Deliver the syscalls recorded with the previous configuration
+    flushSyscallTrace();
+    if(syscallCbk != nullptr) {
+        queueCacheFlush();
+    }
+    // The ring is kept as the current sequence could still append to it until the flush
+    syscallTraceRules.clear();
+    syscallThreshold = 0;
+    syscallReserve = 0;
+    syscallCbk = nullptr;
+    syscallData = nullptr;
+    if(cbk == nullptr) {
+        return true;
+    }
+    RequireAction("Engine::setSyscallTrace", batchSize > 0, return false);
+#if defined(QBDI_ARCH_X86_64)
+    Constant ring((rword) &syscallRing);
+    // The record is written before the syscall and its return value after it
+    syscallTraceRules.push_back(std::make_shared<InstrRule>(
+        True(),
+        PatchGenerator::SharedPtrVec({RecordSyscall(Temp(0), Temp(1), Temp(2), ring, false)}),
+        PREINST,
+        false
+    ));
+    syscallTraceRules.push_back(std::make_shared<InstrRule>(
+        True(),
+        PatchGenerator::SharedPtrVec({RecordSyscall(Temp(0), Temp(1), Temp(2), ring, true)}),
+        POSTINST,
+        false
+    ));
+    // The records are delivered before the syscalls which do not return, once theirs is written
+    std::vector<Predicate> noReturn;
+    for(rword number : NORETURN_SYSCALLS) {
+        noReturn.push_back(Predicate {PREDICATE_OR, PREDICATE_REG_EQUAL, 0, (rword) -1, number, 0});
+    }
+    syscallTraceRules.push_back(std::make_shared<InstrRule>(
+        True(),
+        getCallbackGenerator(syscallFlushGate, this),
+        PREINST,
+        true,
+        PatchGenerator::SharedPtrVec(),
+        noReturn
+    ));
+    syscallThreshold = batchSize;
+    syscallCbk = cbk;
+    syscallData = data;
+    // The records appended by the previous configuration after its last delivery are dropped
+    syscallDelivered = syscallRing.count;
+    resizeSyscallRing(syscallThreshold);
+    queueCacheFlush();
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Engine::resizeSyscallRing(size_t capacity) {
+    size_t pending = std::min((size_t) (syscallRing.count - syscallDelivered), syscallBuffer.size());
+    size_t cursor = (syscallRing.cursor - syscallRing.start) / sizeof(SyscallRecord);
+    std::vector<SyscallRecord> resized(std::max(capacity, pending));
+
+    // The pending records are moved to the start of the new buffer, in order
+    for(size_t i = 0; i < pending; i++) {
+        resized[i] = syscallBuffer[(cursor + syscallBuffer.size() - pending + i) % syscallBuffer.size()];
+    }
+    syscallBuffer.swap(resized);
+    syscallRing.start = (rword) syscallBuffer.data();
+    syscallRing.end = (rword) (syscallBuffer.data() + syscallBuffer.size());
+    syscallRing.cursor = (rword) (syscallBuffer.data() + (pending % syscallBuffer.size()));
+    syscallRing.last = syscallRing.start;
+    syscallDelivered = syscallRing.count - pending;
+}
+
+VMAction Engine::checkSyscallTrace() {
+    if(syscallCbk != nullptr && syscallRing.count - syscallDelivered >= syscallThreshold) {
+        return flushSyscallTrace();
+    }
+    return CONTINUE;
+}
+
+VMAction Engine::flushSyscallTrace() {
+    if(syscallCbk == nullptr || syscallRing.count == syscallDelivered) {
+        return CONTINUE;
+    }
+    size_t size = syscallRing.count - syscallDelivered;
+    // The oldest records are overwritten if the ring was not delivered in time
+    if(size > syscallBuffer.size()) {
+        LogWarning("Engine::flushSyscallTrace", "%zu syscall records were overwritten", size - syscallBuffer.size());
+        size = syscallBuffer.size();
+    }
+    size_t cursor = (syscallRing.cursor - syscallRing.start) / sizeof(SyscallRecord);
+    // The batch is delivered from a copy as a run started by the callback records in the ring
+    std::vector<SyscallRecord> batch(size);
+    for(size_t i = 0; i < size; i++) {
+        batch[i] = syscallBuffer[(cursor + syscallBuffer.size() - size + i) % syscallBuffer.size()];
+    }
+    syscallDelivered = syscallRing.count;
+    return syscallCbk(vminstance, batch.data(), size, syscallData);
+}
+
+VMAction Engine::signalSyscall(VMEvent kind, GPRState* gprState, FPRState* fprState) {
+#if defined(QBDI_ARCH_X86_64)
+    if(kind == SYSCALL_ENTRY) {
+        lastSyscall.number = gprState->rax;
+        lastSyscall.args[0] = gprState->rdi;
+        lastSyscall.args[1] = gprState->rsi;
+        lastSyscall.args[2] = gprState->rdx;
+        lastSyscall.args[3] = gprState->r10;
+        lastSyscall.args[4] = gprState->r8;
+        lastSyscall.args[5] = gprState->r9;
+        lastSyscall.ret = 0;
+    }
+    else {
+        lastSyscall.ret = gprState->rax;
+    }
+#endif
+    // The event is signaled from the middle of the current sequence
+    uint16_t seqStart = curExecBlock->getSeqStart(curExecBlock->getCurrentSeqID());
+    signalEvent(kind, curExecBlock->getInstMetadata(seqStart)->address, gprState, fprState);
+    return CONTINUE;
+}
+
+bool Engine::setCallStackTracking(bool enable) {
+#if defined(QBDI_ARCH_X86_64)
+    if(enable == callStackEnabled) {
+        return true;
+    }
+    // The shadow stack is kept until the destruction as code referencing it may still execute
+    // until the cache flush is committed
+    if(enable && callStack == nullptr) {
+        callStack = new ShadowCallStack();
+    }
+    callStackEnabled = enable;
+    patchRules = getDefaultPatchRules(enable ? (rword) callStack : 0);
+    buildPatchRuleIndex();
+    clearAllCache();
+    return true;
+#else
+    RequireAction("Engine::setCallStackTracking", enable == false, return false);
+    return true;
+#endif
+}
+
+bool Engine::runWithBudget(rword start, rword stop, uint64_t limit, BudgetType type, uint64_t* executed) {
+#if defined(QBDI_ARCH_X86_64)
+    const int64_t unlimited = std::numeric_limits<int64_t>::max();
+    int64_t initial = (int64_t) std::min(limit, (uint64_t) unlimited);
+    int64_t remaining;
+
+    // The countdown is part of the translation of every basic block, it is kept once enabled and
+    // the other runs use an unlimited budget
+    if(budgetEnabled == false || budgetType != type) {
+        budgetEnabled = true;
+        budgetType = type;
+        blockManager->clearCache();
+    }
+    budget = initial;
+    budgetStop = 0;
+    bool hasRan = run(start, stop);
+    // The budget ran out inside a basic block, its remaining instructions are executed up to an 
+    // exact stop
+    if(budgetStop != 0) {
+        uint32_t tailID = addInstrRule(InstrRule(
+            AddressInRange(budgetStop, budgetStop + 1),
+            getCallbackGenerator(budgetTailStop, nullptr),
+            PREINST,
+            true
+        ));
+        budgetStop = 0;
+        budget = unlimited;
+        hasRan = run(QBDI_GPR_GET(gprState, REG_PC), stop) || hasRan;
+        deleteInstrumentation(tailID);
+        remaining = 0;
+    }
+    else {
+        remaining = std::max(budget, (int64_t) 0);
+    }
+    budget = unlimited;
+    if(executed != nullptr) {
+        *executed = initial - remaining;
+    }
+    return hasRan;
+#else
+    LogError("Engine::runWithBudget", "Execution budgets are not supported on this architecture");
+    return false;
+#endif
+}
+
+VMAction Engine::budgetExhausted(GPRState* gprState) {
+    // The countdown kept its value before the charge of the basic block, which is less than the
+    // number of instructions written
+    if(budgetType == BUDGET_INSTRUCTIONS && budgetEntry > 0) {
+        std::vector<Patch> basicBlock = patch(QBDI_GPR_GET(gprState, REG_PC));
+        budgetStop = basicBlock[budgetEntry].metadata.address;
+    }
+    budget = 0;
+    return STOP;
+}
+
+VMAction Engine::chargeSplitSequence() {
+    uint16_t seqID = curExecBlock->getCurrentSeqID();
+    uint16_t seqStart = curExecBlock->getSeqStart(seqID);
+    int64_t length = 1;
+    if(budgetType == BUDGET_INSTRUCTIONS) {
+        length = curExecBlock->getSeqEnd(seqID) - seqStart + 1;
+    }
+    if(budget >= length) {
+        budget -= length;
+        return CONTINUE;
+    }
+    if(budgetType == BUDGET_INSTRUCTIONS && budget > 0) {
+        budgetStop = curExecBlock->getInstMetadata(seqStart + budget)->address;
+    }
+    budget = 0;
+    return STOP;
+}
+
+bool Engine::setBranchProfiling(bool enable) {
+#if defined(QBDI_ARCH_X86_64)
+    if(enable == branchProfiling) {
+        return true;
+    }
+    // The sites are kept until the destruction as code referencing them may still execute until 
+    // the cache flush is committed
+    if(enable) {
+        for(auto& item : branchSites) {
+            memset(item.second.entries, 0, sizeof(item.second.entries));
+            memset(item.second.counts, 0, sizeof(item.second.counts));
+            item.second.targets.clear();
+        }
+    }
+    branchProfiling = enable;
+    queueCacheFlush();
+    return true;
+#else
+    RequireAction("Engine::setBranchProfiling", enable == false, return false);
+    return true;
+#endif
+}
+
+std::vector<rword> Engine::getBranchSites() const {
+    std::vector<rword> sites;
+    for(const auto& item : branchSites) {
+        // The first entry is taken by the first execution
+        if(item.second.entries[0] != 0) {
+            sites.push_back(item.first);
+        }
+    }
+    return sites;
+}
+
+std::vector<BranchTarget> Engine::getBranchTargets(rword site) const {
+    std::vector<BranchTarget> targets;
+    auto it = branchSites.find(site);
+    if(it == branchSites.end() || it->second.entries[0] == 0) {
+        return targets;
+    }
+    std::map<rword, uint64_t> counts = it->second.targets;
+    for(size_t i = 0; i < BRANCH_SITE_ENTRIES && it->second.entries[i] != 0; i++) {
+        counts[it->second.entries[i]] += it->second.counts[i];
+    }
+    for(const auto& count : counts) {
+        targets.push_back(BranchTarget {count.first, count.second});
+    }
+    std::stable_sort(targets.begin(), targets.end(), [](const BranchTarget& a, const BranchTarget& b) {
+        return a.count > b.count;
+    });
+    return targets;
+}
+
+bool Engine::setFastNativeCalls(bool enable) {
+#if defined(QBDI_ARCH_X86_64)
+    if(enable != fastNativeCalls) {
+        fastNativeCalls = enable;
+        queueNativeCallsFlush();
+    }
+    return true;
+#else
+    RequireAction("Engine::setFastNativeCalls", enable == false, return false);
+    return true;
+#endif
+}
+
+std::shared_ptr<PatchRule> Engine::getNativeCall(const llvm::MCInst* inst, rword address, rword instSize) {
+#if defined(QBDI_ARCH_X86_64)
+    rword callee, slot;
+    // The stub and the pointer are only read from the modules known to the registry
+    if(moduleRegistry->hasChanged()) {
+        updateModules();
+    }
+    if(getCallTarget(inst, address, instSize, *moduleRegistry, &callee, &slot) == false) {
+        return nullptr;
+    }
+    // The pointer is read at each call, the decision holds for the module it binds to. A pointer
+    // not bound yet by the lazy binding leads back to the stub, its module is then found from the
+    // symbol the loader will bind it to.
+    rword target = callee;
+    if(slot != 0) {
+        target = *((rword*) slot);
+        const LoadedModule* stubModule = moduleRegistry->findModuleByAddr(slot);
+        if(stubModule != nullptr && stubModule->executable.contains(target)) {
+            target = ModuleRegistry::getSlotBinding(slot);
+            if(target == 0) {
+                return nullptr;
+            }
+        }
+    }
+    const LoadedModule* calleeModule = moduleRegistry->findModuleByAddr(target);
+    if(calleeModule != nullptr) {
+        for(const Range<rword>& r : calleeModule->executable.getRanges()) {
+            if(execBroker->isInstrumented(r)) {
+                return nullptr;
+            }
+        }
+    }
+    else if(execBroker->isInstrumented(target)) {
+        return nullptr;
+    }
+    if(interceptions.count(callee) > 0 || interceptions.count(target) > 0) {
+        return nullptr;
+    }
+    // The loader calls go through the ExecBroker for the module changes to be noticed
+    if(ModuleRegistry::isLoaderFunction(target)) {
+        return nullptr;
+    }
+    return getNativeCallRule(target, slot);
+#else
+    return nullptr;
+#endif
+}
+
+VMAction Engine::branchTargetChanged(GPRState* gprState) {
+    const InstMetadata* metadata = curExecBlock->getInstMetadata(curExecBlock->getCurrentInstID());
+    auto it = branchSites.find(metadata->address);
+    RequireAction("Engine::branchTargetChanged", it != branchSites.end(), return CONTINUE);
+    // The table is full, the execution was counted in the scratch entry
+    it->second.targets[QBDI_GPR_GET(gprState, REG_PC)] += 1;
+    return CONTINUE;
+}
+
+std::vector<CallFrame> Engine::getCallStack() const {
+    std::vector<CallFrame> frames;
+    if(callStackEnabled == false) {
+        return frames;
+    }
+    // The frames above the stack pointer are those of functions which have already returned
+    rword sp = QBDI_GPR_GET(curGPRState, REG_SP);
+    for(int16_t depth = (int16_t) callStack->depth; depth > 0; depth--) {
+        const CallFrame& frame = callStack->frames[(uint16_t) depth];
+        if(frame.stackPointer < sp || (frames.size() > 0 && frame.stackPointer <= frames.back().stackPointer)) {
+            continue;
+        }
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+void Engine::unwindCallStack(rword sp) {
+    while((int16_t) callStack->depth > 0 && callStack->frames[callStack->depth].stackPointer < sp) {
+        callStack->depth--;
+    }
+}
+
+void Engine::signalCallStackEvents(uint16_t depth, rword currentPC) {
+    for(int16_t delta = (int16_t) (callStack->depth - depth); delta != 0; delta += (delta > 0) ? -1 : 1) {
+        signalEvent(delta > 0 ? FUNCTION_ENTRY : FUNCTION_EXIT, currentPC, curGPRState, curFPRState);
+    }
+}
+
+static VMAction taintStringGate(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
+    ((Engine*) data)->propagateStringTaint(gprState);
+    return CONTINUE;
+}
+
+bool Engine::setTaintTracking(bool enable) {
+    if(enable == false) {
+        if(taintRules.size() > 0) {
+            queueCacheFlush();
+        }
+        taintRules.clear();
+        return true;
+    }
+    if(taintRules.size() > 0) {
+        return true;
+    }
+#if defined(QBDI_ARCH_X86_64) && (defined(QBDI_OS_LINUX) || defined(QBDI_OS_ANDROID) || defined(QBDI_OS_DARWIN))
+    // The shadow is only backed by memory where it is written
+    if(taintShadow == nullptr) {
+        void* shadow = mmap(nullptr, TAINT_SHADOW_SIZE + TAINT_SHADOW_GUARD, PROT_READ | PROT_WRITE, 
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        RequireAction("Engine::setTaintTracking", shadow != MAP_FAILED, return false);
+        taintShadow = (uint8_t*) shadow;
+    }
+    // The propagation itself depends on the flags liveness and is built by instrument. String 
+    // operations depend on the direction flag and the repetition count
+    taintRules.push_back(std::make_shared<InstrRule>(
+        IsStringAccess(),
+        getCallbackGenerator(taintStringGate, this),
+        PREINST,
+        true
+    ));
+    queueCacheFlush();
+    return true;
+#else
+    LogError("Engine::setTaintTracking", "Taint tracking is not supported on this platform");
+    return false;
+#endif
+}
+
+bool Engine::setMemoryTaint(rword start, rword size, TaintLabel label) {
+    RequireAction("Engine::setMemoryTaint", taintShadow != nullptr, return false);
+    for(rword i = 0; i < size; i++) {
+        taintShadow[(start + i) & (TAINT_SHADOW_SIZE - 1)] = label;
+    }
+    return true;
+}
+
+TaintLabel Engine::getMemoryTaint(rword start, rword size) const {
+    TaintLabel label = 0;
+    if(taintShadow == nullptr) {
+        return 0;
+    }
+    for(rword i = 0; i < size; i++) {
+        label |= taintShadow[(start + i) & (TAINT_SHADOW_SIZE - 1)];
+    }
+    return label;
+}
+
+bool Engine::setRegisterTaint(unsigned int gpr, TaintLabel label) {
+#if defined(QBDI_ARCH_X86_64)
+    RequireAction("Engine::setRegisterTaint", gpr < NUM_GPR && gpr != REG_SP && gpr != REG_PC, return false);
+    context->hostState.taintRegs[gpr] = label * (rword) 0x0101010101010101ULL;
+    return true;
+#else
+    return false;
+#endif
+}
+
+TaintLabel Engine::getRegisterTaint(unsigned int gpr) const {
+    TaintLabel label = 0;
+#if defined(QBDI_ARCH_X86_64)
+    RequireAction("Engine::getRegisterTaint", gpr < NUM_GPR && gpr != REG_SP && gpr != REG_PC, return 0);
+    for(unsigned i = 0; i < sizeof(rword); i++) {
+        label |= (TaintLabel) (context->hostState.taintRegs[gpr] >> (8 * i));
+    }
+#endif
+    return label;
+}
+
+void Engine::propagateStringTaint(const GPRState* gprState) {
+#if defined(QBDI_ARCH_X86_64)
+    RequireAction("Engine::propagateStringTaint", curExecBlock != nullptr && taintShadow != nullptr, return);
+    const InstMetadata* metadata = curExecBlock->getInstMetadata(curExecBlock->getCurrentInstID());
+    llvm::StringRef name = MCII->getName(metadata->inst.getOpcode());
+    const rword mask = TAINT_SHADOW_SIZE - 1;
+    rword* rax = &context->hostState.taintRegs[0];
+    bool movs = name.find("MOVS") != llvm::StringRef::npos;
+    bool stos = name.find("STOS") != llvm::StringRef::npos;
+    bool lods = name.find("LODS") != llvm::StringRef::npos;
+    // SCAS and CMPS only read memory and the flags are not tracked
+    if(movs == false && stos == false && lods == false) {
+        return;
+    }
+    size_t suffix = name.find(movs ? "MOVS" : (stos ? "STOS" : "LODS")) + 4;
+    rword elemSize = 0;
+    switch(suffix < name.size() ? name[suffix] : 0) {
+        case 'B': elemSize = 1; break;
+        case 'W': elemSize = 2; break;
+        case 'L': elemSize = 4; break;
+        case 'Q': elemSize = 8; break;
+        default: return;
+    }
+    // The repetition prefixes are found among the bytes preceding the opcode
+    bool rep = name.startswith("REP");
+    for(rword p = metadata->address; p + 1 < metadata->endAddress(); p++) {
+        uint8_t prefix = *((uint8_t*) p);
+        if(prefix == 0xF2 || prefix == 0xF3) {
+            rep = true;
+        }
+    }
+    rword count = rep ? gprState->rcx : 1;
+    rword step = (gprState->eflags & (1 << 10)) ? -elemSize : elemSize;
+    rword src = gprState->rsi;
+    rword dst = gprState->rdi;
+
+    for(rword n = 0; n < count; n++, src += step, dst += step) {
+        for(rword i = 0; i < elemSize; i++) {
+            if(movs) {
+                taintShadow[(dst + i) & mask] = taintShadow[(src + i) & mask];
+            }
+            else if(stos) {
+                taintShadow[(dst + i) & mask] = (TaintLabel) (*rax >> (8 * i));
+            }
+            else if(n + 1 == count) {
+                *rax = (*rax & ~((rword) 0xff << (8 * i))) | ((rword) taintShadow[(src + i) & mask] << (8 * i));
+            }
+        }
+    }
+    // A 32 bits load clears the upper half of RAX
+    if(lods && count > 0 && elemSize == 4) {
+        *rax &= 0xffffffff;
+    }
+#endif
+}
+
 uint32_t Engine::addVMEventCB(VMEvent mask, VMCallback cbk, void *data) {
+    // The function events are computed from the shadow call stack
+    if((mask & (FUNCTION_ENTRY | FUNCTION_EXIT)) && setCallStackTracking(true) == false) {
+        return VMError::INVALID_EVENTID;
+    }
+    // The syscall events are signaled by the syscall instructions instrumentation
+    if((mask & (SYSCALL_ENTRY | SYSCALL_EXIT)) && syscallEvents == false) {
+#if defined(QBDI_ARCH_X86_64)
+        syscallEvents = true;
+        queueCacheFlush();
+#else
+        LogError("Engine::addVMEventCB", "Syscall events are not supported on this architecture");
+        return VMError::INVALID_EVENTID;
+#endif
+    }
+    // The module events are signaled from the registry updates, only the changes following the
+    // registration are reported
+    if((mask & (MODULE_LOAD | MODULE_UNLOAD)) && moduleEvents == false) {
+        updateModules();
+        if(moduleRegistry->isTracked() == false) {
+            LogError("Engine::addVMEventCB", "Module events are not supported on this platform");
+            return VMError::INVALID_EVENTID;
+        }
+        moduleEvents = true;
+    }
     uint32_t id = vmCallbacksCounter++;
     RequireAction("Engine::addVMEventCB", id < EVENTID_VM_MASK, return VMError::INVALID_EVENTID);
-    vmCallbacks.push_back(std::make_pair(id, CallbackRegistration {mask, cbk, data}));
+    vmCallbacks.push_back(std::make_pair(id, CallbackRegistration {mask, cbk, data, true}));
+    return id | EVENTID_VM_MASK;
+}
+
+uint32_t Engine::addInterception(rword target, rword replacement, InstCallback pre, InstCallback post, void* data) {
+    RequireAction("Engine::addInterception", interceptions.count(target) == 0, return VMError::INVALID_EVENTID);
+    RequireAction("Engine::addInterception", replacement != 0 || pre != nullptr || post != nullptr, 
+                  return VMError::INVALID_EVENTID);
+    uint32_t id = vmCallbacksCounter++;
+    RequireAction("Engine::addInterception", id < EVENTID_VM_MASK, return VMError::INVALID_EVENTID);
+    interceptions[target] = Interception {id, replacement, pre, post, data, true};
+    // The calls to the target may have been translated as native calls
+    if(fastNativeCalls) {
+        queueNativeCallsFlush();
+    }
     return id | EVENTID_VM_MASK;
 }
 
+VMAction Engine::interceptReturn(rword currentPC) {
+    rword sp = QBDI_GPR_GET(curGPRState, REG_SP);
+    // The wrapped functions which have returned, those left through a longjmp are dropped
+    while(pendingReturns.size() > 0) {
+        PendingReturn pending = pendingReturns.back();
+        bool returned = (currentPC == pending.returnAddress && sp == pending.stackPointer);
+        if(returned == false && sp <= pending.stackPointer) {
+            break;
+        }
+        pendingReturns.pop_back();
+        if(returned && pending.post != nullptr && 
+           pending.post(vminstance, curGPRState, curFPRState, pending.data) == STOP) {
+            return STOP;
+        }
+    }
+    return CONTINUE;
+}
+
+VMAction Engine::interceptCall(rword currentPC) {
+    if(pendingReturns.size() > 0 && interceptReturn(currentPC) == STOP) {
+        return STOP;
+    }
+    auto it = interceptions.find(currentPC);
+    if(it == interceptions.end() || it->second.enabled == false) {
+        return CONTINUE;
+    }
+    // The registration can be deleted by the callbacks
+    Interception interception = it->second;
+    if(interception.replacement != 0) {
+        // The replacement returns directly to the caller, it is executed natively if it is not 
+        // instrumented
+        QBDI_GPR_SET(curGPRState, REG_PC, interception.replacement);
+        return CONTINUE;
+    }
+    rword sp = QBDI_GPR_GET(curGPRState, REG_SP);
+#if defined(QBDI_ARCH_X86_64)
+    rword returnAddress = *((rword*) sp);
+    rword returnSP = sp + sizeof(rword);
+#elif defined(QBDI_ARCH_ARM)
+    rword returnAddress = QBDI_GPR_GET(curGPRState, REG_LR);
+    rword returnSP = sp;
+#endif
+    // A back edge or a self tail call to the entry does not start a new frame, the frame already 
+    // entered is the innermost one still expected
+    if(pendingReturns.size() > 0 && pendingReturns.back().id == interception.id && 
+       pendingReturns.back().returnAddress == returnAddress && pendingReturns.back().stackPointer == returnSP) {
+        return CONTINUE;
+    }
+    if(interception.pre != nullptr && 
+       interception.pre(vminstance, curGPRState, curFPRState, interception.data) == STOP) {
+        return STOP;
+    }
+    // The return is only expected if the pre callback did not skip the function. The frames of the 
+    // functions without post callback are also kept to recognize their reentries.
+    if(QBDI_GPR_GET(curGPRState, REG_PC) == currentPC) {
+        pendingReturns.push_back(PendingReturn {interception.id, returnAddress, returnSP, interception.post, interception.data});
+    }
+    return CONTINUE;
+}
+
 void Engine::signalEvent(VMEvent kind, rword currentPC, GPRState *gprState, FPRState *fprState) {
-    VMState state = VMState {kind, currentPC, currentPC, currentPC, currentPC, 0};
+    VMState state = VMState {kind, currentPC, currentPC, currentPC, currentPC, 0, 0, {0}, 0, 0, 0};
+    if(kind & (SYSCALL_ENTRY | SYSCALL_EXIT)) {
+        state.syscallNumber = lastSyscall.number;
+        std::copy(lastSyscall.args, lastSyscall.args + 6, state.syscallArgs);
+        state.syscallReturn = lastSyscall.ret;
+    }
+    if(kind & (MODULE_LOAD | MODULE_UNLOAD)) {
+        state.moduleStart = lastModule.start;
+        state.moduleEnd = lastModule.end;
+    }
     if(curExecBlock != nullptr) {
         const BBInfo* bbInfo = blockManager->getBBInfo(currentPC);
         state.sequenceEnd = curExecBlock->getInstMetadata(curExecBlock->getSeqEnd(curExecBlock->getCurrentSeqID()))->endAddress();
@@ -440,7 +1698,7 @@ void Engine::signalEvent(VMEvent kind, rword currentPC, GPRState *gprState, FPRS
     }
     for(const auto& item : vmCallbacks) {
         const QBDI::CallbackRegistration& r = item.second;
-        if(kind & r.mask) {
+        if((kind & r.mask) && r.enabled) {
             r.cbk(vminstance, &state, gprState, fprState, r.data);
         }
     }
@@ -455,12 +1713,22 @@ bool Engine::deleteInstrumentation(uint32_t id) {
                 return true;
             }
         }
+        for(auto it = interceptions.begin(); it != interceptions.end(); ++it) {
+            if(it->second.id == id) {
+                interceptions.erase(it);
+                // The post callbacks of the calls in progress are not called anymore
+                pendingReturns.erase(std::remove_if(pendingReturns.begin(), pendingReturns.end(),
+                    [id](const PendingReturn& r) { return r.id == id; }), pendingReturns.end());
+                return true;
+            }
+        }
     }
     else {
         for(size_t i = 0; i < instrRules.size(); i++) {
             if(instrRules[i].first == id) {
                 blockManager->clearCache(instrRules[i].second->affectedRange());
                 instrRules.erase(instrRules.begin() + i);
+                ruleIndexValid = false;
                 return true;
             }
         }
@@ -468,21 +1736,140 @@ bool Engine::deleteInstrumentation(uint32_t id) {
     return false;
 }
 
+SwitchStatus Engine::setInstrumentationEnabled(uint32_t id, bool enable) {
+    if(id & EVENTID_VM_MASK) {
+        id &= ~EVENTID_VM_MASK;
+        for(auto& item : vmCallbacks) {
+            if(item.first == id) {
+                item.second.enabled = enable;
+                return SwitchStatus::SWITCH_UPDATED;
+            }
+        }
+        for(auto& item : interceptions) {
+            if(item.second.id == id) {
+                item.second.enabled = enable;
+                return SwitchStatus::SWITCH_UPDATED;
+            }
+        }
+        return SwitchStatus::SWITCH_INVALID_ID;
+    }
+    for(auto& item : instrRules) {
+        if(item.first != id) {
+            continue;
+        }
+#if defined(QBDI_ARCH_X86_64)
+        // Only the break to the host can be skipped inline without modifying the guest flags, 
+        // the inline rules have no gate to read the switch from
+        if(item.second->doesBreakToHost() == false) {
+            LogDebug("Engine::setInstrumentationEnabled", "Rule %u does not break to the host and cannot be switched", id);
+            return SwitchStatus::SWITCH_UNSUPPORTED;
+        }
+        auto guard = ruleGuards.find(id);
+        if(guard == ruleGuards.end()) {
+            // The guard is never released as the code of a deleted rule can still be running, 
+            // the rule ids are not reused
+            RuleGuard& newGuard = ruleGuards[id];
+            bool conditional = item.second->hasFilter();
+            newGuard.scratch = 1;
+            newGuard.zero = 0;
+            item.second->appendFilter(ReadGuard(Temp(0), Temp(1), Constant((rword) &newGuard), conditional));
+            blockManager->clearCache(item.second->affectedRange());
+            guard = ruleGuards.find(id);
+        }
+        guard->second.select = enable ? (rword) &guard->second.scratch : (rword) &guard->second.zero;
+        return SwitchStatus::SWITCH_UPDATED;
+#else
+        LogError("Engine::setInstrumentationEnabled", "Instrumentation switches are not supported on this architecture");
+        return SwitchStatus::SWITCH_UNSUPPORTED;
+#endif
+    }
+    return SwitchStatus::SWITCH_INVALID_ID;
+}
+
 void Engine::deleteAllInstrumentations() {
+    // The translated code of the deleted rules is flushed before the next execution
+    for(const auto& item : instrRules) {
+        blockManager->clearCache(item.second->affectedRange());
+    }
     instrRules.clear();
+    ruleIndexValid = false;
     vmCallbacks.clear();
+    interceptions.clear();
+    pendingReturns.clear();
 }
 
 const InstAnalysis* Engine::analyzeInstMetadata(const InstMetadata* instMetadata, AnalysisType type) {
     return blockManager->analyzeInstMetadata(instMetadata, type);
 }
 
+void Engine::updateModules() {
+    std::vector<LoadedModule> loaded, unloaded;
+
+    if(moduleRegistry->update(&loaded, &unloaded) == false) {
+        return;
+    }
+    for(const LoadedModule& module : unloaded) {
+        LogDebug("Engine::updateModules", "Module %s was unloaded", module.name.c_str());
+        for(const Range<rword>& r : module.executable.getRanges()) {
+            clearCache(r.start, r.end);
+        }
+    }
+    if(moduleEvents == false) {
+        return;
+    }
+    for(const LoadedModule& module : unloaded) {
+        const std::vector<Range<rword>>& ranges = module.mapped.getRanges();
+        pendingModuleEvents.push_back(std::make_pair(MODULE_UNLOAD, Range<rword>(ranges.front().start, ranges.back().end)));
+    }
+    for(const LoadedModule& module : loaded) {
+        const std::vector<Range<rword>>& ranges = module.mapped.getRanges();
+        pendingModuleEvents.push_back(std::make_pair(MODULE_LOAD, Range<rword>(ranges.front().start, ranges.back().end)));
+    }
+}
+
+void Engine::checkModules(rword currentPC) {
+    if(moduleRegistry->hasChanged()) {
+        updateModules();
+    }
+    if(pendingModuleEvents.size() == 0) {
+        return;
+    }
+    // The callbacks can change the registry and queue new events, or clear the cache and thus
+    // the private context of the last exec block
+    std::vector<std::pair<VMEvent, Range<rword>>> events;
+    events.swap(pendingModuleEvents);
+    syncState();
+    for(const auto& event : events) {
+        lastModule = event.second;
+        signalEvent(event.first, currentPC, curGPRState, curFPRState);
+    }
+}
+
+void Engine::queueCacheFlush() {
+    blockManager->clearCache(Range<rword>(0, (rword) -1));
+}
+
+void Engine::queueNativeCallsFlush() {
+    queueCacheFlush();
+    patchCache.clear();
+}
+
 void Engine::clearAllCache() {
     blockManager->clearCache();
+    patchCache.clear();
 }
 
 void Engine::clearCache(rword start, rword end) {
-    blockManager->clearCache(Range<rword>(start, end));
+    Range<rword> range(start, end);
+    blockManager->clearCache(range);
+    for(auto it = patchCache.begin(); it != patchCache.end(); ) {
+        if(range.overlaps(Range<rword>(it->first, it->second.basicBlock.back().metadata.endAddress()))) {
+            it = patchCache.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
 }
 
 } // QBDI::
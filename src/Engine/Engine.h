@@ -36,18 +36,24 @@
 #include "llvm/MC/MCObjectFileInfo.h"
 #include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/Memory.h"
 
 #include "Callback.h"
+#include "Errors.h"
 #include "InstAnalysis.h"
+#include "Range.h"
 #include "State.h"
 #include "Patch/Types.h"
 
 namespace QBDI {
 
 class Assembly;
+struct Context;
+struct ShadowCallStack;
 class ExecBlock;
 class ExecBlockManager;
 class ExecBroker;
+class ModuleRegistry;
 class PatchRule;
 class InstrRule;
 class Patch;
@@ -60,6 +66,73 @@ struct CallbackRegistration {
     VMEvent    mask;
     VMCallback cbk;
     void*      data;
+    bool       enabled;
+};
+
+/*! Runtime switch of an instrumentation rule, read inline by the rule filter. The select word 
+ *  points to scratch when the rule is enabled and to zero when it is disabled, the layout is the 
+ *  one expected by the ReadGuard generator.
+ */
+struct RuleGuard {
+    rword select;
+    rword scratch;
+    rword zero;
+};
+
+const static size_t BRANCH_SITE_ENTRIES = 4;
+
+/*! Profile of an indirect branch site. The first targets taken and their execution counts are 
+ *  updated inline, with the layout expected by the ProfileBranch generator. The last entry is a 
+ *  scratch written when the table is full, the other targets are then counted by the host.
+ */
+struct BranchSite {
+    rword                     entries[BRANCH_SITE_ENTRIES + 1];
+    rword                     counts[BRANCH_SITE_ENTRIES + 1];
+    std::map<rword, uint64_t> targets;
+};
+
+/*! Ring buffer of the syscall trace, with the layout expected by the RecordSyscall generator. The 
+ *  cursor is wrapped inline from the end to the start of the buffer, the host compares the number 
+ *  of records written with the number delivered.
+ */
+struct SyscallRing {
+    rword cursor;
+    rword last;
+    rword count;
+    rword start;
+    rword end;
+};
+
+/*! Interception of a function entry. The function is either replaced by another one or wrapped
+ *  by callbacks called on its entry and on its return.
+ */
+struct Interception {
+    uint32_t     id;
+    rword        replacement;
+    InstCallback pre;
+    InstCallback post;
+    void*        data;
+    bool         enabled;
+};
+
+/*! Patches of a basic block kept for its next translations, with a copy of the guest code they 
+ *  were generated from and the patch cache clock value at their last use.
+ */
+struct PatchCacheEntry {
+    std::vector<Patch>   basicBlock;
+    std::vector<uint8_t> code;
+    uint64_t             lastUse;
+};
+
+/*! Return of a wrapped function which is still expected. The stack pointer is the one the 
+ *  function returns with. The post callback is null if the function is only wrapped on entry.
+ */
+struct PendingReturn {
+    uint32_t     id;
+    rword        returnAddress;
+    rword        stackPointer;
+    InstCallback post;
+    void*        data;
 };
 
 class Engine {
@@ -81,27 +154,204 @@ private:
     Assembly*                                                       assembly;
     ExecBlockManager*                                               blockManager;
     ExecBroker*                                                     execBroker;
+    ModuleRegistry*                                                 moduleRegistry;
     std::vector<std::shared_ptr<PatchRule>>                         patchRules;
+    std::map<unsigned int, std::vector<uint32_t>>                   patchRulesByOpcode;
+    std::vector<uint32_t>                                           genericPatchRules;
     std::vector<std::pair<uint32_t, std::shared_ptr<InstrRule>>>    instrRules;
     uint32_t                                                        instrRulesCounter;
+    std::map<uint32_t, RuleGuard>                                   ruleGuards;
+    std::map<unsigned int, std::vector<size_t>>                     opcodeRules;
+    std::vector<std::pair<Range<rword>, size_t>>                    rangeRules;
+    std::vector<rword>                                              rangeRulesMaxEnd;
+    std::vector<size_t>                                             genericRules;
+    bool                                                            ruleIndexValid;
     std::vector<std::pair<uint32_t, CallbackRegistration>>          vmCallbacks;
+    std::map<rword, Interception>                                   interceptions;
+    std::vector<PendingReturn>                                      pendingReturns;
     uint32_t                                                        vmCallbacksCounter;
-    std::unique_ptr<GPRState>                                       gprState;
-    std::unique_ptr<FPRState>                                       fprState;
+    std::shared_ptr<InstrRule>                                      coverageRule;
+    rword                                                           coverageBitmap;
+    std::vector<std::shared_ptr<InstrRule>>                         traceRules;
+    std::vector<std::shared_ptr<InstrRule>>                         syscallTraceRules;
+    std::vector<MemoryAccess>                                       traceBuffer;
+    size_t                                                          traceThreshold;
+    size_t                                                          traceReserve;
+    MemoryTraceCallback                                             traceCbk;
+    void*                                                           traceData;
+    std::vector<std::shared_ptr<InstrRule>>                         taintRules;
+    uint8_t*                                                        taintShadow;
+    ShadowCallStack*                                                callStack;
+    bool                                                            callStackEnabled;
+    int64_t                                                         budget;
+    int64_t                                                         budgetEntry;
+    BudgetType                                                      budgetType;
+    bool                                                            budgetEnabled;
+    rword                                                           budgetStop;
+    std::map<rword, BranchSite>                                     branchSites;
+    bool                                                            branchProfiling;
+    bool                                                            fastNativeCalls;
+    bool                                                            syscallEvents;
+    SyscallRecord                                                   lastSyscall;
+    bool                                                            moduleEvents;
+    std::vector<std::pair<VMEvent, Range<rword>>>                   pendingModuleEvents;
+    Range<rword>                                                    lastModule;
+    std::vector<SyscallRecord>                                      syscallBuffer;
+    SyscallRing                                                     syscallRing;
+    rword                                                           syscallDelivered;
+    size_t                                                          syscallThreshold;
+    size_t                                                          syscallReserve;
+    SyscallTraceCallback                                            syscallCbk;
+    void*                                                           syscallData;
+    llvm::sys::MemoryBlock                                          contextBlock;
+    Context*                                                        context;
+    GPRState*                                                       gprState;
+    FPRState*                                                       fprState;
     GPRState*                                                       curGPRState;
     FPRState*                                                       curFPRState;
     ExecBlock*                                                      curExecBlock;
-
+    bool                                                            running;
+    std::map<rword, PatchCacheEntry>                                patchCache;
+    uint64_t                                                        patchCacheClock;
+    uint64_t                                                        patchCacheEpoch;
+
+    /*! Disassemble and patch a basic block. The instrumentation free patches only depend on the
+     *  guest code, they are kept across the translation cache flushes caused by instrumentation 
+     *  changes and only dropped when the guest code is declared modified by a cache clear, or 
+     *  found modified when they are reused. With the native calls, they also depend on the 
+     *  instrumented ranges and the interceptions.
+     */
     std::vector<Patch> patch(rword start);
 
+    /*! Commit the pending translation cache flushes. The patches of the flushed basic blocks 
+     *  which have not been reused since the previous commit are forgotten.
+     */
+    void commitCacheFlush();
+
+    /*! Forget the patches of the basic blocks which have not been used since a clock value.
+     *
+     * @param[in] before  The patch cache clock value.
+     */
+    void evictPatchCache(uint64_t before);
+
+    /*! Get the patch rule performing a call natively, if the call target is known at translation
+     *  time, is not intercepted and its module is not instrumented. A call through a pointer not
+     *  bound yet by the loader is decided on the module the pointer will be bound to.
+     *
+     * @param[in] inst      The call instruction.
+     * @param[in] address   The address of the call instruction.
+     * @param[in] instSize  The size of the call instruction.
+     *
+     * @return The patch rule, or nullptr if the call needs to be simulated.
+     */
+    std::shared_ptr<PatchRule> getNativeCall(const llvm::MCInst* inst, rword address, rword instSize);
+
+    /*! Compute for each opcode the patch rules which can apply to it, in order. The opcodes 
+     *  absent from the index only need to test the rules which are not restricted to opcodes.
+     */
+    void buildPatchRuleIndex();
+
     void initGPRState();
     void initFPRState();
 
-    void instrument(std::vector<Patch> &basicBlock);
+    /*! Queue the removal of the whole translation cache. Unlike clearAllCache, the exec blocks 
+     *  are only released once the current sequence has returned to the run loop, so it can be 
+     *  used by the configuration changes made from a callback.
+     */
+    void queueCacheFlush();
+
+    /*! Queue the removal of the whole translation cache and forget the patches of every basic 
+     *  block, whose native calls depend on the instrumented ranges and the interceptions.
+     */
+    void queueNativeCallsFlush();
+
+    /*! Copy the guest state back into the VM context if it was left in the private context of 
+     *  an exec block.
+     */
+    void syncState();
+
+    /*! Rebuild the indexes of the instrumentation rules: the rules restricted to some opcodes 
+     *  are indexed by opcode, the other ones restricted to some address ranges are indexed by 
+     *  range start and the remaining ones are tested on every instruction.
+     */
+    void buildRuleIndex();
+
+    /*! Select the instrumentation rules which may apply to a patch using the rule indexes.
+     *
+     * @param[in]  patch       The patch to instrument.
+     * @param[out] candidates  The positions in instrRules of the rules to test, in order.
+     */
+    void selectInstrRules(const Patch &patch, std::vector<size_t> &candidates);
+
+    /*! Apply the instrumentation rules to a basic block.
+     *
+     * @param[in,out] basicBlock  The patches of the basic block.
+     * @param[in]     length      The number of patches written in the cache, the basic block 
+     *                            being truncated at the first instruction already cached.
+     */
+    void instrument(std::vector<Patch> &basicBlock, size_t length);
     void handleNewBasicBlock(rword pc);
 
     void signalEvent(VMEvent kind, rword currentBasicBlock, GPRState *gprState, FPRState *fprState);
 
+    /*! Deliver the memory trace records to the trace callback if the threshold has been reached.
+     *
+     * @return The action returned by the trace callback, CONTINUE if it was not called.
+     */
+    VMAction checkMemoryTrace();
+
+    /*! Deliver the syscall trace records to the trace callback if the threshold has been reached.
+     *
+     * @return The action returned by the trace callback, CONTINUE if it was not called.
+     */
+    VMAction checkSyscallTrace();
+
+    /*! Call the wrappers of a function entered or returned from and redirect the replaced 
+     *  functions. Only called between sequences, which the calls and returns always end.
+     *
+     * @param[in] currentPC  The address about to be executed.
+     *
+     * @return The action returned by the callbacks, STOP if one of them returned STOP.
+     */
+    VMAction interceptCall(rword currentPC);
+
+    /*! Call the post callbacks of the wrapped functions which have returned to the current 
+     *  address, and drop the ones which have been left without returning.
+     *
+     * @param[in] currentPC  The address about to be executed.
+     *
+     * @return The action returned by the callbacks, STOP if one of them returned STOP.
+     */
+    VMAction interceptReturn(rword currentPC);
+
+    /*! Pop the frames of the shadow call stack which are above a stack pointer. These functions 
+     *  have returned without executing an instrumented return: through an execution transfer or a 
+     *  longjmp.
+     *
+     * @param[in] sp  The current stack pointer.
+     */
+    void unwindCallStack(rword sp);
+
+    /*! Signal the function entry and exit events corresponding to the change of depth of the 
+     *  shadow call stack.
+     *
+     * @param[in] depth      The depth of the shadow call stack before the change.
+     * @param[in] currentPC  The address of the current sequence.
+     */
+    void signalCallStackEvents(uint16_t depth, rword currentPC);
+
+    /*! Bring the module registry up to date. The cache of the unloaded modules is cleared, as 
+     *  their addresses can be reused, and the module events are queued if they are enabled.
+     */
+    void updateModules();
+
+    /*! Update the module registry if a module was loaded or unloaded, and signal the queued 
+     *  module events. Only called between sequences, outside of any exec block.
+     *
+     * @param[in] currentPC  The address about to be executed.
+     */
+    void checkModules(rword currentPC);
+
 public:
 
     /*! Construct a new Engine for a given CPU with specific attributes
@@ -145,6 +395,12 @@ public:
      */
     void         addInstrumentedRange(rword start, rword end);
 
+    /*! Add a set of address ranges to the set of instrumented address ranges at once.
+     *
+     * @param[in] ranges  The address ranges.
+     */
+    void         addInstrumentedRanges(const RangeSet<rword>& ranges);
+
     /*! Add the executable address ranges of a module to the set of instrumented address ranges.
      *
      * @param[in] name  The module's name.
@@ -172,6 +428,12 @@ public:
      */
     void         removeInstrumentedRange(rword start, rword end);
 
+    /*! Remove a set of address ranges from the set of instrumented address ranges at once.
+     *
+     * @param[in] ranges  The address ranges.
+     */
+    void         removeInstrumentedRanges(const RangeSet<rword>& ranges);
+
     /*! Remove the executable address ranges of a module from the set of instrumented address ranges.
      *
      * @param[in] name  The module's name.
@@ -199,6 +461,38 @@ public:
      */
     bool        run(rword start, rword stop);
 
+    /*! Start the execution by the DBI and stop it once a budget of instructions or basic blocks
+     *  has been consumed. The budget is decremented by an inline countdown at the entry of each 
+     *  basic block, by the number of instructions written in the cache, and by the run loop 
+     *  for the sequences entered in the middle of a basic block. When it does not cover the 
+     *  whole sequence, the execution stops at its entry and the instructions left in the budget 
+     *  are executed up to an exact stop.
+     *
+     * @param[in]  start     Pointer to the first instruction to execute.
+     * @param[in]  stop      Stop the execution when this instruction is reached.
+     * @param[in]  limit     The maximum number of instructions or basic blocks to execute.
+     * @param[in]  type      The unit of the budget.
+     * @param[out] executed  The number of instructions or basic blocks executed (optional).
+     *
+     * @return  True if at least one block has been executed.
+     */
+    bool        runWithBudget(rword start, rword stop, uint64_t limit, BudgetType type, uint64_t* executed);
+
+    /*! Called by the budget countdown when it goes below zero at the entry of a basic block.
+     *
+     * @param[in] gprState  The guest state, its PC is the basic block entry.
+     *
+     * @return STOP.
+     */
+    VMAction    budgetExhausted(GPRState* gprState);
+
+    /*! Charge the budget for the current sequence, entered in the middle of a basic block and 
+     *  thus without executing its countdown.
+     *
+     * @return STOP if the budget does not cover the sequence, CONTINUE otherwise.
+     */
+    VMAction    chargeSplitSequence();
+
     /*! Add a custom instrumentation rule to the engine. Requires internal headers
      *
      * @param[in] rule A custom instrumentation rule.
@@ -208,6 +502,184 @@ public:
      */
     uint32_t addInstrRule(InstrRule rule);
 
+    /*! Enable or disable the inline edge coverage instrumentation. Each time a basic block is 
+     *  entered, the byte of the bitmap indexed by the hash of the (previous, current) basic block 
+     *  pair is incremented.
+     *
+     * @param[in] bitmap The coverage bitmap, or nullptr to disable the edge coverage.
+     * @param[in] size   The size of the bitmap in bytes, which must be a power of two.
+     *
+     * @return True if the edge coverage has been enabled or disabled.
+     */
+    bool setEdgeCoverage(uint8_t* bitmap, size_t size);
+
+    /*! Enable or disable the memory trace. The memory accesses are appended inline to a trace 
+     *  buffer which is delivered to the callback once it holds at least batchSize records and 
+     *  at the end of each run.
+     *
+     * @param[in] type       The memory accesses to trace, 0 to disable the memory trace.
+     * @param[in] cbk        The callback receiving the batches of memory accesses.
+     * @param[in] data       User defined data passed to the callback.
+     * @param[in] batchSize  The number of records triggering a delivery.
+     *
+     * @return True if the memory trace has been enabled or disabled.
+     */
+    bool setMemoryTrace(MemoryAccessType type, MemoryTraceCallback cbk, void* data, size_t batchSize);
+
+    /*! Deliver the pending memory trace records to the trace callback.
+     *
+     * @return The action returned by the trace callback, CONTINUE if it was not called.
+     */
+    VMAction flushMemoryTrace();
+
+    /*! Enable or disable the syscall trace. The number, arguments and return value of the 
+     *  syscalls are appended inline to a ring buffer which is delivered to the callback once it 
+     *  holds at least batchSize records, at the end of each run and before the syscalls which do 
+     *  not return.
+     *
+     * @param[in] cbk        The callback receiving the batches of syscalls, nullptr to disable the
+     *                       syscall trace.
+     * @param[in] data       User defined data passed to the callback.
+     * @param[in] batchSize  The number of records triggering a delivery.
+     *
+     * @return True if the syscall trace has been enabled or disabled.
+     */
+    bool setSyscallTrace(SyscallTraceCallback cbk, void* data, size_t batchSize);
+
+    /*! Deliver the pending syscall trace records to the trace callback.
+     *
+     * @return The action returned by the trace callback, CONTINUE if it was not called.
+     */
+    VMAction flushSyscallTrace();
+
+    /*! Resize the syscall trace ring, keeping its pending records.
+     *
+     * @param[in] capacity  The number of records of the ring.
+     */
+    void resizeSyscallRing(size_t capacity);
+
+    /*! Called before and after a syscall instruction when the syscall events are enabled.
+     *
+     * @param[in] kind      SYSCALL_ENTRY or SYSCALL_EXIT.
+     * @param[in] gprState  The guest state.
+     * @param[in] fprState  The guest floating point state.
+     *
+     * @return The action to take, always CONTINUE.
+     */
+    VMAction signalSyscall(VMEvent kind, GPRState* gprState, FPRState* fprState);
+
+    /*! Enable or disable the shadow call stack maintained inline by the call and return patches.
+     *
+     * @param[in] enable  True to enable the call stack tracking, false to disable it.
+     *
+     * @return True if the call stack tracking has been enabled or disabled.
+     */
+    bool setCallStackTracking(bool enable);
+
+    /*! Get the frames of the shadow call stack.
+     *
+     * @return The frames, from the innermost to the outermost one.
+     */
+    std::vector<CallFrame> getCallStack() const;
+
+    /*! Enable or disable the byte-level taint tracking. The labels of the memory are kept in a 
+     *  direct mapped shadow, allocated on the first activation, where the guest addresses alias 
+     *  modulo TAINT_SHADOW_SIZE. The labels are propagated inline through the data flow of the 
+     *  instructions but not through the flags nor the control flow.
+     *
+     * @param[in] enable  True to enable the taint tracking, false to disable it.
+     *
+     * @return True if the taint tracking has been enabled or disabled.
+     */
+    bool setTaintTracking(bool enable);
+
+    /*! Set the taint label of a memory range.
+     *
+     * @param[in] start  Start address of the range.
+     * @param[in] size   Size of the range in bytes.
+     * @param[in] label  The label, 0 to clear the taint.
+     *
+     * @return True if the label has been set.
+     */
+    bool setMemoryTaint(rword start, rword size, TaintLabel label);
+
+    /*! Get the union of the taint labels of a memory range.
+     *
+     * @param[in] start  Start address of the range.
+     * @param[in] size   Size of the range in bytes.
+     *
+     * @return The union of the labels of the range bytes.
+     */
+    TaintLabel getMemoryTaint(rword start, rword size) const;
+
+    /*! Set the taint label of every byte of a general purpose register.
+     *
+     * @param[in] gpr    The GPR index, the stack and instruction pointers are not tracked.
+     * @param[in] label  The label, 0 to clear the taint.
+     *
+     * @return True if the label has been set.
+     */
+    bool setRegisterTaint(unsigned int gpr, TaintLabel label);
+
+    /*! Get the union of the taint labels of the bytes of a general purpose register.
+     *
+     * @param[in] gpr  The GPR index, the stack and instruction pointers are not tracked.
+     *
+     * @return The union of the labels of the register bytes.
+     */
+    TaintLabel getRegisterTaint(unsigned int gpr) const;
+
+    /*! Propagate the taint labels through the string operation about to be executed by the
+     *  current exec block.
+     *
+     * @param[in] gprState  The guest state before the string operation.
+     */
+    void propagateStringTaint(const GPRState* gprState);
+
+    /*! Enable or disable the profiling of the indirect branch and call targets. The sites are 
+     *  counted inline, breaking to the host only when a site goes to another target than the 
+     *  previous time. Enabling it again starts a new profile.
+     *
+     * @param[in] enable  True to enable the branch profiling, false to disable it.
+     *
+     * @return True if the branch profiling has been enabled (or disabled).
+     */
+    bool        setBranchProfiling(bool enable);
+
+    /*! Obtain the addresses of the indirect branch sites executed since the profiling was enabled.
+     *
+     * @return The site addresses, in increasing order.
+     */
+    std::vector<rword> getBranchSites() const;
+
+    /*! Obtain the targets observed at an indirect branch site.
+     *
+     * @param[in] site  The address of the branch instruction.
+     *
+     * @return The targets, from the most to the least frequent one.
+     */
+    std::vector<BranchTarget> getBranchTargets(rword site) const;
+
+    /*! Enable or disable the native calls. A call whose target is known at translation time and 
+     *  outside of the instrumented ranges is then performed natively from the exec block, the 
+     *  callee returning straight into the rest of the basic block, instead of going through an 
+     *  execution transfer.
+     *
+     * @param[in] enable  True to enable the native calls, false to disable them.
+     *
+     * @return True if the native calls have been enabled (or disabled).
+     */
+    bool        setFastNativeCalls(bool enable);
+
+    /*! Called by the branch profiling when a site goes to a target which is not in its full 
+     *  inline table.
+     *
+     * @param[in] gprState  The guest state, its PC is the target.
+     *
+     * @return The action to take, always CONTINUE.
+     */
+    VMAction    branchTargetChanged(GPRState* gprState);
+
     /*! Register a callback event for a specific VM event.
      *
      * @param[in] mask A mask of VM event type which will trigger the callback.
@@ -219,6 +691,21 @@ public:
      */
     uint32_t    addVMEventCB(VMEvent mask, VMCallback cbk, void *data);
 
+    /*! Intercept the entry of a function. The execution is either redirected to a replacement 
+     *  function, or the pre and post callbacks are called when the function is entered and when 
+     *  it returns. A function can only be intercepted once.
+     *
+     * @param[in] target       The entry address of the function.
+     * @param[in] replacement  The address of the replacement function, 0 to wrap the function.
+     * @param[in] pre          The callback called on the entry of the wrapped function, or NULL.
+     * @param[in] post         The callback called on the return of the wrapped function, or NULL.
+     * @param[in] data         User defined data passed to the callbacks.
+     *
+     * @return The id of the registered interception (or VMError::INVALID_EVENTID in case of 
+     *         failure).
+     */
+    uint32_t    addInterception(rword target, rword replacement, InstCallback pre, InstCallback post, void* data);
+
     /*! Remove an instrumentation.
      *
      * @param[in] id The id of the instrumentation to remove.
@@ -226,6 +713,18 @@ public:
      */
     bool        deleteInstrumentation(uint32_t id);
 
+    /*! Enable or disable an instrumentation without modifying the code cache. The first call for
+     *  an instrumentation rule adds an inline switch to its filter, which requires to translate 
+     *  again its affected range once, the following calls only update the switch. The rules 
+     *  which do not break to the host cannot be switched as their inline code has no gate.
+     *
+     * @param[in] id      The id of the instrumentation.
+     * @param[in] enable  Whether the instrumentation should be enabled.
+     *
+     * @return  The status of the switch.
+     */
+    SwitchStatus setInstrumentationEnabled(uint32_t id, bool enable);
+
     /*! Remove all the registered instrumentations.
      *
      */
@@ -262,7 +761,8 @@ public:
      */
     bool precacheBasicBlock(rword pc);
 
-    /*! Clear a specific address range from the translation cache.
+    /*! Clear a specific address range from the translation cache, and forget the patches of its
+     *  basic blocks as their code could have been modified.
      *
      * @param[in] start Start of the address range to clear from the cache.
      * @param[in] end   End of the address range to clear from the cache.
@@ -270,7 +770,7 @@ public:
     */
     void clearCache(rword start, rword end);
 
-    /*! Clear the entire translation cache.
+    /*! Clear the entire translation cache, and forget the patches of every basic block.
     */
     void clearAllCache();
 };
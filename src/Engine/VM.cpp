@@ -15,6 +15,9 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
+#include <cstring>
+
 #include "VM.h"
 #include "Range.h"
 #include "Errors.h"
@@ -29,59 +32,244 @@
 
 namespace QBDI {
 
+// Number of entries of a watch filter, indexed by the bits 16 to 31 of the access address
+#define MEM_WATCH_FILTER_SIZE 65536
+// Largest access made by an instruction which is not a string operation. The watch filters are 
+// marked below the watched ranges such that an access starting before a range still hits it.
+#define MEM_WATCH_MAX_ACCESS 512
+
 struct MemCBInfo {
     MemoryAccessType type;
     Range<rword> range;
     InstCallback cbk;
     void* data;
+    bool enabled;
 };
 
-VMAction memReadGate(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
-    std::vector<std::pair<uint32_t, MemCBInfo>>* memCBInfos = (std::vector<std::pair<uint32_t, MemCBInfo>>*) data;
+enum MemWatchFilter {
+    WATCH_READ = 0,       /*!< Read addresses against the MEMORY_READ ranges */
+    WATCH_WRITE = 1,      /*!< Write addresses against the ranges watching writes */
+    WATCH_READ_WRITE = 2, /*!< Read addresses against the MEMORY_READ_WRITE ranges */
+    WATCH_FILTER_NUM = 3,
+};
+
+/*! Memory range callbacks of a VM. The ranges are kept in an interval index rebuilt on every 
+ *  change, which the gate callbacks query, and summarized in watch filters the instrumentation 
+ *  looks up inline to only break to the host when an access could hit a range.
+ */
+class MemWatch {
+
+    // Range positions in infos sorted by range start, and running maximum of the range ends
+    std::vector<size_t> byStart;
+    std::vector<rword> maxEnd;
+    // The filter address is embedded in the generated code, it is kept for the VM lifetime
+    uint8_t* filters;
+
+    void mark(MemWatchFilter filter, const Range<rword>& range) {
+        uint8_t* table = filters + filter * MEM_WATCH_FILTER_SIZE;
+        rword low = (range.start > MEM_WATCH_MAX_ACCESS - 1) ? range.start - (MEM_WATCH_MAX_ACCESS - 1) : 0;
+        rword high = range.end - 1;
+
+        if((high >> 16) - (low >> 16) >= MEM_WATCH_FILTER_SIZE - 1) {
+            memset(table, 1, MEM_WATCH_FILTER_SIZE);
+            return;
+        }
+        for(rword granule = low >> 16; granule <= (high >> 16); granule++) {
+            table[granule % MEM_WATCH_FILTER_SIZE] = 1;
+        }
+    }
+
+public:
+
+    std::vector<std::pair<uint32_t, MemCBInfo>> infos;
+
+    MemWatch() : filters(nullptr) {}
+
+    ~MemWatch() {
+        delete[] filters;
+    }
+
+    uint8_t* getFilter(MemWatchFilter filter) {
+        if(filters == nullptr) {
+            filters = new uint8_t[WATCH_FILTER_NUM * MEM_WATCH_FILTER_SIZE];
+            rebuild();
+        }
+        return filters + filter * MEM_WATCH_FILTER_SIZE;
+    }
+
+    void rebuild() {
+        byStart.resize(infos.size());
+        maxEnd.resize(infos.size());
+        for(size_t i = 0; i < infos.size(); i++) {
+            byStart[i] = i;
+        }
+        std::sort(byStart.begin(), byStart.end(), [this](size_t a, size_t b) {
+            return infos[a].second.range.start < infos[b].second.range.start;
+        });
+        for(size_t i = 0; i < byStart.size(); i++) {
+            rword end = infos[byStart[i]].second.range.end;
+            maxEnd[i] = (i > 0 && maxEnd[i - 1] > end) ? maxEnd[i - 1] : end;
+        }
+
+        if(filters == nullptr) {
+            return;
+        }
+        memset(filters, 0, WATCH_FILTER_NUM * MEM_WATCH_FILTER_SIZE);
+        for(const auto& info : infos) {
+            if(info.second.enabled == false) {
+                continue;
+            }
+            if(info.second.type == MEMORY_READ) {
+                mark(WATCH_READ, info.second.range);
+            }
+            if(info.second.type & MEMORY_WRITE) {
+                mark(WATCH_WRITE, info.second.range);
+            }
+            if(info.second.type == MEMORY_READ_WRITE) {
+                mark(WATCH_READ_WRITE, info.second.range);
+            }
+        }
+    }
+
+    /*! Collect the positions in infos of the ranges overlapping an access, in registration order.
+     */
+    void overlapping(const Range<rword>& access, std::vector<size_t>& hits) const {
+        // Only the ranges starting before the end of the access can overlap it, and walking them 
+        // backward stops as soon as none of the remaining ones ends after its start.
+        size_t n = std::partition_point(byStart.begin(), byStart.end(), [this, &access](size_t i) {
+            return infos[i].second.range.start < access.end;
+        }) - byStart.begin();
+        for(size_t i = n; i-- > 0 && maxEnd[i] > access.start; ) {
+            if(infos[byStart[i]].second.range.end > access.start) {
+                hits.push_back(byStart[i]);
+            }
+        }
+        std::sort(hits.begin(), hits.end());
+    }
+};
+
+static VMAction memWatchDispatch(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, 
+                                 MemWatch* memWatch, MemoryAccessType gate) {
     std::vector<MemoryAccess> memAccesses = vm->getInstMemoryAccess();
+    std::vector<MemCBInfo> matched;
+    std::vector<size_t> hits;
     VMAction action = VMAction::CONTINUE;
+
     for(const MemoryAccess& memAccess : memAccesses) {
-        Range<rword> accessRange(memAccess.accessAddress, memAccess.accessAddress + memAccess.size);
-        for(size_t i = 0; i < memCBInfos->size(); i++) {
+        if(memAccess.size == 0) {
+            continue;
+        }
+        hits.clear();
+        memWatch->overlapping(Range<rword>(memAccess.accessAddress, memAccess.accessAddress + memAccess.size), hits);
+        for(size_t i : hits) {
+            const MemCBInfo& info = memWatch->infos[i].second;
+            if(info.enabled == false) {
+                continue;
+            }
             // Check access type
-            if((*memCBInfos)[i].second.type == MEMORY_READ && (memAccess.type & (*memCBInfos)[i].second.type)) {
-                // Check access range
-                if((*memCBInfos)[i].second.range.overlaps(accessRange)) {
-                    // Forward to virtual callback
-                    VMAction ret = (*memCBInfos)[i].second.cbk(vm, gprState, fprState, (*memCBInfos)[i].second.data);
-                    // Always keep the most extreme action as the return
-                    if(ret > action) {
-                        action = ret;
-                    }
-                }
+            if(gate == MEMORY_READ && info.type == MEMORY_READ && (memAccess.type & MEMORY_READ)) {
+                matched.push_back(info);
+            }
+            else if(gate == MEMORY_WRITE && (info.type & MEMORY_WRITE) && (memAccess.type & info.type)) {
+                matched.push_back(info);
             }
         }
     }
+    // The callbacks are free to delete virtual callbacks, they are thus forwarded from a copy
+    for(const MemCBInfo& info : matched) {
+        VMAction ret = info.cbk(vm, gprState, fprState, info.data);
+        // Always keep the most extreme action as the return
+        if(ret > action) {
+            action = ret;
+        }
+    }
     return action;
 }
 
+VMAction memReadGate(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
+    return memWatchDispatch(vm, gprState, fprState, (MemWatch*) data, MEMORY_READ);
+}
+
 VMAction memWriteGate(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
-    std::vector<std::pair<uint32_t, MemCBInfo>>* memCBInfos = (std::vector<std::pair<uint32_t, MemCBInfo>>*) data;
-    std::vector<MemoryAccess> memAccesses = vm->getInstMemoryAccess();
-    VMAction action = VMAction::CONTINUE;
-    for(const MemoryAccess& memAccess : memAccesses) {
-        Range<rword> accessRange(memAccess.accessAddress, memAccess.accessAddress + memAccess.size);
-        for(size_t i = 0; i < memCBInfos->size(); i++) {
-            // Check access type
-            if(((*memCBInfos)[i].second.type & MEMORY_WRITE) && (memAccess.type & (*memCBInfos)[i].second.type)) {
-                // Check access range
-                if((*memCBInfos)[i].second.range.overlaps(accessRange)) {
-                    // Forward to virtual callback
-                    VMAction ret = (*memCBInfos)[i].second.cbk(vm, gprState, fprState, (*memCBInfos)[i].second.data);
-                    // Always keep the most extreme action as the return
-                    if(ret > action) {
-                        action = ret;
-                    }
-                }
-            }
+    return memWatchDispatch(vm, gprState, fprState, (MemWatch*) data, MEMORY_WRITE);
+}
+
+/*! Check an inline predicate, which the rules breaking to the host compile into their filter.
+ */
+static bool checkPredicate(const std::vector<Predicate>& predicate) {
+    if(predicate.empty()) {
+        return true;
+    }
+    for(const Predicate& term : predicate) {
+        switch(term.type) {
+            case PREDICATE_REG_EQUAL:
+            case PREDICATE_REG_NOT_EQUAL:
+            case PREDICATE_REG_IN_RANGE:
+                RequireAction("VM::checkPredicate", term.operand < REG_PC, return false);
+                break;
+            case PREDICATE_MEM_IN_RANGE:
+            case PREDICATE_MEM_MASK:
+                RequireAction("VM::checkPredicate", term.operand == MEMORY_READ || term.operand == MEMORY_WRITE, 
+                              return false);
+                break;
+            default:
+                RequireAction("VM::checkPredicate", false && "Unknown predicate type", return false);
         }
     }
-    return action;
+#if defined(QBDI_ARCH_X86_64)
+    return true;
+#else
+    LogError("VM::checkPredicate", "Inline predicates are not supported on this architecture");
+    return false;
+#endif
+}
+
+/*! State of a sampled callback. The countdown is decremented by the instrumentation, or by the
+ *  VM event gate, and reloaded by the gate when it goes below zero.
+ */
+class Sampler {
+public:
+    int64_t      countdown;
+    uint32_t     period;
+    bool         randomized;
+    uint64_t     seed;
+    InstCallback instCbk;
+    VMCallback   vmCbk;
+    void*        data;
+
+    Sampler(uint32_t period, bool randomized, InstCallback instCbk, VMCallback vmCbk, void* data) :
+        period(period), randomized(randomized), seed(0x9e3779b97f4a7c15ULL ^ (uint64_t) this),
+        instCbk(instCbk), vmCbk(vmCbk), data(data) {
+        reload();
+    }
+
+    void reload() {
+        uint64_t interval = period;
+        if(randomized && period > 1) {
+            // xorshift64, only the mean of the intervals matters
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            interval = 1 + seed % (2 * (uint64_t) period - 1);
+        }
+        countdown = interval - 1;
+    }
+};
+
+static VMAction sampledInstGate(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
+    Sampler* sampler = (Sampler*) data;
+    sampler->reload();
+    return sampler->instCbk(vm, gprState, fprState, sampler->data);
+}
+
+static VMAction sampledVMEventGate(VMInstanceRef vm, const VMState* vmState, GPRState* gprState, 
+                                   FPRState* fprState, void* data) {
+    Sampler* sampler = (Sampler*) data;
+    if(--sampler->countdown >= 0) {
+        return VMAction::CONTINUE;
+    }
+    sampler->reload();
+    return sampler->vmCbk(vm, vmState, gprState, fprState, sampler->data);
 }
 
 VMAction stopCallback(VMInstanceRef vm, GPRState* gprState, FPRState* fprState, void* data) {
@@ -91,12 +279,20 @@ VMAction stopCallback(VMInstanceRef vm, GPRState* gprState, FPRState* fprState,
 VM::VM(const std::string& cpu, const std::vector<std::string>& mattrs) :
     memoryLoggingLevel(0), memCBID(0), memReadGateCBID(VMError::INVALID_EVENTID), memWriteGateCBID(VMError::INVALID_EVENTID) {
     engine = new Engine(cpu, mattrs, this);
-    memCBInfos = new std::vector<std::pair<uint32_t, MemCBInfo>>;
+    memWatch = new MemWatch;
+    counters = new std::vector<std::pair<uint32_t, uint64_t*>>;
+    samplers = new std::vector<std::pair<uint32_t, Sampler*>>;
 }
 
 VM::~VM() {
-    delete memCBInfos;
+    delete memWatch;
+    delete counters;
     delete engine;
+    // The samplers are referenced by the translated code until the engine is destroyed
+    for(const auto& item : *samplers) {
+        delete item.second;
+    }
+    delete samplers;
 }
 
 GPRState* VM::getGPRState() const {
@@ -123,6 +319,10 @@ void VM::addInstrumentedRange(rword start, rword end) {
     engine->addInstrumentedRange(start, end);
 }
 
+void VM::addInstrumentedRanges(const RangeSet<rword>& ranges) {
+    engine->addInstrumentedRanges(ranges);
+}
+
 bool VM::addInstrumentedModule(const std::string& name) {
     return engine->addInstrumentedModule(name);
 }
@@ -140,10 +340,18 @@ void VM::removeInstrumentedRange(rword start, rword end) {
     engine->removeInstrumentedRange(start, end);
 }
 
+void VM::removeInstrumentedRanges(const RangeSet<rword>& ranges) {
+    engine->removeInstrumentedRanges(ranges);
+}
+
 void VM::removeAllInstrumentedRanges() {
     engine->removeAllInstrumentedRanges();
 }
 
+bool VM::setFastNativeCalls(bool enable) {
+    return engine->setFastNativeCalls(enable);
+}
+
 bool VM::removeInstrumentedModule(const std::string& name) {
     return engine->removeInstrumentedModule(name);
 }
@@ -152,13 +360,36 @@ bool VM::removeInstrumentedModuleFromAddr(rword addr) {
     return engine->removeInstrumentedModuleFromAddr(addr);
 }
 
+// The samplers of the deleted instrumentations can still be reached by the translated code until
+// the cache flush is committed, which happens before anything is executed by the next run
+void VM::releaseSamplers() {
+    for(size_t i = 0; i < samplers->size(); ) {
+        if((*samplers)[i].first == VMError::INVALID_EVENTID) {
+            delete (*samplers)[i].second;
+            samplers->erase(samplers->begin() + i);
+        }
+        else {
+            i++;
+        }
+    }
+}
+
 bool VM::run(rword start, rword stop) {
+    releaseSamplers();
     uint32_t stopCB = addCodeAddrCB(stop, InstPosition::PREINST, stopCallback, nullptr);
     bool ret = engine->run(start, stop);
     deleteInstrumentation(stopCB);
     return ret;
 }
 
+bool VM::runWithBudget(rword start, rword stop, uint64_t budget, BudgetType type, uint64_t* executed) {
+    releaseSamplers();
+    uint32_t stopCB = addCodeAddrCB(stop, InstPosition::PREINST, stopCallback, nullptr);
+    bool ret = engine->runWithBudget(start, stop, budget, type, executed);
+    deleteInstrumentation(stopCB);
+    return ret;
+}
+
 #define FAKE_RET_ADDR 42
 
 bool VM::callA(rword* retval, rword function, uint32_t argNum, const rword* args) {
@@ -202,43 +433,164 @@ uint32_t VM::addInstrRule(InstrRule rule) {
     return engine->addInstrRule(rule);
 }
 
-uint32_t VM::addMnemonicCB(const char* mnemonic, InstPosition pos, InstCallback cbk, void *data) {
+uint32_t VM::addMnemonicCB(const char* mnemonic, InstPosition pos, InstCallback cbk, void *data,
+                           const std::vector<Predicate>& predicate) {
     RequireAction("VM::addMnemonicCB", mnemonic != nullptr, return VMError::INVALID_EVENTID);
     RequireAction("VM::addMnemonicCB", cbk != nullptr, return VMError::INVALID_EVENTID);
+    RequireAction("VM::addMnemonicCB", checkPredicate(predicate), return VMError::INVALID_EVENTID);
     return addInstrRule(InstrRule(
         MnemonicIs(mnemonic),
         getCallbackGenerator(cbk, data),
         pos,
-        true
+        true,
+        {},
+        predicate
     ));
 }
 
-uint32_t VM::addCodeCB(InstPosition pos, InstCallback cbk, void *data) {
+uint32_t VM::addCodeCB(InstPosition pos, InstCallback cbk, void *data, const std::vector<Predicate>& predicate) {
     RequireAction("VM::addCodeCB", cbk != nullptr, return VMError::INVALID_EVENTID);
+    RequireAction("VM::addCodeCB", checkPredicate(predicate), return VMError::INVALID_EVENTID);
     return addInstrRule(InstrRule(
         True(),
         getCallbackGenerator(cbk, data),
         pos,
-        true
+        true,
+        {},
+        predicate
     ));
 }
 
-uint32_t VM::addCodeAddrCB(rword address, InstPosition pos, InstCallback cbk, void *data) {
+uint32_t VM::addCodeAddrCB(rword address, InstPosition pos, InstCallback cbk, void *data,
+                           const std::vector<Predicate>& predicate) {
     RequireAction("VM::addCodeAddrCB", cbk != nullptr, return VMError::INVALID_EVENTID);
-    return addCodeRangeCB(address, address + 1, pos, cbk, data);
+    return addCodeRangeCB(address, address + 1, pos, cbk, data, predicate);
 }
 
-uint32_t VM::addCodeRangeCB(rword start, rword end, InstPosition pos, InstCallback cbk, void *data) {
+uint32_t VM::addCodeRangeCB(rword start, rword end, InstPosition pos, InstCallback cbk, void *data,
+                            const std::vector<Predicate>& predicate) {
     RequireAction("VM::addCodeRangeCB", start < end, return VMError::INVALID_EVENTID);
     RequireAction("VM::addCodeRangeCB", cbk != nullptr, return VMError::INVALID_EVENTID);
+    RequireAction("VM::addCodeRangeCB", checkPredicate(predicate), return VMError::INVALID_EVENTID);
     return addInstrRule(InstrRule(
         AddressInRange(start, end),
         getCallbackGenerator(cbk, data),
         pos,
-        true
+        true,
+        {},
+        predicate
     ));
 }
 
+uint32_t VM::addSampledCodeCB(InstPosition pos, InstCallback cbk, void *data, uint32_t period,
+                              bool randomized, const std::vector<Predicate>& predicate) {
+    return addSampledCodeRangeCB(0, (rword) -1, pos, cbk, data, period, randomized, predicate);
+}
+
+uint32_t VM::addSampledCodeRangeCB(rword start, rword end, InstPosition pos, InstCallback cbk, void *data,
+                                   uint32_t period, bool randomized, const std::vector<Predicate>& predicate) {
+    PatchGenerator::SharedPtrVec filter;
+    RequireAction("VM::addSampledCodeRangeCB", start < end, return VMError::INVALID_EVENTID);
+    RequireAction("VM::addSampledCodeRangeCB", cbk != nullptr, return VMError::INVALID_EVENTID);
+    RequireAction("VM::addSampledCodeRangeCB", period > 0, return VMError::INVALID_EVENTID);
+    RequireAction("VM::addSampledCodeRangeCB", checkPredicate(predicate), return VMError::INVALID_EVENTID);
+#if defined(QBDI_ARCH_X86_64)
+    // addSampledCodeCB covers every address
+    PatchCondition::SharedPtr condition = AddressInRange(start, end);
+    if(start == 0 && end == (rword) -1) {
+        condition = True();
+    }
+    Sampler* sampler = new Sampler(period, randomized, cbk, nullptr, data);
+    filter.push_back(DecrementCountdown(Temp(0), Temp(1), Temp(2), Constant((rword) &sampler->countdown), 1, 
+                                        predicate.size() > 0));
+    uint32_t id = addInstrRule(InstrRule(
+        condition,
+        getCallbackGenerator(sampledInstGate, sampler),
+        pos,
+        true,
+        filter,
+        predicate
+    ));
+    if(id == VMError::INVALID_EVENTID) {
+        delete sampler;
+        return id;
+    }
+    samplers->push_back(std::make_pair(id, sampler));
+    return id;
+#else
+    LogError("VM::addSampledCodeRangeCB", "Sampled callbacks are not supported on this architecture");
+    return VMError::INVALID_EVENTID;
+#endif
+}
+
+uint32_t VM::addCounterRule(InstrRule rule, uint64_t* counter) {
+    uint32_t id = addInstrRule(rule);
+    if(id != VMError::INVALID_EVENTID) {
+        counters->push_back(std::make_pair(id, counter));
+    }
+    return id;
+}
+
+uint32_t VM::addCodeCounter(uint64_t* counter, bool atomic) {
+    RequireAction("VM::addCodeCounter", counter != nullptr, return VMError::INVALID_EVENTID);
+#ifdef QBDI_ARCH_X86_64
+    return addCounterRule(InstrRule(
+        True(),
+        {IncrementCounter(Temp(0), Temp(1), Constant((rword) counter), atomic)},
+        PREINST,
+        false
+    ), counter);
+#else
+    return VMError::INVALID_EVENTID;
+#endif
+}
+
+uint32_t VM::addCodeAddrCounter(rword address, uint64_t* counter, bool atomic) {
+    return addCodeRangeCounter(address, address + 1, counter, atomic);
+}
+
+uint32_t VM::addCodeRangeCounter(rword start, rword end, uint64_t* counter, bool atomic) {
+    RequireAction("VM::addCodeRangeCounter", start < end, return VMError::INVALID_EVENTID);
+    RequireAction("VM::addCodeRangeCounter", counter != nullptr, return VMError::INVALID_EVENTID);
+#ifdef QBDI_ARCH_X86_64
+    return addCounterRule(InstrRule(
+        AddressInRange(start, end),
+        {IncrementCounter(Temp(0), Temp(1), Constant((rword) counter), atomic)},
+        PREINST,
+        false
+    ), counter);
+#else
+    return VMError::INVALID_EVENTID;
+#endif
+}
+
+uint32_t VM::addMnemonicCounter(const char* mnemonic, uint64_t* counter, bool atomic) {
+    RequireAction("VM::addMnemonicCounter", mnemonic != nullptr, return VMError::INVALID_EVENTID);
+    RequireAction("VM::addMnemonicCounter", counter != nullptr, return VMError::INVALID_EVENTID);
+#ifdef QBDI_ARCH_X86_64
+    return addCounterRule(InstrRule(
+        MnemonicIs(mnemonic),
+        {IncrementCounter(Temp(0), Temp(1), Constant((rword) counter), atomic)},
+        PREINST,
+        false
+    ), counter);
+#else
+    return VMError::INVALID_EVENTID;
+#endif
+}
+
+std::vector<CounterValue> VM::getCounters() const {
+    std::vector<CounterValue> values;
+    for(const auto& counter : *counters) {
+        values.push_back(CounterValue {counter.first, *counter.second});
+    }
+    return values;
+}
+
+bool VM::setEdgeCoverage(uint8_t* bitmap, size_t size) {
+    return engine->setEdgeCoverage(bitmap, size);
+}
+
 uint32_t VM::addMemAccessCB(MemoryAccessType type, InstCallback cbk, void *data) {
     RequireAction("VM::addMemAccessCB", cbk != nullptr, return VMError::INVALID_EVENTID);
     recordMemoryAccess(type);
@@ -282,15 +634,65 @@ uint32_t VM::addMemRangeCB(rword start, rword end, MemoryAccessType type, InstCa
     RequireAction("VM::addMemRangeCB", start < end, return VMError::INVALID_EVENTID);
     RequireAction("VM::addMemRangeCB", type & MEMORY_READ_WRITE, return VMError::INVALID_EVENTID);
     RequireAction("VM::addMemRangeCB", cbk != nullptr, return VMError::INVALID_EVENTID);
+    uint32_t id = memCBID++;
+    RequireAction("VM::addMemRangeCB", id < EVENTID_VIRTCB_MASK, return VMError::INVALID_EVENTID);
+    memWatch->infos.push_back(std::make_pair(id, MemCBInfo {type, Range<rword>(start, end), cbk, data, true}));
+    memWatch->rebuild();
+#if defined(QBDI_ARCH_X86_64)
+    // The gates only break to the host when the watch filters report a possible hit
     if((type == MEMORY_READ) && memReadGateCBID == VMError::INVALID_EVENTID) {
-        memReadGateCBID = addMemAccessCB(MEMORY_READ, memReadGate, memCBInfos);
+        recordMemoryAccess(MEMORY_READ);
+        memReadGateCBID = addInstrRule(InstrRule(
+            DoesReadAccess(),
+            getCallbackGenerator(memReadGate, memWatch),
+            PREINST,
+            true,
+            {
+                GetMemWatchHit(Temp(0), Temp(1), MEMORY_READ, 
+                               Constant((rword) memWatch->getFilter(WATCH_READ))),
+            }
+        ));
     }
     if((type & MEMORY_WRITE) && memWriteGateCBID == VMError::INVALID_EVENTID) {
-        memWriteGateCBID = addMemAccessCB(MEMORY_READ_WRITE, memWriteGate, memCBInfos);
+        recordMemoryAccess(MEMORY_READ_WRITE);
+        // The read address may not be computable after the instruction, its lookup is done before
+        // and its result kept for the write gate
+        addInstrRule(InstrRule(
+            Or({
+                DoesReadAccess(),
+                DoesWriteAccess(),
+            }),
+            {
+                GetMemWatchHit(Temp(0), Temp(1), MEMORY_READ, 
+                               Constant((rword) memWatch->getFilter(WATCH_READ_WRITE))),
+                WriteTemp(Temp(0), Offset(offsetof(Context, hostState.watchReadHit))),
+            },
+            PREINST,
+            false
+        ));
+        memWriteGateCBID = addInstrRule(InstrRule(
+            Or({
+                DoesReadAccess(),
+                DoesWriteAccess(),
+            }),
+            getCallbackGenerator(memWriteGate, memWatch),
+            POSTINST,
+            true,
+            {
+                GetMemWatchHit(Temp(0), Temp(1), MEMORY_WRITE, 
+                               Constant((rword) memWatch->getFilter(WATCH_WRITE)),
+                               Offset(offsetof(Context, hostState.watchReadHit))),
+            }
+        ));
     }
-    uint32_t id = memCBID++;
-    RequireAction("VM::addMemRangeCB", id < EVENTID_VIRTCB_MASK, return VMError::INVALID_EVENTID);
-    memCBInfos->push_back(std::make_pair(id, MemCBInfo {type, Range<rword>(start, end), cbk, data}));
+#else
+    if((type == MEMORY_READ) && memReadGateCBID == VMError::INVALID_EVENTID) {
+        memReadGateCBID = addMemAccessCB(MEMORY_READ, memReadGate, memWatch);
+    }
+    if((type & MEMORY_WRITE) && memWriteGateCBID == VMError::INVALID_EVENTID) {
+        memWriteGateCBID = addMemAccessCB(MEMORY_READ_WRITE, memWriteGate, memWatch);
+    }
+#endif
     return id | EVENTID_VIRTCB_MASK;
 }
 
@@ -300,27 +702,83 @@ uint32_t VM::addVMEventCB(VMEvent mask, VMCallback cbk, void *data) {
     return engine->addVMEventCB(mask, cbk, data);
 }
 
+uint32_t VM::addSampledVMEventCB(VMEvent mask, VMCallback cbk, void *data, uint32_t period, bool randomized) {
+    RequireAction("VM::addSampledVMEventCB", mask != 0, return VMError::INVALID_EVENTID);
+    RequireAction("VM::addSampledVMEventCB", cbk != nullptr, return VMError::INVALID_EVENTID);
+    RequireAction("VM::addSampledVMEventCB", period > 0, return VMError::INVALID_EVENTID);
+    Sampler* sampler = new Sampler(period, randomized, nullptr, cbk, data);
+    uint32_t id = engine->addVMEventCB(mask, sampledVMEventGate, sampler);
+    if(id == VMError::INVALID_EVENTID) {
+        delete sampler;
+        return id;
+    }
+    samplers->push_back(std::make_pair(id, sampler));
+    return id;
+}
+
+uint32_t VM::replaceFunction(rword target, rword replacement) {
+    RequireAction("VM::replaceFunction", replacement != 0, return VMError::INVALID_EVENTID);
+    return engine->addInterception(target, replacement, nullptr, nullptr, nullptr);
+}
+
+uint32_t VM::wrapFunction(rword target, InstCallback pre, InstCallback post, void *data) {
+    RequireAction("VM::wrapFunction", pre != nullptr || post != nullptr, return VMError::INVALID_EVENTID);
+    return engine->addInterception(target, 0, pre, post, data);
+}
+
 bool VM::deleteInstrumentation(uint32_t id) {
     if(id & EVENTID_VIRTCB_MASK) {
         id &= ~EVENTID_VIRTCB_MASK;
-        for(size_t i = 0; i < memCBInfos->size(); i++) {
-            if((*memCBInfos)[i].first == id) {
-                memCBInfos->erase(memCBInfos->begin() + i);
+        for(size_t i = 0; i < memWatch->infos.size(); i++) {
+            if(memWatch->infos[i].first == id) {
+                memWatch->infos.erase(memWatch->infos.begin() + i);
+                memWatch->rebuild();
                 return true;
             }
         }
         return false;
     }
     else {
+        for(size_t i = 0; i < counters->size(); i++) {
+            if((*counters)[i].first == id) {
+                counters->erase(counters->begin() + i);
+                break;
+            }
+        }
+        for(auto& item : *samplers) {
+            if(item.first == id) {
+                item.first = VMError::INVALID_EVENTID;
+            }
+        }
         return engine->deleteInstrumentation(id);
     }
 }
 
+SwitchStatus VM::setInstrumentationEnabled(uint32_t id, bool enable) {
+    if(id & EVENTID_VIRTCB_MASK) {
+        id &= ~EVENTID_VIRTCB_MASK;
+        for(auto& info : memWatch->infos) {
+            if(info.first == id) {
+                info.second.enabled = enable;
+                memWatch->rebuild();
+                return SwitchStatus::SWITCH_UPDATED;
+            }
+        }
+        return SwitchStatus::SWITCH_INVALID_ID;
+    }
+    return engine->setInstrumentationEnabled(id, enable);
+}
+
 void VM::deleteAllInstrumentations() {
     engine->deleteAllInstrumentations();
     memReadGateCBID = VMError::INVALID_EVENTID;
     memWriteGateCBID = VMError::INVALID_EVENTID;
-    memCBInfos->clear();
+    memWatch->infos.clear();
+    memWatch->rebuild();
+    counters->clear();
+    for(auto& item : *samplers) {
+        item.first = VMError::INVALID_EVENTID;
+    }
     memoryLoggingLevel = 0;
 }
 
@@ -337,12 +795,31 @@ bool VM::recordMemoryAccess(MemoryAccessType type) {
     if(type & MEMORY_READ && !(memoryLoggingLevel & MEMORY_READ)) {
         memoryLoggingLevel |= MEMORY_READ;
         addInstrRule(InstrRule(
-            DoesReadAccess(),
+            And({
+                DoesReadAccess(),
+                Not(IsStringAccess()),
+            }),
             {
                 GetReadAddress(Temp(0)),
                 WriteTemp(Temp(0), Shadow(MEM_READ_ADDRESS_TAG)),
                 GetReadValue(Temp(0)),
                 WriteTemp(Temp(0), Shadow(MEM_VALUE_TAG)),
+                GetWideValue(Temp(0), Shadow(MEM_VALUE_TAG), MEMORY_READ),
+            },
+            PREINST,
+            false
+        ));
+        // String operations record their length in place of their value
+        addInstrRule(InstrRule(
+            And({
+                DoesReadAccess(),
+                IsStringAccess(),
+            }),
+            {
+                GetReadAddress(Temp(0), Temp(1), Temp(2)),
+                WriteTemp(Temp(0), Shadow(MEM_READ_ADDRESS_TAG)),
+                GetStringLength(Temp(0)),
+                WriteTemp(Temp(0), Shadow(MEM_VALUE_TAG)),
             },
             PREINST,
             false
@@ -351,16 +828,36 @@ bool VM::recordMemoryAccess(MemoryAccessType type) {
     if(type & MEMORY_WRITE && !(memoryLoggingLevel & MEMORY_WRITE)) {
         memoryLoggingLevel |= MEMORY_WRITE;
         addInstrRule(InstrRule(
-            DoesWriteAccess(),
+            And({
+                DoesWriteAccess(),
+                Not(IsStringAccess()),
+            }),
             {
                 GetWriteAddress(Temp(0)),
                 WriteTemp(Temp(0), Shadow(MEM_WRITE_ADDRESS_TAG)),
                 GetWriteValue(Temp(0)),
                 WriteTemp(Temp(0), Shadow(MEM_VALUE_TAG)),
+                GetWideValue(Temp(0), Shadow(MEM_VALUE_TAG), MEMORY_WRITE),
             },
             POSTINST,
             false
         ));
+        // The index registers of string operations are updated by the instruction, their 
+        // destination range is thus computed before it
+        addInstrRule(InstrRule(
+            And({
+                DoesWriteAccess(),
+                IsStringAccess(),
+            }),
+            {
+                GetWriteAddress(Temp(0), Temp(1), Temp(2)),
+                WriteTemp(Temp(0), Shadow(MEM_WRITE_ADDRESS_TAG)),
+                GetStringLength(Temp(0)),
+                WriteTemp(Temp(0), Shadow(MEM_VALUE_TAG)),
+            },
+            PREINST,
+            false
+        ));
     }
     return true;
 #else
@@ -419,6 +916,16 @@ std::vector<MemoryAccess> VM::getInstMemoryAccess() const {
             continue;
         }
 
+        // String operations record their length in place of their value
+        if(isStringAccess(curExecBlock->getOriginalMCInst(instID))) {
+            access.size = access.value;
+            access.value = 0;
+            access.flags = MEMORY_UNKNOWN_VALUE;
+        }
+        else if(access.size > sizeof(rword)) {
+            access.flags = MEMORY_PARTIAL_VALUE;
+        }
+
         // we found our access and its value, record access
         memAccess.push_back(access);
         i += 1;
@@ -479,6 +986,16 @@ std::vector<MemoryAccess> VM::getBBMemoryAccess() const {
             continue;
         }
 
+        // String operations record their length in place of their value
+        if(isStringAccess(curExecBlock->getOriginalMCInst(shadows[i].instID))) {
+            access.size = access.value;
+            access.value = 0;
+            access.flags = MEMORY_UNKNOWN_VALUE;
+        }
+        else if(access.size > sizeof(rword)) {
+            access.flags = MEMORY_PARTIAL_VALUE;
+        }
+
         // we found our access and its value, record access
         memAccess.push_back(access);
         i += 1;
@@ -486,6 +1003,93 @@ std::vector<MemoryAccess> VM::getBBMemoryAccess() const {
     return memAccess;
 }
 
+bool VM::getMemoryAccessValue(const MemoryAccess& access, void* buffer, size_t size) const {
+    RequireAction("VM::getMemoryAccessValue", buffer != nullptr, return false);
+    const ExecBlock* curExecBlock = engine->getCurExecBlock();
+    if(curExecBlock == nullptr || (access.flags & MEMORY_UNKNOWN_VALUE)) {
+        return false;
+    }
+    uint16_t addressTag = (access.type == MEMORY_READ) ? MEM_READ_ADDRESS_TAG : MEM_WRITE_ADDRESS_TAG;
+    std::vector<ShadowInfo> shadows = curExecBlock->queryShadowBySeq(curExecBlock->getCurrentSeqID(), ANY);
+
+    for(size_t i = 0; i < shadows.size(); i++) {
+        if(shadows[i].tag != addressTag ||
+           curExecBlock->getInstAddress(shadows[i].instID) != access.instAddress ||
+           curExecBlock->getShadow(shadows[i].shadowID) != access.accessAddress) {
+            continue;
+        }
+        // The value is stored one rword per shadow after the address shadow
+        size_t copied = 0;
+        size_t length = std::min(size, (size_t) access.size);
+        for(size_t j = i + 1; j < shadows.size() && copied < length; j++) {
+            if(shadows[j].tag != MEM_VALUE_TAG || shadows[j].instID != shadows[i].instID) {
+                break;
+            }
+            rword value = curExecBlock->getShadow(shadows[j].shadowID);
+            size_t chunk = std::min(length - copied, sizeof(rword));
+            memcpy(static_cast<uint8_t*>(buffer) + copied, &value, chunk);
+            copied += chunk;
+        }
+        return copied == length;
+    }
+    return false;
+}
+
+bool VM::setMemoryTrace(MemoryAccessType type, MemoryTraceCallback cbk, void *data, size_t batchSize) {
+    return engine->setMemoryTrace(type, cbk, data, batchSize);
+}
+
+void VM::flushMemoryTrace() {
+    engine->flushMemoryTrace();
+}
+
+bool VM::setSyscallTrace(SyscallTraceCallback cbk, void *data, size_t batchSize) {
+    return engine->setSyscallTrace(cbk, data, batchSize);
+}
+
+void VM::flushSyscallTrace() {
+    engine->flushSyscallTrace();
+}
+
+bool VM::setCallStackTracking(bool enable) {
+    return engine->setCallStackTracking(enable);
+}
+
+std::vector<CallFrame> VM::getCallStack() const {
+    return engine->getCallStack();
+}
+
+bool VM::setBranchProfiling(bool enable) {
+    return engine->setBranchProfiling(enable);
+}
+
+std::vector<rword> VM::getBranchSites() const {
+    return engine->getBranchSites();
+}
+
+std::vector<BranchTarget> VM::getBranchTargets(rword site) const {
+    return engine->getBranchTargets(site);
+}
+
+bool VM::setTaintTracking(bool enable) {
+    return engine->setTaintTracking(enable);
+}
+
+bool VM::setMemoryTaint(rword start, rword size, TaintLabel label) {
+    return engine->setMemoryTaint(start, size, label);
+}
+
+TaintLabel VM::getMemoryTaint(rword start, rword size) const {
+    return engine->getMemoryTaint(start, size);
+}
+
+bool VM::setRegisterTaint(unsigned int gpr, TaintLabel label) {
+    return engine->setRegisterTaint(gpr, label);
+}
+
+TaintLabel VM::getRegisterTaint(unsigned int gpr) const {
+    return engine->getRegisterTaint(gpr);
+}
 
 bool VM::precacheBasicBlock(rword pc) {
     return engine->precacheBasicBlock(pc);
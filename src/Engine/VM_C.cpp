@@ -54,6 +54,16 @@ void qbdi_addInstrumentedRange(VMInstanceRef instance, rword start, rword end) {
     ((VM*)instance)->addInstrumentedRange(start, end);
 }
 
+void qbdi_addInstrumentedRanges(VMInstanceRef instance, const rword* starts, const rword* ends, size_t size) {
+    RequireAction("VM_C::addInstrumentedRanges", instance, return);
+    RequireAction("VM_C::addInstrumentedRanges", size == 0 || (starts && ends), return);
+    RangeSet<rword> ranges;
+    for(size_t i = 0; i < size; i++) {
+        ranges.add(Range<rword>(starts[i], ends[i]));
+    }
+    ((VM*)instance)->addInstrumentedRanges(ranges);
+}
+
 bool qbdi_addInstrumentedModule(VMInstanceRef instance, const char* name) {
     RequireAction("VM_C::addInstrumentedModule", instance, return false);
     return ((VM*)instance)->addInstrumentedModule(std::string(name));
@@ -74,11 +84,26 @@ void qbdi_removeInstrumentedRange(VMInstanceRef instance, rword start, rword end
     ((VM*)instance)->removeInstrumentedRange(start, end);
 }
 
+void qbdi_removeInstrumentedRanges(VMInstanceRef instance, const rword* starts, const rword* ends, size_t size) {
+    RequireAction("VM_C::removeInstrumentedRanges", instance, return);
+    RequireAction("VM_C::removeInstrumentedRanges", size == 0 || (starts && ends), return);
+    RangeSet<rword> ranges;
+    for(size_t i = 0; i < size; i++) {
+        ranges.add(Range<rword>(starts[i], ends[i]));
+    }
+    ((VM*)instance)->removeInstrumentedRanges(ranges);
+}
+
 void qbdi_removeAllInstrumentedRanges(VMInstanceRef instance) {
     RequireAction("VM_C::removeAllInstrumentedRanges", instance, return);
     ((VM*)instance)->removeAllInstrumentedRanges();
 }
 
+bool qbdi_setFastNativeCalls(VMInstanceRef instance, bool enable) {
+    RequireAction("VM_C::setFastNativeCalls", instance, return false);
+    return ((VM*)instance)->setFastNativeCalls(enable);
+}
+
 bool qbdi_removeInstrumentedModule(VMInstanceRef instance, const char* name) {
     RequireAction("VM_C::removeInstrumentedModule", instance, return false);
     return ((VM*)instance)->removeInstrumentedModule(std::string(name));
@@ -94,6 +119,11 @@ bool qbdi_run(VMInstanceRef instance, rword start, rword stop) {
     return ((VM*) instance)->run(start, stop);
 }
 
+bool qbdi_runWithBudget(VMInstanceRef instance, rword start, rword stop, uint64_t budget, BudgetType type, uint64_t* executed) {
+    RequireAction("VM_C::runWithBudget", instance, return false);
+    return ((VM*) instance)->runWithBudget(start, stop, budget, type, executed);
+}
+
 bool qbdi_call(VMInstanceRef instance, rword* retval, rword function, uint32_t argNum, ...) {
     RequireAction("VM_C::call", instance, return false);
     va_list ap;
@@ -153,6 +183,77 @@ uint32_t qbdi_addCodeRangeCB(VMInstanceRef instance, rword start, rword end, Ins
     return ((VM*) instance)->addCodeRangeCB(start, end, pos, cbk, data);
 }
 
+uint32_t qbdi_addPredicatedCodeCB(VMInstanceRef instance, InstPosition pos, InstCallback cbk, void *data, const Predicate* predicate, size_t size) {
+    RequireAction("VM_C::addPredicatedCodeCB", instance, return VMError::INVALID_EVENTID);
+    RequireAction("VM_C::addPredicatedCodeCB", predicate != nullptr || size == 0, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->addCodeCB(pos, cbk, data, std::vector<Predicate>(predicate, predicate + size));
+}
+
+uint32_t qbdi_addPredicatedCodeRangeCB(VMInstanceRef instance, rword start, rword end, InstPosition pos, InstCallback cbk, void *data, const Predicate* predicate, size_t size) {
+    RequireAction("VM_C::addPredicatedCodeRangeCB", instance, return VMError::INVALID_EVENTID);
+    RequireAction("VM_C::addPredicatedCodeRangeCB", predicate != nullptr || size == 0, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->addCodeRangeCB(start, end, pos, cbk, data, std::vector<Predicate>(predicate, predicate + size));
+}
+
+uint32_t qbdi_addPredicatedMnemonicCB(VMInstanceRef instance, const char* mnemonic, InstPosition pos, InstCallback cbk, void *data, const Predicate* predicate, size_t size) {
+    RequireAction("VM_C::addPredicatedMnemonicCB", instance, return VMError::INVALID_EVENTID);
+    RequireAction("VM_C::addPredicatedMnemonicCB", predicate != nullptr || size == 0, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->addMnemonicCB(mnemonic, pos, cbk, data, std::vector<Predicate>(predicate, predicate + size));
+}
+
+uint32_t qbdi_addSampledCodeCB(VMInstanceRef instance, InstPosition pos, InstCallback cbk, void *data, uint32_t period, bool randomized) {
+    RequireAction("VM_C::addSampledCodeCB", instance, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->addSampledCodeCB(pos, cbk, data, period, randomized);
+}
+
+uint32_t qbdi_addSampledCodeRangeCB(VMInstanceRef instance, rword start, rword end, InstPosition pos, InstCallback cbk, void *data, uint32_t period, bool randomized) {
+    RequireAction("VM_C::addSampledCodeRangeCB", instance, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->addSampledCodeRangeCB(start, end, pos, cbk, data, period, randomized);
+}
+
+uint32_t qbdi_addCodeCounter(VMInstanceRef instance, uint64_t* counter, bool atomic) {
+    RequireAction("VM_C::addCodeCounter", instance, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->addCodeCounter(counter, atomic);
+}
+
+uint32_t qbdi_addCodeAddrCounter(VMInstanceRef instance, rword address, uint64_t* counter, bool atomic) {
+    RequireAction("VM_C::addCodeAddrCounter", instance, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->addCodeAddrCounter(address, counter, atomic);
+}
+
+uint32_t qbdi_addCodeRangeCounter(VMInstanceRef instance, rword start, rword end, uint64_t* counter, bool atomic) {
+    RequireAction("VM_C::addCodeRangeCounter", instance, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->addCodeRangeCounter(start, end, counter, atomic);
+}
+
+uint32_t qbdi_addMnemonicCounter(VMInstanceRef instance, const char* mnemonic, uint64_t* counter, bool atomic) {
+    RequireAction("VM_C::addMnemonicCounter", instance, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->addMnemonicCounter(mnemonic, counter, atomic);
+}
+
+CounterValue* qbdi_getCounters(VMInstanceRef instance, size_t* size) {
+    RequireAction("VM_C::getCounters", instance, return nullptr);
+    RequireAction("VM_C::getCounters", size, return nullptr);
+    *size = 0;
+    std::vector<CounterValue> cv_vec = ((VM*) instance)->getCounters();
+    // Do not allocate if no counters
+    if(cv_vec.size() == 0) {
+        return NULL;
+    }
+    // Allocate and copy
+    *size = cv_vec.size();
+    CounterValue* cv_arr = (CounterValue*) malloc(*size * sizeof(CounterValue));
+    for(size_t i = 0; i < *size; i++) {
+        cv_arr[i] = cv_vec[i];
+    }
+    return cv_arr;
+}
+
+bool qbdi_setEdgeCoverage(VMInstanceRef instance, uint8_t* bitmap, size_t size) {
+    RequireAction("VM_C::setEdgeCoverage", instance, return false);
+    return ((VM*) instance)->setEdgeCoverage(bitmap, size);
+}
+
 uint32_t qbdi_addMemAccessCB(VMInstanceRef instance, MemoryAccessType type, InstCallback cbk, void *data) {
     RequireAction("VM_C::addMemAccessCB", instance, return VMError::INVALID_EVENTID);
     return ((VM*) instance)->addMemAccessCB(type, cbk, data);
@@ -173,11 +274,31 @@ uint32_t qbdi_addVMEventCB(VMInstanceRef instance, VMEvent mask, VMCallback cbk,
     return ((VM*) instance)->addVMEventCB(mask, cbk, data);
 }
 
+uint32_t qbdi_addSampledVMEventCB(VMInstanceRef instance, VMEvent mask, VMCallback cbk, void *data, uint32_t period, bool randomized) {
+    RequireAction("VM_C::addSampledVMEventCB", instance, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->addSampledVMEventCB(mask, cbk, data, period, randomized);
+}
+
+uint32_t qbdi_replaceFunction(VMInstanceRef instance, rword target, rword replacement) {
+    RequireAction("VM_C::replaceFunction", instance, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->replaceFunction(target, replacement);
+}
+
+uint32_t qbdi_wrapFunction(VMInstanceRef instance, rword target, InstCallback pre, InstCallback post, void *data) {
+    RequireAction("VM_C::wrapFunction", instance, return VMError::INVALID_EVENTID);
+    return ((VM*) instance)->wrapFunction(target, pre, post, data);
+}
+
 bool qbdi_deleteInstrumentation(VMInstanceRef instance, uint32_t id) {
     RequireAction("VM_C::deleteInstrumentation", instance, return false);
     return ((VM*) instance)->deleteInstrumentation(id);
 }
 
+SwitchStatus qbdi_setInstrumentationEnabled(VMInstanceRef instance, uint32_t id, bool enable) {
+    RequireAction("VM_C::setInstrumentationEnabled", instance, return SwitchStatus::SWITCH_INVALID_ID);
+    return ((VM*) instance)->setInstrumentationEnabled(id, enable);
+}
+
 void qbdi_deleteAllInstrumentations(VMInstanceRef instance) {
     RequireAction("VM_C::deleteAllInstrumentations", instance, return);
     ((VM*) instance)->deleteAllInstrumentations();
@@ -229,6 +350,121 @@ MemoryAccess* qbdi_getBBMemoryAccess(VMInstanceRef instance, size_t* size) {
     return ma_arr;
 }
 
+bool qbdi_getMemoryAccessValue(VMInstanceRef instance, const MemoryAccess* access, void* buffer, size_t size) {
+    RequireAction("VM_C::getMemoryAccessValue", instance, return false);
+    RequireAction("VM_C::getMemoryAccessValue", access, return false);
+    return ((VM*) instance)->getMemoryAccessValue(*access, buffer, size);
+}
+
+bool qbdi_setMemoryTrace(VMInstanceRef instance, MemoryAccessType type, MemoryTraceCallback cbk, void *data, size_t batchSize) {
+    RequireAction("VM_C::setMemoryTrace", instance, return false);
+    return ((VM*) instance)->setMemoryTrace(type, cbk, data, batchSize);
+}
+
+void qbdi_flushMemoryTrace(VMInstanceRef instance) {
+    RequireAction("VM_C::flushMemoryTrace", instance, return);
+    ((VM*) instance)->flushMemoryTrace();
+}
+
+bool qbdi_setSyscallTrace(VMInstanceRef instance, SyscallTraceCallback cbk, void *data, size_t batchSize) {
+    RequireAction("VM_C::setSyscallTrace", instance, return false);
+    return ((VM*) instance)->setSyscallTrace(cbk, data, batchSize);
+}
+
+void qbdi_flushSyscallTrace(VMInstanceRef instance) {
+    RequireAction("VM_C::flushSyscallTrace", instance, return);
+    ((VM*) instance)->flushSyscallTrace();
+}
+
+bool qbdi_setCallStackTracking(VMInstanceRef instance, bool enable) {
+    RequireAction("VM_C::setCallStackTracking", instance, return false);
+    return ((VM*) instance)->setCallStackTracking(enable);
+}
+
+CallFrame* qbdi_getCallStack(VMInstanceRef instance, size_t* size) {
+    RequireAction("VM_C::getCallStack", instance, return nullptr);
+    RequireAction("VM_C::getCallStack", size, return nullptr);
+    *size = 0;
+    std::vector<CallFrame> cf_vec = ((VM*) instance)->getCallStack();
+    // Do not allocate if the call stack is empty
+    if(cf_vec.size() == 0) {
+        return NULL;
+    }
+    // Allocate and copy
+    *size = cf_vec.size();
+    CallFrame* cf_arr = (CallFrame*) malloc(*size * sizeof(CallFrame));
+    for(size_t i = 0; i < *size; i++) {
+        cf_arr[i] = cf_vec[i];
+    }
+    return cf_arr;
+}
+
+bool qbdi_setBranchProfiling(VMInstanceRef instance, bool enable) {
+    RequireAction("VM_C::setBranchProfiling", instance, return false);
+    return ((VM*) instance)->setBranchProfiling(enable);
+}
+
+rword* qbdi_getBranchSites(VMInstanceRef instance, size_t* size) {
+    RequireAction("VM_C::getBranchSites", instance, return nullptr);
+    RequireAction("VM_C::getBranchSites", size, return nullptr);
+    *size = 0;
+    std::vector<rword> site_vec = ((VM*) instance)->getBranchSites();
+    // Do not allocate if no site was executed
+    if(site_vec.size() == 0) {
+        return NULL;
+    }
+    // Allocate and copy
+    *size = site_vec.size();
+    rword* site_arr = (rword*) malloc(*size * sizeof(rword));
+    for(size_t i = 0; i < *size; i++) {
+        site_arr[i] = site_vec[i];
+    }
+    return site_arr;
+}
+
+BranchTarget* qbdi_getBranchTargets(VMInstanceRef instance, rword site, size_t* size) {
+    RequireAction("VM_C::getBranchTargets", instance, return nullptr);
+    RequireAction("VM_C::getBranchTargets", size, return nullptr);
+    *size = 0;
+    std::vector<BranchTarget> bt_vec = ((VM*) instance)->getBranchTargets(site);
+    // Do not allocate if the site was not executed
+    if(bt_vec.size() == 0) {
+        return NULL;
+    }
+    // Allocate and copy
+    *size = bt_vec.size();
+    BranchTarget* bt_arr = (BranchTarget*) malloc(*size * sizeof(BranchTarget));
+    for(size_t i = 0; i < *size; i++) {
+        bt_arr[i] = bt_vec[i];
+    }
+    return bt_arr;
+}
+
+bool qbdi_setTaintTracking(VMInstanceRef instance, bool enable) {
+    RequireAction("VM_C::setTaintTracking", instance, return false);
+    return ((VM*) instance)->setTaintTracking(enable);
+}
+
+bool qbdi_setMemoryTaint(VMInstanceRef instance, rword start, rword size, TaintLabel label) {
+    RequireAction("VM_C::setMemoryTaint", instance, return false);
+    return ((VM*) instance)->setMemoryTaint(start, size, label);
+}
+
+TaintLabel qbdi_getMemoryTaint(VMInstanceRef instance, rword start, rword size) {
+    RequireAction("VM_C::getMemoryTaint", instance, return 0);
+    return ((VM*) instance)->getMemoryTaint(start, size);
+}
+
+bool qbdi_setRegisterTaint(VMInstanceRef instance, uint32_t gpr, TaintLabel label) {
+    RequireAction("VM_C::setRegisterTaint", instance, return false);
+    return ((VM*) instance)->setRegisterTaint(gpr, label);
+}
+
+TaintLabel qbdi_getRegisterTaint(VMInstanceRef instance, uint32_t gpr) {
+    RequireAction("VM_C::getRegisterTaint", instance, return 0);
+    return ((VM*) instance)->getRegisterTaint(gpr);
+}
+
 bool qbdi_precacheBasicBlock(VMInstanceRef instance, rword pc) {
     RequireAction("VM_C::precacheBasicBlock", instance, return false);
     return ((VM*) instance)->precacheBasicBlock(pc);
@@ -18,6 +18,7 @@
 #ifndef CONTEXT_H
 #define CONTEXT_H
 
+#include "Callback.h"
 #include "State.h"
 
 // ============================================================================
@@ -30,6 +31,25 @@ struct HostState;
 
 struct Context;
 
+/*! Guest flags restoration requested from the exec block prologue. Set by the sequence selection
+ *  and the break to host code depending on the flags liveness at the point where the execution
+ *  resumes.
+ */
+enum FlagsRestore {
+    FLAGS_RESTORE_NONE  = 0, /*!< The flags are dead, do not restore them */
+    FLAGS_RESTORE_ARITH = 1, /*!< Only restore the arithmetic flags */
+    FLAGS_RESTORE_FULL  = 2, /*!< Restore the complete flags register */
+};
+
+/*! Shadow call stack maintained by the call and return patches. The generated code only updates 
+ *  the 16 bits depth, which wraps around, and stores the frame of depth d in frames[d & 0xffff] 
+ *  without any flags modification.
+ */
+struct ShadowCallStack {
+    uint16_t  depth;
+    CallFrame frames[1 << 16];
+};
+
 }
 
 // ============================================================================
@@ -60,6 +80,14 @@ struct HostState {
     rword callback;
     rword data;
     rword origin;
+    rword restoreFlags;
+    rword edgeLocation;
+    rword traceCursor;
+    rword watchScratch;
+    rword watchReadHit;
+    rword predicateRead;
+    rword predicateWrite;
+    rword taintRegs[NUM_GPR + 16]; /* One label per byte of the GPR, then one label per 8 bytes lane of the vector registers */
 };
 
 /*! X86_64 Execution context.
@@ -106,6 +134,13 @@ struct HostState {
     rword callback;
     rword data;
     rword origin;
+    rword restoreFlags;
+    rword edgeLocation;
+    rword traceCursor;
+    rword watchScratch;
+    rword watchReadHit;
+    rword predicateRead;
+    rword predicateWrite;
 };
 
 /*! ARM Execution context.
@@ -15,6 +15,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
+
 #include "llvm/Support/Format.h"
 #include "Patch/PatchRule.h"
 #include "ExecBlock.h"
@@ -42,12 +44,36 @@
 
 namespace QBDI {
 
+#if defined(QBDI_ARCH_X86_64)
+// EFLAGS TF, DF, AC and ID bits
+static const rword SYSTEM_FLAGS_MASK = 0x240500;
+#endif
+
+/*! Check if a context can be addressed pc relatively from everywhere in a code block.
+ *
+ * @param[in] codeBlock  The code block.
+ * @param[in] context    The context.
+ *
+ * @return True if the context is reachable.
+ */
+static bool isContextReachable(const llvm::sys::MemoryBlock& codeBlock, const Context* context) {
+#if defined(QBDI_ARCH_X86_64)
+    // rip relative displacements are signed 32 bits
+    rword low = std::min((rword) codeBlock.base(), (rword) context);
+    rword high = std::max((rword) codeBlock.base() + codeBlock.size(), (rword) context + sizeof(Context));
+    return high - low < (rword) INT32_MAX;
+#else
+    // pc relative loads and stores only reach the neighbouring page
+    return false;
+#endif
+}
+
 uint32_t ExecBlock::epilogueSize = 0;
 RelocatableInst::SharedPtrVec ExecBlock::execBlockPrologue = RelocatableInst::SharedPtrVec();
 RelocatableInst::SharedPtrVec ExecBlock::execBlockEpilogue = RelocatableInst::SharedPtrVec();
 void (*ExecBlock::runCodeBlockFct)(void*) = NULL;
 
-ExecBlock::ExecBlock(Assembly &assembly, VMInstanceRef vminstance) : vminstance(vminstance), assembly(assembly) {
+ExecBlock::ExecBlock(Assembly &assembly, VMInstanceRef vminstance, Context* sharedContext) : vminstance(vminstance), assembly(assembly) {
     // Allocate memory blocks
     std::error_code ec;
 #ifdef QBDI_OS_IOS
@@ -62,17 +88,26 @@ ExecBlock::ExecBlock(Assembly &assembly, VMInstanceRef vminstance) : vminstance(
              mflags |= PF::MF_EXEC;
 #endif
 
-    // Allocate 2 pages block
-    codeBlock = QBDI::allocateMappedMemory(2*pageSize, nullptr, mflags, ec);
+    // Allocate 2 pages block, near the shared context so it can be reached pc relatively
+    llvm::sys::MemoryBlock contextBlock(sharedContext, sizeof(Context));
+    codeBlock = QBDI::allocateMappedMemory(2*pageSize, sharedContext ? &contextBlock : nullptr, mflags, ec);
     RequireAction("ExecBlock::ExecBlock", codeBlock.base() != nullptr, abort());
     // Split it in two blocks
     dataBlock = llvm::sys::MemoryBlock((void*)((uint64_t) codeBlock.base() + pageSize), pageSize);
     codeBlock = llvm::sys::MemoryBlock(codeBlock.base(), pageSize);
     LogDebug("ExecBlock::ExecBlock", "codeBlock @ 0x%" PRIRWORD " | dataBlock @ 0x%" PRIRWORD, (rword) codeBlock.base(), (rword) dataBlock.base());
 
-    // Other initializations
-    context = (Context*) dataBlock.base();
-    shadows = (rword*) ((rword) dataBlock.base() + sizeof(Context));
+    // Use the shared context if possible, else store a private one at the start of the data block
+    if(sharedContext != nullptr && isContextReachable(codeBlock, sharedContext)) {
+        context = sharedContext;
+        shadowOffset = 0;
+    }
+    else {
+        LogDebug("ExecBlock::ExecBlock", "ExecBlock %p uses a private context", this);
+        context = (Context*) dataBlock.base();
+        shadowOffset = sizeof(Context);
+    }
+    shadows = (rword*) ((rword) dataBlock.base() + shadowOffset);
     shadowIdx = 0;
     currentSeq = 0;
     currentInst = 0;
@@ -162,7 +197,6 @@ void ExecBlock::show() const {
 void ExecBlock::selectSeq(uint16_t seqID) {
     Require("ExecBlock::selectSeq", seqID < seqRegistry.size());
     currentSeq = seqID;
-    context->hostState.selector = (rword) codeBlock.base() + (rword) instRegistry[seqRegistry[seqID].startInstID].offset;
 }
 
 void ExecBlock::run() {
@@ -176,15 +210,24 @@ void ExecBlock::run() {
 }
 
 VMAction ExecBlock::execute() {
+    currentInst = seqRegistry[currentSeq].startInstID;
+    context->hostState.selector = (rword) codeBlock.base() + (rword) instRegistry[currentInst].offset;
+    context->hostState.restoreFlags = instMetadata[currentInst].flagsLiveIn ? 
+                                      FLAGS_RESTORE_ARITH : FLAGS_RESTORE_NONE;
     LogDebug("ExecBlock::execute", "Executing ExecBlock %p programmed with selector at 0x%" PRIRWORD, 
              this, context->hostState.selector);
-    currentInst = seqRegistry[currentSeq].startInstID;
     do {
         context->hostState.callback = (rword) 0;
         context->hostState.data = (rword) 0;
 
         LogDebug("ExecBlock::execute", "Execution of ExecBlock %p resumed at 0x%" PRIRWORD, 
                  this, context->hostState.selector);
+#if defined(QBDI_ARCH_X86_64)
+        // Only a complete restoration can recover the system flags (TF, DF, AC and ID)
+        if(context->gprState.eflags & SYSTEM_FLAGS_MASK) {
+            context->hostState.restoreFlags = FLAGS_RESTORE_FULL;
+        }
+#endif
         run();
 
         if(context->hostState.callback != 0) {
@@ -315,7 +358,7 @@ uint16_t ExecBlock::splitSequence(uint16_t instID) {
     seqRegistry.push_back(SeqInfo {
         instID, 
         seqRegistry[seqID].endInstID, 
-        (SeqType) (SeqType::Entry | seqRegistry[seqID].type)
+        (SeqType) (SeqType::Entry | SeqType::Split | seqRegistry[seqID].type)
     });
     return getNextSeqID() - 1;
 }
@@ -346,7 +389,7 @@ void ExecBlock::makeRW() {
 
 uint16_t ExecBlock::newShadow(uint16_t tag) {
     uint16_t id = shadowIdx++;
-    RequireAction("ExecBlock::newShadow", id * sizeof(rword) < dataBlock.size() - sizeof(Context), abort());
+    RequireAction("ExecBlock::newShadow", id * sizeof(rword) < dataBlock.size() - shadowOffset, abort());
     if(tag != NO_REGISTRATION) {
         LogDebug("ExecBlock::newShadow", "Registering new tagged shadow %" PRIu16 "for instID %" PRIu16 " wih tag %" PRIu16, id, getNextInstID(), tag);
         shadowRegistry.push_back({
@@ -360,17 +403,17 @@ uint16_t ExecBlock::newShadow(uint16_t tag) {
 }
 
 void ExecBlock::setShadow(uint16_t id, rword v) {
-    RequireAction("ExecBlock::setShadow", id * sizeof(rword) < dataBlock.size() - sizeof(Context), abort());
+    RequireAction("ExecBlock::setShadow", id * sizeof(rword) < dataBlock.size() - shadowOffset, abort());
     shadows[id] = v;
 }
 
 rword ExecBlock::getShadow(uint16_t id) const {
-    RequireAction("ExecBlock::getShadow", id * sizeof(rword) < dataBlock.size() - sizeof(Context), abort());
+    RequireAction("ExecBlock::getShadow", id * sizeof(rword) < dataBlock.size() - shadowOffset, abort());
     return shadows[id];
 }
 
 rword ExecBlock::getShadowOffset(uint16_t id) const {
-    rword offset = sizeof(Context) + id*sizeof(rword);
+    rword offset = shadowOffset + id*sizeof(rword);
     RequireAction("ExecBlock::getShadowOffset", offset < dataBlock.size(), abort());
     return offset;
 }
@@ -40,6 +40,7 @@ class Patch;
 enum SeqType {
     Entry = 1,
     Exit  = 1<<1,
+    Split = 1<<2, // Entered in the middle of the code written for a basic block
 };
 
 struct InstInfo {
@@ -69,7 +70,9 @@ struct ShadowInfo {
 static const uint16_t EXEC_BLOCK_FULL = 0xFFFF;
 
 /*! Manages the concept of an exec block made of two contiguous memory blocks (one for the code, 
- *  the other for the data) used to store and execute instrumented basic blocks.
+ *  the other for the data) used to store and execute instrumented basic blocks. The guest context 
+ *  is either shared with the other exec blocks of the VM or, if it cannot be reached with pc 
+ *  relative addressing, private and stored at the start of the data block.
  */
 class ExecBlock {
 private:
@@ -90,6 +93,7 @@ private:
     Assembly&                   assembly;
     Context*                    context;
     rword*                      shadows;
+    rword                       shadowOffset;
     std::vector<ShadowInfo>     shadowRegistry;
     uint16_t                    shadowIdx;
     std::vector<InstMetadata>   instMetadata;
@@ -125,8 +129,10 @@ public:
      *
      * @param[in] assembly    Assembly used to assemble instructions in the ExecBlock.
      * @param[in] vminstance  Pointer to public engine interface
+     * @param[in] sharedContext  Guest context shared by all the exec blocks of the VM. A private 
+     *                           context is used if it is null or out of reach.
      */
-    ExecBlock(Assembly& assembly, VMInstanceRef vminstance = nullptr);
+    ExecBlock(Assembly& assembly, VMInstanceRef vminstance = nullptr, Context* sharedContext = nullptr);
 
     ~ExecBlock();
 
@@ -173,6 +179,15 @@ public:
         return (rword) dataBlock.base() - (rword) codeBlock.base() - codeStream->current_pos();
     }
 
+    /*! Compute the offset between the current code stream position and the start of the context.
+     *  Used for pc relative memory access to the context.
+     *  
+     * @return The computed offset.
+     */
+    rword getContextOffset() const {
+        return (rword) context - (rword) codeBlock.base() - codeStream->current_pos();
+    }
+
     /*! Compute the offset between the current code stream position and the start of the 
      *  exec block epilogue code. Used for computing the remaining code space left or jumping to 
      *  the exec block epilogue at the end of a sequence.
@@ -294,13 +309,14 @@ public:
     uint16_t getSeqEnd(uint16_t seqID) const;
 
     /*! Set the selector of the exec block to a specific sequence offset. Used to program the
-     *  execution of a specific sequence within the exec block.
+     *  execution of a specific sequence within the exec block. The selector is written in the 
+     *  context when the sequence is executed as the context might be shared.
      *
      *  @param seqID [in] Basic block ID within the exec block.
      */
     void selectSeq(uint16_t seqID);
 
-    /*! Get a pointer to the context structure stored in the data block.
+    /*! Get a pointer to the context structure used by the exec block.
      *  
      * @return The context pointer.
      */
@@ -29,8 +29,8 @@
 
 namespace QBDI {
 
-ExecBlockManager::ExecBlockManager(llvm::MCInstrInfo& MCII, llvm::MCRegisterInfo& MRI, Assembly& assembly, VMInstanceRef vminstance) :
-   total_translated_size(1), total_translation_size(1), vminstance(vminstance), MCII(MCII), MRI(MRI), assembly(assembly) {
+ExecBlockManager::ExecBlockManager(llvm::MCInstrInfo& MCII, llvm::MCRegisterInfo& MRI, Assembly& assembly, VMInstanceRef vminstance, Context* sharedContext) :
+   total_translated_size(1), total_translation_size(1), vminstance(vminstance), sharedContext(sharedContext), MCII(MCII), MRI(MRI), assembly(assembly) {
 }
 
 ExecBlockManager::~ExecBlockManager() {
@@ -123,10 +123,7 @@ const BBInfo* ExecBlockManager::getBBInfo(rword address) const {
     return nullptr;
 }
 
-void ExecBlockManager::writeBasicBlock(const std::vector<Patch>& basicBlock) {
-    unsigned translated = 0;
-    unsigned translation = 0;
-    size_t patchIdx = 0, patchEnd = basicBlock.size();
+size_t ExecBlockManager::getWriteLength(const std::vector<Patch>& basicBlock) {
     const Patch& firstPatch = basicBlock.front();
     const Patch& lastPatch = basicBlock.back();
 
@@ -137,10 +134,22 @@ void ExecBlockManager::writeBasicBlock(const std::vector<Patch>& basicBlock) {
     // Basic block truncation to prevent dedoubled sequence
     for(size_t i = 0; i < basicBlock.size(); i++) {
         if(regions[r].sequenceCache.count(basicBlock[i].metadata.address) != 0) {
-            patchEnd = i;
-            break;
+            return i;
         }
     }
+    return basicBlock.size();
+}
+
+void ExecBlockManager::writeBasicBlock(const std::vector<Patch>& basicBlock) {
+    unsigned translated = 0;
+    unsigned translation = 0;
+    size_t patchIdx = 0, patchEnd = getWriteLength(basicBlock);
+    const Patch& firstPatch = basicBlock.front();
+    const Patch& lastPatch = basicBlock.back();
+
+    // The region was selected, and extended if needed, by getWriteLength
+    Range<rword> codeRange(firstPatch.metadata.address, lastPatch.metadata.address + lastPatch.metadata.instSize);
+    size_t r = findRegion(codeRange);
     // Cache integrity safeguard
     if(patchEnd == 0) {
         LogDebug("ExecBlockManager::writeBasicBlock", "Cache hit, basic block 0x%" PRIRWORD " already exist", firstPatch.metadata.address);
@@ -161,7 +170,7 @@ void ExecBlockManager::writeBasicBlock(const std::vector<Patch>& basicBlock) {
             // Optimally, a region should only have one ExecBlocks but misspredictions or oversized 
             // basic blocks can cause overflows.
             if(i >= regions[r].blocks.size()) {
-                regions[r].blocks.push_back(new ExecBlock(assembly, vminstance));
+                regions[r].blocks.push_back(new ExecBlock(assembly, vminstance, sharedContext));
             }
             // Determine sequence type
             SeqType seqType = (SeqType) 0;
@@ -70,6 +70,7 @@ private:
     rword                           total_translation_size;
 
     VMInstanceRef              vminstance;
+    Context*                   sharedContext;
     llvm::MCInstrInfo&         MCII;
     llvm::MCRegisterInfo&      MRI;
     Assembly&                  assembly;
@@ -89,7 +90,7 @@ private:
 
 public:
 
-    ExecBlockManager(llvm::MCInstrInfo& MCII, llvm::MCRegisterInfo& MRI, Assembly& assembly, VMInstanceRef vminstance = nullptr);
+    ExecBlockManager(llvm::MCInstrInfo& MCII, llvm::MCRegisterInfo& MRI, Assembly& assembly, VMInstanceRef vminstance = nullptr, Context* sharedContext = nullptr);
 
     ~ExecBlockManager();
 
@@ -99,6 +100,15 @@ public:
 
     const BBInfo* getBBInfo(rword address) const;
 
+    /*! Get the number of patches of a basic block written by writeBasicBlock. The basic block is 
+     *  truncated at the first instruction which already starts a cached sequence.
+     *
+     * @param[in] basicBlock  The patches of the basic block.
+     *
+     * @return The number of patches written, 0 if the basic block is already cached.
+     */
+    size_t getWriteLength(const std::vector<Patch>& basicBlock);
+
     void writeBasicBlock(const std::vector<Patch>& basicBlock);
 
     const InstAnalysis* analyzeInstMetadata(const InstMetadata* instMetadata, AnalysisType type);
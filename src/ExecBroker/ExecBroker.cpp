@@ -19,88 +19,138 @@
 
 namespace QBDI {
 
-ExecBroker::ExecBroker(Assembly& assembly, VMInstanceRef vminstance) :
-    transferBlock(assembly, vminstance) {
+ExecBroker::ExecBroker(Assembly& assembly, VMInstanceRef vminstance, Context* sharedContext) :
+    transferBlock(assembly, vminstance, sharedContext) {
     pageSize = llvm::sys::Process::getPageSize();
+    for(pageShift = 0; ((rword) 1 << pageShift) < pageSize; pageShift++);
+    flushPageLookup();
+}
+
+rword ExecBroker::lookupPage(rword page) const {
+    Range<rword> pageRange(page << pageShift, (page + 1) << pageShift);
+    rword state = PAGE_MIXED;
+    // The last page of the address space wraps around and stays mixed
+    if(pageRange.size() > 0) {
+        if(instrumented.contains(pageRange)) {
+            state = PAGE_INSIDE;
+        }
+        else if(instrumented.overlaps(pageRange) == false) {
+            state = PAGE_OUTSIDE;
+        }
+    }
+    pageLookup[page % PAGE_LOOKUP_SIZE] = (page << 2) | state;
+    return (page << 2) | state;
+}
+
+void ExecBroker::flushPageLookup() {
+    std::fill(pageLookup, pageLookup + PAGE_LOOKUP_SIZE, 0);
 }
 
 void ExecBroker::addInstrumentedRange(const Range<rword>& r) {
     LogDebug("ExecBroker::addInstrumentedRange", "Adding instrumented range [%" PRIRWORD ", %" PRIRWORD "]", 
              r.start, r.end);
     instrumented.add(r);
+    flushPageLookup();
+}
+
+void ExecBroker::addInstrumentedRanges(const RangeSet<rword>& r) {
+    LogDebug("ExecBroker::addInstrumentedRanges", "Adding %zu instrumented ranges", r.getRanges().size());
+    instrumented.add(r);
+    flushPageLookup();
 }
 
 void ExecBroker::removeInstrumentedRange(const Range<rword>& r) {
     LogDebug("ExecBroker::removeInstrumentedRange", "Removing instrumented range [%" PRIRWORD ", %" PRIRWORD "]", 
              r.start, r.end);
     instrumented.remove(r);
+    flushPageLookup();
+}
+
+void ExecBroker::removeInstrumentedRanges(const RangeSet<rword>& r) {
+    LogDebug("ExecBroker::removeInstrumentedRanges", "Removing %zu instrumented ranges", r.getRanges().size());
+    instrumented.remove(r);
+    flushPageLookup();
 }
 
 void ExecBroker::removeAllInstrumentedRanges() {
     instrumented.clear();
+    flushPageLookup();
 }
 
-bool ExecBroker::addInstrumentedModule(const std::string& name) {
-    bool instrumented = false;
+// The modules are looked up in the registry, the memory maps are only read for the names it does 
+// not know, like the names of the files behind a symbolic link.
+static RangeSet<rword> getModuleRanges(const std::string& name, const ModuleRegistry& modules) {
+    RangeSet<rword> ranges;
+
+    for(const LoadedModule& m : modules.getModules()) {
+        if(m.name == name) {
+            ranges.add(m.executable);
+        }
+    }
+    if(ranges.getRanges().size() == 0) {
+        for(const MemoryMap& m : getCurrentProcessMaps()) {
+            if((m.name == name) && (m.permission & QBDI::PF_EXEC)) {
+                ranges.add(m.range);
+            }
+        }
+    }
+    return ranges;
+}
+
+bool ExecBroker::addInstrumentedModule(const std::string& name, const ModuleRegistry& modules) {
     if (name.empty()) {
         return false;
     }
 
-    for(const MemoryMap& m : getCurrentProcessMaps()) {
-        if((m.name == name) && (m.permission & QBDI::PF_EXEC)) {
-            addInstrumentedRange(m.range);
-            instrumented = true;
-        }
-    }
-    return instrumented;
+    RangeSet<rword> ranges = getModuleRanges(name, modules);
+    addInstrumentedRanges(ranges);
+    return ranges.getRanges().size() > 0;
 }
 
-bool ExecBroker::addInstrumentedModuleFromAddr(rword addr) {
-    bool instrumented = false;
+bool ExecBroker::addInstrumentedModuleFromAddr(rword addr, const ModuleRegistry& modules) {
+    const LoadedModule* module = modules.findModuleByAddr(addr);
 
+    if(module != nullptr) {
+        return addInstrumentedModule(module->name, modules);
+    }
     for(const MemoryMap& m : getCurrentProcessMaps()) {
         if(m.range.contains(addr)) {
-            instrumented = addInstrumentedModule(m.name);
-            break;
+            return addInstrumentedModule(m.name, modules);
         }
     }
-    return instrumented;
+    return false;
 }
 
-bool ExecBroker::removeInstrumentedModule(const std::string& name) {
-    bool removed = false;
-
-    for(const MemoryMap& m : getCurrentProcessMaps()) {
-        if((m.name == name) && (m.permission & QBDI::PF_EXEC)) {
-            removeInstrumentedRange(m.range);
-            removed = true;
-        }
-    }
-    return removed;
+bool ExecBroker::removeInstrumentedModule(const std::string& name, const ModuleRegistry& modules) {
+    RangeSet<rword> ranges = getModuleRanges(name, modules);
+    removeInstrumentedRanges(ranges);
+    return ranges.getRanges().size() > 0;
 }
 
-bool ExecBroker::removeInstrumentedModuleFromAddr(rword addr) {
-    bool removed = false;
+bool ExecBroker::removeInstrumentedModuleFromAddr(rword addr, const ModuleRegistry& modules) {
+    const LoadedModule* module = modules.findModuleByAddr(addr);
 
+    if(module != nullptr) {
+        return removeInstrumentedModule(module->name, modules);
+    }
     for(const MemoryMap& m : getCurrentProcessMaps()) {
         if(m.range.contains(addr)) {
-            removed = removeInstrumentedModule(m.name);
-            break;
+            return removeInstrumentedModule(m.name, modules);
         }
     }
-    return removed;
+    return false;
 }
 
 bool ExecBroker::instrumentAllExecutableMaps() {
-    bool instrumented = false;
+    RangeSet<rword> ranges;
 
     for(const MemoryMap& m : getCurrentProcessMaps()) {
         if(m.permission & QBDI::PF_EXEC) {
-            addInstrumentedRange(m.range);
-            instrumented = true;
+            ranges.add(m.range);
         }
     }
-    return instrumented;
+    addInstrumentedRanges(ranges);
+    return ranges.getRanges().size() > 0;
 }
 
 bool ExecBroker::canTransferExecution(GPRState *gprState) const {
@@ -123,24 +173,34 @@ bool ExecBroker::transferExecution(rword addr, GPRState *gprState, FPRState *fpr
     LogDebug("ExecBroker::transferExecution", "Patched %p hooking return address 0x%" PRIRWORD " with 0x%" PRIRWORD, 
              ptr, hookedAddress, *ptr);
 
-    // Write transfer state
-    transferBlock.getContext()->gprState = *gprState;
-    transferBlock.getContext()->fprState = *fprState;
-    transferBlock.getContext()->hostState.selector = addr;
+    // Write transfer state, the state is only copied if the transfer block doesn't already use it
+    Context* context = transferBlock.getContext();
+    if(&context->gprState != gprState) {
+        context->gprState = *gprState;
+    }
+    if(&context->fprState != fprState) {
+        context->fprState = *fprState;
+    }
+    context->hostState.selector = addr;
+    context->hostState.restoreFlags = FLAGS_RESTORE_FULL;
     // Execute transfer
     LogDebug("ExecBroker::transferExecution", "Transfering execution to 0x%" PRIRWORD " using transferBlock %p", addr, &transferBlock);
     transferBlock.run();
     // Restore original return
-    QBDI_GPR_SET(&transferBlock.getContext()->gprState, REG_PC, hookedAddress);
+    QBDI_GPR_SET(&context->gprState, REG_PC, hookedAddress);
     #if defined(QBDI_ARCH_ARM)
     // Under ARM, also reset the LR register
-    if(QBDI_GPR_GET(&transferBlock.getContext()->gprState, REG_LR) == hook) {
-        QBDI_GPR_SET(&transferBlock.getContext()->gprState, REG_LR, hookedAddress);
+    if(QBDI_GPR_GET(&context->gprState, REG_LR) == hook) {
+        QBDI_GPR_SET(&context->gprState, REG_LR, hookedAddress);
     }
     #endif
     // Read transfer result
-    *gprState = transferBlock.getContext()->gprState;
-    *fprState = transferBlock.getContext()->fprState;
+    if(&context->gprState != gprState) {
+        *gprState = context->gprState;
+    }
+    if(&context->fprState != fprState) {
+        *fprState = context->fprState;
+    }
 
     return true;
 }
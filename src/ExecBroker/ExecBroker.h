@@ -28,9 +28,12 @@
 #include "ExecBlock/ExecBlock.h"
 #include "Utility/Assembly.h"
 #include "Utility/LogSys.h"
+#include "Utility/ModuleRegistry.h"
 
 namespace QBDI {
 
+static const size_t PAGE_LOOKUP_SIZE = 512;
+
 class ExecBroker {
 
 private:
@@ -38,25 +41,73 @@ private:
     RangeSet<rword>        instrumented;
     ExecBlock              transferBlock;
     rword                  pageSize;
+    rword                  pageShift;
+    // Direct mapped cache of the page states, an entry is the page number shifted by two bits 
+    // with one of the PAGE_* states below, or zero.
+    mutable rword          pageLookup[PAGE_LOOKUP_SIZE];
+
+    static const rword PAGE_OUTSIDE = 1;
+    static const rword PAGE_INSIDE  = 2;
+    static const rword PAGE_MIXED   = 3;
 
     using PF = llvm::sys::Memory::ProtectionFlags;
 
     // ARCH dependant method
     rword *getReturnPoint(GPRState* gprState) const;
 
-public:
+    /*! Compute whether a page is entirely, partially or not instrumented and cache it.
+     *
+     * @param[in] page  The page number.
+     *
+     * @return The page lookup entry.
+     */
+    rword lookupPage(rword page) const;
 
-    ExecBroker(Assembly& assembly, VMInstanceRef vminstance = nullptr);
+    void flushPageLookup();
+
+public:
 
-    bool isInstrumented(rword addr) const { return instrumented.contains(addr);}
+    ExecBroker(Assembly& assembly, VMInstanceRef vminstance = nullptr, Context* sharedContext = nullptr);
+
+    /*! Determine whether an address is instrumented. The pages entirely inside or outside of the 
+     *  instrumented ranges are answered from the page lookup cache, the other ones by a binary 
+     *  search in the ranges.
+     *
+     * @param[in] addr  The address.
+     *
+     * @return True if the address is in the instrumented ranges.
+     */
+    bool isInstrumented(rword addr) const {
+        rword page = addr >> pageShift;
+        rword entry = pageLookup[page % PAGE_LOOKUP_SIZE];
+        if((entry >> 2) != page || entry == 0) {
+            entry = lookupPage(page);
+        }
+        if((entry & 3) == PAGE_MIXED) {
+            return instrumented.contains(addr);
+        }
+        return (entry & 3) == PAGE_INSIDE;
+    }
+
+    /*! Determine whether a range overlaps the instrumented ranges.
+     *
+     * @param[in] r  The range.
+     *
+     * @return True if part of the range is instrumented.
+     */
+    bool isInstrumented(const Range<rword>& r) const {
+        return instrumented.overlaps(r);
+    }
 
     void addInstrumentedRange(const Range<rword>& r);
-    bool addInstrumentedModule(const std::string& name);
-    bool addInstrumentedModuleFromAddr(rword addr);
+    void addInstrumentedRanges(const RangeSet<rword>& r);
+    bool addInstrumentedModule(const std::string& name, const ModuleRegistry& modules);
+    bool addInstrumentedModuleFromAddr(rword addr, const ModuleRegistry& modules);
     
     void removeInstrumentedRange(const Range<rword>& r);
-    bool removeInstrumentedModule(const std::string& name);
-    bool removeInstrumentedModuleFromAddr(rword addr);
+    void removeInstrumentedRanges(const RangeSet<rword>& r);
+    bool removeInstrumentedModule(const std::string& name, const ModuleRegistry& modules);
+    bool removeInstrumentedModuleFromAddr(rword addr, const ModuleRegistry& modules);
     void removeAllInstrumentedRanges();
 
     bool instrumentAllExecutableMaps();
@@ -45,4 +45,34 @@ bool isStackWrite(const llvm::MCInst* inst) {
     return false;
 }
 
+bool isStringAccess(const llvm::MCInst* inst) {
+    LogWarning("isStringAccess", "This architecture does not support memory access information");
+    return false;
+}
+
+// Flags liveness is not analyzed on this architecture: flags are always considered live.
+
+bool readFlags(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII) {
+    return true;
+}
+
+bool overwriteFlags(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII) {
+    return false;
+}
+
+// Register liveness is not analyzed on this architecture (instructions can be conditionally
+// executed): all the registers are always considered live.
+
+uint32_t getReadRegs(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII, const llvm::MCRegisterInfo* MRI) {
+    return (1U << AVAILABLE_GPR) - 1;
+}
+
+uint32_t getOverwrittenRegs(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII, const llvm::MCRegisterInfo* MRI) {
+    return 0;
+}
+
+bool getTaintFlow(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII, const llvm::MCRegisterInfo* MRI, TaintFlow& flow) {
+    return false;
+}
+
 };
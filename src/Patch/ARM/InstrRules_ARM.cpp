@@ -21,14 +21,16 @@ namespace QBDI {
 
 /* Genreate a series of RelocatableInst which when appended to an instrumentation code trigger a 
  * break to host. It receive in argument a temporary reg which will be used for computations then 
- * finally restored.
+ * finally restored. The ARM prologue always restores the flags, restoreFlags is thus ignored. The 
+ * resumeOffset argument is a number of bytes following the sequence which are skipped when the 
+ * execution resumes.
 */
-RelocatableInst::SharedPtrVec getBreakToHost(Reg temp) {
+RelocatableInst::SharedPtrVec getBreakToHost(Reg temp, bool restoreFlags, rword resumeOffset) {
     RelocatableInst::SharedPtrVec breakToHost;
 
     // Use the temporary register to compute PC + 16 which is the address which will follow this 
     // patch and where the execution needs to be resumed
-    breakToHost.push_back(HostPCRel(ldri12(temp, Reg(REG_PC), 0), 2, 16));
+    breakToHost.push_back(HostPCRel(ldri12(temp, Reg(REG_PC), 0), 2, 16 + resumeOffset));
     // Set the selector to this address so the execution can be resumed when the exec block will be 
     // reexecuted
     append(breakToHost, SaveReg(temp, Offset(offsetof(Context, hostState.selector))));
@@ -40,4 +42,19 @@ RelocatableInst::SharedPtrVec getBreakToHost(Reg temp) {
     return breakToHost;
 }
 
+/* Conditional breaks to host are not implemented on ARM: the break is always taken and the cond
+ * register is ignored.
+*/
+RelocatableInst::SharedPtrVec getConditionalBreakToHost(Reg cond, const Reg::Vec& usedRegisters,
+                                                        bool restoreFlags) {
+    RelocatableInst::SharedPtrVec breakToHost;
+
+    for(uint32_t i = 1; i < usedRegisters.size(); i++) {
+        append(breakToHost, LoadReg(usedRegisters[i], Offset(usedRegisters[i])));
+    }
+    append(breakToHost, getBreakToHost(usedRegisters[0], restoreFlags));
+
+    return breakToHost;
+}
+
 }
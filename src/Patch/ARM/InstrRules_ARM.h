@@ -30,7 +30,10 @@
 
 namespace QBDI {
 
-RelocatableInst::SharedPtrVec getBreakToHost(Reg temp);
+RelocatableInst::SharedPtrVec getBreakToHost(Reg temp, bool restoreFlags = true, rword resumeOffset = 0);
+
+RelocatableInst::SharedPtrVec getConditionalBreakToHost(Reg cond, const Reg::Vec& usedRegisters,
+                                                        bool restoreFlags = true);
 
 }
 
@@ -16,6 +16,10 @@
  * limitations under the License.
  */
 #include <stdint.h>
+#include <vector>
+
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
 #include "Patch/Types.h"
 
 #ifndef INSTINFO_H
@@ -23,11 +27,36 @@
 
 namespace QBDI {
 
+/*! Register operand of the data flow of an instruction.
+ */
+struct TaintOperand {
+    unsigned int slot;   /*!< GPR index, or NUM_GPR + n for the vector register n */
+    unsigned int size;   /*!< Size in bytes of the register (16, 32 or 64 for a vector register) */
+    unsigned int offset; /*!< Position in bytes of the register in its GPR (1 for AH, BH, CH, DH) */
+};
+
+/*! Data flow of an instruction, as used by the taint propagation. The memory accesses are given by
+ *  the access tables and the flags are not tracked.
+ */
+struct TaintFlow {
+    std::vector<TaintOperand> sources;
+    std::vector<TaintOperand> destinations;
+    bool bytewise; /*!< Every byte of the result only depends on the source bytes at the same position */
+    bool clear;    /*!< The result does not depend on the sources (zeroing idioms) */
+    bool zeroUpper; /*!< The vector destinations are VEX or EVEX encoded and their upper part is zeroed */
+};
+
 void initMemAccessInfo();
 unsigned getReadSize(const llvm::MCInst* inst);
 unsigned getWriteSize(const llvm::MCInst* inst);
 bool isStackRead(const llvm::MCInst* inst);
 bool isStackWrite(const llvm::MCInst* inst);
+bool isStringAccess(const llvm::MCInst* inst);
+bool readFlags(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII);
+bool overwriteFlags(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII);
+uint32_t getReadRegs(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII, const llvm::MCRegisterInfo* MRI);
+uint32_t getOverwrittenRegs(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII, const llvm::MCRegisterInfo* MRI);
+bool getTaintFlow(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII, const llvm::MCRegisterInfo* MRI, TaintFlow& flow);
 
 };
 
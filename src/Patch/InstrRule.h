@@ -46,6 +46,8 @@ class InstrRule : public AutoAlloc<InstrRule, InstrRule> {
     PatchGenerator::SharedPtrVec  patchGen;
     InstPosition                  position;
     bool                          breakToHost;
+    PatchGenerator::SharedPtrVec  filter;
+    std::vector<Predicate>        predicate;
 
 public:
 
@@ -63,10 +65,17 @@ public:
      *                         before the instruction or after it.
      * @param[in] breakToHost  A boolean determining whether this instrumentation should end with
      *                         a break to host (in the case of a callback for example).
+     * @param[in] filter       An optional vector of PatchGenerator evaluated at runtime before a
+     *                         break to host. They leave a value in Temp(0) and the break is only
+     *                         taken if this value is not zero.
+     * @param[in] predicate    An optional inline predicate evaluated before the filter, which 
+     *                         receives its value in Temp(0). Only supported on X86_64.
     */
     InstrRule(PatchCondition::SharedPtr condition, PatchGenerator::SharedPtrVec patchGen,
-              InstPosition position, bool breakToHost) : condition(condition),
-              patchGen(patchGen), position(position), breakToHost(breakToHost) {}
+              InstPosition position, bool breakToHost, PatchGenerator::SharedPtrVec filter = {},
+              std::vector<Predicate> predicate = {}) :
+              condition(condition), patchGen(patchGen), position(position), 
+              breakToHost(breakToHost), filter(filter), predicate(predicate) {}
 
     InstPosition getPosition() { return position; }
 
@@ -74,6 +83,10 @@ public:
         return condition->affectedRange();
     }
 
+    bool affectedOpcodes(llvm::MCInstrInfo* MCII, std::set<unsigned int>& opcodes) const {
+        return condition->affectedOpcodes(MCII, opcodes);
+    }
+
     /*! Determine wheter this rule applies by evaluating this rule condition on the current
      *  context.
      *
@@ -86,106 +99,229 @@ public:
         return condition->test(&patch.metadata.inst, patch.metadata.address, patch.metadata.instSize, MCII);
     }
 
-    /*! Instrument a patch by evaluating its generators on the current context. Also handles the
-     *  temporary register management for this patch.
+    bool doesBreakToHost() const { return breakToHost; }
+
+    bool hasFilter() const { return filter.size() > 0 || predicate.size() > 0; }
+
+    /*! Append a generator to the runtime filter of this rule. It receives in Temp(0) the value of
+     *  the previous filters, if any.
      *
-     * @param[in] patch  The current patch to instrument.
-     * @param[in] MCII   A LLVM::MCInstrInfo classes used for internal architecture specific
-     *                   queries.
-     * @param[in] MRI    A LLVM::MCRegisterInfo classes used for internal architecture specific
-     *                   queries.
+     * @param[in] generator  The filter generator to append.
     */
-    void instrument(Patch &patch, llvm::MCInstrInfo* MCII, llvm::MCRegisterInfo* MRI) {
-        /* The instrument function needs to handle several different cases. An instrumentation can 
+    void appendFilter(PatchGenerator::SharedPtr generator) {
+        filter.push_back(generator);
+    }
+
+    /*! Generate the instrumentation code of this rule. The temporary registers are allocated
+     *  using the tempManager but are neither saved nor restored, except for the rules breaking to
+     *  the host which handle the complete sequence. 
+     *
+     * @param[in] patch        The current patch to instrument.
+     * @param[in] tempManager  The temporary register manager of the instrumentation.
+     * @param[in] savedRegs    Mask of the GPR indexes whose context storage already holds their 
+     *                         value. Only used by the rules breaking to the host.
+     *
+     * @return The instrumentation code.
+    */
+    RelocatableInst::SharedPtrVec generate(const Patch &patch, TempManager *tempManager, uint32_t savedRegs) {
+        /* The generate function needs to handle several different cases. An instrumentation can 
          * be either prepended or appended to the patch and, in each case, can trigger a break to 
          * host.
         */
         RelocatableInst::SharedPtrVec instru;
-        TempManager tempManager(&patch.metadata.inst, MCII, MRI);
 
         // Generate the instrumentation code from the original instruction context
         for(PatchGenerator::SharedPtr& g : patchGen) {
             append(instru,
-                g->generate(&patch.metadata.inst, patch.metadata.address, patch.metadata.instSize, &tempManager, nullptr)
+                g->generate(&patch.metadata.inst, patch.metadata.address, patch.metadata.instSize, tempManager, nullptr)
             );
         }
 
+        if(breakToHost == false) {
+            return instru;
+        }
+
         // In case we break to the host, we need to ensure the value of PC in the context is 
         // correct. This value needs to be set when instrumenting before the instruction or when 
         // instrumenting after an instruction which does not set PC.
-        if(breakToHost) {
-            if(position == InstPosition::PREINST || patch.metadata.modifyPC == false) {
-                switch(position) {
-                    // In PREINST PC is set to the current address
-                    case InstPosition::PREINST:
-                        append(instru,
-                               GetConstant(
-                                    Temp(0),
-                                    Constant(patch.metadata.address)
-                               ).generate(
-                                    &patch.metadata.inst,
-                                    patch.metadata.address,
-                                    patch.metadata.instSize,
-                                    &tempManager,
-                                    nullptr
-                               )
-                        );
-                        break;
-                    // In POSTINST PC is set to the next instruction address
-                    case InstPosition::POSTINST:
-                        append(instru,
-                               GetConstant(
-                                    Temp(0),
-                                    Constant(patch.metadata.address + patch.metadata.instSize)
-                               ).generate(
-                                    &patch.metadata.inst,
-                                    patch.metadata.address,
-                                    patch.metadata.instSize,
-                                    &tempManager,
-                                    nullptr
-                               )
-                        );
-                        break;
-                }
-                append(instru, SaveReg(tempManager.getRegForTemp(0), Offset(Reg(REG_PC))));
+        if(position == InstPosition::PREINST || patch.metadata.modifyPC == false) {
+            switch(position) {
+                // In PREINST PC is set to the current address
+                case InstPosition::PREINST:
+                    append(instru,
+                           GetConstant(
+                                Temp(0),
+                                Constant(patch.metadata.address)
+                           ).generate(
+                                &patch.metadata.inst,
+                                patch.metadata.address,
+                                patch.metadata.instSize,
+                                tempManager,
+                                nullptr
+                           )
+                    );
+                    break;
+                // In POSTINST PC is set to the next instruction address
+                case InstPosition::POSTINST:
+                    append(instru,
+                           GetConstant(
+                                Temp(0),
+                                Constant(patch.metadata.address + patch.metadata.instSize)
+                           ).generate(
+                                &patch.metadata.inst,
+                                patch.metadata.address,
+                                patch.metadata.instSize,
+                                tempManager,
+                                nullptr
+                           )
+                    );
+                    break;
             }
+            append(instru, SaveReg(tempManager->getRegForTemp(0), Offset(Reg(REG_PC))));
+        }
+
+        // The flags liveness at the instrumentation point tells if the flags need to be preserved
+        // by the filter and restored when the execution resumes.
+        bool flagsLive = (position == PREINST) ? patch.metadata.flagsLiveIn : patch.metadata.flagsLiveOut;
+
+        // The filter computes in Temp(0) whether the break to host is needed
+#if defined(QBDI_ARCH_X86_64)
+        if(predicate.size() > 0) {
+            append(instru,
+                   EvaluatePredicate(Temp(0), Temp(1), Temp(2), Temp(3), predicate, flagsLive).generate(
+                        &patch.metadata.inst,
+                        patch.metadata.address,
+                        patch.metadata.instSize,
+                        tempManager,
+                        nullptr
+                   )
+            );
+        }
+#endif
+        for(PatchGenerator::SharedPtr& g : filter) {
+            append(instru,
+                g->generate(&patch.metadata.inst, patch.metadata.address, patch.metadata.instSize, tempManager, nullptr)
+            );
         }
 
         // The breakToHost code requires one temporary register. If none were allocated by the
         // instrumentation we thus need to add one.
-        if(breakToHost && tempManager.getUsedRegisterNumber() == 0) {
-            tempManager.getRegForTemp(Temp(0));
+        if(tempManager->getUsedRegisterNumber() == 0) {
+            tempManager->getRegForTemp(Temp(0));
         }
-        // Prepend the temporary register saving code to the instrumentation
-        Reg::Vec usedRegisters = tempManager.getUsedRegisters();
+        // Prepend the temporary register saving code to the instrumentation, unless the context
+        // already holds their value.
+        Reg::Vec usedRegisters = tempManager->getUsedRegisters();
         for(uint32_t i = 0; i < usedRegisters.size(); i++) {
-            prepend(instru, SaveReg(usedRegisters[i], Offset(usedRegisters[i])));
+            if((savedRegs & (1U << usedRegisters[i].id)) == 0) {
+                prepend(instru, SaveReg(usedRegisters[i], Offset(usedRegisters[i])));
+            }
         }
 
-        // In the break to host case the first used register is not restored and instead given to
-        // the break to host code as a scratch. It will later be restored by the break to host code.
-        if(breakToHost) {
-            for(uint32_t i = 1; i < usedRegisters.size(); i++) {
-                append(instru, LoadReg(usedRegisters[i], Offset(usedRegisters[i])));
-            }
-            append(instru, getBreakToHost(usedRegisters[0]));
+        // The first used register is not restored and instead given to the break to host code as
+        // a scratch. It will later be restored by the break to host code.
+        if(hasFilter()) {
+            append(instru, getConditionalBreakToHost(tempManager->getRegForTemp(0), usedRegisters, flagsLive));
+            return instru;
         }
-        // Normal case where we append the temporary register restoration code to the instrumentation
-        else {
-            for(uint32_t i = 0; i < usedRegisters.size(); i++) {
-                append(instru, LoadReg(usedRegisters[i], Offset(usedRegisters[i])));
+        for(uint32_t i = 1; i < usedRegisters.size(); i++) {
+            append(instru, LoadReg(usedRegisters[i], Offset(usedRegisters[i])));
+        }
+        append(instru, getBreakToHost(usedRegisters[0], flagsLive));
+
+        return instru;
+    }
+
+    /*! Instrument a patch by evaluating its generators on the current context. Also handles the
+     *  temporary register management for this patch.
+     *
+     * @param[in] patch  The current patch to instrument.
+     * @param[in] MCII   A LLVM::MCInstrInfo classes used for internal architecture specific
+     *                   queries.
+     * @param[in] MRI    A LLVM::MCRegisterInfo classes used for internal architecture specific
+     *                   queries.
+    */
+    void instrument(Patch &patch, llvm::MCInstrInfo* MCII, llvm::MCRegisterInfo* MRI) {
+        instrument(patch, {this}, 0, 0, MCII, MRI);
+    }
+
+    /*! Instrument a patch with a list of rules sharing the same position. Consecutive rules which
+     *  do not break to the host share their temporary registers, and thus a single saving and 
+     *  restoration sequence. Dead registers are used as temporaries without being saved.
+     *
+     * @param[in] patch      The current patch to instrument.
+     * @param[in] rules      The rules to apply, in the order their code is laid out. They all 
+     *                       need to have the same position.
+     * @param[in] freeRegs   Mask of the GPR indexes which are dead at the instrumentation point.
+     * @param[in] savedRegs  Mask of the GPR indexes whose context storage already holds their 
+     *                       value when the instrumentation starts.
+     * @param[in] MCII       A LLVM::MCInstrInfo classes used for internal architecture specific
+     *                       queries.
+     * @param[in] MRI        A LLVM::MCRegisterInfo classes used for internal architecture 
+     *                       specific queries.
+     *
+     * @return Mask of the GPR indexes whose context storage holds their value when the 
+     *         instrumentation ends.
+    */
+    static uint32_t instrument(Patch &patch, const std::vector<InstrRule*> &rules, uint32_t freeRegs,
+                               uint32_t savedRegs, llvm::MCInstrInfo* MCII, llvm::MCRegisterInfo* MRI) {
+        RelocatableInst::SharedPtrVec instru;
+        size_t i = 0;
+
+        if(rules.size() == 0) {
+            return savedRegs;
+        }
+        while(i < rules.size()) {
+            // A break to host saves the complete context and resumes from it. A filtered one only 
+            // saves its temporary registers when the break is not taken.
+            if(rules[i]->breakToHost) {
+                TempManager tempManager(&patch.metadata.inst, MCII, MRI);
+                append(instru, rules[i]->generate(patch, &tempManager, savedRegs));
+                if(rules[i]->hasFilter()) {
+                    for(Reg r : tempManager.getUsedRegisters()) {
+                        savedRegs |= (1U << r.id);
+                    }
+                }
+                else {
+                    savedRegs = (1U << AVAILABLE_GPR) - 1;
+                }
+                i++;
+                continue;
+            }
+            // Group the following rules which do not break to host
+            TempManager tempManager(&patch.metadata.inst, MCII, MRI, freeRegs);
+            RelocatableInst::SharedPtrVec group;
+            for(; i < rules.size() && rules[i]->breakToHost == false; i++) {
+                append(group, rules[i]->generate(patch, &tempManager, savedRegs));
+            }
+            Reg::Vec spilledRegisters = tempManager.getSpilledRegisters();
+            for(Reg r : spilledRegisters) {
+                if((savedRegs & (1U << r.id)) == 0) {
+                    append(instru, SaveReg(r, Offset(r)));
+                }
+            }
+            append(instru, group);
+            for(Reg r : spilledRegisters) {
+                append(instru, LoadReg(r, Offset(r)));
+                savedRegs |= (1U << r.id);
+            }
+            // Dead registers used as temporaries no longer hold their context value
+            for(Reg r : tempManager.getUsedRegisters()) {
+                if(freeRegs & (1U << r.id)) {
+                    savedRegs &= ~(1U << r.id);
+                }
             }
         }
 
         // The resulting instrumentation is either appended or prepended as per the InstPosition
-        if(position == PREINST) {
+        if(rules[0]->position == PREINST) {
             patch.prepend(instru);
         }
-        else if(position == POSTINST) {
+        else if(rules[0]->position == POSTINST) {
             patch.append(instru);
         }
+        return savedRegs;
     }
-
 };
 
 }
@@ -35,10 +35,14 @@ public:
     
     Patch() {
         metadata.patchSize = 0;
+        metadata.flagsLiveIn = true;
+        metadata.flagsLiveOut = true;
     }
 
     Patch(llvm::MCInst inst, rword address, rword instSize) {
         metadata.patchSize = 0;
+        metadata.flagsLiveIn = true;
+        metadata.flagsLiveOut = true;
         setInst(inst, address, instSize);
     }
 
@@ -50,6 +54,11 @@ public:
         metadata.modifyPC = modifyPC;
     }
 
+    void setFlagsLiveness(bool liveIn, bool liveOut) {
+        metadata.flagsLiveIn = liveIn;
+        metadata.flagsLiveOut = liveOut;
+    }
+
     void setInst(llvm::MCInst inst, rword address, rword instSize) {
         metadata.inst = inst;
         metadata.address = address;
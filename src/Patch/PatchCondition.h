@@ -19,10 +19,12 @@
 #define PATCHCONDITION_H
 
 #include <memory>
+#include <set>
 #include <vector>
 #include <string>
 
 #include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstrInfo.h"
 
 #include "Range.h"
 #include "Patch/Types.h"
@@ -52,6 +54,18 @@ public:
         return r;
     }
 
+    /*! Collect the opcodes for which this condition can be true. Used to index the rules by 
+     *  opcode instead of testing every rule on every instruction.
+     *
+     * @param[in]  MCII     An LLVM MC instruction info context.
+     * @param[out] opcodes  The opcodes, only filled if the condition restricts them.
+     *
+     * @return False if the condition can be true for any opcode.
+     */
+    virtual bool affectedOpcodes(llvm::MCInstrInfo* MCII, std::set<unsigned int>& opcodes) {
+        return false;
+    }
+
     virtual ~PatchCondition() {};
 };
 
@@ -69,6 +83,15 @@ public:
     bool test(const llvm::MCInst* inst, rword address, rword instSize, llvm::MCInstrInfo* MCII) {
         return QBDI::String::startsWith(mnemonic.c_str(), MCII->getName(inst->getOpcode()).data());
     }
+
+    bool affectedOpcodes(llvm::MCInstrInfo* MCII, std::set<unsigned int>& opcodes) {
+        for(unsigned int op = 0; op < MCII->getNumOpcodes(); op++) {
+            if(QBDI::String::startsWith(mnemonic.c_str(), MCII->getName(op).data())) {
+                opcodes.insert(op);
+            }
+        }
+        return true;
+    }
 };
 
 class OpIs : public PatchCondition, public AutoAlloc<PatchCondition, OpIs> {
@@ -85,6 +108,11 @@ public:
     bool test(const llvm::MCInst* inst, rword address, rword instSize, llvm::MCInstrInfo* MCII) { // refactor all test() add MCII
         return inst->getOpcode() == op;
     }
+
+    bool affectedOpcodes(llvm::MCInstrInfo* MCII, std::set<unsigned int>& opcodes) {
+        opcodes.insert(op);
+        return true;
+    }
 };
 
 class RegIs : public PatchCondition, public AutoAlloc<PatchCondition, RegIs> {
@@ -214,6 +242,28 @@ public:
         }
         return r;
     }
+
+    bool affectedOpcodes(llvm::MCInstrInfo* MCII, std::set<unsigned int>& opcodes) {
+        std::set<unsigned int> r;
+        bool restricted = false;
+        for(unsigned int i = 0; i < conditions.size(); i++) {
+            std::set<unsigned int> c;
+            if(conditions[i]->affectedOpcodes(MCII, c) == false) {
+                continue;
+            }
+            if(restricted == false) {
+                r.swap(c);
+                restricted = true;
+            }
+            else {
+                for(auto it = r.begin(); it != r.end(); ) {
+                    it = c.count(*it) ? std::next(it) : r.erase(it);
+                }
+            }
+        }
+        opcodes.insert(r.begin(), r.end());
+        return restricted;
+    }
 };
 
 class Or : public PatchCondition, public AutoAlloc<PatchCondition, Or> {
@@ -243,6 +293,17 @@ public:
         }
         return r;
     }
+
+    bool affectedOpcodes(llvm::MCInstrInfo* MCII, std::set<unsigned int>& opcodes) {
+        std::set<unsigned int> r;
+        for(unsigned int i = 0; i < conditions.size(); i++) {
+            if(conditions[i]->affectedOpcodes(MCII, r) == false) {
+                return false;
+            }
+        }
+        opcodes.insert(r.begin(), r.end());
+        return true;
+    }
 };
 
 class Not : public PatchCondition, public AutoAlloc<PatchCondition, Not> {
@@ -297,6 +358,19 @@ public:
     }
 };
 
+class IsStringAccess : public PatchCondition, public AutoAlloc<PatchCondition, IsStringAccess> {
+public:
+
+    /*! Return true if the instruction is a string operation, possibly repeated, accessing memory
+     * through its index registers.
+    */
+    IsStringAccess() {};
+
+    bool test(const llvm::MCInst* inst, rword address, rword instSize, llvm::MCInstrInfo* MCII) {
+        return isStringAccess(inst);
+    }
+};
+
 class ReadAccessSizeIs : public PatchCondition, public AutoAlloc<PatchCondition, ReadAccessSizeIs> {
 public:
 
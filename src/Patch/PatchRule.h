@@ -70,6 +70,10 @@ public:
         return condition->test(inst, address, instSize, MCII);
     }
 
+    bool affectedOpcodes(llvm::MCInstrInfo* MCII, std::set<unsigned int>& opcodes) const {
+        return condition->affectedOpcodes(MCII, opcodes);
+    }
+
     /*! Generate this rule output patch by evaluating its generators on the current context. Also
      *  handles the temporary register management for this patch.
      *
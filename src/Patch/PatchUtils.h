@@ -83,14 +83,57 @@ class TempManager {
     const llvm::MCInst* inst;
     llvm::MCInstrInfo* MCII;
     llvm::MCRegisterInfo* MRI;
+    uint32_t freeRegs;
+
+    bool isAllocated(unsigned int i) {
+        for(auto p : temps) {
+            if(p.second == i) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isUsedByInst(unsigned int i) {
+        const llvm::MCInstrDesc &desc = MCII->get(inst->getOpcode());
+        // Check for explicit registers
+        for(unsigned int j = 0; inst && j < inst->getNumOperands(); j++) {
+            const llvm::MCOperand &op = inst->getOperand(j);
+            if (op.isReg() && MRI->isSubRegisterEq(GPR_ID[i], op.getReg())) {
+                return true;
+            }
+        }
+        // Check for implicitly used registers
+        const uint16_t* implicitRegs = desc.getImplicitUses();
+        for (; implicitRegs && *implicitRegs; ++implicitRegs) {
+            if (MRI->isSubRegisterEq(GPR_ID[i], *implicitRegs)) {
+                return true;
+            }
+        }
+        // Check for implicitly modified registers
+        implicitRegs = desc.getImplicitDefs();
+        for (; implicitRegs && *implicitRegs; ++implicitRegs) {
+            if (MRI->isSubRegisterEq(GPR_ID[i], *implicitRegs)) {
+                return true;
+            }
+        }
+        return false;
+    }
 
 public:
 
-    TempManager(const llvm::MCInst *inst, llvm::MCInstrInfo* MCII, llvm::MCRegisterInfo *MRI) : inst(inst), MCII(MCII), MRI(MRI) {};
+    /*! Allocate a temporary register manager for an instruction.
+     *
+     * @param[in] inst      The instruction being patched or instrumented.
+     * @param[in] MCII      An LLVM MC instruction info context.
+     * @param[in] MRI       An LLVM MC register info context.
+     * @param[in] freeRegs  Mask of the GPR indexes which are dead at this point. They are 
+     *                      allocated first and do not need to be saved.
+    */
+    TempManager(const llvm::MCInst *inst, llvm::MCInstrInfo* MCII, llvm::MCRegisterInfo *MRI, uint32_t freeRegs = 0) 
+        : inst(inst), MCII(MCII), MRI(MRI), freeRegs(freeRegs) {};
 
     Reg getRegForTemp(unsigned int id) {
-        unsigned int i;
-
         // Check if the id is already alocated
         for(auto p : temps) {
             if(p.first == id) {
@@ -98,51 +141,18 @@ public:
             }
         }
 
-        // Start from the last free register found (or default)
-        if(temps.size() > 0) {
-            i = temps.back().second + 1;
-        }
-        else {
-            i = _QBDI_FIRST_FREE_REGISTER;
-        }
-
-        const llvm::MCInstrDesc &desc = MCII->get(inst->getOpcode());
-        // Find a free register
-        for(; i < AVAILABLE_GPR; i++) {
-            bool free = true;
-            // Check for explicit registers
-            for(unsigned int j = 0; inst && j < inst->getNumOperands(); j++) {
-                const llvm::MCOperand &op = inst->getOperand(j);
-                if (op.isReg() && MRI->isSubRegisterEq(GPR_ID[i], op.getReg())) {
-                    free = false;
-                    break;
-                }
-            }
-            // Check for implicitly used registers
-            if (free) {
-                const uint16_t* implicitRegs = desc.getImplicitUses();
-                for (; implicitRegs && *implicitRegs; ++implicitRegs) {
-                    if (MRI->isSubRegisterEq(GPR_ID[i], *implicitRegs)) {
-                        free = false;
-                        break;
-                    }
+        // Find a free register, looking at the dead registers first
+        for(int deadOnly = 1; deadOnly >= 0; deadOnly--) {
+            for(unsigned int i = _QBDI_FIRST_FREE_REGISTER; i < AVAILABLE_GPR; i++) {
+                if(deadOnly && (freeRegs & (1U << i)) == 0) {
+                    continue;
                 }
-            }
-            // Check for implicitly modified registers
-            if (free) {
-                const uint16_t* implicitRegs = desc.getImplicitDefs();
-                for (; implicitRegs && *implicitRegs; ++implicitRegs) {
-                    if (MRI->isSubRegisterEq(GPR_ID[i], *implicitRegs)) {
-                        free = false;
-                        break;
-                    }
+                if(isAllocated(i) == false && isUsedByInst(i) == false) {
+                    // store it and return it
+                    temps.push_back(std::make_pair(id, i));
+                    return Reg(i);
                 }
             }
-            if(free) {
-                // store it and return it
-                temps.push_back(std::make_pair(id, i));
-                return Reg(i);
-            }
         }
         LogError("TempManager::getRegForTemp", "No free registers found");
         abort();
@@ -155,10 +165,28 @@ public:
         return list;
     }
 
+    /*! Return the allocated registers which are not dead and thus need to be saved and restored.
+    */
+    Reg::Vec getSpilledRegisters() {
+        Reg::Vec list;
+        for(auto p: temps)
+            if((freeRegs & (1U << p.second)) == 0)
+                list.push_back(Reg(p.second));
+        return list;
+    }
+
     size_t getUsedRegisterNumber() {
         return temps.size();
     }
 
+    llvm::MCInstrInfo* getMCII() const {
+        return MCII;
+    }
+
+    llvm::MCRegisterInfo* getMRI() const {
+        return MRI;
+    }
+
     unsigned getRegSize(unsigned reg) {
         for(unsigned i = 0; i < MRI->getNumRegClasses(); i++) {
             if(MRI->getRegClass(i).contains(reg)) {
@@ -67,7 +67,7 @@ public:
         : RelocatableInst(inst), opn(opn), offset(offset) {};
 
     llvm::MCInst reloc(ExecBlock *exec_block) {
-        inst.getOperand(opn).setImm(offset + exec_block->getDataBlockOffset());
+        inst.getOperand(opn).setImm(offset + exec_block->getContextOffset());
         return inst;
     }
 };
@@ -189,6 +189,8 @@ public:
     uint32_t patchSize;
     bool modifyPC;
     bool merge;
+    bool flagsLiveIn;
+    bool flagsLiveOut;
 
     inline rword endAddress() const {
         return address + instSize;
@@ -997,7 +997,222 @@ unsigned STACK_READ_64[] = {
 
 size_t STACK_READ_64_SIZE = sizeof(STACK_READ_64)/sizeof(unsigned);
 
-uint16_t MEMACCESS_INFO_TABLE[llvm::X86::INSTRUCTION_LIST_END] = {0};
+unsigned READ_128[] = {
+	llvm::X86::MOVAPSrm,
+	llvm::X86::MOVUPSrm,
+	llvm::X86::MOVAPDrm,
+	llvm::X86::MOVUPDrm,
+	llvm::X86::MOVDQArm,
+	llvm::X86::MOVDQUrm,
+	llvm::X86::MOVNTDQArm,
+	llvm::X86::LDDQUrm,
+	llvm::X86::PXORrm,
+	llvm::X86::PANDrm,
+	llvm::X86::PANDNrm,
+	llvm::X86::PORrm,
+	llvm::X86::PCMPEQBrm,
+	llvm::X86::PCMPEQWrm,
+	llvm::X86::PCMPEQDrm,
+	llvm::X86::PADDBrm,
+	llvm::X86::PADDWrm,
+	llvm::X86::PADDDrm,
+	llvm::X86::PADDQrm,
+	llvm::X86::PSUBBrm,
+	llvm::X86::PSUBWrm,
+	llvm::X86::PSUBDrm,
+	llvm::X86::PSUBQrm,
+	llvm::X86::PMINUBrm,
+	llvm::X86::PMAXUBrm,
+	llvm::X86::PSHUFBrm,
+	llvm::X86::PSHUFDmi,
+	llvm::X86::XORPSrm,
+	llvm::X86::ANDPSrm,
+	llvm::X86::ORPSrm,
+	llvm::X86::ADDPSrm,
+	llvm::X86::ADDPDrm,
+	llvm::X86::SUBPSrm,
+	llvm::X86::SUBPDrm,
+	llvm::X86::MULPSrm,
+	llvm::X86::MULPDrm,
+	llvm::X86::DIVPSrm,
+	llvm::X86::DIVPDrm,
+	llvm::X86::VMOVAPSrm,
+	llvm::X86::VMOVUPSrm,
+	llvm::X86::VMOVAPDrm,
+	llvm::X86::VMOVUPDrm,
+	llvm::X86::VMOVDQArm,
+	llvm::X86::VMOVDQUrm,
+	llvm::X86::VMOVNTDQArm,
+	llvm::X86::VLDDQUrm,
+	llvm::X86::VPXORrm,
+	llvm::X86::VPANDrm,
+	llvm::X86::VPORrm,
+	llvm::X86::VPCMPEQBrm,
+	llvm::X86::VPMINUBrm,
+	llvm::X86::VXORPSrm,
+	llvm::X86::CMPXCHG16B,
+	llvm::X86::LCMPXCHG16B
+};
+
+size_t READ_128_SIZE = sizeof(READ_128)/sizeof(unsigned);
+
+unsigned READ_256[] = {
+	llvm::X86::VMOVAPSYrm,
+	llvm::X86::VMOVUPSYrm,
+	llvm::X86::VMOVAPDYrm,
+	llvm::X86::VMOVUPDYrm,
+	llvm::X86::VMOVDQAYrm,
+	llvm::X86::VMOVDQUYrm,
+	llvm::X86::VMOVNTDQAYrm,
+	llvm::X86::VLDDQUYrm,
+	llvm::X86::VPXORYrm,
+	llvm::X86::VPANDYrm,
+	llvm::X86::VPORYrm,
+	llvm::X86::VPCMPEQBYrm,
+	llvm::X86::VPMINUBYrm,
+	llvm::X86::VXORPSYrm
+};
+
+size_t READ_256_SIZE = sizeof(READ_256)/sizeof(unsigned);
+
+unsigned READ_512[] = {
+	llvm::X86::FXRSTOR,
+	llvm::X86::FXRSTOR64
+};
+
+size_t READ_512_SIZE = sizeof(READ_512)/sizeof(unsigned);
+
+unsigned WRITE_128[] = {
+	llvm::X86::MOVAPSmr,
+	llvm::X86::MOVUPSmr,
+	llvm::X86::MOVAPDmr,
+	llvm::X86::MOVUPDmr,
+	llvm::X86::MOVDQAmr,
+	llvm::X86::MOVDQUmr,
+	llvm::X86::MOVNTPSmr,
+	llvm::X86::MOVNTPDmr,
+	llvm::X86::MOVNTDQmr,
+	llvm::X86::VMOVAPSmr,
+	llvm::X86::VMOVUPSmr,
+	llvm::X86::VMOVAPDmr,
+	llvm::X86::VMOVUPDmr,
+	llvm::X86::VMOVDQAmr,
+	llvm::X86::VMOVDQUmr,
+	llvm::X86::VMOVNTPSmr,
+	llvm::X86::VMOVNTPDmr,
+	llvm::X86::VMOVNTDQmr,
+	llvm::X86::CMPXCHG16B,
+	llvm::X86::LCMPXCHG16B
+};
+
+size_t WRITE_128_SIZE = sizeof(WRITE_128)/sizeof(unsigned);
+
+unsigned WRITE_256[] = {
+	llvm::X86::VMOVAPSYmr,
+	llvm::X86::VMOVUPSYmr,
+	llvm::X86::VMOVAPDYmr,
+	llvm::X86::VMOVUPDYmr,
+	llvm::X86::VMOVDQAYmr,
+	llvm::X86::VMOVDQUYmr,
+	llvm::X86::VMOVNTPSYmr,
+	llvm::X86::VMOVNTPDYmr,
+	llvm::X86::VMOVNTDQYmr
+};
+
+size_t WRITE_256_SIZE = sizeof(WRITE_256)/sizeof(unsigned);
+
+unsigned WRITE_512[] = {
+	llvm::X86::FXSAVE,
+	llvm::X86::FXSAVE64
+};
+
+size_t WRITE_512_SIZE = sizeof(WRITE_512)/sizeof(unsigned);
+
+// String operations, the size is the one of an element
+unsigned STRING_READ_8[] = {
+	llvm::X86::MOVSB,
+	llvm::X86::LODSB,
+	llvm::X86::SCASB,
+	llvm::X86::CMPSB
+};
+
+size_t STRING_READ_8_SIZE = sizeof(STRING_READ_8)/sizeof(unsigned);
+
+unsigned STRING_READ_16[] = {
+	llvm::X86::MOVSW,
+	llvm::X86::LODSW,
+	llvm::X86::SCASW,
+	llvm::X86::CMPSW
+};
+
+size_t STRING_READ_16_SIZE = sizeof(STRING_READ_16)/sizeof(unsigned);
+
+unsigned STRING_READ_32[] = {
+	llvm::X86::MOVSL,
+	llvm::X86::LODSL,
+	llvm::X86::SCASL,
+	llvm::X86::CMPSL
+};
+
+size_t STRING_READ_32_SIZE = sizeof(STRING_READ_32)/sizeof(unsigned);
+
+unsigned STRING_READ_64[] = {
+	llvm::X86::MOVSQ,
+	llvm::X86::LODSQ,
+	llvm::X86::SCASQ,
+	llvm::X86::CMPSQ
+};
+
+size_t STRING_READ_64_SIZE = sizeof(STRING_READ_64)/sizeof(unsigned);
+
+unsigned STRING_WRITE_8[] = {
+	llvm::X86::MOVSB,
+	llvm::X86::STOSB
+};
+
+size_t STRING_WRITE_8_SIZE = sizeof(STRING_WRITE_8)/sizeof(unsigned);
+
+unsigned STRING_WRITE_16[] = {
+	llvm::X86::MOVSW,
+	llvm::X86::STOSW
+};
+
+size_t STRING_WRITE_16_SIZE = sizeof(STRING_WRITE_16)/sizeof(unsigned);
+
+unsigned STRING_WRITE_32[] = {
+	llvm::X86::MOVSL,
+	llvm::X86::STOSL
+};
+
+size_t STRING_WRITE_32_SIZE = sizeof(STRING_WRITE_32)/sizeof(unsigned);
+
+unsigned STRING_WRITE_64[] = {
+	llvm::X86::MOVSQ,
+	llvm::X86::STOSQ
+};
+
+size_t STRING_WRITE_64_SIZE = sizeof(STRING_WRITE_64)/sizeof(unsigned);
+
+uint32_t MEMACCESS_INFO_TABLE[llvm::X86::INSTRUCTION_LIST_END] = {0};
+
+/* Instruction families defining all the arithmetic flags (OF, SF, ZF, AF, PF and CF), either to a 
+ * computed or to an undefined value. LLVM models EFLAGS as a single register: INC, DEC, shifts or 
+ * rotations are seen as defining EFLAGS while they preserve some of the flags.
+*/
+const char* FLAGS_OVERWRITE_FAMILIES[] = {
+    "ADD", "ADC", "SUB", "SBB", "CMP", "AND", "OR", "XOR", "TEST", "NEG", "MUL", "IMUL", "DIV", "IDIV"
+};
+
+size_t FLAGS_OVERWRITE_FAMILIES_SIZE = sizeof(FLAGS_OVERWRITE_FAMILIES)/sizeof(const char*);
+
+/* Exceptions to the families above which only define a part of the flags or leave them untouched 
+ * when their count is zero.
+*/
+const char* FLAGS_PARTIAL_FAMILIES[] = {
+    "ADCX", "ADOX", "CMPS", "CMPXCHG8B", "CMPXCHG16B"
+};
+
+size_t FLAGS_PARTIAL_FAMILIES_SIZE = sizeof(FLAGS_PARTIAL_FAMILIES)/sizeof(const char*);
 
 void initMemAccessInfo() {
     for(size_t i = 0; i < READ_8_SIZE; i++) {
@@ -1024,6 +1239,48 @@ void initMemAccessInfo() {
     for(size_t i = 0; i < WRITE_64_SIZE; i++) {
         MEMACCESS_INFO_TABLE[WRITE_64[i]] |= WRITE(8);
     }
+    for(size_t i = 0; i < READ_128_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[READ_128[i]] |= READ(16);
+    }
+    for(size_t i = 0; i < READ_256_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[READ_256[i]] |= READ(32);
+    }
+    for(size_t i = 0; i < READ_512_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[READ_512[i]] |= READ(512);
+    }
+    for(size_t i = 0; i < WRITE_128_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[WRITE_128[i]] |= WRITE(16);
+    }
+    for(size_t i = 0; i < WRITE_256_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[WRITE_256[i]] |= WRITE(32);
+    }
+    for(size_t i = 0; i < WRITE_512_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[WRITE_512[i]] |= WRITE(512);
+    }
+    for(size_t i = 0; i < STRING_READ_8_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[STRING_READ_8[i]] |= STRING_READ(1);
+    }
+    for(size_t i = 0; i < STRING_READ_16_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[STRING_READ_16[i]] |= STRING_READ(2);
+    }
+    for(size_t i = 0; i < STRING_READ_32_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[STRING_READ_32[i]] |= STRING_READ(4);
+    }
+    for(size_t i = 0; i < STRING_READ_64_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[STRING_READ_64[i]] |= STRING_READ(8);
+    }
+    for(size_t i = 0; i < STRING_WRITE_8_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[STRING_WRITE_8[i]] |= STRING_WRITE(1);
+    }
+    for(size_t i = 0; i < STRING_WRITE_16_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[STRING_WRITE_16[i]] |= STRING_WRITE(2);
+    }
+    for(size_t i = 0; i < STRING_WRITE_32_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[STRING_WRITE_32[i]] |= STRING_WRITE(4);
+    }
+    for(size_t i = 0; i < STRING_WRITE_64_SIZE; i++) {
+        MEMACCESS_INFO_TABLE[STRING_WRITE_64[i]] |= STRING_WRITE(8);
+    }
     for(size_t i = 0; i < STACK_READ_16_SIZE; i++) {
         MEMACCESS_INFO_TABLE[STACK_READ_16[i]] |= STACK_READ(2);
     }
@@ -1060,4 +1317,281 @@ bool isStackWrite(const llvm::MCInst* inst) {
     return IS_STACK_WRITE(MEMACCESS_INFO_TABLE[inst->getOpcode()]);
 }
 
+bool isStringAccess(const llvm::MCInst* inst) {
+    return IS_STRING_ACCESS(MEMACCESS_INFO_TABLE[inst->getOpcode()]);
+}
+
+bool readFlags(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII) {
+    return MCII->get(inst->getOpcode()).hasImplicitUseOfPhysReg(llvm::X86::EFLAGS);
+}
+
+bool overwriteFlags(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII) {
+    if(MCII->get(inst->getOpcode()).hasImplicitDefOfPhysReg(llvm::X86::EFLAGS) == false) {
+        return false;
+    }
+    llvm::StringRef name = MCII->getName(inst->getOpcode());
+    if(name.startswith("LOCK_")) {
+        name = name.drop_front(5);
+    }
+    for(size_t i = 0; i < FLAGS_PARTIAL_FAMILIES_SIZE; i++) {
+        if(name.startswith(FLAGS_PARTIAL_FAMILIES[i])) {
+            return false;
+        }
+    }
+    for(size_t i = 0; i < FLAGS_OVERWRITE_FAMILIES_SIZE; i++) {
+        if(name.startswith(FLAGS_OVERWRITE_FAMILIES[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Instructions whose register uses are not modeled by LLVM
+unsigned OPAQUE_INSTS[] = {
+    llvm::X86::SYSCALL,
+    llvm::X86::SYSENTER,
+    llvm::X86::INT,
+    llvm::X86::INT3,
+    llvm::X86::INTO,
+};
+
+size_t OPAQUE_INSTS_SIZE = sizeof(OPAQUE_INSTS)/sizeof(unsigned);
+
+static uint32_t getGPRMask(unsigned reg, const llvm::MCRegisterInfo* MRI) {
+    uint32_t mask = 0;
+    for(unsigned i = 0; i < AVAILABLE_GPR; i++) {
+        if(MRI->isSubRegisterEq(GPR_ID[i], reg)) {
+            mask |= (1U << i);
+        }
+    }
+    return mask;
+}
+
+// Writing a 64 bits register or its 32 bits sub register (which is zero extended) overwrites it.
+static uint32_t getOverwrittenGPRMask(unsigned reg, const llvm::MCRegisterInfo* MRI) {
+    uint32_t mask = 0;
+    for(unsigned i = 0; i < AVAILABLE_GPR; i++) {
+        if(GPR_ID[i] == reg || MRI->getSubReg(GPR_ID[i], llvm::X86::sub_32bit) == reg) {
+            mask |= (1U << i);
+        }
+    }
+    return mask;
+}
+
+uint32_t getReadRegs(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII, const llvm::MCRegisterInfo* MRI) {
+    const llvm::MCInstrDesc &desc = MCII->get(inst->getOpcode());
+    uint32_t mask = 0;
+
+    // Be conservative with the instructions whose register uses are unknown
+    if(desc.isCall() || desc.isReturn() || desc.isBranch() || desc.hasUnmodeledSideEffects()) {
+        return (1U << AVAILABLE_GPR) - 1;
+    }
+    for(size_t i = 0; i < OPAQUE_INSTS_SIZE; i++) {
+        if(inst->getOpcode() == OPAQUE_INSTS[i]) {
+            return (1U << AVAILABLE_GPR) - 1;
+        }
+    }
+    // Explicit register operands after the definitions and implicit uses
+    for(unsigned i = desc.getNumDefs(); i < inst->getNumOperands(); i++) {
+        const llvm::MCOperand &op = inst->getOperand(i);
+        if(op.isReg() && op.getReg() != 0) {
+            mask |= getGPRMask(op.getReg(), MRI);
+        }
+    }
+    for(const uint16_t* implicitRegs = desc.getImplicitUses(); implicitRegs && *implicitRegs; ++implicitRegs) {
+        mask |= getGPRMask(*implicitRegs, MRI);
+    }
+    // A REP prefix, merged in the patch but not in the instruction, uses the count register
+    if(isStringAccess(inst)) {
+        mask |= getGPRMask(llvm::X86::RCX, MRI);
+    }
+    // Partial writes need the previous value of the register
+    for(unsigned i = 0; i < desc.getNumDefs() && i < inst->getNumOperands(); i++) {
+        const llvm::MCOperand &op = inst->getOperand(i);
+        if(op.isReg() && op.getReg() != 0) {
+            mask |= getGPRMask(op.getReg(), MRI) & ~getOverwrittenGPRMask(op.getReg(), MRI);
+        }
+    }
+    for(const uint16_t* implicitRegs = desc.getImplicitDefs(); implicitRegs && *implicitRegs; ++implicitRegs) {
+        mask |= getGPRMask(*implicitRegs, MRI) & ~getOverwrittenGPRMask(*implicitRegs, MRI);
+    }
+    return mask;
+}
+
+uint32_t getOverwrittenRegs(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII, const llvm::MCRegisterInfo* MRI) {
+    const llvm::MCInstrDesc &desc = MCII->get(inst->getOpcode());
+    uint32_t mask = 0;
+
+    for(unsigned i = 0; i < desc.getNumDefs() && i < inst->getNumOperands(); i++) {
+        const llvm::MCOperand &op = inst->getOperand(i);
+        if(op.isReg() && op.getReg() != 0) {
+            mask |= getOverwrittenGPRMask(op.getReg(), MRI);
+        }
+    }
+    for(const uint16_t* implicitRegs = desc.getImplicitDefs(); implicitRegs && *implicitRegs; ++implicitRegs) {
+        mask |= getOverwrittenGPRMask(*implicitRegs, MRI);
+    }
+    return mask;
+}
+
+static const unsigned TAINT_VECTOR_REGS[] = {
+    llvm::X86::ZMM0,  llvm::X86::ZMM1,  llvm::X86::ZMM2,  llvm::X86::ZMM3,
+    llvm::X86::ZMM4,  llvm::X86::ZMM5,  llvm::X86::ZMM6,  llvm::X86::ZMM7,
+    llvm::X86::ZMM8,  llvm::X86::ZMM9,  llvm::X86::ZMM10, llvm::X86::ZMM11,
+    llvm::X86::ZMM12, llvm::X86::ZMM13, llvm::X86::ZMM14, llvm::X86::ZMM15,
+};
+
+static const size_t TAINT_VECTOR_REGS_SIZE = sizeof(TAINT_VECTOR_REGS)/sizeof(unsigned);
+
+// Families whose result bytes only depend on the source bytes at the same position
+static const char* BYTEWISE_FAMILIES[] = {
+    "MOV", "CMOV", "AND", "OR", "XOR", "NOT", "PUSH", "POP", "XCHG",
+};
+
+static const size_t BYTEWISE_FAMILIES_SIZE = sizeof(BYTEWISE_FAMILIES)/sizeof(char*);
+
+// Exceptions to the families above
+static const char* SHUFFLING_FAMILIES[] = {
+    "MOVSX", "MOVBE", "MOVMSK", "POPCNT",
+};
+
+static const size_t SHUFFLING_FAMILIES_SIZE = sizeof(SHUFFLING_FAMILIES)/sizeof(char*);
+
+// Families which zero their destination when both sources are the same register
+static const char* ZEROING_FAMILIES[] = {
+    "XOR", "SUB", "PXOR", "VPXOR", "VXORP", "PSUB", "VPSUB",
+};
+
+static const size_t ZEROING_FAMILIES_SIZE = sizeof(ZEROING_FAMILIES)/sizeof(char*);
+
+static bool getTaintOperand(unsigned reg, const llvm::MCRegisterInfo* MRI, TaintOperand& operand) {
+    // The stack and instruction pointers are not tracked
+    for(unsigned i = 0; i < NUM_GPR; i++) {
+        if(i == REG_SP || i == REG_PC || MRI->isSubRegisterEq(GPR_ID[i], reg) == false) {
+            continue;
+        }
+        operand.slot = i;
+        operand.size = 0;
+        operand.offset = 0;
+        for(unsigned j = 0; j < MRI->getNumRegClasses(); j++) {
+            if(MRI->getRegClass(j).contains(reg)) {
+                operand.size = MRI->getRegClass(j).getSize();
+                break;
+            }
+        }
+        if(reg == llvm::X86::AH || reg == llvm::X86::BH || reg == llvm::X86::CH || reg == llvm::X86::DH) {
+            operand.offset = 1;
+        }
+        return operand.size > 0;
+    }
+    // The XMM, YMM and ZMM registers overlap, their size tells how many lanes they cover
+    for(unsigned i = 0; i < TAINT_VECTOR_REGS_SIZE; i++) {
+        if(MRI->isSubRegisterEq(TAINT_VECTOR_REGS[i], reg)) {
+            operand.slot = NUM_GPR + i;
+            operand.offset = 0;
+            if(reg == TAINT_VECTOR_REGS[i]) {
+                operand.size = 64;
+            }
+            else if(reg == MRI->getSubReg(TAINT_VECTOR_REGS[i], llvm::X86::sub_ymm)) {
+                operand.size = 32;
+            }
+            else {
+                operand.size = 16;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool getTaintFlow(const llvm::MCInst* inst, const llvm::MCInstrInfo* MCII, const llvm::MCRegisterInfo* MRI, TaintFlow& flow) {
+    const llvm::MCInstrDesc &desc = MCII->get(inst->getOpcode());
+    llvm::StringRef name = MCII->getName(inst->getOpcode());
+    TaintOperand operand;
+
+    flow.sources.clear();
+    flow.destinations.clear();
+    flow.bytewise = false;
+    flow.clear = false;
+    // The VEX and EVEX encoded opcodes are the only ones starting with a V and writing a vector
+    flow.zeroUpper = name.startswith("V");
+    // Control flow is not propagated and string operations are handled separately
+    if(desc.isCall() || desc.isReturn() || desc.isBranch() || isStringAccess(inst)) {
+        return false;
+    }
+    for(size_t i = 0; i < OPAQUE_INSTS_SIZE; i++) {
+        if(inst->getOpcode() == OPAQUE_INSTS[i]) {
+            return false;
+        }
+    }
+    // The registers of the memory operand only compute an address, except for LEA
+    bool lea = name.startswith("LEA");
+    unsigned memOp = inst->getNumOperands();
+    if(lea || getReadSize(inst) > 0 || getWriteSize(inst) > 0) {
+        for(unsigned i = 0; i + 4 < inst->getNumOperands(); i++) {
+            if(inst->getOperand(i + 0).isReg() && inst->getOperand(i + 1).isImm() &&
+               inst->getOperand(i + 2).isReg() && inst->getOperand(i + 3).isImm() &&
+               inst->getOperand(i + 4).isReg()) {
+                memOp = i;
+                break;
+            }
+        }
+    }
+    for(unsigned i = 0; i < inst->getNumOperands(); i++) {
+        const llvm::MCOperand &op = inst->getOperand(i);
+        if(op.isReg() == false || op.getReg() == 0) {
+            continue;
+        }
+        if(i >= memOp && i < memOp + 5) {
+            if(lea == false || (i != memOp && i != memOp + 2)) {
+                continue;
+            }
+        }
+        if(getTaintOperand(op.getReg(), MRI, operand)) {
+            if(i < desc.getNumDefs()) {
+                flow.destinations.push_back(operand);
+            }
+            else {
+                flow.sources.push_back(operand);
+            }
+        }
+    }
+    for(const uint16_t* implicitRegs = desc.getImplicitUses(); implicitRegs && *implicitRegs; ++implicitRegs) {
+        if(getTaintOperand(*implicitRegs, MRI, operand)) {
+            flow.sources.push_back(operand);
+        }
+    }
+    // The implicit vector definitions (VZEROUPPER) keep the taint of the preserved lower parts
+    for(const uint16_t* implicitRegs = desc.getImplicitDefs(); implicitRegs && *implicitRegs; ++implicitRegs) {
+        if(getTaintOperand(*implicitRegs, MRI, operand) && operand.slot < NUM_GPR) {
+            flow.destinations.push_back(operand);
+        }
+    }
+
+    for(size_t i = 0; i < BYTEWISE_FAMILIES_SIZE; i++) {
+        if(name.startswith(BYTEWISE_FAMILIES[i])) {
+            flow.bytewise = true;
+        }
+    }
+    for(size_t i = 0; i < SHUFFLING_FAMILIES_SIZE; i++) {
+        if(name.startswith(SHUFFLING_FAMILIES[i])) {
+            flow.bytewise = false;
+        }
+    }
+    // XOR and SUB of a register with itself, the sources being the tied destination and the
+    // second operand
+    if(getReadSize(inst) == 0 && desc.getNumDefs() > 0 && inst->getNumOperands() >= desc.getNumDefs() + 2) {
+        const llvm::MCOperand &src1 = inst->getOperand(desc.getNumDefs());
+        const llvm::MCOperand &src2 = inst->getOperand(desc.getNumDefs() + 1);
+        if(src1.isReg() && src2.isReg() && src1.getReg() == src2.getReg()) {
+            for(size_t i = 0; i < ZEROING_FAMILIES_SIZE; i++) {
+                if(name.startswith(ZEROING_FAMILIES[i])) {
+                    flow.clear = true;
+                }
+            }
+        }
+    }
+    return true;
+}
+
 };
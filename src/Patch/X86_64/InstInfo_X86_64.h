@@ -24,28 +24,35 @@
 
 namespace QBDI {
 
-/* Highest 8 bits are the write access, lowest 8 bits are the read access. For each 8 bits part: the 
- * highest bit stores if the access is a stack access or not while the lowest 7 bits store the 
- * unsigned access size in bytes (thus up to 127 bytes). A size of 0 means no access.
+/* Highest 16 bits are the write access, lowest 16 bits are the read access. For each 16 bits part: 
+ * the highest bit stores if the access is a stack access or not, the next one if the access is a 
+ * string operation (through RSI / RDI, possibly repeated) while the lowest 14 bits store the 
+ * unsigned access size in bytes (thus up to 16383 bytes, the element size for a string operation). 
+ * A size of 0 means no access.
  *
- * -----------------------------------------------------------------------------------------------------------------
- * |                     WRITE ACCESS                      |                      READ ACCESS                      |
- * -----------------------------------------------------------------------------------------------------------------
- * | 1 bit stack access flag | 7 bits unsigned access size | 1 bit stack access flag | 7 bits unsigned access size |
- * -----------------------------------------------------------------------------------------------------------------
+ * ---------------------------------------------------------------------------------------------------------------------------------------
+ * |                             WRITE ACCESS                             |                              READ ACCESS                             |
+ * ---------------------------------------------------------------------------------------------------------------------------------------
+ * | 1 bit stack flag | 1 bit string flag | 14 bits unsigned access size | 1 bit stack flag | 1 bit string flag | 14 bits unsigned access size |
+ * ---------------------------------------------------------------------------------------------------------------------------------------
 */
 
-#define STACK_ACCESS_FLAG 0x40
+#define STACK_ACCESS_FLAG 0x8000
+#define STRING_ACCESS_FLAG 0x4000
+#define ACCESS_SIZE_MASK 0x3fff
 #define READ(s) (s)
-#define WRITE(s) ((s)<<8)
+#define WRITE(s) ((s)<<16)
 #define STACK_READ(s) (STACK_ACCESS_FLAG | s)
-#define STACK_WRITE(s) ((STACK_ACCESS_FLAG | s)<<8)
-#define GET_READ_SIZE(v) ((v) & 0x3f)
-#define GET_WRITE_SIZE(v) (((v)>>8) & 0x3f)
+#define STACK_WRITE(s) ((STACK_ACCESS_FLAG | s)<<16)
+#define STRING_READ(s) (STRING_ACCESS_FLAG | s)
+#define STRING_WRITE(s) ((STRING_ACCESS_FLAG | s)<<16)
+#define GET_READ_SIZE(v) ((v) & ACCESS_SIZE_MASK)
+#define GET_WRITE_SIZE(v) (((v)>>16) & ACCESS_SIZE_MASK)
 #define IS_STACK_READ(v) (((v) & STACK_ACCESS_FLAG) > 0)
-#define IS_STACK_WRITE(v) ((((v)>>8) & STACK_ACCESS_FLAG) > 0)
+#define IS_STACK_WRITE(v) ((((v)>>16) & STACK_ACCESS_FLAG) > 0)
+#define IS_STRING_ACCESS(v) ((((v) | ((v)>>16)) & STRING_ACCESS_FLAG) > 0)
 
-extern uint16_t MEMACCESS_INFO_TABLE[];
+extern uint32_t MEMACCESS_INFO_TABLE[];
 
 };
 
@@ -21,14 +21,19 @@ namespace QBDI {
 
 /* Genreate a series of RelocatableInst which when appended to an instrumentation code trigger a 
  * break to host. It receive in argument a temporary reg which will be used for computations then 
- * finally restored.
+ * finally restored. The restoreFlags argument tells if the flags are live where the execution 
+ * resumes. The resumeOffset argument is a number of bytes following the sequence which are 
+ * skipped when the execution resumes.
 */
-RelocatableInst::SharedPtrVec getBreakToHost(Reg temp) {
+RelocatableInst::SharedPtrVec getBreakToHost(Reg temp, bool restoreFlags, rword resumeOffset) {
     RelocatableInst::SharedPtrVec breakToHost;
 
+    // Request the prologue to restore the flags or not when the execution is resumed
+    breakToHost.push_back(Mov(Offset(offsetof(Context, hostState.restoreFlags)),
+                              Constant(restoreFlags ? FLAGS_RESTORE_ARITH : FLAGS_RESTORE_NONE)));
     // Use the temporary register to compute RIP + 29 which is the address which will follow this 
     // patch and where the execution needs to be resumed 
-    breakToHost.push_back(HostPCRel(mov64ri(temp, 0), 1, 29));
+    breakToHost.push_back(HostPCRel(mov64ri(temp, 0), 1, 29 + resumeOffset));
     // Set the selector to this address so the execution can be resumed when the exec block will be 
     // reexecuted
     append(breakToHost, SaveReg(temp, Offset(offsetof(Context, hostState.selector))));
@@ -40,6 +45,62 @@ RelocatableInst::SharedPtrVec getBreakToHost(Reg temp) {
     return breakToHost;
 }
 
+/* Generate a break to host which is only taken if the cond register is not zero. The used registers
+ * have been saved in the context and are restored on both paths, the first one being given to 
+ * getBreakToHost as its scratch. The flags are preserved on the guest stack, beyond its red zone,
+ * around the test when they are live.
+ *
+ * The layout is:
+ *
+ *   (LEA RSP, [RSP - 128] ; PUSHFQ)
+ *   TEST cond, cond
+ *   JE skip
+ *   (POPFQ ; LEA RSP, [RSP + 128])
+ *   LoadReg used[1..n]
+ *   getBreakToHost(used[0]) resuming after skip
+ * skip:
+ *   (POPFQ ; LEA RSP, [RSP + 128])
+ *   LoadReg used[0..n]
+*/
+RelocatableInst::SharedPtrVec getConditionalBreakToHost(Reg cond, const Reg::Vec& usedRegisters, 
+                                                        bool restoreFlags) {
+    RelocatableInst::SharedPtrVec breakToHost;
+    RelocatableInst::SharedPtrVec restoreStack;
+    RelocatableInst::SharedPtrVec hitPath;
+    RelocatableInst::SharedPtrVec skipPath;
+
+    if(restoreFlags) {
+        breakToHost.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, -128, 0)));
+        breakToHost.push_back(Pushf());
+        // POPFQ is 1 byte and LEA RSP, [RSP + 128] uses a 32 bits displacement, 8 bytes
+        restoreStack.push_back(Popf());
+        restoreStack.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, 128, 0)));
+    }
+    rword restoreSize = restoreStack.size() > 0 ? 9 : 0;
+
+    // The skip path restores every used register, 7 bytes each
+    append(skipPath, restoreStack);
+    for(uint32_t i = 0; i < usedRegisters.size(); i++) {
+        append(skipPath, LoadReg(usedRegisters[i], Offset(usedRegisters[i])));
+    }
+    rword skipSize = restoreSize + 7 * usedRegisters.size();
+
+    // The hit path is followed by the 40 bytes of the break to host
+    append(hitPath, restoreStack);
+    for(uint32_t i = 1; i < usedRegisters.size(); i++) {
+        append(hitPath, LoadReg(usedRegisters[i], Offset(usedRegisters[i])));
+    }
+    append(hitPath, getBreakToHost(usedRegisters[0], restoreFlags, skipSize));
+    rword hitSize = restoreSize + 7 * (usedRegisters.size() - 1) + 40;
+
+    breakToHost.push_back(Test(cond, cond));
+    breakToHost.push_back(Je(Constant(hitSize + 4)));
+    append(breakToHost, hitPath);
+    append(breakToHost, skipPath);
+
+    return breakToHost;
+}
+
 std::vector<std::shared_ptr<InstrRule>> getMemAccessInstrRules() {
     // TODO: Insert here memory access rules
     return {};
@@ -31,7 +31,10 @@ namespace QBDI {
 
 class InstrRule;
 
-RelocatableInst::SharedPtrVec getBreakToHost(Reg temp);
+RelocatableInst::SharedPtrVec getBreakToHost(Reg temp, bool restoreFlags = true, rword resumeOffset = 0);
+
+RelocatableInst::SharedPtrVec getConditionalBreakToHost(Reg cond, const Reg::Vec& usedRegisters,
+                                                        bool restoreFlags = true);
 
 std::vector<std::shared_ptr<InstrRule>> getMemAccessInstrRules();
 
@@ -54,6 +54,68 @@ llvm::MCInst mov64mr(unsigned int base, rword scale, unsigned int offset, rword
     return inst;
 }
 
+llvm::MCInst mov8mr(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, unsigned int src) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::MOV8mr);
+    inst.addOperand(llvm::MCOperand::createReg(base));
+    inst.addOperand(llvm::MCOperand::createImm(scale));
+    inst.addOperand(llvm::MCOperand::createReg(offset));
+    inst.addOperand(llvm::MCOperand::createImm(displacement));
+    inst.addOperand(llvm::MCOperand::createReg(seg));
+    inst.addOperand(llvm::MCOperand::createReg(src));
+
+    return inst;
+}
+
+llvm::MCInst mov16mr(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, unsigned int src) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::MOV16mr);
+    inst.addOperand(llvm::MCOperand::createReg(base));
+    inst.addOperand(llvm::MCOperand::createImm(scale));
+    inst.addOperand(llvm::MCOperand::createReg(offset));
+    inst.addOperand(llvm::MCOperand::createImm(displacement));
+    inst.addOperand(llvm::MCOperand::createReg(seg));
+    inst.addOperand(llvm::MCOperand::createReg(src));
+
+    return inst;
+}
+
+llvm::MCInst mov32mr(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, unsigned int src) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::MOV32mr);
+    inst.addOperand(llvm::MCOperand::createReg(base));
+    inst.addOperand(llvm::MCOperand::createImm(scale));
+    inst.addOperand(llvm::MCOperand::createReg(offset));
+    inst.addOperand(llvm::MCOperand::createImm(displacement));
+    inst.addOperand(llvm::MCOperand::createReg(seg));
+    inst.addOperand(llvm::MCOperand::createReg(src));
+
+    return inst;
+}
+
+llvm::MCInst mov32rr(unsigned int dst, unsigned int src) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::MOV32rr);
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(src));
+
+    return inst;
+}
+
+llvm::MCInst movzx32rr8(unsigned int dst, unsigned int src) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::MOVZX32rr8);
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(src));
+
+    return inst;
+}
+
 llvm::MCInst mov32rm8(unsigned int dst, unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg) {
     llvm::MCInst inst;
 
@@ -82,6 +144,20 @@ llvm::MCInst mov32rm16(unsigned int dst, unsigned int base, rword scale, unsigne
     return inst;
 }
 
+llvm::MCInst mov64rm16(unsigned int dst, unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::MOVZX64rm16);
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(base));
+    inst.addOperand(llvm::MCOperand::createImm(scale));
+    inst.addOperand(llvm::MCOperand::createReg(offset));
+    inst.addOperand(llvm::MCOperand::createImm(displacement));
+    inst.addOperand(llvm::MCOperand::createReg(seg));
+
+    return inst;
+}
+
 llvm::MCInst mov32rm(unsigned int dst, unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg) {
     llvm::MCInst inst;
 
@@ -111,6 +187,62 @@ llvm::MCInst mov64rm(unsigned int dst, unsigned int base, rword scale, unsigned
     return inst;
 }
 
+llvm::MCInst mov8rm(unsigned int dst, unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::MOV8rm);
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(base));
+    inst.addOperand(llvm::MCOperand::createImm(scale));
+    inst.addOperand(llvm::MCOperand::createReg(offset));
+    inst.addOperand(llvm::MCOperand::createImm(displacement));
+    inst.addOperand(llvm::MCOperand::createReg(seg));
+
+    return inst;
+}
+
+llvm::MCInst mov64mi(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, rword imm) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::MOV64mi32);
+    inst.addOperand(llvm::MCOperand::createReg(base));
+    inst.addOperand(llvm::MCOperand::createImm(scale));
+    inst.addOperand(llvm::MCOperand::createReg(offset));
+    inst.addOperand(llvm::MCOperand::createImm(displacement));
+    inst.addOperand(llvm::MCOperand::createReg(seg));
+    inst.addOperand(llvm::MCOperand::createImm(imm));
+
+    return inst;
+}
+
+llvm::MCInst cmp64mi(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, rword imm) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::CMP64mi8);
+    inst.addOperand(llvm::MCOperand::createReg(base));
+    inst.addOperand(llvm::MCOperand::createImm(scale));
+    inst.addOperand(llvm::MCOperand::createReg(offset));
+    inst.addOperand(llvm::MCOperand::createImm(displacement));
+    inst.addOperand(llvm::MCOperand::createReg(seg));
+    inst.addOperand(llvm::MCOperand::createImm(imm));
+
+    return inst;
+}
+
+llvm::MCInst lockadd64mi(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, rword imm) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::LOCK_ADD64mi8);
+    inst.addOperand(llvm::MCOperand::createReg(base));
+    inst.addOperand(llvm::MCOperand::createImm(scale));
+    inst.addOperand(llvm::MCOperand::createReg(offset));
+    inst.addOperand(llvm::MCOperand::createImm(displacement));
+    inst.addOperand(llvm::MCOperand::createReg(seg));
+    inst.addOperand(llvm::MCOperand::createImm(imm));
+
+    return inst;
+}
+
 llvm::MCInst jmp64m(unsigned int base, rword offset) {
     llvm::MCInst inst;
 
@@ -124,6 +256,28 @@ llvm::MCInst jmp64m(unsigned int base, rword offset) {
     return inst;
 }
 
+llvm::MCInst call64r(unsigned int reg) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::CALL64r);
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+
+    return inst;
+}
+
+llvm::MCInst call64m(unsigned int base, rword offset) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::CALL64m);
+    inst.addOperand(llvm::MCOperand::createReg(base));
+    inst.addOperand(llvm::MCOperand::createImm(1));
+    inst.addOperand(llvm::MCOperand::createReg(0));
+    inst.addOperand(llvm::MCOperand::createImm(offset));
+    inst.addOperand(llvm::MCOperand::createReg(0));
+
+    return inst;
+}
+
 llvm::MCInst jmp(rword offset) {
     llvm::MCInst inst;
 
@@ -133,6 +287,52 @@ llvm::MCInst jmp(rword offset) {
     return inst;
 }
 
+llvm::MCInst jmp8(rword offset) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::JMP_1);
+    inst.addOperand(llvm::MCOperand::createImm(offset));
+
+    return inst;
+}
+
+llvm::MCInst ja8(rword offset) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::JA_1);
+    inst.addOperand(llvm::MCOperand::createImm(offset));
+
+    return inst;
+}
+
+llvm::MCInst jb8(rword offset) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::JB_1);
+    inst.addOperand(llvm::MCOperand::createImm(offset));
+
+    return inst;
+}
+
+llvm::MCInst je(rword offset) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::JE_4);
+    inst.addOperand(llvm::MCOperand::createImm(offset));
+
+    return inst;
+}
+
+llvm::MCInst test64rr(unsigned int src1, unsigned int src2) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::TEST64rr);
+    inst.addOperand(llvm::MCOperand::createReg(src1));
+    inst.addOperand(llvm::MCOperand::createReg(src2));
+
+    return inst;
+}
+
 llvm::MCInst fxsave(unsigned int base, rword offset) {
     llvm::MCInst inst;
 
@@ -253,6 +453,180 @@ llvm::MCInst pushf() {
     return inst;
 }
 
+llvm::MCInst sahf() {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::SAHF);
+
+    return inst;
+}
+
+llvm::MCInst shr8ri(unsigned int reg, rword imm) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::SHR8ri);
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+    inst.addOperand(llvm::MCOperand::createImm(imm));
+
+    return inst;
+}
+
+llvm::MCInst and8ri(unsigned int reg, rword imm) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::AND8ri);
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+    inst.addOperand(llvm::MCOperand::createImm(imm));
+
+    return inst;
+}
+
+llvm::MCInst add8ri(unsigned int reg, rword imm) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::ADD8ri);
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+    inst.addOperand(llvm::MCOperand::createImm(imm));
+
+    return inst;
+}
+
+llvm::MCInst and64rr(unsigned int dst, unsigned int src) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::AND64rr);
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(src));
+
+    return inst;
+}
+
+llvm::MCInst cmp64rr(unsigned int src1, unsigned int src2) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::CMP64rr);
+    inst.addOperand(llvm::MCOperand::createReg(src1));
+    inst.addOperand(llvm::MCOperand::createReg(src2));
+
+    return inst;
+}
+
+llvm::MCInst and8rr(unsigned int dst, unsigned int src) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::AND8rr);
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(src));
+
+    return inst;
+}
+
+llvm::MCInst or8rr(unsigned int dst, unsigned int src) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::OR8rr);
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(src));
+
+    return inst;
+}
+
+llvm::MCInst or64rr(unsigned int dst, unsigned int src) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::OR64rr);
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(src));
+
+    return inst;
+}
+
+llvm::MCInst shr64ri(unsigned int reg, rword imm) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::SHR64ri);
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+    inst.addOperand(llvm::MCOperand::createImm(imm));
+
+    return inst;
+}
+
+llvm::MCInst imul64rr(unsigned int dst, unsigned int src) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::IMUL64rr);
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(src));
+
+    return inst;
+}
+
+llvm::MCInst not64r(unsigned int reg) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::NOT64r);
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+
+    return inst;
+}
+
+llvm::MCInst cmove64rr(unsigned int dst, unsigned int src) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::CMOVE64rr);
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(dst));
+    inst.addOperand(llvm::MCOperand::createReg(src));
+
+    return inst;
+}
+
+llvm::MCInst sete(unsigned int reg) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::SETEr);
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+
+    return inst;
+}
+
+llvm::MCInst setne(unsigned int reg) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::SETNEr);
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+
+    return inst;
+}
+
+llvm::MCInst setae(unsigned int reg) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::SETAEr);
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+
+    return inst;
+}
+
+llvm::MCInst setb(unsigned int reg) {
+    llvm::MCInst inst;
+
+    inst.setOpcode(llvm::X86::SETBr);
+    inst.addOperand(llvm::MCOperand::createReg(reg));
+
+    return inst;
+}
+
 llvm::MCInst ret() {
     llvm::MCInst inst;
 
@@ -277,6 +651,29 @@ RelocatableInst::SharedPtr Mov(Reg reg, Offset offset) {
     return DataBlockRel(mov64rm(reg, Reg(REG_PC), 0, 0, 0, 0), 4, offset - 7);
 }
 
+RelocatableInst::SharedPtr Mov(Offset offset, Constant cst) {
+    return DataBlockRel(mov64mi(Reg(REG_PC), 0, 0, 0, 0, cst), 3, offset - 11);
+}
+
+RelocatableInst::SharedPtr Movzx8(unsigned int dst, Offset offset) {
+    // dst needs to be a 32 bits register which does not require a REX prefix
+    return DataBlockRel(mov32rm8(dst, Reg(REG_PC), 0, 0, 0, 0), 4, offset - 7);
+}
+
+RelocatableInst::SharedPtr Movzx16(Reg dst, Offset offset) {
+    // The 64 bits form always has a REX.W prefix, its size does not depend on dst
+    return DataBlockRel(mov64rm16(dst, Reg(REG_PC), 0, 0, 0, 0), 4, offset - 8);
+}
+
+RelocatableInst::SharedPtr Mov8(unsigned int dst, Offset offset) {
+    // dst needs to be an 8 bits register which does not require a REX prefix
+    return DataBlockRel(mov8rm(dst, Reg(REG_PC), 0, 0, 0, 0), 4, offset - 6);
+}
+
+RelocatableInst::SharedPtr Cmp(Offset offset, Constant cst) {
+    return DataBlockRel(cmp64mi(Reg(REG_PC), 0, 0, 0, 0, cst), 3, offset - 8);
+}
+
 RelocatableInst::SharedPtr Jmp64m(Offset offset) {
     return DataBlockRel(jmp64m(Reg(REG_PC), 0), 3, offset - 6);
 }
@@ -317,6 +714,48 @@ RelocatableInst::SharedPtr Popf() {
     return NoReloc(popf());
 }
 
+RelocatableInst::SharedPtr Sahf() {
+    return NoReloc(sahf());
+}
+
+RelocatableInst::SharedPtr Shr8(unsigned int reg, Constant cst) {
+    return NoReloc(shr8ri(reg, cst));
+}
+
+RelocatableInst::SharedPtr And8(unsigned int reg, Constant cst) {
+    return NoReloc(and8ri(reg, cst));
+}
+
+RelocatableInst::SharedPtr Add8(unsigned int reg, Constant cst) {
+    return NoReloc(add8ri(reg, cst));
+}
+
+// Short jumps: the offset is relative to the end of the jump opcode byte, thus the number of 
+// bytes to skip after the jump plus one.
+
+RelocatableInst::SharedPtr Jmp8(Constant offset) {
+    return NoReloc(jmp8(offset));
+}
+
+RelocatableInst::SharedPtr Ja8(Constant offset) {
+    return NoReloc(ja8(offset));
+}
+
+RelocatableInst::SharedPtr Jb8(Constant offset) {
+    return NoReloc(jb8(offset));
+}
+
+// Near conditional jumps: the offset is relative to the end of the two opcode bytes, thus the 
+// number of bytes to skip after the jump plus four.
+
+RelocatableInst::SharedPtr Je(Constant offset) {
+    return NoReloc(je(offset));
+}
+
+RelocatableInst::SharedPtr Test(Reg src1, Reg src2) {
+    return NoReloc(test64rr(src1, src2));
+}
+
 RelocatableInst::SharedPtr Ret() {
     return NoReloc(ret());
 }
@@ -31,16 +31,39 @@ llvm::MCInst mov64ri(unsigned int reg, rword imm);
 
 llvm::MCInst mov64mr(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, unsigned int src);
 
+llvm::MCInst mov8mr(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, unsigned int src);
+
+llvm::MCInst mov16mr(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, unsigned int src);
+
+llvm::MCInst mov32mr(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, unsigned int src);
+
+llvm::MCInst mov32rr(unsigned int dst, unsigned int src);
+
+llvm::MCInst movzx32rr8(unsigned int dst, unsigned int src);
+
 llvm::MCInst mov32rm8(unsigned int dst, unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg);
 
 llvm::MCInst mov32rm16(unsigned int dst, unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg);
 
+llvm::MCInst mov64rm16(unsigned int dst, unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg);
+
 llvm::MCInst mov32rm(unsigned int dst, unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg);
 
 llvm::MCInst mov64rm(unsigned int dst, unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg);
 
+llvm::MCInst mov8rm(unsigned int dst, unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg);
+
+llvm::MCInst mov64mi(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, rword imm);
+
+llvm::MCInst cmp64mi(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, rword imm);
+llvm::MCInst lockadd64mi(unsigned int base, rword scale, unsigned int offset, rword displacement, unsigned int seg, rword imm);
+
 llvm::MCInst jmp64m(unsigned int base, rword offset);
 
+llvm::MCInst call64r(unsigned int reg);
+
+llvm::MCInst call64m(unsigned int base, rword offset);
+
 llvm::MCInst fxsave(unsigned int base, rword offset);
 
 llvm::MCInst fxrstor(unsigned int base, rword offset);
@@ -63,6 +86,50 @@ llvm::MCInst popf();
 
 llvm::MCInst jmp(rword offset);
 
+llvm::MCInst jmp8(rword offset);
+
+llvm::MCInst ja8(rword offset);
+
+llvm::MCInst jb8(rword offset);
+
+llvm::MCInst je(rword offset);
+
+llvm::MCInst test64rr(unsigned int src1, unsigned int src2);
+
+llvm::MCInst shr8ri(unsigned int reg, rword imm);
+
+llvm::MCInst and8ri(unsigned int reg, rword imm);
+
+llvm::MCInst add8ri(unsigned int reg, rword imm);
+
+llvm::MCInst and64rr(unsigned int dst, unsigned int src);
+
+llvm::MCInst cmp64rr(unsigned int src1, unsigned int src2);
+
+llvm::MCInst and8rr(unsigned int dst, unsigned int src);
+
+llvm::MCInst or8rr(unsigned int dst, unsigned int src);
+
+llvm::MCInst or64rr(unsigned int dst, unsigned int src);
+
+llvm::MCInst shr64ri(unsigned int reg, rword imm);
+
+llvm::MCInst imul64rr(unsigned int dst, unsigned int src);
+
+llvm::MCInst not64r(unsigned int reg);
+
+llvm::MCInst cmove64rr(unsigned int dst, unsigned int src);
+
+llvm::MCInst sete(unsigned int reg);
+
+llvm::MCInst setne(unsigned int reg);
+
+llvm::MCInst setae(unsigned int reg);
+
+llvm::MCInst setb(unsigned int reg);
+
+llvm::MCInst sahf();
+
 llvm::MCInst ret();
 
 // high level layer 2
@@ -75,6 +142,16 @@ RelocatableInst::SharedPtr Mov(Offset offset, Reg reg);
 
 RelocatableInst::SharedPtr Mov(Reg reg, Offset offset);
 
+RelocatableInst::SharedPtr Mov(Offset offset, Constant cst);
+
+RelocatableInst::SharedPtr Movzx8(unsigned int dst, Offset offset);
+
+RelocatableInst::SharedPtr Movzx16(Reg dst, Offset offset);
+
+RelocatableInst::SharedPtr Mov8(unsigned int dst, Offset offset);
+
+RelocatableInst::SharedPtr Cmp(Offset offset, Constant cst);
+
 RelocatableInst::SharedPtr Jmp64m(Offset offset);
 
 RelocatableInst::SharedPtr Fxsave(Offset offset);
@@ -95,6 +172,24 @@ RelocatableInst::SharedPtr Pushf();
 
 RelocatableInst::SharedPtr Popf();
 
+RelocatableInst::SharedPtr Sahf();
+
+RelocatableInst::SharedPtr Shr8(unsigned int reg, Constant cst);
+
+RelocatableInst::SharedPtr And8(unsigned int reg, Constant cst);
+
+RelocatableInst::SharedPtr Add8(unsigned int reg, Constant cst);
+
+RelocatableInst::SharedPtr Jmp8(Constant offset);
+
+RelocatableInst::SharedPtr Ja8(Constant offset);
+
+RelocatableInst::SharedPtr Jb8(Constant offset);
+
+RelocatableInst::SharedPtr Je(Constant offset);
+
+RelocatableInst::SharedPtr Test(Reg src1, Reg src2);
+
 RelocatableInst::SharedPtr Ret();
 
 }
@@ -18,6 +18,12 @@
 #ifndef PATCHGENERATOR_X86_64_H
 #define PATCHGENERATOR_X86_64_H
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "Callback.h"
+
 #include "Patch/X86_64/Layer2_X86_64.h"
 #include "Patch/PatchUtils.h"
 #include "Patch/X86_64/RelocatableInst_X86_64.h"
@@ -139,21 +145,145 @@ public:
     }
 };
 
+class GetStringStart : public PatchGenerator, public AutoAlloc<PatchGenerator, GetStringStart> {
+
+    Temp     temp;
+    unsigned index;
+    Temp     direction;
+    Temp     count;
+    bool     saveFlags;
+
+public:
+
+    /*! Compute the lowest address a string operation will access through one of its index 
+     * registers and copy it in a temporary. Without a REP prefix, or when the direction flag is 
+     * clear, this is the index register value. With a REP prefix and the direction flag set, the 
+     * elements are accessed downward and the start is index - (RCX - 1) * size. The direction flag 
+     * is read from the guest flags, pushed on the guest stack beyond its red zone. The computation 
+     * overwrites the status flags, which are only preserved if saveFlags is set. This 
+     * PatchGenerator is only guaranteed to work before the instruction has been executed.
+     *
+     * @param[in] temp       A temporary where the address will be copied.
+     * @param[in] index      The index register, RSI or RDI.
+     * @param[in] direction  A temporary used to hold the direction flag.
+     * @param[in] count      A temporary used to hold the repetition count.
+     * @param[in] saveFlags  Preserve the guest flags.
+    */
+    GetStringStart(Temp temp, unsigned index, Temp direction, Temp count, bool saveFlags)
+        : temp(temp), index(index), direction(direction), count(count), saveFlags(saveFlags) {}
+
+    /*! Output:
+     *
+     * MOV REG64 temp, REG64 index
+     * if REP prefix:
+     * MOV REG64 count, REG64 RCX
+     * LEA RSP, [RSP - 128]
+     * PUSHFQ
+     * MOV REG64 df, MEM64 [RSP] if saveFlags, POP REG64 df otherwise
+     * (LEA RSP, [RSP + 128]) if not saveFlags
+     * SHR REG64 df, 10
+     * AND REG8 df, 1
+     * MOVZX REG32 df, REG8 df
+     * LEA REG64 count, [count - 1]
+     * IMUL REG64 df, REG64 count
+     * NOT REG64 df
+     * LEA REG64 df, [df + 1]
+     * LEA REG64 temp, [temp + df * size]
+     * (POPFQ ; LEA RSP, [RSP + 128]) if saveFlags
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        Reg dst = temp_manager->getRegForTemp(temp);
+        RelocatableInst::SharedPtrVec patch;
+
+        patch.push_back(NoReloc(mov64rr(dst, index)));
+        // The REP prefixes are merged in the patch, the opcode of a string operation being its 
+        // last byte
+        bool rep = false;
+        for(rword i = 0; i + 1 < instSize; i++) {
+            uint8_t byte = *reinterpret_cast<uint8_t*>(address + i);
+            if(byte == 0xF2 || byte == 0xF3) {
+                rep = true;
+            }
+        }
+        if(rep == false) {
+            return patch;
+        }
+        rword size = std::max(getReadSize(inst), getWriteSize(inst));
+        Reg dfReg = temp_manager->getRegForTemp(direction);
+        Reg countReg = temp_manager->getRegForTemp(count);
+        // If RCX was given to a temporary, its value is in the context
+        bool rcxSaved = false;
+        for(Reg r : temp_manager->getUsedRegisters()) {
+            if(r == llvm::X86::RCX) {
+                patch.push_back(Mov(countReg, Offset(r)));
+                rcxSaved = true;
+            }
+        }
+        if(rcxSaved == false) {
+            patch.push_back(NoReloc(mov64rr(countReg, llvm::X86::RCX)));
+        }
+        patch.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, -128, 0)));
+        patch.push_back(Pushf());
+        if(saveFlags) {
+            patch.push_back(NoReloc(mov64rm(dfReg, Reg(REG_SP), 1, 0, 0, 0)));
+        }
+        else {
+            patch.push_back(Popr(dfReg));
+            patch.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, 128, 0)));
+        }
+        // DF is the bit 10 of EFLAGS
+        unsigned df8 = temp_manager->getSizedSubReg(dfReg, 1);
+        patch.push_back(NoReloc(shr64ri(dfReg, 10)));
+        patch.push_back(NoReloc(and8ri(df8, 1)));
+        patch.push_back(NoReloc(movzx32rr8(temp_manager->getSizedSubReg(dfReg, 4), df8)));
+        patch.push_back(NoReloc(lea(countReg, countReg, 1, 0, -1, 0)));
+        patch.push_back(NoReloc(imul64rr(dfReg, countReg)));
+        patch.push_back(NoReloc(not64r(dfReg)));
+        patch.push_back(NoReloc(lea(dfReg, dfReg, 1, 0, 1, 0)));
+        patch.push_back(NoReloc(lea(dst, dst, size, dfReg, 0, 0)));
+        if(saveFlags) {
+            patch.push_back(Popf());
+            patch.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, 128, 0)));
+        }
+        return patch;
+    }
+};
+
 class GetReadAddress : public PatchGenerator, public AutoAlloc<PatchGenerator, GetReadAddress> {
 
     Temp temp;
+    Temp direction;
+    Temp count;
+    bool saveFlags;
+    bool string;
 
 public:
     
     /*! Resolve the memory address where the instructions will read its value and copy the address in a 
      * temporary. This PatchGenerator is only guaranteed to work before the instruction has been 
-     * executed.
+     * executed. It cannot be used on the string operations.
      *
      * @param[in] temp   A temporary where the memory address will be copied.
     */
-    GetReadAddress(Temp temp) : temp(temp) {}
+    GetReadAddress(Temp temp) : temp(temp), direction(temp), count(temp), saveFlags(true), string(false) {}
+
+    /*! Resolve the memory address where the instructions will read its value and copy the address in a 
+     * temporary, the string operations included. This PatchGenerator is only guaranteed to work 
+     * before the instruction has been executed.
+     *
+     * @param[in] temp       A temporary where the memory address will be copied.
+     * @param[in] direction  A temporary used by GetStringStart to hold the direction flag.
+     * @param[in] count      A temporary used by GetStringStart to hold the repetition count.
+     * @param[in] saveFlags  Preserve the guest flags, which GetStringStart overwrites.
+    */
+    GetReadAddress(Temp temp, Temp direction, Temp count, bool saveFlags = true) 
+        : temp(temp), direction(direction), count(count), saveFlags(saveFlags), string(true) {}
 
     /*! Output:
+     *
+     * if string access:
+     * GetStringStart(temp, RSI (RDI for SCAS), direction, count, saveFlags)
      *
      * if stack access:
      * MOV REG64 temp, REG64 RSP
@@ -165,6 +295,18 @@ public:
         rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
         // Check if this instruction does indeed read something
         if(getReadSize(inst) > 0) {
+            // If it is a string read, return the source index value (the destination one for SCAS)
+            if(isStringAccess(inst)) {
+                RequireAction("GetReadAddress::generate", string && "No temporaries for a string access", abort());
+                unsigned opcode = inst->getOpcode();
+                unsigned src = llvm::X86::RSI;
+                if(opcode == llvm::X86::SCASB || opcode == llvm::X86::SCASW ||
+                   opcode == llvm::X86::SCASL || opcode == llvm::X86::SCASQ) {
+                    src = llvm::X86::RDI;
+                }
+                return GetStringStart(temp, src, direction, count, saveFlags).generate(inst, address, instSize, 
+                                                                                       temp_manager, toMerge);
+            }
             // If it is a stack read, return RSP value
             if(isStackRead(inst)) {
                 return {Mov(temp_manager->getRegForTemp(temp), Reg(REG_SP))};
@@ -217,18 +359,37 @@ public:
 class GetWriteAddress : public PatchGenerator, public AutoAlloc<PatchGenerator, GetWriteAddress> {
 
     Temp temp;
+    Temp direction;
+    Temp count;
+    bool saveFlags;
+    bool string;
 
 public:
     
     /*! Resolve the memory address where the instructions will write its value and copy the address in a 
      * temporary. This PatchGenerator is only guaranteed to work before the instruction has been 
-     * executed.
+     * executed. It cannot be used on the string operations.
      *
      * @param[in] temp   A temporary where the memory address will be copied.
     */
-    GetWriteAddress(Temp temp) : temp(temp) {}
+    GetWriteAddress(Temp temp) : temp(temp), direction(temp), count(temp), saveFlags(true), string(false) {}
+
+    /*! Resolve the memory address where the instructions will write its value and copy the address in a 
+     * temporary, the string operations included. This PatchGenerator is only guaranteed to work 
+     * before the instruction has been executed.
+     *
+     * @param[in] temp       A temporary where the memory address will be copied.
+     * @param[in] direction  A temporary used by GetStringStart to hold the direction flag.
+     * @param[in] count      A temporary used by GetStringStart to hold the repetition count.
+     * @param[in] saveFlags  Preserve the guest flags, which GetStringStart overwrites.
+    */
+    GetWriteAddress(Temp temp, Temp direction, Temp count, bool saveFlags = true) 
+        : temp(temp), direction(direction), count(count), saveFlags(saveFlags), string(true) {}
 
     /*! Output:
+     *
+     * if string access:
+     * GetStringStart(temp, RDI, direction, count, saveFlags)
      *
      * if stack access:
      * MOV REG64 temp, REG64 RSP
@@ -240,6 +401,12 @@ public:
         rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
         // Check if this instruction does indeed read something
         if(getWriteSize(inst) > 0) {
+            // If it is a string write, return the destination index value
+            if(isStringAccess(inst)) {
+                RequireAction("GetWriteAddress::generate", string && "No temporaries for a string access", abort());
+                return GetStringStart(temp, llvm::X86::RDI, direction, count, saveFlags).generate(inst, address, instSize,
+                                                                                                 temp_manager, toMerge);
+            }
             // If it is a stack read, return RSP value
             if(isStackWrite(inst)) {
                 return {Mov(temp_manager->getRegForTemp(temp), Reg(REG_SP))};
@@ -297,7 +464,8 @@ class GetReadValue : public PatchGenerator, public AutoAlloc<PatchGenerator, Get
      
     /*! Resolve the memory address where the instructions will read its value and copy the value in a 
      * temporary. This PatchGenerator is only guaranteed to work before the instruction has been 
-     * executed.
+     * executed. Only the first 8 bytes of a wider access are copied and the value of a string 
+     * operation is not captured (0 is copied instead).
      *
      * @param[in] temp   A temporary where the memory value will be copied.
     */
@@ -305,12 +473,22 @@ class GetReadValue : public PatchGenerator, public AutoAlloc<PatchGenerator, Get
  
     /*! Output:
      *
+     * if string access:
+     * MOV REG64 temp, IMM64 0
+     *
+     * else:
      * MOV REG64 temp, MEM64 val
     */
     RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
          rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
         if(getReadSize(inst) > 0) {
             unsigned size = getReadSize(inst);
+            if(isStringAccess(inst)) {
+                return {Mov(temp_manager->getRegForTemp(temp), Constant(0))};
+            }
+            if(size > 8) {
+                size = 8;
+            }
             unsigned dst = temp_manager->getRegForTemp(temp);
             if(size < 8) {
                 dst = temp_manager->getSizedSubReg(dst, 4);
@@ -326,7 +504,7 @@ class GetReadValue : public PatchGenerator, public AutoAlloc<PatchGenerator, Get
                 else if(size == 2) {
                     readinst = mov32rm16(dst, Reg(REG_SP), 1, 0, 0, 0);
                 }
-                else if(size == 2) {
+                else if(size == 1) {
                     readinst = mov32rm8(dst, Reg(REG_SP), 1, 0, 0, 0);
                 }
                 return {NoReloc(readinst)};
@@ -392,7 +570,8 @@ public:
      
     /*! Resolve the memory address where the instructions has written its value and copy back the value 
      * in a temporary. This PatchGenerator is only guaranteed to work after the instruction has been 
-     * executed.
+     * executed. Only the first 8 bytes of a wider access are copied and the value of a string 
+     * operation is not captured (0 is copied instead).
      *
      * @param[in] temp   A temporary where the memory value will be copied.
     */
@@ -400,12 +579,22 @@ public:
 
     /*! Output:
      *
+     * if string access:
+     * MOV REG64 temp, IMM64 0
+     *
+     * else:
      * MOV REG64 temp, MEM64 val
     */
     RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
          rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
         if(getWriteSize(inst) > 0) {
             unsigned size = getWriteSize(inst);
+            if(isStringAccess(inst)) {
+                return {Mov(temp_manager->getRegForTemp(temp), Constant(0))};
+            }
+            if(size > 8) {
+                size = 8;
+            }
             unsigned dst = temp_manager->getRegForTemp(temp);
             if(size < 8) {
                 dst = temp_manager->getSizedSubReg(dst, 4);
@@ -422,7 +611,7 @@ public:
                 else if(size == 2) {
                     readinst = mov32rm16(dst, Reg(REG_SP), 1, 0, 0, 0);
                 }
-                else if(size == 2) {
+                else if(size == 1) {
                     readinst = mov32rm8(dst, Reg(REG_SP), 1, 0, 0, 0);
                 }
                 return {NoReloc(readinst)};
@@ -480,6 +669,932 @@ public:
 	}
 };
 
+class GetStringLength : public PatchGenerator, public AutoAlloc<PatchGenerator, GetStringLength> {
+
+    Temp temp;
+
+public:
+
+    /*! Compute the number of bytes a string operation will access and copy it in a temporary. 
+     * With a REP prefix this is the remaining count multiplied by the element size, an upper bound 
+     * for REPE / REPNE which may stop earlier. This PatchGenerator is only guaranteed to work before 
+     * the instruction has been executed.
+     *
+     * @param[in] temp   A temporary where the length will be copied.
+    */
+    GetStringLength(Temp temp) : temp(temp) {}
+
+    /*! Output:
+     *
+     * if REP prefix:
+     * LEA REG64 temp, MEM64 [RCX * size]
+     *
+     * else:
+     * MOV REG64 temp, IMM64 size
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        RequireAction("GetStringLength::generate", isStringAccess(inst) && "Called on an instruction which is not a string operation", abort());
+        unsigned size = std::max(getReadSize(inst), getWriteSize(inst));
+        // The REP prefixes are merged in the patch, the opcode of a string operation being its 
+        // last byte
+        bool rep = false;
+        for(rword i = 0; i + 1 < instSize; i++) {
+            uint8_t byte = *reinterpret_cast<uint8_t*>(address + i);
+            if(byte == 0xF2 || byte == 0xF3) {
+                rep = true;
+            }
+        }
+        if(rep == false) {
+            return {Mov(temp_manager->getRegForTemp(temp), Constant(size))};
+        }
+        // If RCX was already given to another temporary, its value is in the context
+        Reg::Vec used = temp_manager->getUsedRegisters();
+        for(Reg r : used) {
+            if(r == llvm::X86::RCX) {
+                Reg dst = temp_manager->getRegForTemp(temp);
+                return {
+                    Mov(dst, Offset(r)),
+                    NoReloc(lea(dst, 0, size, dst, 0, 0))
+                };
+            }
+        }
+        return {NoReloc(lea(temp_manager->getRegForTemp(temp), 0, size, llvm::X86::RCX, 0, 0))};
+    }
+};
+
+class GetWideValue : public PatchGenerator, public AutoAlloc<PatchGenerator, GetWideValue> {
+
+    Temp             temp;
+    Shadow           shadow;
+    MemoryAccessType type;
+
+public:
+
+    /*! Copy the bytes following the first 8 bytes of a read or write access larger than 8 bytes in 
+     * consecutive shadows, 8 bytes per shadow. It completes GetReadValue / GetWriteValue and has the 
+     * same position constraints. Nothing is generated for smaller accesses and string operations.
+     *
+     * @param[in] temp     A temporary used to copy the value.
+     * @param[in] shadow   The shadow tag used to store the value.
+     * @param[in] type     The access to copy, either MEMORY_READ or MEMORY_WRITE.
+    */
+    GetWideValue(Temp temp, Shadow shadow, MemoryAccessType type)
+        : temp(temp), shadow(shadow), type(type) {}
+
+    /*! Output:
+     *
+     * for each following 8 bytes i:
+     * MOV REG64 temp, MEM64 [addr + 8 * i]
+     * MOV MEM64 DataBlock[Shadow(shadow)], REG64 temp
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        unsigned size = (type == MEMORY_READ) ? getReadSize(inst) : getWriteSize(inst);
+        RelocatableInst::SharedPtrVec patch;
+
+        if(size <= 8 || isStringAccess(inst)) {
+            return patch;
+        }
+        for(unsigned i = 0; i + 4 <= inst->getNumOperands(); i++) {
+            if(inst->getOperand(i + 0).isReg() && inst->getOperand(i + 1).isImm() &&
+               inst->getOperand(i + 2).isReg() && inst->getOperand(i + 3).isImm() &&
+               inst->getOperand(i + 4).isReg()) {
+                unsigned base = inst->getOperand(i + 0).getReg();
+                rword scale = inst->getOperand(i + 1).getImm();
+                unsigned offset = inst->getOperand(i + 2).getReg();
+                rword displacement = inst->getOperand(i + 3).getImm();
+                unsigned seg = inst->getOperand(i + 4).getReg();
+                Reg dst = temp_manager->getRegForTemp(temp);
+
+                if(base == Reg(REG_PC)) {
+                    base = temp_manager->getRegForTemp(0xFFFFFFFF);
+                    patch.push_back(Mov(base, Constant(address + instSize)));
+                }
+                for(unsigned j = 8; j < size; j += 8) {
+                    patch.push_back(NoReloc(mov64rm(dst, base, scale, offset, displacement + j, seg)));
+                    append(patch, WriteTemp(temp, shadow).generate(inst, address, instSize, temp_manager, nullptr));
+                }
+                return patch;
+            }
+        }
+        RequireAction("GetWideValue::generate", false && "No memory address found in the instruction", abort());
+    }
+};
+
+class GetMemWatchHit : public PatchGenerator, public AutoAlloc<PatchGenerator, GetMemWatchHit> {
+
+    Temp             hit;
+    Temp             table;
+    MemoryAccessType type;
+    Constant         filter;
+    bool             accumulate;
+    Offset           pending;
+
+public:
+
+    /*! Look up the read or write access address of the instruction in a watch filter, a table of 
+     * 65536 bytes indexed by the bits 16 to 31 of the address, without modifying the guest flags. 
+     * The hit temporary is set to the filter entry, which is not zero if the access could hit a 
+     * watched range. String operations always hit as their range is only known when they are 
+     * executed. It has the same position constraints as GetReadAddress / GetWriteAddress.
+     *
+     * @param[in] hit     A temporary where the filter entry is copied.
+     * @param[in] table   A temporary used to hold the filter address.
+     * @param[in] type    The access to look up, either MEMORY_READ or MEMORY_WRITE. The hit 
+     *                    temporary is zero if the instruction does not make such an access.
+     * @param[in] filter  The address of the watch filter.
+    */
+    GetMemWatchHit(Temp hit, Temp table, MemoryAccessType type, Constant filter)
+        : hit(hit), table(table), type(type), filter(filter), accumulate(false), pending(0) {}
+
+    /*! Same as above, then add the value stored in the data block at the specified offset to the 
+     * hit temporary. This is used to combine the result of an earlier lookup.
+     *
+     * @param[in] hit      A temporary where the filter entry is copied.
+     * @param[in] table    A temporary used to hold the filter address.
+     * @param[in] type     The access to look up, either MEMORY_READ or MEMORY_WRITE.
+     * @param[in] filter   The address of the watch filter.
+     * @param[in] pending  The offset in the data block of the value to add.
+    */
+    GetMemWatchHit(Temp hit, Temp table, MemoryAccessType type, Constant filter, Offset pending)
+        : hit(hit), table(table), type(type), filter(filter), accumulate(true), pending(pending) {}
+
+    /*! Output:
+     *
+     * if no access:
+     * MOV REG64 hit, IMM64 0
+     *
+     * if string access:
+     * MOV REG64 hit, IMM64 1
+     *
+     * else:
+     * GetReadAddress(hit) / GetWriteAddress(hit)
+     * MOV MEM64 DataBlock[watchScratch], REG64 hit
+     * MOVZX REG64 hit, MEM16 DataBlock[watchScratch + 2]
+     * MOV REG64 table, IMM64 filter
+     * MOVZX REG32 hit, MEM8 [table + hit]
+     *
+     * if accumulate:
+     * MOV REG64 table, MEM64 DataBlock[pending]
+     * LEA REG64 hit, [hit + table]
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        unsigned size = (type == MEMORY_READ) ? getReadSize(inst) : getWriteSize(inst);
+        Reg hitReg = temp_manager->getRegForTemp(hit);
+        RelocatableInst::SharedPtrVec patch;
+
+        if(size == 0) {
+            patch.push_back(Mov(hitReg, Constant(0)));
+        }
+        else if(isStringAccess(inst)) {
+            patch.push_back(Mov(hitReg, Constant(1)));
+        }
+        else {
+            Reg tableReg = temp_manager->getRegForTemp(table);
+            Offset scratch(offsetof(Context, hostState.watchScratch));
+
+            if(type == MEMORY_READ) {
+                append(patch, GetReadAddress(hit).generate(inst, address, instSize, temp_manager, nullptr));
+            }
+            else {
+                append(patch, GetWriteAddress(hit).generate(inst, address, instSize, temp_manager, nullptr));
+            }
+            // The index is extracted through memory as shifts and masks would modify the flags
+            patch.push_back(Mov(scratch, hitReg));
+            patch.push_back(Movzx16(hitReg, Offset(scratch + 2)));
+            patch.push_back(Mov(tableReg, filter));
+            patch.push_back(NoReloc(mov32rm8(temp_manager->getSizedSubReg(hitReg, 4), tableReg, 1, hitReg, 0, 0)));
+        }
+        if(accumulate) {
+            Reg tableReg = temp_manager->getRegForTemp(table);
+            patch.push_back(Mov(tableReg, pending));
+            patch.push_back(NoReloc(lea(hitReg, hitReg, 1, tableReg, 0, 0)));
+        }
+        return patch;
+    }
+};
+
+class EvaluatePredicate : public PatchGenerator, public AutoAlloc<PatchGenerator, EvaluatePredicate> {
+
+    Temp                   result;
+    Temp                   source;
+    Temp                   operand;
+    Temp                   clause;
+    std::vector<Predicate> predicate;
+    bool                   saveFlags;
+
+    bool isSatisfiable(const llvm::MCInst* inst, const Predicate& term) {
+        // A memory term on an access the instruction does not make is always false
+        if(term.type == PREDICATE_MEM_IN_RANGE || term.type == PREDICATE_MEM_MASK) {
+            return (term.operand == MEMORY_READ) ? getReadSize(inst) > 0 : getWriteSize(inst) > 0;
+        }
+        return true;
+    }
+
+public:
+
+    /*! Evaluate an inline predicate and set result to 1 if it is true, 0 otherwise. The guest flags
+     * are preserved on the guest stack, beyond its red zone, around the comparisons if they are 
+     * live. The memory 
+     * access addresses are computed as GetReadAddress / GetWriteAddress and have the same position
+     * constraints. The registers already allocated as temporaries are read from the context, which 
+     * is only valid for the rules breaking to the host.
+     *
+     * @param[in] result     A temporary where the predicate value is copied.
+     * @param[in] source     A temporary used to hold the compared register or address.
+     * @param[in] operand    A temporary used to hold the compared constants.
+     * @param[in] clause     A temporary used to hold the value of the current conjunction.
+     * @param[in] predicate  The predicate terms.
+     * @param[in] saveFlags  Preserve the guest flags, which the comparisons overwrite.
+    */
+    EvaluatePredicate(Temp result, Temp source, Temp operand, Temp clause, std::vector<Predicate> predicate,
+                      bool saveFlags)
+        : result(result), source(source), operand(operand), clause(clause), predicate(predicate), 
+          saveFlags(saveFlags) {}
+
+    /*! Output:
+     *
+     * GetReadAddress(source) / GetWriteAddress(source) if used
+     * MOV MEM64 DataBlock[predicateRead / predicateWrite], REG64 source
+     * (LEA RSP, [RSP - 128] ; PUSHFQ) if saveFlags
+     * MOV REG64 result, IMM64 0
+     * for each conjunction:
+     *   MOV REG64 clause, IMM64 1
+     *   for each term:
+     *     MOV REG64 source, register or address
+     *     (MOV REG64 operand, IMM64 mask ; AND REG64 source, REG64 operand)
+     *     MOV REG64 operand, IMM64 value
+     *     CMP REG64 source, REG64 operand
+     *     SETcc REG8 operand
+     *     AND REG8 clause, REG8 operand
+     *     (MOV REG64 operand, IMM64 limit ; CMP ; SETB ; AND for the ranges)
+     *   OR REG8 result, REG8 clause
+     * (POPFQ ; LEA RSP, [RSP + 128]) if saveFlags
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        Reg resultReg = temp_manager->getRegForTemp(result);
+        Reg sourceReg = temp_manager->getRegForTemp(source);
+        Reg operandReg = temp_manager->getRegForTemp(operand);
+        Reg clauseReg = temp_manager->getRegForTemp(clause);
+        Offset readSlot(offsetof(Context, hostState.predicateRead));
+        Offset writeSlot(offsetof(Context, hostState.predicateWrite));
+        RelocatableInst::SharedPtrVec patch;
+        bool useRead = false, useWrite = false;
+
+        for(const Predicate& term : predicate) {
+            if(term.type == PREDICATE_MEM_IN_RANGE || term.type == PREDICATE_MEM_MASK) {
+                if(term.operand == MEMORY_READ && getReadSize(inst) > 0) useRead = true;
+                if(term.operand == MEMORY_WRITE && getWriteSize(inst) > 0) useWrite = true;
+            }
+        }
+        // The addresses are computed before the stack is moved
+        if(useRead) {
+            append(patch, GetReadAddress(source, operand, clause, saveFlags).generate(inst, address, instSize, 
+                                                                                       temp_manager, nullptr));
+            patch.push_back(Mov(readSlot, sourceReg));
+        }
+        if(useWrite) {
+            append(patch, GetWriteAddress(source, operand, clause, saveFlags).generate(inst, address, instSize, 
+                                                                                        temp_manager, nullptr));
+            patch.push_back(Mov(writeSlot, sourceReg));
+        }
+        Reg::Vec usedRegisters = temp_manager->getUsedRegisters();
+
+        if(saveFlags) {
+            patch.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, -128, 0)));
+            patch.push_back(Pushf());
+        }
+        patch.push_back(Mov(resultReg, Constant(0)));
+
+        unsigned operand8 = temp_manager->getSizedSubReg(operandReg, 1);
+        unsigned clause8 = temp_manager->getSizedSubReg(clauseReg, 1);
+        size_t i = 0;
+        while(i < predicate.size()) {
+            // A conjunction extends up to the next PREDICATE_OR term
+            size_t end = i + 1;
+            while(end < predicate.size() && predicate[end].combine == PREDICATE_AND) {
+                end++;
+            }
+            bool satisfiable = true;
+            for(size_t j = i; j < end; j++) {
+                satisfiable = satisfiable && isSatisfiable(inst, predicate[j]);
+            }
+            if(satisfiable == false) {
+                i = end;
+                continue;
+            }
+
+            patch.push_back(Mov(clauseReg, Constant(1)));
+            for(size_t j = i; j < end; j++) {
+                const Predicate& term = predicate[j];
+
+                if(term.type == PREDICATE_MEM_IN_RANGE || term.type == PREDICATE_MEM_MASK) {
+                    patch.push_back(Mov(sourceReg, (term.operand == MEMORY_READ) ? readSlot : writeSlot));
+                }
+                else if(term.operand == REG_SP) {
+                    // Skip the red zone and the saved flags
+                    patch.push_back(NoReloc(lea(sourceReg, Reg(REG_SP), 1, 0, saveFlags ? 136 : 0, 0)));
+                }
+                else if(std::find_if(usedRegisters.begin(), usedRegisters.end(), [&term](Reg r) {
+                            return r.id == term.operand;
+                        }) != usedRegisters.end()) {
+                    patch.push_back(Mov(sourceReg, Offset(Reg(term.operand))));
+                }
+                else {
+                    patch.push_back(Mov(sourceReg, Reg(term.operand)));
+                }
+
+                if(term.type == PREDICATE_REG_IN_RANGE || term.type == PREDICATE_MEM_IN_RANGE) {
+                    patch.push_back(Mov(operandReg, Constant(term.value)));
+                    patch.push_back(NoReloc(cmp64rr(sourceReg, operandReg)));
+                    patch.push_back(NoReloc(setae(operand8)));
+                    patch.push_back(NoReloc(and8rr(clause8, operand8)));
+                    patch.push_back(Mov(operandReg, Constant(term.limit)));
+                    patch.push_back(NoReloc(cmp64rr(sourceReg, operandReg)));
+                    patch.push_back(NoReloc(setb(operand8)));
+                    patch.push_back(NoReloc(and8rr(clause8, operand8)));
+                }
+                else {
+                    if(term.mask != (rword) -1) {
+                        patch.push_back(Mov(operandReg, Constant(term.mask)));
+                        patch.push_back(NoReloc(and64rr(sourceReg, operandReg)));
+                    }
+                    patch.push_back(Mov(operandReg, Constant(term.value)));
+                    patch.push_back(NoReloc(cmp64rr(sourceReg, operandReg)));
+                    if(term.type == PREDICATE_REG_NOT_EQUAL) {
+                        patch.push_back(NoReloc(setne(operand8)));
+                    }
+                    else {
+                        patch.push_back(NoReloc(sete(operand8)));
+                    }
+                    patch.push_back(NoReloc(and8rr(clause8, operand8)));
+                }
+            }
+            patch.push_back(NoReloc(or8rr(temp_manager->getSizedSubReg(resultReg, 1), clause8)));
+            i = end;
+        }
+
+        if(saveFlags) {
+            patch.push_back(Popf());
+            patch.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, 128, 0)));
+        }
+        return patch;
+    }
+};
+
+class DecrementCountdown : public PatchGenerator, public AutoAlloc<PatchGenerator, DecrementCountdown> {
+
+    Temp     result;
+    Temp     addr;
+    Temp     value;
+    Constant countdown;
+    rword    decrement;
+    bool     conditional;
+    Constant previous;
+
+public:
+
+    /*! Decrement a countdown in memory and set result to a non zero value when it goes below 
+     * zero, without modifying the guest flags. The countdown is not reloaded, this is left to the 
+     * callback the result guards.
+     *
+     * @param[in] result       A temporary where the countdown state is copied. If conditional,
+     *                         it holds on input the 0 or 1 value of a previous filter.
+     * @param[in] addr         A temporary used to hold the countdown address.
+     * @param[in] value        A temporary used to hold the countdown value.
+     * @param[in] countdown    The address of the 64 bits signed countdown.
+     * @param[in] decrement    The value subtracted from the countdown.
+     * @param[in] conditional  Subtract the input value of result instead of decrement.
+     * @param[in] previous     If not 0, the address where the countdown value before the 
+     *                         decrement is stored. Only used when not conditional.
+    */
+    DecrementCountdown(Temp result, Temp addr, Temp value, Constant countdown, rword decrement,
+                       bool conditional = false, Constant previous = Constant(0))
+        : result(result), addr(addr), value(value), countdown(countdown), decrement(decrement),
+          conditional(conditional), previous(previous) {}
+
+    /*! Output:
+     *
+     * MOV REG64 addr, IMM64 countdown
+     * MOV REG64 value, MEM64 [addr]
+     * If conditional:
+     *   NOT REG64 result
+     *   LEA REG64 value, [value + result + 1]
+     * Else:
+     *   (MOV REG64 result, IMM64 previous ; MOV MEM64 [result], REG64 value) if previous
+     *   LEA REG64 value, [value - decrement]
+     * MOV MEM64 [addr], REG64 value
+     * MOVZX REG32 result, MEM8 [addr + 7]
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        Reg resultReg = temp_manager->getRegForTemp(result);
+        Reg addrReg = temp_manager->getRegForTemp(addr);
+        Reg valueReg = temp_manager->getRegForTemp(value);
+        RelocatableInst::SharedPtrVec patch;
+
+        patch.push_back(Mov(addrReg, countdown));
+        patch.push_back(NoReloc(mov64rm(valueReg, addrReg, 1, 0, 0, 0)));
+        if(conditional) {
+            // value - result computed as value + ~result + 1, NOT and LEA leave the flags untouched
+            patch.push_back(NoReloc(not64r(resultReg)));
+            patch.push_back(NoReloc(lea(valueReg, valueReg, 1, resultReg, 1, 0)));
+        }
+        else {
+            // result is only written at the end
+            if(previous != 0) {
+                patch.push_back(Mov(resultReg, previous));
+                patch.push_back(NoReloc(mov64mr(resultReg, 1, 0, 0, 0, valueReg)));
+            }
+            patch.push_back(NoReloc(lea(valueReg, valueReg, 1, 0, -decrement, 0)));
+        }
+        patch.push_back(NoReloc(mov64mr(addrReg, 1, 0, 0, 0, valueReg)));
+        // The sign byte is not zero once the countdown is negative
+        patch.push_back(NoReloc(mov32rm8(temp_manager->getSizedSubReg(resultReg, 4), addrReg, 1, 0, 7, 0)));
+        return patch;
+    }
+};
+
+class ReadGuard : public PatchGenerator, public AutoAlloc<PatchGenerator, ReadGuard> {
+
+    Temp     result;
+    Temp     addr;
+    Constant guard;
+    bool     conditional;
+
+public:
+
+    /*! Gate the value of a filter with a runtime switch, without modifying the guest flags. The 
+     * switch is a word pointing either to the word following it, or to a zero word. When 
+     * conditional, the input value of result is stored in that following word before being read 
+     * back through the switch, else the following word is expected to hold a constant non zero 
+     * value.
+     *
+     * @param[in] result       A temporary where the gated value is copied. If conditional, it
+     *                         holds on input the value of a previous filter.
+     * @param[in] addr         A temporary used to hold the switch address.
+     * @param[in] guard        The address of the switch.
+     * @param[in] conditional  Gate the input value of result instead of a constant.
+    */
+    ReadGuard(Temp result, Temp addr, Constant guard, bool conditional = false)
+        : result(result), addr(addr), guard(guard), conditional(conditional) {}
+
+    /*! Output:
+     *
+     * MOV REG64 addr, IMM64 guard
+     * If conditional:
+     *   MOV MEM64 [addr + 8], REG64 result
+     * MOV REG64 addr, MEM64 [addr]
+     * MOV REG64 result, MEM64 [addr]
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        Reg resultReg = temp_manager->getRegForTemp(result);
+        Reg addrReg = temp_manager->getRegForTemp(addr);
+        RelocatableInst::SharedPtrVec patch;
+
+        patch.push_back(Mov(addrReg, guard));
+        if(conditional) {
+            patch.push_back(NoReloc(mov64mr(addrReg, 1, 0, sizeof(rword), 0, resultReg)));
+        }
+        // Selecting through a pointer instead of testing a flag leaves the guest flags untouched
+        patch.push_back(NoReloc(mov64rm(addrReg, addrReg, 1, 0, 0, 0)));
+        patch.push_back(NoReloc(mov64rm(resultReg, addrReg, 1, 0, 0, 0)));
+        return patch;
+    }
+};
+
+class ProfileBranch : public PatchGenerator, public AutoAlloc<PatchGenerator, ProfileBranch> {
+
+    Temp     result;
+    Temp     target;
+    Temp     addr;
+    Temp     index;
+    Constant site;
+    rword    entries;
+    bool     saveFlags;
+
+public:
+
+    /*! Count an execution of an indirect branch site whose target has already been written to
+     * the context PC. The site starts with a table of entries + 1 targets followed by as many 
+     * execution counts. The target is looked up in the table and its count incremented, a target 
+     * which is not found takes the first free entry. When the table is full, the last target and 
+     * count are used as scratch and the target is left to the host.
+     *
+     * @param[in] result     A temporary set to a non zero value if the table is full and the 
+     *                       target is not in it, else to zero.
+     * @param[in] target     A temporary used to hold the target.
+     * @param[in] addr       A temporary used to hold the site address.
+     * @param[in] index      A temporary used to hold the index of the entry.
+     * @param[in] site       The address of the site profile.
+     * @param[in] entries    The number of entries of the table.
+     * @param[in] saveFlags  Whether the guest flags are live and need to be saved around the 
+     *                       compares.
+    */
+    ProfileBranch(Temp result, Temp target, Temp addr, Temp index, Constant site, rword entries,
+                  bool saveFlags)
+        : result(result), target(target), addr(addr), index(index), site(site), entries(entries),
+          saveFlags(saveFlags) {}
+
+    /*! Output:
+     *
+     * MOV REG64 target, MEM64 DataBlock[Offset(PC)]
+     * MOV REG64 addr, IMM64 site
+     * If saveFlags:
+     *   LEA RSP, [RSP - 128]
+     *   PUSHFQ
+     * MOV REG64 index, IMM64 entries
+     * For i from entries - 1 to 0:
+     *   CMP MEM64 [addr + 8 * i], IMM8 0
+     *   MOV REG64 result, IMM64 i
+     *   CMOVE REG64 index, REG64 result
+     *   MOV REG64 result, MEM64 [addr + 8 * i]
+     *   CMP REG64 result, REG64 target
+     *   MOV REG64 result, IMM64 i
+     *   CMOVE REG64 index, REG64 result
+     * MOV MEM64 [addr + 8 * index], REG64 target
+     * MOV REG64 result, MEM64 [addr + 8 * (entries + 1) + 8 * index]
+     * LEA REG64 result, [result + 1]
+     * MOV MEM64 [addr + 8 * (entries + 1) + 8 * index], REG64 result
+     * MOV REG64 result, IMM64 entries
+     * CMP REG64 index, REG64 result
+     * SETE REG8 result
+     * MOVZX REG32 result, REG8 result
+     * If saveFlags:
+     *   POPFQ
+     *   LEA RSP, [RSP + 128]
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        Reg resultReg = temp_manager->getRegForTemp(result);
+        Reg targetReg = temp_manager->getRegForTemp(target);
+        Reg addrReg = temp_manager->getRegForTemp(addr);
+        Reg indexReg = temp_manager->getRegForTemp(index);
+        unsigned result8 = temp_manager->getSizedSubReg(resultReg, 1);
+        rword counts = sizeof(rword) * (entries + 1);
+        RelocatableInst::SharedPtrVec patch;
+
+        patch.push_back(Mov(targetReg, Offset(Reg(REG_PC))));
+        patch.push_back(Mov(addrReg, site));
+        if(saveFlags) {
+            patch.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, -128, 0)));
+            patch.push_back(Pushf());
+        }
+        // The entries are filled in order and never freed, walking them backward leaves the index 
+        // of the target if present, else of the first free entry, else of the scratch entry
+        patch.push_back(Mov(indexReg, Constant(entries)));
+        for(rword i = entries; i-- > 0;) {
+            patch.push_back(NoReloc(cmp64mi(addrReg, 1, 0, sizeof(rword) * i, 0, 0)));
+            patch.push_back(Mov(resultReg, Constant(i)));
+            patch.push_back(NoReloc(cmove64rr(indexReg, resultReg)));
+            patch.push_back(NoReloc(mov64rm(resultReg, addrReg, 1, 0, sizeof(rword) * i, 0)));
+            patch.push_back(NoReloc(cmp64rr(resultReg, targetReg)));
+            patch.push_back(Mov(resultReg, Constant(i)));
+            patch.push_back(NoReloc(cmove64rr(indexReg, resultReg)));
+        }
+        patch.push_back(NoReloc(mov64mr(addrReg, sizeof(rword), indexReg, 0, 0, targetReg)));
+        patch.push_back(NoReloc(mov64rm(resultReg, addrReg, sizeof(rword), indexReg, counts, 0)));
+        patch.push_back(NoReloc(lea(resultReg, resultReg, 1, 0, 1, 0)));
+        patch.push_back(NoReloc(mov64mr(addrReg, sizeof(rword), indexReg, counts, 0, resultReg)));
+        patch.push_back(Mov(resultReg, Constant(entries)));
+        patch.push_back(NoReloc(cmp64rr(indexReg, resultReg)));
+        patch.push_back(NoReloc(sete(result8)));
+        patch.push_back(NoReloc(movzx32rr8(temp_manager->getSizedSubReg(resultReg, 4), result8)));
+        if(saveFlags) {
+            patch.push_back(Popf());
+            patch.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, 128, 0)));
+        }
+        return patch;
+    }
+};
+
+class RecordSyscall : public PatchGenerator, public AutoAlloc<PatchGenerator, RecordSyscall> {
+
+    Temp     cursor;
+    Temp     addr;
+    Temp     value;
+    Constant ring;
+    bool     exit;
+
+public:
+
+    /*! Record a syscall in a ring buffer of SyscallRecord. The ring is five words: the cursor, 
+     * the last record written, the number of records ever written and the start and end of the 
+     * buffer. Before the syscall, the number and arguments are written at the cursor with a zero 
+     * return value and the cursor is advanced, wrapping at the end of the buffer, so that the 
+     * syscalls which do not return are also recorded. After it, the return value is written in 
+     * the last record. The guest flags are preserved on the guest stack, beyond its red zone, 
+     * around the wrapping.
+     *
+     * @param[in] cursor  A temporary used to hold the cursor.
+     * @param[in] addr    A temporary used to hold the ring address.
+     * @param[in] value   A temporary used to load the guest registers allocated as temporaries 
+     *                    and the ring words.
+     * @param[in] ring    The address of the ring.
+     * @param[in] exit    Record the return value instead of the number and arguments.
+    */
+    RecordSyscall(Temp cursor, Temp addr, Temp value, Constant ring, bool exit)
+        : cursor(cursor), addr(addr), value(value), ring(ring), exit(exit) {}
+
+    /*! Output:
+     *
+     * MOV REG64 addr, IMM64 ring
+     * If exit:
+     *   MOV REG64 cursor, MEM64 [addr + 8]
+     *   MOV MEM64 [cursor + 56], REG64 RAX
+     * Else:
+     *   MOV REG64 cursor, MEM64 [addr]
+     *   MOV MEM64 [addr + 8], REG64 cursor
+     *   For each of RAX, RDI, RSI, RDX, R10, R8 and R9:
+     *     MOV MEM64 [cursor + 8 * i], REG64 reg
+     *   MOV MEM64 [cursor + 56], IMM32 0
+     *   LEA REG64 cursor, [cursor + 64]
+     *   LEA RSP, [RSP - 128]
+     *   PUSHFQ
+     *   MOV REG64 value, MEM64 [addr + 32]
+     *   CMP REG64 cursor, REG64 value
+     *   MOV REG64 value, MEM64 [addr + 24]
+     *   CMOVE REG64 cursor, REG64 value
+     *   POPFQ
+     *   LEA RSP, [RSP + 128]
+     *   MOV MEM64 [addr], REG64 cursor
+     *   MOV REG64 value, MEM64 [addr + 16]
+     *   LEA REG64 value, [value + 1]
+     *   MOV MEM64 [addr + 16], REG64 value
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        // Syscall number and arguments registers, in the GPRState order
+        static const unsigned int SYSCALL_REGS[] = {0, 5, 4, 3, 8, 6, 7};
+        Reg cursorReg = temp_manager->getRegForTemp(cursor);
+        Reg addrReg = temp_manager->getRegForTemp(addr);
+        RelocatableInst::SharedPtrVec patch;
+
+        patch.push_back(Mov(addrReg, ring));
+        // RAX is never allocated as a temporary
+        if(exit) {
+            patch.push_back(NoReloc(mov64rm(cursorReg, addrReg, 1, 0, sizeof(rword), 0)));
+            patch.push_back(NoReloc(mov64mr(cursorReg, 1, 0, offsetof(SyscallRecord, ret), 0, Reg(0))));
+            return patch;
+        }
+        Reg valueReg = temp_manager->getRegForTemp(value);
+        patch.push_back(NoReloc(mov64rm(cursorReg, addrReg, 1, 0, 0, 0)));
+        patch.push_back(NoReloc(mov64mr(addrReg, 1, 0, sizeof(rword), 0, cursorReg)));
+        for(size_t i = 0; i < sizeof(SYSCALL_REGS) / sizeof(unsigned int); i++) {
+            Reg src(SYSCALL_REGS[i]);
+            // The guest value of a register allocated as a temporary was saved in the context
+            if(src.id == cursorReg.id || src.id == addrReg.id || src.id == valueReg.id) {
+                patch.push_back(Mov(valueReg, Offset(src)));
+                src = valueReg;
+            }
+            patch.push_back(NoReloc(mov64mr(cursorReg, 1, 0, i * sizeof(rword), 0, src)));
+        }
+        patch.push_back(NoReloc(mov64mi(cursorReg, 1, 0, offsetof(SyscallRecord, ret), 0, 0)));
+        patch.push_back(NoReloc(lea(cursorReg, cursorReg, 1, 0, sizeof(SyscallRecord), 0)));
+        patch.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, -128, 0)));
+        patch.push_back(Pushf());
+        patch.push_back(NoReloc(mov64rm(valueReg, addrReg, 1, 0, 4 * sizeof(rword), 0)));
+        patch.push_back(NoReloc(cmp64rr(cursorReg, valueReg)));
+        patch.push_back(NoReloc(mov64rm(valueReg, addrReg, 1, 0, 3 * sizeof(rword), 0)));
+        patch.push_back(NoReloc(cmove64rr(cursorReg, valueReg)));
+        patch.push_back(Popf());
+        patch.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, 128, 0)));
+        patch.push_back(NoReloc(mov64mr(addrReg, 1, 0, 0, 0, cursorReg)));
+        patch.push_back(NoReloc(mov64rm(valueReg, addrReg, 1, 0, 2 * sizeof(rword), 0)));
+        patch.push_back(NoReloc(lea(valueReg, valueReg, 1, 0, 1, 0)));
+        patch.push_back(NoReloc(mov64mr(addrReg, 1, 0, 2 * sizeof(rword), 0, valueReg)));
+        return patch;
+    }
+};
+
+class PropagateTaint : public PatchGenerator, public AutoAlloc<PatchGenerator, PropagateTaint> {
+
+    Temp     value;
+    Temp     scratch;
+    Temp     labels;
+    Temp     readShadow;
+    Temp     writeShadow;
+    Constant registers;
+    Constant shadow;
+    Constant mask;
+    bool     saveFlags;
+
+    static bool isSimpleSize(unsigned size) {
+        return size == 1 || size == 2 || size == 4 || size == 8;
+    }
+
+    /* Load the labels of size bytes at base + offset in the low bytes of dst, zero extended. */
+    void loadLabels(RelocatableInst::SharedPtrVec& patch, Reg dst, Reg base, rword offset, unsigned size,
+                    TempManager *temp_manager) {
+        unsigned dst32 = temp_manager->getSizedSubReg(dst, 4);
+        switch(size) {
+            case 1: patch.push_back(NoReloc(mov32rm8(dst32, base, 1, 0, offset, 0))); break;
+            case 2: patch.push_back(NoReloc(mov32rm16(dst32, base, 1, 0, offset, 0))); break;
+            case 4: patch.push_back(NoReloc(mov32rm(dst32, base, 1, 0, offset, 0))); break;
+            default: patch.push_back(NoReloc(mov64rm(dst, base, 1, 0, offset, 0))); break;
+        }
+    }
+
+    /* Store the size low bytes of src at base + offset. */
+    void storeLabels(RelocatableInst::SharedPtrVec& patch, Reg src, Reg base, rword offset, unsigned size,
+                     TempManager *temp_manager) {
+        switch(size) {
+            case 1: patch.push_back(NoReloc(mov8mr(base, 1, 0, offset, 0, temp_manager->getSizedSubReg(src, 1)))); break;
+            case 2: patch.push_back(NoReloc(mov16mr(base, 1, 0, offset, 0, temp_manager->getSizedSubReg(src, 2)))); break;
+            case 4: patch.push_back(NoReloc(mov32mr(base, 1, 0, offset, 0, temp_manager->getSizedSubReg(src, 4)))); break;
+            default: patch.push_back(NoReloc(mov64mr(base, 1, 0, offset, 0, src))); break;
+        }
+    }
+
+    /* Split an access in 8, 4, 2 and 1 bytes parts. */
+    static std::vector<std::pair<rword, unsigned>> splitAccess(unsigned size) {
+        std::vector<std::pair<rword, unsigned>> parts;
+        rword offset = 0;
+        for(unsigned part = 8; part > 0; part >>= 1) {
+            while(size - offset >= part) {
+                parts.push_back(std::make_pair(offset, part));
+                offset += part;
+            }
+        }
+        return parts;
+    }
+
+public:
+
+    /*! Propagate the taint labels through an instruction, before it is executed. The labels of the 
+     * general purpose registers are kept as one byte per register byte and those of the vector 
+     * registers as one byte per 8 bytes lane, such that a write to a part of a register keeps the 
+     * labels of the other part unless the instruction zeroes it. The memory labels are kept one byte per 
+     * guest byte in a direct mapped shadow indexed by (address & mask). The result bytes of the 
+     * instructions which are not bytewise take the union of all the source labels. The guest flags 
+     * are preserved on the guest stack, beyond its red zone, around the propagation if they are 
+     * live. String 
+     * operations, control flow and instructions without a register or memory result are left 
+     * untouched.
+     *
+     * @param[in] value        A temporary used to hold the propagated labels.
+     * @param[in] scratch      A temporary used to hold intermediate labels.
+     * @param[in] labels       A temporary used to hold the address of the register labels.
+     * @param[in] readShadow   A temporary used to hold the shadow address of the read access.
+     * @param[in] writeShadow  A temporary used to hold the shadow address of the write access.
+     * @param[in] registers    The address of the register labels.
+     * @param[in] shadow       The address of the memory shadow.
+     * @param[in] mask         The mask applied to the guest addresses to index the shadow.
+     * @param[in] saveFlags    Preserve the guest flags, which the propagation overwrites.
+    */
+    PropagateTaint(Temp value, Temp scratch, Temp labels, Temp readShadow, Temp writeShadow,
+                   Constant registers, Constant shadow, Constant mask, bool saveFlags)
+        : value(value), scratch(scratch), labels(labels), readShadow(readShadow), writeShadow(writeShadow),
+          registers(registers), shadow(shadow), mask(mask), saveFlags(saveFlags) {}
+
+    /*! Output:
+     *
+     * (GetReadAddress) readShadow
+     * (GetWriteAddress / LEA REG64 writeShadow, [RSP - size] for stack writes) writeShadow
+     * (LEA RSP, [RSP - 128] ; PUSHFQ) if saveFlags
+     * MOV REG64 labels, IMM64 registers
+     * (MOV REG64 scratch, IMM64 mask ; AND REG64 shadow, REG64 scratch 
+     *  MOV REG64 scratch, IMM64 shadow ; LEA REG64 shadow, [shadow + scratch]) for each access
+     * MOV REG64 value, IMM64 0
+     * for each source register and the read access:
+     *   MOV REG scratch, MEM [labels + slot] / [readShadow]
+     *   OR REG64 value, REG64 scratch
+     * if not bytewise: OR the bytes of value together and repeat the result in every byte
+     * for each destination register and the write access:
+     *   (MOV REG64 scratch, IMM64 lanes ; AND REG64 scratch, REG64 value) for a zeroing vector write
+     *   MOV MEM [labels + slot] / [writeShadow], REG value / scratch
+     * (POPFQ ; LEA RSP, [RSP + 128]) if saveFlags
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        TaintFlow flow;
+        if(getTaintFlow(inst, temp_manager->getMCII(), temp_manager->getMRI(), flow) == false) {
+            return {};
+        }
+        unsigned readSize = flow.clear ? 0 : getReadSize(inst);
+        unsigned writeSize = getWriteSize(inst);
+        if(flow.destinations.empty() && writeSize == 0) {
+            return {};
+        }
+
+        RelocatableInst::SharedPtrVec patch;
+        Reg valueReg = temp_manager->getRegForTemp(value);
+        Reg scratchReg = temp_manager->getRegForTemp(scratch);
+        Reg labelsReg = temp_manager->getRegForTemp(labels);
+        bool smear = (flow.bytewise == false) || (readSize > 0 && !isSimpleSize(readSize)) || 
+                     (writeSize > 0 && !isSimpleSize(writeSize));
+
+        // The addresses are computed before the stack is moved
+        if(readSize > 0) {
+            append(patch, GetReadAddress(readShadow).generate(inst, address, instSize, temp_manager, nullptr));
+        }
+        if(writeSize > 0) {
+            if(isStackWrite(inst)) {
+                patch.push_back(NoReloc(lea(temp_manager->getRegForTemp(writeShadow), Reg(REG_SP), 1, 0, 
+                                            -((int64_t) writeSize), 0)));
+            }
+            else {
+                append(patch, GetWriteAddress(writeShadow).generate(inst, address, instSize, temp_manager, nullptr));
+            }
+        }
+        if(saveFlags) {
+            patch.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, -128, 0)));
+            patch.push_back(Pushf());
+        }
+        patch.push_back(Mov(labelsReg, registers));
+        std::vector<Reg> accesses;
+        if(readSize > 0) {
+            accesses.push_back(temp_manager->getRegForTemp(readShadow));
+        }
+        if(writeSize > 0) {
+            accesses.push_back(temp_manager->getRegForTemp(writeShadow));
+        }
+        for(Reg shadowReg : accesses) {
+            patch.push_back(Mov(scratchReg, mask));
+            patch.push_back(NoReloc(and64rr(shadowReg, scratchReg)));
+            patch.push_back(Mov(scratchReg, shadow));
+            patch.push_back(NoReloc(lea(shadowReg, shadowReg, 1, scratchReg, 0, 0)));
+        }
+
+        // Union of the source labels
+        patch.push_back(Mov(valueReg, Constant(0)));
+        if(flow.clear == false) {
+            for(const TaintOperand& src : flow.sources) {
+                // A vector register has one label per 8 bytes lane
+                bool vector = src.slot >= NUM_GPR;
+                if(vector) {
+                    smear = true;
+                }
+                loadLabels(patch, scratchReg, labelsReg, src.slot * sizeof(rword) + src.offset, 
+                           vector ? src.size / 8 : src.size, temp_manager);
+                patch.push_back(NoReloc(or64rr(valueReg, scratchReg)));
+            }
+            if(readSize > 0) {
+                Reg readReg = temp_manager->getRegForTemp(readShadow);
+                for(const std::pair<rword, unsigned>& part : splitAccess(readSize)) {
+                    loadLabels(patch, scratchReg, readReg, part.first, part.second, temp_manager);
+                    patch.push_back(NoReloc(or64rr(valueReg, scratchReg)));
+                }
+            }
+        }
+        for(const TaintOperand& dst : flow.destinations) {
+            if(dst.slot >= NUM_GPR) {
+                smear = true;
+            }
+        }
+        if(smear && flow.clear == false) {
+            for(rword shift : {32, 16, 8}) {
+                patch.push_back(Mov(scratchReg, valueReg));
+                patch.push_back(NoReloc(shr64ri(scratchReg, shift)));
+                patch.push_back(NoReloc(or64rr(valueReg, scratchReg)));
+            }
+            patch.push_back(NoReloc(movzx32rr8(temp_manager->getSizedSubReg(valueReg, 4),
+                                               temp_manager->getSizedSubReg(valueReg, 1))));
+            patch.push_back(Mov(scratchReg, Constant(0x0101010101010101)));
+            patch.push_back(NoReloc(imul64rr(valueReg, scratchReg)));
+        }
+
+        // Results, a 32 bits register write clears the upper half and a VEX or EVEX vector write 
+        // clears the lanes above the register, the other partial writes keep the labels of the 
+        // bytes they do not write
+        for(const TaintOperand& dst : flow.destinations) {
+            rword offset = dst.slot * sizeof(rword) + dst.offset;
+            if(dst.slot >= NUM_GPR && flow.zeroUpper && dst.size < 64) {
+                patch.push_back(Mov(scratchReg, Constant(((rword) 1 << (8 * (dst.size / 8))) - 1)));
+                patch.push_back(NoReloc(and64rr(scratchReg, valueReg)));
+                storeLabels(patch, scratchReg, labelsReg, offset, sizeof(rword), temp_manager);
+            }
+            else if(dst.slot >= NUM_GPR) {
+                storeLabels(patch, valueReg, labelsReg, offset, dst.size / 8, temp_manager);
+            }
+            else if(dst.size == 4) {
+                patch.push_back(NoReloc(mov32rr(temp_manager->getSizedSubReg(scratchReg, 4),
+                                                temp_manager->getSizedSubReg(valueReg, 4))));
+                storeLabels(patch, scratchReg, labelsReg, offset, sizeof(rword), temp_manager);
+            }
+            else {
+                storeLabels(patch, valueReg, labelsReg, offset, dst.size, temp_manager);
+            }
+        }
+        if(writeSize > 0) {
+            Reg writeReg = temp_manager->getRegForTemp(writeShadow);
+            for(const std::pair<rword, unsigned>& part : splitAccess(writeSize)) {
+                storeLabels(patch, valueReg, writeReg, part.first, part.second, temp_manager);
+            }
+        }
+
+        if(saveFlags) {
+            patch.push_back(Popf());
+            patch.push_back(NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, 128, 0)));
+        }
+        return patch;
+    }
+};
+
 class CopyReg : public PatchGenerator, public AutoAlloc<PatchGenerator, CopyReg> {
     Temp dst;
     Reg src;
@@ -528,6 +1643,232 @@ public:
     }
 };
 
+class IncrementCounter : public PatchGenerator, public AutoAlloc<PatchGenerator, IncrementCounter> {
+
+    Temp     addr;
+    Temp     value;
+    Constant counter;
+    bool     atomic;
+
+public:
+
+    /*! Increment a 64 bits counter in memory without modifying the guest flags.
+     *
+     * @param[in] addr     A temporary used to hold the counter address.
+     * @param[in] value    A temporary used to hold the counter value (unused if atomic).
+     * @param[in] counter  The address of the counter.
+     * @param[in] atomic   Use a locked increment, which requires the flags to be saved on the 
+     *                     guest stack.
+    */
+    IncrementCounter(Temp addr, Temp value, Constant counter, bool atomic)
+        : addr(addr), value(value), counter(counter), atomic(atomic) {}
+
+    /*! Output:
+     *
+     * If not atomic:
+     * MOV REG64 addr, IMM64 counter
+     * MOV REG64 value, MEM64 [addr]
+     * LEA REG64 value, [value + 1]
+     * MOV MEM64 [addr], REG64 value
+     *
+     * If atomic:
+     * MOV REG64 addr, IMM64 counter
+     * LEA RSP, [RSP - 128]
+     * PUSHFQ
+     * LOCK ADD MEM64 [addr], IMM8 1
+     * POPFQ
+     * LEA RSP, [RSP + 128]
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        Reg addrReg = temp_manager->getRegForTemp(addr);
+
+        if(atomic) {
+            // The guest red zone must be skipped before using its stack
+            return {
+                Mov(addrReg, counter),
+                NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, -128, 0)),
+                Pushf(),
+                NoReloc(lockadd64mi(addrReg, 1, 0, 0, 0, 1)),
+                Popf(),
+                NoReloc(lea(Reg(REG_SP), Reg(REG_SP), 1, 0, 128, 0)),
+            };
+        }
+        else {
+            Reg valueReg = temp_manager->getRegForTemp(value);
+            return {
+                Mov(addrReg, counter),
+                NoReloc(mov64rm(valueReg, addrReg, 1, 0, 0, 0)),
+                Add(valueReg, Constant(1)),
+                NoReloc(mov64mr(addrReg, 1, 0, 0, 0, valueReg)),
+            };
+        }
+    }
+};
+
+class EdgeCoverage : public PatchGenerator, public AutoAlloc<PatchGenerator, EdgeCoverage> {
+
+    Temp     location;
+    Temp     value;
+    Constant state;
+    Constant bitmap;
+    Constant mask;
+
+public:
+
+    /*! Increment the bitmap entry of the edge going from the previous location to the current 
+     * location, AFL style, without modifying the guest flags. The previous location is kept in 
+     * memory as a pointer to bitmap + (previous >> 1) such that the edge index is an addition 
+     * computed by the addressing mode instead of a xor. The current location is hashed within 
+     * half of the bitmap for this addition to stay in bounds.
+     *
+     * @param[in] location  A temporary used to hold the previous location pointer.
+     * @param[in] value     A temporary used to hold the bitmap entry.
+     * @param[in] state     The address where the previous location pointer is stored.
+     * @param[in] bitmap    The address of the coverage bitmap.
+     * @param[in] mask      The size of the bitmap minus one (the size being a power of two).
+    */
+    EdgeCoverage(Temp location, Temp value, Constant state, Constant bitmap, Constant mask)
+        : location(location), value(value), state(state), bitmap(bitmap), mask(mask) {}
+
+    /*! Output:
+     *
+     * MOV REG64 location, IMM64 state
+     * MOV REG64 location, MEM64 [location]
+     * MOVZX REG32 value, MEM8 [location + (hash & (mask >> 1))]
+     * LEA REG64 value, [value + 1]
+     * MOV MEM8 [location + (hash & (mask >> 1))], REG8 value
+     * MOV REG64 location, IMM64 state
+     * MOV REG64 value, IMM64 (bitmap + ((hash & mask) >> 1))
+     * MOV MEM64 [location], REG64 value
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        Reg locationReg = temp_manager->getRegForTemp(location);
+        Reg valueReg = temp_manager->getRegForTemp(value);
+        // Same location hash as the AFL QEMU mode, computed at translation time
+        rword hash = (address >> 4) ^ (address << 8);
+        rword current = hash & (mask >> 1);
+        rword previous = (hash & mask) >> 1;
+
+        return {
+            Mov(locationReg, state),
+            NoReloc(mov64rm(locationReg, locationReg, 1, 0, 0, 0)),
+            NoReloc(mov32rm8(temp_manager->getSizedSubReg(valueReg, 4), locationReg, 1, 0, current, 0)),
+            Add(valueReg, Constant(1)),
+            NoReloc(mov8mr(locationReg, 1, 0, current, 0, temp_manager->getSizedSubReg(valueReg, 1))),
+            Mov(locationReg, state),
+            Mov(valueReg, Constant(bitmap + previous)),
+            NoReloc(mov64mr(locationReg, 1, 0, 0, 0, valueReg)),
+        };
+    }
+};
+
+class AppendMemoryAccess : public PatchGenerator, public AutoAlloc<PatchGenerator, AppendMemoryAccess> {
+
+    Temp             cursor;
+    Temp             value;
+    Temp             direction;
+    Temp             count;
+    Constant         state;
+    MemoryAccessType type;
+
+public:
+
+    /*! Append a MemoryAccess record describing the read or write access of the instruction to a 
+     * memory trace buffer, without modifying the guest flags. The cursor of the buffer is kept in 
+     * memory and points to the next free record. A read access has to be appended before the 
+     * instruction is executed and a write access after, except for the string operations whose 
+     * accesses are always appended before.
+     *
+     * @param[in] cursor     A temporary used to hold the buffer cursor.
+     * @param[in] value      A temporary used to hold the record fields.
+     * @param[in] direction  A temporary used to hold the direction flag of a string operation.
+     * @param[in] count      A temporary used to hold the repetition count of a string operation.
+     * @param[in] state      The address where the buffer cursor is stored.
+     * @param[in] type       The access to record, either MEMORY_READ or MEMORY_WRITE.
+    */
+    AppendMemoryAccess(Temp cursor, Temp value, Temp direction, Temp count, Constant state, MemoryAccessType type)
+        : cursor(cursor), value(value), direction(direction), count(count), state(state), type(type) {}
+
+    /*! Output:
+     *
+     * MOV REG64 cursor, IMM64 state
+     * MOV REG64 cursor, MEM64 [cursor]
+     * (GetReadAddress / GetWriteAddress) value
+     * MOV MEM64 [cursor + accessAddress], REG64 value
+     * (GetReadValue / GetWriteValue) value
+     * MOV MEM64 [cursor + value], REG64 value
+     * MOV REG64 value, IMM64 address
+     * MOV MEM64 [cursor + instAddress], REG64 value
+     * MOV REG64 value, IMM64 size / (GetStringLength) value
+     * MOV MEM64 [cursor + size], REG64 value
+     * MOV REG64 value, IMM64 (type, flags)
+     * MOV MEM64 [cursor + type], REG64 value
+     * LEA REG64 cursor, [cursor + sizeof(MemoryAccess)]
+     * MOV REG64 value, IMM64 state
+     * MOV MEM64 [value], REG64 cursor
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+        static_assert(offsetof(MemoryAccess, type) + sizeof(rword) == sizeof(MemoryAccess),
+                      "The type and flags of a MemoryAccess should fit in its last word");
+        Reg cursorReg = temp_manager->getRegForTemp(cursor);
+        Reg valueReg = temp_manager->getRegForTemp(value);
+        RelocatableInst::SharedPtrVec patch;
+        unsigned size = (type == MEMORY_READ) ? getReadSize(inst) : getWriteSize(inst);
+        bool string = isStringAccess(inst);
+
+        // The type and flags fields are known at translation time and written as a single word
+        MemoryAccess info;
+        rword infoWord = 0;
+        memset(&info, 0, sizeof(MemoryAccess));
+        info.type = type;
+        if(string) {
+            info.flags = MEMORY_UNKNOWN_VALUE;
+        }
+        else if(size > sizeof(rword)) {
+            info.flags = MEMORY_PARTIAL_VALUE;
+        }
+        memcpy(&infoWord, reinterpret_cast<uint8_t*>(&info) + offsetof(MemoryAccess, type), sizeof(rword));
+
+        patch.push_back(Mov(cursorReg, state));
+        patch.push_back(NoReloc(mov64rm(cursorReg, cursorReg, 1, 0, 0, 0)));
+        if(type == MEMORY_READ) {
+            append(patch, GetReadAddress(value, direction, count).generate(inst, address, instSize, temp_manager, 
+                                                                           nullptr));
+        }
+        else {
+            append(patch, GetWriteAddress(value, direction, count).generate(inst, address, instSize, temp_manager, 
+                                                                            nullptr));
+        }
+        patch.push_back(NoReloc(mov64mr(cursorReg, 1, 0, offsetof(MemoryAccess, accessAddress), 0, valueReg)));
+        if(type == MEMORY_READ) {
+            append(patch, GetReadValue(value).generate(inst, address, instSize, temp_manager, nullptr));
+        }
+        else {
+            append(patch, GetWriteValue(value).generate(inst, address, instSize, temp_manager, nullptr));
+        }
+        patch.push_back(NoReloc(mov64mr(cursorReg, 1, 0, offsetof(MemoryAccess, value), 0, valueReg)));
+        patch.push_back(Mov(valueReg, Constant(address)));
+        patch.push_back(NoReloc(mov64mr(cursorReg, 1, 0, offsetof(MemoryAccess, instAddress), 0, valueReg)));
+        if(string) {
+            append(patch, GetStringLength(value).generate(inst, address, instSize, temp_manager, nullptr));
+        }
+        else {
+            patch.push_back(Mov(valueReg, Constant(size)));
+        }
+        patch.push_back(NoReloc(mov64mr(cursorReg, 1, 0, offsetof(MemoryAccess, size), 0, valueReg)));
+        patch.push_back(Mov(valueReg, Constant(infoWord)));
+        patch.push_back(NoReloc(mov64mr(cursorReg, 1, 0, offsetof(MemoryAccess, type), 0, valueReg)));
+        patch.push_back(Add(cursorReg, Constant(sizeof(MemoryAccess))));
+        patch.push_back(Mov(valueReg, state));
+        patch.push_back(NoReloc(mov64mr(valueReg, 1, 0, 0, 0, cursorReg)));
+
+        return patch;
+    }
+};
+
 class WriteTemp : public PatchGenerator, public AutoAlloc<PatchGenerator, WriteTemp> {
 
     Temp  temp;
@@ -659,7 +2000,9 @@ public:
 
 class SimulateCall : public PatchGenerator, public AutoAlloc<PatchGenerator, SimulateCall> {
 
-    Temp temp;
+    Temp     temp;
+    Temp     scratch;
+    Constant callStack;
 
 public:
 
@@ -668,15 +2011,39 @@ public:
      * is pushed onto the stack. This generator signals a PC modification and triggers and end of basic
      * block.
      *
-     * @param[in] temp   Stores the call target address. Overwritten by this generator.
+     * If a shadow call stack is given, a frame describing the call is pushed on it without modifying
+     * the flags.
+     *
+     * @param[in] temp       Stores the call target address. Overwritten by this generator.
+     * @param[in] scratch    A temporary only used with a shadow call stack. Overwritten by this 
+     *                       generator.
+     * @param[in] callStack  The address of the ShadowCallStack, or 0 to not maintain it.
     */
-    SimulateCall(Temp temp) : temp(temp) {}
+    SimulateCall(Temp temp, Temp scratch = Temp(1), Constant callStack = Constant(0))
+        : temp(temp), scratch(scratch), callStack(callStack) {}
 
     /*! Output:
      *
      * MOV MEM64 DataBlock[Offset(RIP)], REG64 temp
      * MOV REG64 temp, IMM64 (address + InstSize)
      * PUSH REG64 temp
+     *
+     * With a shadow call stack:
+     *
+     * MOV REG64 scratch, IMM64 callStack
+     * MOVZX REG32 temp, MEM16 [scratch + depth]
+     * LEA REG64 temp, [temp + 1]
+     * MOV MEM16 [scratch + depth], REG16 temp
+     * MOVZX REG32 temp, MEM16 [scratch + depth]
+     * LEA REG64 temp, [temp * 8]
+     * LEA REG64 scratch, [scratch + temp * 4]
+     * MOV REG64 temp, IMM64 address
+     * MOV MEM64 [scratch + frames + callSite], REG64 temp
+     * MOV REG64 temp, IMM64 (address + InstSize)
+     * MOV MEM64 [scratch + frames + returnAddress], REG64 temp
+     * MOV REG64 temp, MEM64 DataBlock[Offset(RIP)]
+     * MOV MEM64 [scratch + frames + target], REG64 temp
+     * MOV MEM64 [scratch + frames + stackPointer], REG64 RSP
     */
     RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
         rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
@@ -686,6 +2053,30 @@ public:
         append(patch, GetPCOffset(temp, Constant(0)).generate(inst, address, instSize, temp_manager, nullptr));
         patch.push_back(Pushr(temp_manager->getRegForTemp(temp)));
 
+        if(callStack != 0) {
+            Reg tempReg = temp_manager->getRegForTemp(temp);
+            Reg scratchReg = temp_manager->getRegForTemp(scratch);
+            unsigned int temp32 = temp_manager->getSizedSubReg(tempReg, 4);
+            rword depth = offsetof(ShadowCallStack, depth);
+            rword frame = offsetof(ShadowCallStack, frames);
+
+            // The depth wraps around on 16 bits, the frame of depth d is frames[d & 0xffff]
+            patch.push_back(Mov(scratchReg, callStack));
+            patch.push_back(NoReloc(mov32rm16(temp32, scratchReg, 1, 0, depth, 0)));
+            patch.push_back(NoReloc(lea(tempReg, tempReg, 1, 0, 1, 0)));
+            patch.push_back(NoReloc(mov16mr(scratchReg, 1, 0, depth, 0, temp_manager->getSizedSubReg(tempReg, 2))));
+            patch.push_back(NoReloc(mov32rm16(temp32, scratchReg, 1, 0, depth, 0)));
+            patch.push_back(NoReloc(lea(tempReg, 0, 8, tempReg, 0, 0)));
+            patch.push_back(NoReloc(lea(scratchReg, scratchReg, 4, tempReg, 0, 0)));
+            patch.push_back(Mov(tempReg, Constant(address)));
+            patch.push_back(NoReloc(mov64mr(scratchReg, 1, 0, frame + offsetof(CallFrame, callSite), 0, tempReg)));
+            patch.push_back(Mov(tempReg, Constant(address + instSize)));
+            patch.push_back(NoReloc(mov64mr(scratchReg, 1, 0, frame + offsetof(CallFrame, returnAddress), 0, tempReg)));
+            append(patch, LoadReg(tempReg, Offset(Reg(REG_PC))));
+            patch.push_back(NoReloc(mov64mr(scratchReg, 1, 0, frame + offsetof(CallFrame, target), 0, tempReg)));
+            patch.push_back(NoReloc(mov64mr(scratchReg, 1, 0, frame + offsetof(CallFrame, stackPointer), 0, Reg(REG_SP))));
+        }
+
         return {patch};
     }
 
@@ -696,7 +2087,9 @@ public:
 
 class SimulateRet : public PatchGenerator, public AutoAlloc<PatchGenerator, SimulateRet> {
 
-    Temp temp;
+    Temp     temp;
+    Temp     scratch;
+    Constant callStack;
 
 public:
 
@@ -708,15 +2101,28 @@ public:
      * The optional deallocation is performed if the current instruction has one single immediate
      * operand (which is the case of RETIQ and RETIW).
      *
-     * @param[in] temp   Any unused temporary, overwritten by this generator.
+     * If a shadow call stack is given, its top frame is popped without modifying the flags.
+     *
+     * @param[in] temp       Any unused temporary, overwritten by this generator.
+     * @param[in] scratch    A temporary only used with a shadow call stack. Overwritten by this 
+     *                       generator.
+     * @param[in] callStack  The address of the ShadowCallStack, or 0 to not maintain it.
     */
-    SimulateRet(Temp temp) : temp(temp) {}
+    SimulateRet(Temp temp, Temp scratch = Temp(1), Constant callStack = Constant(0))
+        : temp(temp), scratch(scratch), callStack(callStack) {}
 
     /*! Output:
      *
      * POP REG64 temp
      * ADD RSP, IMM64 deallocation # Optional
      * MOV MEM64 DataBlock[Offset(RIP)], REG64 temp
+     *
+     * With a shadow call stack:
+     *
+     * MOV REG64 scratch, IMM64 callStack
+     * MOVZX REG32 temp, MEM16 [scratch + depth]
+     * LEA REG64 temp, [temp - 1]
+     * MOV MEM16 [scratch + depth], REG16 temp
     */
     RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
         rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
@@ -728,6 +2134,17 @@ public:
         }
         append(patch, WriteTemp(temp, Offset(Reg(REG_PC))).generate(inst, address, instSize, temp_manager, nullptr));
 
+        if(callStack != 0) {
+            Reg tempReg = temp_manager->getRegForTemp(temp);
+            Reg scratchReg = temp_manager->getRegForTemp(scratch);
+            rword depth = offsetof(ShadowCallStack, depth);
+
+            patch.push_back(Mov(scratchReg, callStack));
+            patch.push_back(NoReloc(mov32rm16(temp_manager->getSizedSubReg(tempReg, 4), scratchReg, 1, 0, depth, 0)));
+            patch.push_back(NoReloc(lea(tempReg, tempReg, 1, 0, -1, 0)));
+            patch.push_back(NoReloc(mov16mr(scratchReg, 1, 0, depth, 0, temp_manager->getSizedSubReg(tempReg, 2))));
+        }
+
         return {patch};
     }
 
@@ -736,6 +2153,44 @@ public:
     }
 };
 
+class NativeCall : public PatchGenerator, public AutoAlloc<PatchGenerator, NativeCall>,
+    public PureEval<NativeCall> {
+
+    Constant target;
+    Constant slot;
+
+public:
+
+    /*! Perform a call natively: the callee returns directly to the instruction following this 
+     * patch in the ExecBlock and the basic block goes on. The call target is loaded in R11, which
+     * is not preserved across calls and not used to pass arguments by the calling conventions. 
+     *
+     * @param[in] target  The address of the callee, used if no slot is given.
+     * @param[in] slot    The address of a pointer to the callee read at each call, e.g. a GOT 
+     *                    entry, or 0.
+    */
+    NativeCall(Constant target, Constant slot = Constant(0)) : target(target), slot(slot) {}
+
+    /*! Output:
+     *
+     * MOV REG64 R11, IMM64 target
+     * CALL REG64 R11
+     *
+     * With a slot:
+     *
+     * MOV REG64 R11, IMM64 slot
+     * CALL MEM64 [R11]
+    */
+    RelocatableInst::SharedPtrVec generate(const llvm::MCInst* inst,
+        rword address, rword instSize, TempManager *temp_manager, const Patch *toMerge) {
+
+        Reg scratch(9);
+        if(slot != 0) {
+            return {Mov(scratch, slot), NoReloc(call64m(scratch, 0))};
+        }
+        return {Mov(scratch, target), NoReloc(call64r(scratch))};
+    }
+};
 
 }
 
@@ -15,10 +15,13 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <string.h>
+
 #include "Patch/PatchRule.h"
 #include "Patch/X86_64/PatchRules_X86_64.h"
 #include "Patch/X86_64/Layer2_X86_64.h"
 #include "Utility/LogSys.h"
+#include "Utility/ModuleRegistry.h"
 #include "Utility/System.h"
 
 namespace QBDI {
@@ -53,7 +56,29 @@ RelocatableInst::SharedPtrVec getExecBlockPrologue() {
         prologue.push_back(Vinserti128(llvm::X86::YMM15, Offset(offsetof(Context, fprState) + offsetof(FPRState, ymm15)), 1));
     }
 #endif
-    // Restore EFLAGS
+    // Restore EFLAGS according to hostState.restoreFlags. POPF is microcoded and slow, it is only
+    // used when the system flags need to be restored. Jump offsets are the encoded size of the
+    // skipped instructions (see Jmp8).
+    prologue.push_back(Cmp(Offset(offsetof(Context, hostState.restoreFlags)), Constant(FLAGS_RESTORE_ARITH)));
+    if(isHostCPUFeaturePresent("sahf")) {
+        // FLAGS_RESTORE_NONE: skip the restoration
+        prologue.push_back(Jb8(Constant(37)));
+        // FLAGS_RESTORE_FULL: use POPF
+        prologue.push_back(Ja8(Constant(26)));
+        // FLAGS_RESTORE_ARITH: OF is the bit 3 of the second byte of EFLAGS, adding 0x7F to it
+        // sets OF. The other arithmetic flags are then loaded using SAHF which leaves OF untouched.
+        prologue.push_back(Movzx8(llvm::X86::EAX, Offset(offsetof(Context, gprState.eflags) + 1)));
+        prologue.push_back(Shr8(llvm::X86::AL, Constant(3)));
+        prologue.push_back(And8(llvm::X86::AL, Constant(1)));
+        prologue.push_back(Add8(llvm::X86::AL, Constant(0x7F)));
+        prologue.push_back(Mov8(llvm::X86::AH, Offset(offsetof(Context, gprState.eflags))));
+        prologue.push_back(Sahf());
+        prologue.push_back(Jmp8(Constant(10)));
+    }
+    else {
+        // FLAGS_RESTORE_NONE: skip the restoration, otherwise use POPF
+        prologue.push_back(Jb8(Constant(10)));
+    }
     append(prologue, LoadReg(Reg(0), Offset(offsetof(Context, gprState.eflags))));
     prologue.push_back(Pushr(Reg(0)));
     prologue.push_back(Popf());
@@ -108,7 +133,7 @@ RelocatableInst::SharedPtrVec getExecBlockEpilogue() {
     return epilogue;
 }
 
-PatchRule::SharedPtrVec getDefaultPatchRules() {
+PatchRule::SharedPtrVec getDefaultPatchRules(rword callStack) {
     PatchRule::SharedPtrVec rules;
 
     /* Rule #0: Avoid instrumenting instruction prefixes.
@@ -183,7 +208,7 @@ PatchRule::SharedPtrVec getDefaultPatchRules() {
                     SetOpcode(llvm::X86::MOV64rm),
                     AddOperand(Operand(0), Temp(1))
                 }),
-                SimulateCall(Temp(1))
+                SimulateCall(Temp(1), Temp(0), Constant(callStack))
             }
         )
     );
@@ -236,7 +261,7 @@ PatchRule::SharedPtrVec getDefaultPatchRules() {
                     SetOpcode(llvm::X86::MOV64rm),
                     AddOperand(Operand(0), Temp(0))
                 }),
-                SimulateCall(Temp(0))
+                SimulateCall(Temp(0), Temp(1), Constant(callStack))
             }
         )
     );
@@ -286,7 +311,7 @@ PatchRule::SharedPtrVec getDefaultPatchRules() {
             OpIs(llvm::X86::CALL64r),
             {
                 GetOperand(Temp(0), Operand(0)),
-                SimulateCall(Temp(0))
+                SimulateCall(Temp(0), Temp(1), Constant(callStack))
             }
         )
     );
@@ -420,7 +445,7 @@ PatchRule::SharedPtrVec getDefaultPatchRules() {
             }),
             {
                 GetPCOffset(Temp(0), Operand(0)),
-                SimulateCall(Temp(0))
+                SimulateCall(Temp(0), Temp(1), Constant(callStack))
             }
         )
     );
@@ -438,7 +463,7 @@ PatchRule::SharedPtrVec getDefaultPatchRules() {
                 OpIs(llvm::X86::RETIW)
             }),
             {
-                SimulateRet(Temp(0))
+                SimulateRet(Temp(0), Temp(1), Constant(callStack))
             }
         )
     );
@@ -452,6 +477,55 @@ PatchRule::SharedPtrVec getDefaultPatchRules() {
     return rules;
 }
 
+bool getCallTarget(const llvm::MCInst* inst, rword address, rword instSize, const ModuleRegistry& modules,
+                   rword* callee, rword* slot) {
+    static const uint8_t ENDBR64[] = {0xF3, 0x0F, 0x1E, 0xFA};
+    // ENDBR64, the BND prefix and JMP *[RIP + IMM]
+    static const rword STUB_MAX_SIZE = sizeof(ENDBR64) + 1 + 6;
+
+    *slot = 0;
+    if(inst->getOpcode() == llvm::X86::CALL64pcrel32) {
+        *callee = address + instSize + inst->getOperand(0).getImm();
+        // The callee can be unmapped or execute only, it is then called without looking for a stub
+        if(modules.isReadable(*callee, STUB_MAX_SIZE) == false) {
+            return true;
+        }
+        // Follow a PLT stub, JMP *[RIP + IMM] optionally preceded by ENDBR64 and a BND prefix
+        const uint8_t* stub = (const uint8_t*) *callee;
+        if(memcmp(stub, ENDBR64, sizeof(ENDBR64)) == 0) {
+            stub += sizeof(ENDBR64);
+        }
+        if(stub[0] == 0xF2) {
+            stub += 1;
+        }
+        if(stub[0] == 0xFF && stub[1] == 0x25) {
+            int32_t disp;
+            memcpy(&disp, stub + 2, sizeof(disp));
+            *slot = (rword) stub + 6 + (int64_t) disp;
+        }
+    }
+    // CALL *[RIP + IMM], e.g. when compiled with -fno-plt
+    else if(inst->getOpcode() == llvm::X86::CALL64m && inst->getOperand(0).getReg() == Reg(REG_PC) &&
+            inst->getOperand(2).getReg() == 0 && inst->getOperand(4).getReg() == 0) {
+        *callee = 0;
+        *slot = address + instSize + inst->getOperand(3).getImm();
+    }
+    else {
+        return false;
+    }
+    if(*slot != 0 && modules.isReadable(*slot, sizeof(rword)) == false) {
+        return false;
+    }
+    if(*slot != 0 && *callee == 0) {
+        *callee = *((rword*) *slot);
+    }
+    return true;
+}
+
+PatchRule::SharedPtr getNativeCallRule(rword target, rword slot) {
+    return std::make_shared<PatchRule>(True(), PatchGenerator::SharedPtrVec({NativeCall(Constant(target), Constant(slot))}));
+}
+
 // Patch allowing to terminate a basic block early by writing address into DataBlock[Offset(RIP)]
 RelocatableInst::SharedPtrVec getTerminator(rword address) {
     RelocatableInst::SharedPtrVec terminator;
@@ -26,6 +26,7 @@
 namespace QBDI {
 
 class PatchRule;
+class ModuleRegistry;
 
 static const uint32_t MINIMAL_BLOCK_SIZE = 64;
 
@@ -35,7 +36,42 @@ RelocatableInst::SharedPtrVec getExecBlockEpilogue();
 
 RelocatableInst::SharedPtrVec getTerminator(rword address);
 
-std::vector<std::shared_ptr<PatchRule>> getDefaultPatchRules();
+/*! Get the patch rules of the architecture.
+ *
+ * @param[in] callStack  The address of the ShadowCallStack maintained by the call and return 
+ *                       patches, 0 to not maintain it.
+ *
+ * @return The patch rules, in the order they are tested.
+ */
+std::vector<std::shared_ptr<PatchRule>> getDefaultPatchRules(rword callStack = 0);
+
+/*! Get the target of a call whose destination is known at translation time: a direct call, 
+ *  possibly to a PLT stub, or a call through a RIP relative pointer.
+ *
+ * @param[in]  inst      The call instruction.
+ * @param[in]  address   The address of the call instruction.
+ * @param[in]  instSize  The size of the call instruction.
+ * @param[in]  modules   The loaded modules, the stub and the pointer are only read if they lie in
+ *                       their readable segments.
+ * @param[out] callee    The address of the code reached by the call, for a call through a pointer
+ *                       the current value of the pointer.
+ * @param[out] slot      The address of the pointer the call goes through, either directly or from
+ *                       a PLT stub, or 0.
+ *
+ * @return True if the target is known. A stub which cannot be read is taken as the callee itself.
+ */
+bool getCallTarget(const llvm::MCInst* inst, rword address, rword instSize, const ModuleRegistry& modules,
+                   rword* callee, rword* slot);
+
+/*! Get a patch rule performing a call natively.
+ *
+ * @param[in] target  The address of the callee.
+ * @param[in] slot    The address of a pointer to the callee read at each call, or 0 to call the 
+ *                    target directly.
+ *
+ * @return The patch rule.
+ */
+std::shared_ptr<PatchRule> getNativeCallRule(rword target, rword slot);
 
 }
 
@@ -0,0 +1,319 @@
+/*
+ * This file is part of QBDI.
+ *
+ * Copyright 2017 Quarkslab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <map>
+#include <set>
+#include <utility>
+
+#include "llvm/Support/Process.h"
+
+#include "Utility/LogSys.h"
+#include "Utility/ModuleRegistry.h"
+#include "Memory.h"
+
+#if defined(QBDI_OS_LINUX)
+#include <stddef.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <limits.h>
+#include <link.h>
+#include <unistd.h>
+#endif
+
+namespace QBDI {
+
+#if defined(QBDI_OS_LINUX)
+
+struct LoaderCounters {
+    unsigned long long loads;
+    unsigned long long unloads;
+    bool               available;
+};
+
+struct ModuleCollection {
+    std::vector<LoadedModule>* modules;
+    const std::string*         mainName;
+    rword                      pageSize;
+    LoaderCounters             counters;
+};
+
+// The loader counters are only present in the recent versions of the structure
+static bool readLoaderCounters(struct dl_phdr_info* info, size_t size, LoaderCounters* counters) {
+    counters->available = size >= offsetof(struct dl_phdr_info, dlpi_subs) + sizeof(info->dlpi_subs);
+    if(counters->available) {
+        counters->loads = info->dlpi_adds;
+        counters->unloads = info->dlpi_subs;
+    }
+    return counters->available;
+}
+
+static int firstObjectCallback(struct dl_phdr_info* info, size_t size, void* data) {
+    readLoaderCounters(info, size, (LoaderCounters*) data);
+    // The counters are the same for every object
+    return 1;
+}
+
+static int collectModuleCallback(struct dl_phdr_info* info, size_t size, void* data) {
+    ModuleCollection* collection = (ModuleCollection*) data;
+    LoadedModule module;
+
+    readLoaderCounters(info, size, &collection->counters);
+    // The main program is the first object and has an empty name
+    if(info->dlpi_name == nullptr || info->dlpi_name[0] == '\0') {
+        if(collection->modules->size() > 0) {
+            return 0;
+        }
+        module.name = *(collection->mainName);
+    }
+    else {
+        const char* name = strrchr(info->dlpi_name, '/');
+        module.name = std::string(name != nullptr ? name + 1 : info->dlpi_name);
+    }
+    for(ElfW(Half) i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)* phdr = &info->dlpi_phdr[i];
+        if(phdr->p_type != PT_LOAD || phdr->p_memsz == 0) {
+            continue;
+        }
+        rword start = (info->dlpi_addr + phdr->p_vaddr) & ~(collection->pageSize - 1);
+        rword end = (info->dlpi_addr + phdr->p_vaddr + phdr->p_memsz + collection->pageSize - 1) &
+                    ~(collection->pageSize - 1);
+        module.mapped.add(Range<rword>(start, end));
+        if(phdr->p_flags & PF_X) {
+            module.executable.add(Range<rword>(start, end));
+        }
+        if(phdr->p_flags & PF_R) {
+            module.readable.add(Range<rword>(start, end));
+        }
+    }
+    if(module.mapped.getRanges().size() > 0) {
+        collection->modules->push_back(module);
+    }
+    return 0;
+}
+
+bool ModuleRegistry::hasChanged() const {
+    LoaderCounters counters = {0, 0, false};
+
+    if(built == false) {
+        return true;
+    }
+    if(tracked == false) {
+        return false;
+    }
+    dl_iterate_phdr(firstObjectCallback, &counters);
+    return counters.loads != loads || counters.unloads != unloads;
+}
+
+std::vector<LoadedModule> ModuleRegistry::readModules() {
+    std::vector<LoadedModule> current;
+
+    if(mainName.empty()) {
+        char path[PATH_MAX];
+        ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+        if(len > 0) {
+            path[len] = '\0';
+            const char* name = strrchr(path, '/');
+            mainName = std::string(name != nullptr ? name + 1 : path);
+        }
+    }
+    ModuleCollection collection = {&current, &mainName, (rword) llvm::sys::Process::getPageSize(), {0, 0, false}};
+    dl_iterate_phdr(collectModuleCallback, &collection);
+    tracked = collection.counters.available;
+    loads = collection.counters.loads;
+    unloads = collection.counters.unloads;
+    LogDebug("ModuleRegistry::readModules", "Read %zu modules from the loader", current.size());
+    return current;
+}
+
+// In a non PIE executable, the address of a function taken by the executable is its canonical PLT
+// entry while the calls from the libraries are bound to the real symbol, both are matched
+bool ModuleRegistry::isLoaderFunction(rword addr) {
+    static const rword loaderFunctions[4] = {
+        (rword) &dlopen,
+        (rword) &dlclose,
+        (rword) dlsym(RTLD_NEXT, "dlopen"),
+        (rword) dlsym(RTLD_NEXT, "dlclose"),
+    };
+
+    for(rword f : loaderFunctions) {
+        if(f != 0 && addr == f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if defined(QBDI_BITS_64)
+#define ELF_R_SYM(info) ELF64_R_SYM(info)
+#else
+#define ELF_R_SYM(info) ELF32_R_SYM(info)
+#endif
+
+// The loader relocates the dynamic section in place, except where it is mapped read only
+static rword dynamicPointer(const struct link_map* map, ElfW(Addr) ptr) {
+    return (ptr < map->l_addr) ? map->l_addr + ptr : ptr;
+}
+
+rword ModuleRegistry::getSlotBinding(rword slot) {
+    Dl_info info;
+    struct link_map* map = nullptr;
+    const ElfW(Rela)* relocs = nullptr;
+    const ElfW(Sym)* symbols = nullptr;
+    const char* strings = nullptr;
+    size_t relocsSize = 0;
+
+    if(dladdr1((void*) slot, &info, (void**) &map, RTLD_DL_LINKMAP) == 0 || map == nullptr || map->l_ld == nullptr) {
+        return 0;
+    }
+    for(const ElfW(Dyn)* dyn = map->l_ld; dyn->d_tag != DT_NULL; dyn++) {
+        switch(dyn->d_tag) {
+            case DT_JMPREL:
+                relocs = (const ElfW(Rela)*) dynamicPointer(map, dyn->d_un.d_ptr);
+                break;
+            case DT_PLTRELSZ:
+                relocsSize = dyn->d_un.d_val;
+                break;
+            case DT_SYMTAB:
+                symbols = (const ElfW(Sym)*) dynamicPointer(map, dyn->d_un.d_ptr);
+                break;
+            case DT_STRTAB:
+                strings = (const char*) dynamicPointer(map, dyn->d_un.d_ptr);
+                break;
+            case DT_PLTREL:
+                // Only the relocations with an addend, used under x86-64, are read
+                if(dyn->d_un.d_val != DT_RELA) {
+                    return 0;
+                }
+                break;
+        }
+    }
+    if(relocs == nullptr || symbols == nullptr || strings == nullptr) {
+        return 0;
+    }
+    for(size_t i = 0; i < relocsSize / sizeof(ElfW(Rela)); i++) {
+        if(map->l_addr + relocs[i].r_offset != slot) {
+            continue;
+        }
+        const ElfW(Sym)* symbol = &symbols[ELF_R_SYM(relocs[i].r_info)];
+        if(symbol->st_name == 0) {
+            return 0;
+        }
+        LogDebug("ModuleRegistry::getSlotBinding", "Pointer 0x%" PRIRWORD " is bound to %s", slot, strings + symbol->st_name);
+        return (rword) dlsym(RTLD_DEFAULT, strings + symbol->st_name);
+    }
+    return 0;
+}
+
+#else
+
+bool ModuleRegistry::hasChanged() const {
+    return built == false;
+}
+
+std::vector<LoadedModule> ModuleRegistry::readModules() {
+    std::vector<LoadedModule> current;
+    std::map<std::string, size_t> index;
+
+    for(const MemoryMap& m : getCurrentProcessMaps()) {
+        if(m.name.empty()) {
+            continue;
+        }
+        auto it = index.find(m.name);
+        if(it == index.end()) {
+            it = index.insert(std::make_pair(m.name, current.size())).first;
+            current.push_back(LoadedModule {m.name, RangeSet<rword>(), RangeSet<rword>(), RangeSet<rword>()});
+        }
+        current[it->second].mapped.add(m.range);
+        if(m.permission & QBDI::PF_EXEC) {
+            current[it->second].executable.add(m.range);
+        }
+        if(m.permission & QBDI::PF_READ) {
+            current[it->second].readable.add(m.range);
+        }
+    }
+    return current;
+}
+
+bool ModuleRegistry::isLoaderFunction(rword addr) {
+    return false;
+}
+
+rword ModuleRegistry::getSlotBinding(rword slot) {
+    return 0;
+}
+
+#endif
+
+// Two modules are the same if they have the same name and were loaded at the same address
+static std::pair<std::string, rword> moduleKey(const LoadedModule& module) {
+    return std::make_pair(module.name, module.mapped.getRanges()[0].start);
+}
+
+bool ModuleRegistry::update(std::vector<LoadedModule>* loaded, std::vector<LoadedModule>* unloaded) {
+    if(built && tracked && hasChanged() == false) {
+        return false;
+    }
+    std::vector<LoadedModule> current = readModules();
+    std::set<std::pair<std::string, rword>> previousKeys, currentKeys;
+    bool changed = false;
+
+    for(const LoadedModule& module : modules) {
+        previousKeys.insert(moduleKey(module));
+    }
+    for(const LoadedModule& module : current) {
+        currentKeys.insert(moduleKey(module));
+    }
+    for(const LoadedModule& module : current) {
+        if(previousKeys.count(moduleKey(module)) == 0) {
+            changed = true;
+            if(loaded != nullptr && built) {
+                loaded->push_back(module);
+            }
+        }
+    }
+    for(const LoadedModule& module : modules) {
+        if(currentKeys.count(moduleKey(module)) == 0) {
+            changed = true;
+            if(unloaded != nullptr) {
+                unloaded->push_back(module);
+            }
+        }
+    }
+    modules.swap(current);
+    built = true;
+    return changed;
+}
+
+const LoadedModule* ModuleRegistry::findModuleByAddr(rword addr) const {
+    for(const LoadedModule& module : modules) {
+        if(module.mapped.contains(addr)) {
+            return &module;
+        }
+    }
+    return nullptr;
+}
+
+bool ModuleRegistry::isReadable(rword addr, rword size) const {
+    // The range must not wrap around the address space
+    if(addr + size < addr) {
+        return false;
+    }
+    const LoadedModule* module = findModuleByAddr(addr);
+    return module != nullptr && module->readable.contains(Range<rword>(addr, addr + size));
+}
+
+}
@@ -0,0 +1,122 @@
+/*
+ * This file is part of QBDI.
+ *
+ * Copyright 2017 Quarkslab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MODULEREGISTRY_H
+#define MODULEREGISTRY_H
+
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+#include "Range.h"
+#include "State.h"
+
+namespace QBDI {
+
+/*! A module loaded in the current process.
+ */
+struct LoadedModule {
+    std::string     name;       /*!< The module file name, as reported by the memory maps.*/
+    RangeSet<rword> mapped;     /*!< The page aligned ranges of all its segments.*/
+    RangeSet<rword> executable; /*!< The page aligned ranges of its executable segments.*/
+    RangeSet<rword> readable;   /*!< The page aligned ranges of its readable segments.*/
+};
+
+/*! The list of the modules loaded in the current process. Under Linux it is read from the dynamic
+ *  loader with dl_iterate_phdr and only read again when the loader counters of loaded and
+ *  unloaded objects have changed. Elsewhere it is rebuilt from the memory maps on every update.
+ */
+class ModuleRegistry {
+
+private:
+
+    std::vector<LoadedModule> modules;
+    std::string               mainName;
+    unsigned long long        loads;
+    unsigned long long        unloads;
+    bool                      tracked;
+    bool                      built;
+
+    std::vector<LoadedModule> readModules();
+
+public:
+
+    ModuleRegistry() : loads(0), unloads(0), tracked(false), built(false) {}
+
+    /*! Cheaply determine whether modules were loaded or unloaded since the last update.
+     *
+     * @return True if a change was detected, always false when the changes cannot be tracked.
+     */
+    bool hasChanged() const;
+
+    /*! Bring the registry up to date. Where the changes cannot be tracked the registry is
+     *  always rebuilt.
+     *
+     * @param[out] loaded    Optional list receiving the modules loaded since the last update.
+     * @param[out] unloaded  Optional list receiving the modules unloaded since the last update.
+     *
+     * @return True if the list of modules changed.
+     */
+    bool update(std::vector<LoadedModule>* loaded = nullptr, std::vector<LoadedModule>* unloaded = nullptr);
+
+    const std::vector<LoadedModule>& getModules() const { return modules; }
+
+    /*! Whether the changes can be detected by hasChanged. Only known after the first update.
+     */
+    bool isTracked() const { return tracked; }
+
+    /*! Find the module having a segment containing an address.
+     *
+     * @param[in] addr  The address.
+     *
+     * @return The module, or nullptr if no module contains the address.
+     */
+    const LoadedModule* findModuleByAddr(rword addr) const;
+
+    /*! Determine whether a memory range lies in the readable segments of a loaded module and can
+     *  be read by the engine without faulting.
+     *
+     * @param[in] addr  The range start address.
+     * @param[in] size  The range size in bytes.
+     *
+     * @return True if the whole range is readable.
+     */
+    bool isReadable(rword addr, rword size) const;
+
+    /*! Determine whether a function can load or unload modules. The calls to these functions need
+     *  to be visible to the engine for it to notice the changes.
+     *
+     * @param[in] addr  The function address.
+     *
+     * @return True if the function is a loader entry point.
+     */
+    static bool isLoaderFunction(rword addr);
+
+    /*! Find the function a lazily bound pointer, e.g. a GOT entry used by a PLT stub, will be 
+     *  bound to. The symbol of its relocation is looked up in the global scope like the loader
+     *  would, symbol versions aside.
+     *
+     * @param[in] slot  The address of the pointer.
+     *
+     * @return The address of the function, or 0 if it cannot be found.
+     */
+    static rword getSlotBinding(rword slot);
+};
+
+}
+
+#endif // MODULEREGISTRY_H
@@ -39,6 +39,12 @@ int qbdipreload_on_run(VMInstanceRef vm, rword start, rword stop) {
 }
 
 
+int qbdipreload_on_thread(VMInstanceRef vm, rword start, rword arg) {
+    qbdi_addCodeCB(vm, QBDI_PREINST, onInstruction, NULL);
+    return QBDIPRELOAD_NO_ERROR;
+}
+
+
 int qbdipreload_on_exit(int status) {
     return QBDIPRELOAD_NO_ERROR;
 }
@@ -127,3 +127,71 @@ TEST(Range, Intersection) {
         ASSERT_EQ(true, rangeSet2.contains(r));
     }
 }
+
+TEST(Range, Lookup) {
+    static const int N = 100;
+    static const int SPACE = 2000;
+    std::vector<bool> reference(SPACE, false);
+    QBDI::RangeSet<int> rangeSet;
+
+    for(int i = 0; i < N; i++) {
+        int start = rand() % (SPACE - 50);
+        int end = start + 1 + rand() % 40;
+        bool add = (rand() % 3) != 0;
+        if(add) {
+            rangeSet.add(QBDI::Range<int>(start, end));
+        }
+        else {
+            rangeSet.remove(QBDI::Range<int>(start, end));
+        }
+        for(int j = start; j < end; j++) {
+            reference[j] = add;
+        }
+    }
+
+    for(int i = 0; i < SPACE; i++) {
+        ASSERT_EQ(reference[i], rangeSet.contains(i));
+    }
+    for(int start = 0; start < SPACE - 20; start += 7) {
+        for(int end = start + 1; end < start + 20; end++) {
+            bool all = true, any = false;
+            for(int j = start; j < end; j++) {
+                all = all && reference[j];
+                any = any || reference[j];
+            }
+            ASSERT_EQ(all, rangeSet.contains(QBDI::Range<int>(start, end)));
+            ASSERT_EQ(any, rangeSet.overlaps(QBDI::Range<int>(start, end)));
+        }
+    }
+}
+
+TEST(Range, BulkOperations) {
+    static const int N = 100;
+    QBDI::RangeSet<int> rangeSet1;
+    QBDI::RangeSet<int> rangeSet2;
+
+    for(int i = 0; i < N; i++) {
+        int start = rand() % 1000000;
+        int end = start + 1 + rand() % 10000;
+        rangeSet1.add(QBDI::Range<int>(start, end));
+    }
+    for(int i = 0; i < N; i++) {
+        int start = rand() % 1000000;
+        int end = start + 1 + rand() % 10000;
+        rangeSet2.add(QBDI::Range<int>(start, end));
+    }
+
+    QBDI::RangeSet<int> added = rangeSet1;
+    QBDI::RangeSet<int> removed = rangeSet1;
+    added.add(rangeSet2);
+    removed.remove(rangeSet2);
+
+    QBDI::RangeSet<int> addedOneByOne = rangeSet1;
+    QBDI::RangeSet<int> removedOneByOne = rangeSet1;
+    for(QBDI::Range<int> r: rangeSet2.getRanges()) {
+        addedOneByOne.add(r);
+        removedOneByOne.remove(r);
+    }
+    ASSERT_EQ(addedOneByOne, added);
+    ASSERT_EQ(removedOneByOne, removed);
+}
@@ -15,6 +15,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
+#include <cstring>
 #include <gtest/gtest.h>
 #include "VMTest.h"
 
@@ -24,6 +26,13 @@
 #include "Platform.h"
 #include "Memory.h"
 
+#if defined(QBDI_OS_LINUX)
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+
 #ifndef QBDI_OS_WIN
 // Can be used to log failure on a test (usefull in subroutines)
 #define TEST_GUARD(T) ({    \
@@ -237,6 +246,1006 @@ TEST_F(VMTest, InstCallback) {
     SUCCEED();
 }
 
+QBDI::VMAction countExecution(QBDI::VMInstanceRef vm, QBDI::GPRState *gprState, QBDI::FPRState *fprState, void *data) {
+    *((uint64_t*) data) += 1;
+    return QBDI::VMAction::CONTINUE;
+}
+
+#if defined(QBDI_ARCH_X86_64)
+TEST_F(VMTest, InlineCounter) {
+    uint64_t counters[3] = {0, 0, 0};
+    uint64_t count = 0;
+    QBDI::rword retval = 0;
+
+    QBDI::rword rstart = (QBDI::rword) &satanicFun;
+    QBDI::rword rend = (QBDI::rword) (((uint8_t*) &satanicFun) + 100);
+
+    uint32_t id0 = vm->addCodeRangeCounter(rstart, rend, &counters[0]);
+    uint32_t id1 = vm->addCodeRangeCounter(rstart, rend, &counters[1], true);
+    uint32_t id2 = vm->addCodeAddrCounter(rstart, &counters[2]);
+    ASSERT_NE(id0, QBDI::VMError::INVALID_EVENTID);
+    ASSERT_NE(id1, QBDI::VMError::INVALID_EVENTID);
+    ASSERT_NE(id2, QBDI::VMError::INVALID_EVENTID);
+    vm->addCodeRangeCB(rstart, rend, QBDI::InstPosition::PREINST, countExecution, &count);
+
+    bool ran = vm->call(&retval, (QBDI::rword) satanicFun, {42});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(retval, (QBDI::rword) satanicFun(42));
+
+    // Inline counters should count the same instructions as the callback
+    EXPECT_NE((uint64_t) 0, count);
+    EXPECT_EQ(count, counters[0]);
+    EXPECT_EQ(count, counters[1]);
+    EXPECT_EQ((uint64_t) 1, counters[2]);
+
+    std::vector<QBDI::CounterValue> values = vm->getCounters();
+    ASSERT_EQ((size_t) 3, values.size());
+    EXPECT_EQ(id0, values[0].id);
+    EXPECT_EQ(counters[0], values[0].value);
+    EXPECT_EQ(id2, values[2].id);
+    EXPECT_EQ(counters[2], values[2].value);
+
+    bool success = vm->deleteInstrumentation(id1);
+    ASSERT_TRUE(success);
+    ASSERT_EQ((size_t) 2, vm->getCounters().size());
+
+    SUCCEED();
+}
+#endif
+
+#if defined(QBDI_ARCH_X86_64)
+TEST_F(VMTest, EdgeCoverage) {
+    std::vector<uint8_t> bitmap(1 << 16, 0);
+    std::vector<uint8_t> firstRun;
+    QBDI::rword retval = 0;
+
+    ASSERT_FALSE(vm->setEdgeCoverage(bitmap.data(), 1000));
+    ASSERT_TRUE(vm->setEdgeCoverage(bitmap.data(), bitmap.size()));
+
+    bool ran = vm->call(&retval, (QBDI::rword) satanicFun, {42});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(retval, (QBDI::rword) satanicFun(42));
+    size_t edges = std::count_if(bitmap.begin(), bitmap.end(), [](uint8_t v) { return v != 0; });
+    EXPECT_NE((size_t) 0, edges);
+
+    // The same execution should hit the same edges, as the previous location is reset
+    firstRun = bitmap;
+    ran = vm->call(&retval, (QBDI::rword) satanicFun, {42});
+    ASSERT_TRUE(ran);
+    for(size_t i = 0; i < bitmap.size(); i++) {
+        ASSERT_EQ((uint8_t) (firstRun[i] * 2), bitmap[i]);
+    }
+
+    ASSERT_TRUE(vm->setEdgeCoverage(nullptr, 0));
+    firstRun = bitmap;
+    ran = vm->call(&retval, (QBDI::rword) satanicFun, {42});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(firstRun, bitmap);
+
+    SUCCEED();
+}
+#endif
+
+QBDI::VMAction collectInstMemoryAccess(QBDI::VMInstanceRef vm, QBDI::GPRState *gprState, QBDI::FPRState *fprState, void *data) {
+    std::vector<QBDI::MemoryAccess>* accesses = (std::vector<QBDI::MemoryAccess>*) data;
+    for(const QBDI::MemoryAccess& access : vm->getInstMemoryAccess()) {
+        accesses->push_back(access);
+    }
+    return QBDI::VMAction::CONTINUE;
+}
+
+QBDI::VMAction collectMemoryTrace(QBDI::VMInstanceRef vm, const QBDI::MemoryAccess* accesses, size_t size, void* data) {
+    std::vector<std::vector<QBDI::MemoryAccess>>* batches = (std::vector<std::vector<QBDI::MemoryAccess>>*) data;
+    batches->emplace_back(accesses, accesses + size);
+    return QBDI::VMAction::CONTINUE;
+}
+
+QBDI_NOINLINE QBDI::rword fillBuffer(volatile QBDI::rword* buffer, QBDI::rword size) {
+    for(QBDI::rword i = 0; i < size; i++) {
+        buffer[i] = i * 3;
+    }
+    return size;
+}
+
+#if defined(QBDI_ARCH_X86_64)
+TEST_F(VMTest, MemoryTrace) {
+    QBDI::rword buffer[16];
+    std::vector<QBDI::MemoryAccess> expected;
+    std::vector<std::vector<QBDI::MemoryAccess>> batches;
+    QBDI::rword retval = 0;
+
+    uint32_t id = vm->addMemAccessCB(QBDI::MEMORY_WRITE, collectInstMemoryAccess, &expected);
+    ASSERT_NE(id, QBDI::VMError::INVALID_EVENTID);
+    ASSERT_TRUE(vm->setMemoryTrace(QBDI::MEMORY_WRITE, collectMemoryTrace, &batches, 4));
+
+    bool ran = vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer, 16});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(retval, (QBDI::rword) 16);
+
+    // The trace should be delivered in batches and contain the same accesses as the callback
+    std::vector<QBDI::MemoryAccess> traced;
+    for(const auto& batch : batches) {
+        EXPECT_NE((size_t) 0, batch.size());
+        traced.insert(traced.end(), batch.begin(), batch.end());
+    }
+    EXPECT_LT((size_t) 1, batches.size());
+    ASSERT_LE((size_t) 16, traced.size());
+    ASSERT_EQ(expected.size(), traced.size());
+    for(size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(expected[i].instAddress, traced[i].instAddress);
+        EXPECT_EQ(expected[i].accessAddress, traced[i].accessAddress);
+        EXPECT_EQ(expected[i].value, traced[i].value);
+        EXPECT_EQ(expected[i].size, traced[i].size);
+        EXPECT_EQ(QBDI::MEMORY_WRITE, traced[i].type);
+    }
+
+    // Nothing is delivered once disabled
+    ASSERT_TRUE(vm->setMemoryTrace((QBDI::MemoryAccessType) 0, nullptr, nullptr));
+    batches.clear();
+    ran = vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer, 16});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((size_t) 0, batches.size());
+
+    SUCCEED();
+}
+#endif
+
+#if defined(QBDI_ARCH_X86_64) && !defined(QBDI_OS_WIN)
+QBDI_NOINLINE QBDI::rword wideCopy(QBDI::rword dst, QBDI::rword src, QBDI::rword size) {
+    asm volatile(
+        "movups (%1), %%xmm0\n"
+        "movups %%xmm0, (%0)\n"
+        "rep movsb\n"
+        : "+D"(dst), "+S"(src), "+c"(size)
+        :
+        : "xmm0", "memory"
+    );
+    return size;
+}
+
+// Copy size words backward, from the last one, with the direction flag set
+QBDI_NOINLINE QBDI::rword backwardCopy(QBDI::rword dst, QBDI::rword src, QBDI::rword size) {
+    dst += (size - 1) * sizeof(QBDI::rword);
+    src += (size - 1) * sizeof(QBDI::rword);
+    asm volatile(
+        "std\n"
+        "rep movsq\n"
+        "cld\n"
+        : "+D"(dst), "+S"(src), "+c"(size)
+        :
+        : "memory"
+    );
+    return size;
+}
+
+struct WideAccess {
+    QBDI::MemoryAccess access;
+    std::vector<uint8_t> value;
+};
+
+QBDI::VMAction collectWideAccess(QBDI::VMInstanceRef vm, QBDI::GPRState *gprState, QBDI::FPRState *fprState, void *data) {
+    std::vector<WideAccess>* accesses = (std::vector<WideAccess>*) data;
+    for(const QBDI::MemoryAccess& access : vm->getInstMemoryAccess()) {
+        WideAccess wide = {access, std::vector<uint8_t>(access.size)};
+        if(!vm->getMemoryAccessValue(access, wide.value.data(), wide.value.size())) {
+            wide.value.clear();
+        }
+        accesses->push_back(wide);
+    }
+    return QBDI::VMAction::CONTINUE;
+}
+
+TEST_F(VMTest, WideMemoryAccess) {
+    uint8_t src[32];
+    uint8_t dst[32];
+    std::vector<WideAccess> accesses;
+    QBDI::rword retval = 1;
+
+    for(size_t i = 0; i < sizeof(src); i++) {
+        src[i] = i * 7;
+    }
+    memset(dst, 0, sizeof(dst));
+    uint32_t id = vm->addMemAccessCB(QBDI::MEMORY_READ_WRITE, collectWideAccess, &accesses);
+    ASSERT_NE(id, QBDI::VMError::INVALID_EVENTID);
+
+    bool ran = vm->call(&retval, (QBDI::rword) wideCopy, {(QBDI::rword) dst, (QBDI::rword) src, sizeof(src)});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((QBDI::rword) 0, retval);
+    EXPECT_EQ(0, memcmp(src, dst, sizeof(src)));
+
+    bool wideRead = false, wideWrite = false, stringRead = false, stringWrite = false;
+    for(const WideAccess& wide : accesses) {
+        const QBDI::MemoryAccess& access = wide.access;
+        if(access.size == 16 && access.type == QBDI::MEMORY_READ && access.accessAddress == (QBDI::rword) src) {
+            wideRead = true;
+            EXPECT_EQ(QBDI::MEMORY_PARTIAL_VALUE, access.flags);
+            EXPECT_EQ(*(QBDI::rword*) src, access.value);
+            ASSERT_EQ((size_t) 16, wide.value.size());
+            EXPECT_EQ(0, memcmp(src, wide.value.data(), 16));
+        }
+        else if(access.size == 16 && access.type == QBDI::MEMORY_WRITE && access.accessAddress == (QBDI::rword) dst) {
+            wideWrite = true;
+            EXPECT_EQ(QBDI::MEMORY_PARTIAL_VALUE, access.flags);
+            ASSERT_EQ((size_t) 16, wide.value.size());
+            EXPECT_EQ(0, memcmp(src, wide.value.data(), 16));
+        }
+        else if(access.flags == QBDI::MEMORY_UNKNOWN_VALUE) {
+            // The complete range of the repeated string operation is reported
+            EXPECT_EQ(sizeof(src), access.size);
+            EXPECT_TRUE(wide.value.empty());
+            if(access.type == QBDI::MEMORY_READ) {
+                stringRead = true;
+                EXPECT_EQ((QBDI::rword) src, access.accessAddress);
+            }
+            else {
+                stringWrite = true;
+                EXPECT_EQ((QBDI::rword) dst, access.accessAddress);
+            }
+        }
+    }
+    EXPECT_TRUE(wideRead);
+    EXPECT_TRUE(wideWrite);
+    EXPECT_TRUE(stringRead);
+    EXPECT_TRUE(stringWrite);
+
+    // A backward string operation is reported from its lowest address
+    accesses.clear();
+    memset(dst, 0, sizeof(dst));
+    ran = vm->call(&retval, (QBDI::rword) backwardCopy, {(QBDI::rword) dst, (QBDI::rword) src, sizeof(src) / sizeof(QBDI::rword)});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(0, memcmp(src, dst, sizeof(src)));
+    stringRead = stringWrite = false;
+    for(const WideAccess& wide : accesses) {
+        const QBDI::MemoryAccess& access = wide.access;
+        if(access.flags != QBDI::MEMORY_UNKNOWN_VALUE) {
+            continue;
+        }
+        EXPECT_EQ(sizeof(src), access.size);
+        if(access.type == QBDI::MEMORY_READ) {
+            stringRead = true;
+            EXPECT_EQ((QBDI::rword) src, access.accessAddress);
+        }
+        else {
+            stringWrite = true;
+            EXPECT_EQ((QBDI::rword) dst, access.accessAddress);
+        }
+    }
+    EXPECT_TRUE(stringRead);
+    EXPECT_TRUE(stringWrite);
+
+    SUCCEED();
+}
+#endif
+
+#if defined(QBDI_ARCH_X86_64)
+QBDI::VMAction countMemoryAccess(QBDI::VMInstanceRef vm, QBDI::GPRState *gprState, QBDI::FPRState *fprState, void *data) {
+    *((size_t*) data) += 1;
+    return QBDI::VMAction::CONTINUE;
+}
+
+TEST_F(VMTest, MemoryRangeWatch) {
+    // Large enough to span several watch filter granules
+    std::vector<QBDI::rword> buffer(64 * 1024);
+    QBDI::rword* watchedStart = buffer.data() + 40000;
+    size_t writes = 0, reads = 0;
+    QBDI::rword retval = 0;
+
+    uint32_t writeID = vm->addMemRangeCB((QBDI::rword) watchedStart, (QBDI::rword) (watchedStart + 16),
+                                         QBDI::MEMORY_WRITE, countMemoryAccess, &writes);
+    ASSERT_NE(writeID, QBDI::VMError::INVALID_EVENTID);
+    uint32_t readID = vm->addMemRangeCB((QBDI::rword) buffer.data(), (QBDI::rword) (buffer.data() + 1),
+                                        QBDI::MEMORY_READ, countMemoryAccess, &reads);
+    ASSERT_NE(readID, QBDI::VMError::INVALID_EVENTID);
+
+    bool ran = vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer.data(), buffer.size()});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((QBDI::rword) buffer.size(), retval);
+    // Only the writes to the watched words are forwarded, the buffer is never read
+    EXPECT_EQ((size_t) 16, writes);
+    EXPECT_EQ((size_t) 0, reads);
+
+    // The filters are updated when a range is deleted, without flushing the cache
+    ASSERT_TRUE(vm->deleteInstrumentation(writeID));
+    ran = vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer.data(), buffer.size()});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((size_t) 16, writes);
+
+    SUCCEED();
+}
+
+TEST_F(VMTest, PredicatedCallback) {
+    std::vector<QBDI::rword> buffer(1024);
+    QBDI::rword* watchedStart = buffer.data() + 512;
+    size_t hits = 0;
+    QBDI::rword retval = 0;
+
+    // Writes to the watched words, or to the exact address of the first word
+    std::vector<QBDI::Predicate> predicate = {
+        {QBDI::PREDICATE_AND, QBDI::PREDICATE_MEM_IN_RANGE, QBDI::MEMORY_WRITE, 0,
+         (QBDI::rword) watchedStart, (QBDI::rword) (watchedStart + 16)},
+        {QBDI::PREDICATE_OR, QBDI::PREDICATE_MEM_MASK, QBDI::MEMORY_WRITE, (QBDI::rword) -1,
+         (QBDI::rword) buffer.data(), 0},
+    };
+    uint32_t instrID = vm->addCodeCB(QBDI::PREINST, countMemoryAccess, &hits, predicate);
+    ASSERT_NE(instrID, QBDI::VMError::INVALID_EVENTID);
+
+    bool ran = vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer.data(), buffer.size()});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((QBDI::rword) buffer.size(), retval);
+    EXPECT_EQ((size_t) 17, hits);
+
+    SUCCEED();
+}
+#endif
+
+#if defined(QBDI_ARCH_X86_64)
+QBDI::VMAction countEvent(QBDI::VMInstanceRef vm, const QBDI::VMState *state, QBDI::GPRState *gprState,
+                          QBDI::FPRState *fprState, void *data) {
+    *((size_t*) data) += 1;
+    return QBDI::VMAction::CONTINUE;
+}
+
+TEST_F(VMTest, SampledCallback) {
+    std::vector<QBDI::rword> buffer(1024);
+    uint64_t executed = 0;
+    size_t samples = 0, writeSamples = 0, sequences = 0, sequenceSamples = 0;
+    QBDI::rword retval = 0;
+
+    ASSERT_EQ(QBDI::VMError::INVALID_EVENTID, vm->addSampledCodeCB(QBDI::PREINST, countMemoryAccess, &samples, 0));
+    ASSERT_NE(QBDI::VMError::INVALID_EVENTID, vm->addCodeCounter(&executed));
+    ASSERT_NE(QBDI::VMError::INVALID_EVENTID, vm->addSampledCodeCB(QBDI::PREINST, countMemoryAccess, &samples, 100));
+    // Only the writes to the last 64 words are counted by the countdown
+    std::vector<QBDI::Predicate> predicate = {
+        {QBDI::PREDICATE_AND, QBDI::PREDICATE_MEM_IN_RANGE, QBDI::MEMORY_WRITE, 0,
+         (QBDI::rword) (buffer.data() + 960), (QBDI::rword) (buffer.data() + 1024)},
+    };
+    ASSERT_NE(QBDI::VMError::INVALID_EVENTID, vm->addSampledCodeCB(QBDI::PREINST, countMemoryAccess, &writeSamples, 
+                                                                   16, false, predicate));
+    ASSERT_NE(QBDI::VMError::INVALID_EVENTID, vm->addVMEventCB(QBDI::SEQUENCE_ENTRY, countEvent, &sequences));
+    ASSERT_NE(QBDI::VMError::INVALID_EVENTID, vm->addSampledVMEventCB(QBDI::SEQUENCE_ENTRY, countEvent, 
+                                                                      &sequenceSamples, 3));
+
+    bool ran = vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer.data(), buffer.size()});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((QBDI::rword) buffer.size(), retval);
+    EXPECT_EQ((size_t) (executed / 100), samples);
+    EXPECT_EQ((size_t) 4, writeSamples);
+    EXPECT_EQ(sequences / 3, sequenceSamples);
+
+    // Randomized intervals keep the same mean
+    vm->deleteAllInstrumentations();
+    samples = 0;
+    executed = 0;
+    ASSERT_NE(QBDI::VMError::INVALID_EVENTID, vm->addCodeCounter(&executed));
+    uint32_t id = vm->addSampledCodeCB(QBDI::PREINST, countMemoryAccess, &samples, 10, true);
+    ASSERT_NE(QBDI::VMError::INVALID_EVENTID, id);
+    for(int i = 0; i < 16; i++) {
+        vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer.data(), buffer.size()});
+    }
+    EXPECT_GT(samples, executed / 20);
+    EXPECT_LT(samples, executed / 5);
+
+    // A deleted sampled callback is not called anymore, its sampler is released by the next run
+    size_t remaining = samples;
+    ASSERT_TRUE(vm->deleteInstrumentation(id));
+    ASSERT_TRUE(vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer.data(), buffer.size()}));
+    EXPECT_EQ(remaining, samples);
+
+    SUCCEED();
+}
+#endif
+
+#if defined(QBDI_ARCH_X86_64)
+TEST_F(VMTest, ExecutionBudget) {
+    std::vector<QBDI::rword> buffer(64);
+    QBDI::GPRState* state = vm->getGPRState();
+    uint64_t total = 0, sliced = 0, executed = 0;
+    QBDI::rword retval = 0;
+
+    uint32_t counterID = vm->addCodeCounter(&total);
+    ASSERT_NE(QBDI::VMError::INVALID_EVENTID, counterID);
+    ASSERT_TRUE(vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer.data(), buffer.size()}));
+    vm->deleteInstrumentation(counterID);
+    ASSERT_GT(total, (uint64_t) 64);
+
+    // The same call executed by slices of 7 instructions, each one resumed where the previous 
+    // one stopped
+    QBDI::simulateCall(state, 42, {(QBDI::rword) buffer.data(), buffer.size()});
+    QBDI::rword pc = (QBDI::rword) fillBuffer;
+    while(pc != 42) {
+        ASSERT_TRUE(vm->runWithBudget(pc, 42, 7, QBDI::BUDGET_INSTRUCTIONS, &executed));
+        pc = QBDI_GPR_GET(state, QBDI::REG_PC);
+        if(pc != 42) {
+            ASSERT_EQ((uint64_t) 7, executed);
+        }
+        sliced += executed;
+    }
+    EXPECT_EQ(total, sliced);
+    EXPECT_EQ((QBDI::rword) buffer.size(), QBDI_GPR_GET(state, QBDI::REG_RETURN));
+
+    // A basic block budget stops at the entry of a basic block
+    QBDI::simulateCall(state, 42, {(QBDI::rword) buffer.data(), buffer.size()});
+    ASSERT_TRUE(vm->runWithBudget((QBDI::rword) fillBuffer, 42, 3, QBDI::BUDGET_BASIC_BLOCKS, &executed));
+    EXPECT_EQ((uint64_t) 3, executed);
+    EXPECT_NE((QBDI::rword) 42, QBDI_GPR_GET(state, QBDI::REG_PC));
+    ASSERT_TRUE(vm->run(QBDI_GPR_GET(state, QBDI::REG_PC), 42));
+    EXPECT_EQ((QBDI::rword) buffer.size(), QBDI_GPR_GET(state, QBDI::REG_RETURN));
+
+    SUCCEED();
+}
+#endif
+
+#if defined(QBDI_ARCH_X86_64)
+QBDI_NOINLINE QBDI::rword budgetTail(QBDI::rword skip) {
+    QBDI::rword count = 0;
+    asm volatile(
+        "test %1, %1\n"
+        "jnz 1f\n"
+        "inc %0\n"
+        "inc %0\n"
+        "inc %0\n"
+        "inc %0\n"
+        "1:\n"
+        "inc %0\n"
+        "inc %0\n"
+        "inc %0\n"
+        "inc %0\n"
+        : "+r" (count) : "r" (skip) : "cc"
+    );
+    return count;
+}
+
+TEST_F(VMTest, ExecutionBudgetCachedTail) {
+    QBDI::GPRState* state = vm->getGPRState();
+    uint64_t full = 0, tail = 0, executed = 0;
+    QBDI::rword retval = 0;
+
+    uint32_t counterID = vm->addCodeCounter(&full);
+    ASSERT_NE(QBDI::VMError::INVALID_EVENTID, counterID);
+    ASSERT_TRUE(vm->call(&retval, (QBDI::rword) budgetTail, {0}));
+    vm->deleteInstrumentation(counterID);
+    counterID = vm->addCodeCounter(&tail);
+    ASSERT_NE(QBDI::VMError::INVALID_EVENTID, counterID);
+    ASSERT_TRUE(vm->call(&retval, (QBDI::rword) budgetTail, {1}));
+    vm->deleteInstrumentation(counterID);
+    ASSERT_EQ(full, tail + 4);
+
+    // The tail is cached first, the basic block entered next is only written up to it and 
+    // charged for the instructions written
+    QBDI::simulateCall(state, 42, {1});
+    ASSERT_TRUE(vm->runWithBudget((QBDI::rword) budgetTail, 42, 1000, QBDI::BUDGET_INSTRUCTIONS, &executed));
+    ASSERT_EQ(tail, executed);
+    QBDI::simulateCall(state, 42, {0});
+    ASSERT_TRUE(vm->runWithBudget((QBDI::rword) budgetTail, 42, full - 2, QBDI::BUDGET_INSTRUCTIONS, &executed));
+    EXPECT_EQ(full - 2, executed);
+    ASSERT_NE((QBDI::rword) 42, QBDI_GPR_GET(state, QBDI::REG_PC));
+    ASSERT_TRUE(vm->runWithBudget(QBDI_GPR_GET(state, QBDI::REG_PC), 42, 1000, QBDI::BUDGET_INSTRUCTIONS, 
+                                  &executed));
+    EXPECT_EQ((uint64_t) 2, executed);
+    EXPECT_EQ((QBDI::rword) 8, QBDI_GPR_GET(state, QBDI::REG_RETURN));
+
+    // The whole basic block is cached first, the tail is then entered in the middle of its 
+    // sequence
+    vm->clearAllCache();
+    QBDI::simulateCall(state, 42, {0});
+    ASSERT_TRUE(vm->runWithBudget((QBDI::rword) budgetTail, 42, 1000, QBDI::BUDGET_INSTRUCTIONS, &executed));
+    ASSERT_EQ(full, executed);
+    QBDI::simulateCall(state, 42, {1});
+    ASSERT_TRUE(vm->runWithBudget((QBDI::rword) budgetTail, 42, tail - 2, QBDI::BUDGET_INSTRUCTIONS, &executed));
+    EXPECT_EQ(tail - 2, executed);
+    ASSERT_NE((QBDI::rword) 42, QBDI_GPR_GET(state, QBDI::REG_PC));
+    ASSERT_TRUE(vm->runWithBudget(QBDI_GPR_GET(state, QBDI::REG_PC), 42, 1000, QBDI::BUDGET_INSTRUCTIONS, 
+                                  &executed));
+    EXPECT_EQ((uint64_t) 2, executed);
+    EXPECT_EQ((QBDI::rword) 4, QBDI_GPR_GET(state, QBDI::REG_RETURN));
+
+    SUCCEED();
+}
+#endif
+
+#if defined(QBDI_ARCH_X86_64)
+TEST_F(VMTest, InstrumentationSwitch) {
+    std::vector<QBDI::rword> buffer(1024);
+    QBDI::rword* watchedStart = buffer.data() + 512;
+    uint64_t executed = 0;
+    size_t calls = 0, hits = 0, writes = 0, translations = 0;
+    QBDI::rword retval = 0;
+
+    uint32_t counterID = vm->addCodeCounter(&executed);
+    ASSERT_NE(counterID, QBDI::VMError::INVALID_EVENTID);
+    uint32_t codeID = vm->addCodeCB(QBDI::PREINST, countMemoryAccess, &calls);
+    ASSERT_NE(codeID, QBDI::VMError::INVALID_EVENTID);
+    std::vector<QBDI::Predicate> predicate = {
+        {QBDI::PREDICATE_AND, QBDI::PREDICATE_MEM_IN_RANGE, QBDI::MEMORY_WRITE, 0,
+         (QBDI::rword) watchedStart, (QBDI::rword) (watchedStart + 16)},
+    };
+    uint32_t predicateID = vm->addCodeCB(QBDI::PREINST, countMemoryAccess, &hits, predicate);
+    ASSERT_NE(predicateID, QBDI::VMError::INVALID_EVENTID);
+    uint32_t rangeID = vm->addMemRangeCB((QBDI::rword) watchedStart, (QBDI::rword) (watchedStart + 16),
+                                         QBDI::MEMORY_WRITE, countMemoryAccess, &writes);
+    ASSERT_NE(rangeID, QBDI::VMError::INVALID_EVENTID);
+    ASSERT_NE(QBDI::VMError::INVALID_EVENTID, vm->addVMEventCB(QBDI::BASIC_BLOCK_NEW, countEvent, &translations));
+    // Inline counters do not break to the host and cannot be switched
+    EXPECT_EQ(QBDI::SwitchStatus::SWITCH_UNSUPPORTED, vm->setInstrumentationEnabled(counterID, false));
+    EXPECT_EQ(QBDI::SwitchStatus::SWITCH_INVALID_ID, vm->setInstrumentationEnabled(counterID + 1000, false));
+
+    // The first switch of a code callback translates its range again
+    ASSERT_EQ(QBDI::SwitchStatus::SWITCH_UPDATED, vm->setInstrumentationEnabled(codeID, false));
+    ASSERT_EQ(QBDI::SwitchStatus::SWITCH_UPDATED, vm->setInstrumentationEnabled(predicateID, false));
+    ASSERT_EQ(QBDI::SwitchStatus::SWITCH_UPDATED, vm->setInstrumentationEnabled(rangeID, false));
+    bool ran = vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer.data(), buffer.size()});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((QBDI::rword) buffer.size(), retval);
+    EXPECT_NE((uint64_t) 0, executed);
+    EXPECT_EQ((size_t) 0, calls);
+    EXPECT_EQ((size_t) 0, hits);
+    EXPECT_EQ((size_t) 0, writes);
+    EXPECT_NE((size_t) 0, translations);
+
+    // The following switches only update the inline switches
+    translations = 0;
+    executed = 0;
+    ASSERT_EQ(QBDI::SwitchStatus::SWITCH_UPDATED, vm->setInstrumentationEnabled(codeID, true));
+    ASSERT_EQ(QBDI::SwitchStatus::SWITCH_UPDATED, vm->setInstrumentationEnabled(predicateID, true));
+    ASSERT_EQ(QBDI::SwitchStatus::SWITCH_UPDATED, vm->setInstrumentationEnabled(rangeID, true));
+    ran = vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer.data(), buffer.size()});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((size_t) executed, calls);
+    EXPECT_EQ((size_t) 16, hits);
+    EXPECT_EQ((size_t) 16, writes);
+    EXPECT_EQ((size_t) 0, translations);
+
+    size_t enabledCalls = calls;
+    ASSERT_EQ(QBDI::SwitchStatus::SWITCH_UPDATED, vm->setInstrumentationEnabled(codeID, false));
+    ran = vm->call(&retval, (QBDI::rword) fillBuffer, {(QBDI::rword) buffer.data(), buffer.size()});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(enabledCalls, calls);
+    EXPECT_EQ((size_t) 32, hits);
+    EXPECT_EQ((size_t) 0, translations);
+
+    SUCCEED();
+}
+#endif
+
+#if defined(QBDI_ARCH_X86_64) && !defined(QBDI_OS_WIN)
+QBDI_NOINLINE QBDI::rword maskBuffer(const volatile uint8_t* src, volatile uint8_t* dst, QBDI::rword size) {
+    for(QBDI::rword i = 0; i < size; i++) {
+        dst[i] = src[i] ^ 0x5a;
+    }
+    return dst[3];
+}
+
+// Load 16 bytes, then overwrite the second byte of the first word and the whole second word
+QBDI_NOINLINE void partialWrite(volatile uint8_t* dst, const volatile uint8_t* src) {
+    asm volatile(
+        "movq (%1), %%rax\n"
+        "movb $0, %%ah\n"
+        "movq %%rax, (%0)\n"
+        "movq 8(%1), %%rax\n"
+        "movl $1, %%eax\n"
+        "movq %%rax, 8(%0)\n"
+        :
+        : "r"(dst), "r"(src)
+        : "rax", "memory"
+    );
+}
+
+TEST_F(VMTest, TaintTracking) {
+    uint8_t src[16] = {0};
+    uint8_t dst[16] = {0};
+    QBDI::rword retval = 0;
+
+    ASSERT_FALSE(vm->setMemoryTaint((QBDI::rword) src, sizeof(src), 1));
+    ASSERT_TRUE(vm->setTaintTracking(true));
+    ASSERT_TRUE(vm->setMemoryTaint((QBDI::rword) (src + 2), 4, 1));
+    EXPECT_EQ(1, vm->getMemoryTaint((QBDI::rword) src, sizeof(src)));
+    EXPECT_EQ(0, vm->getMemoryTaint((QBDI::rword) dst, sizeof(dst)));
+    EXPECT_FALSE(vm->setRegisterTaint(QBDI::REG_SP, 1));
+
+    bool ran = vm->call(&retval, (QBDI::rword) maskBuffer, {(QBDI::rword) src, (QBDI::rword) dst, sizeof(src)});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((QBDI::rword) 0x5a, retval);
+    // Only the bytes computed from the tainted ones are tainted
+    for(size_t i = 0; i < sizeof(dst); i++) {
+        EXPECT_EQ((i >= 2 && i < 6) ? 1 : 0, vm->getMemoryTaint((QBDI::rword) (dst + i), 1));
+    }
+    EXPECT_EQ(1, vm->getRegisterTaint(QBDI::REG_RETURN));
+
+    // The labels of the bytes a partial write does not reach are kept, except for the upper half
+    // cleared by a 32 bits write
+    ASSERT_TRUE(vm->setMemoryTaint((QBDI::rword) src, sizeof(src), 1));
+    ran = vm->call(nullptr, (QBDI::rword) partialWrite, {(QBDI::rword) dst, (QBDI::rword) src});
+    ASSERT_TRUE(ran);
+    for(size_t i = 0; i < sizeof(dst); i++) {
+        EXPECT_EQ((i == 1 || i >= 8) ? 0 : 1, vm->getMemoryTaint((QBDI::rword) (dst + i), 1));
+    }
+
+    // The labels are no longer propagated once disabled
+    ASSERT_TRUE(vm->setRegisterTaint(QBDI::REG_RETURN, 0));
+    ASSERT_TRUE(vm->setMemoryTaint((QBDI::rword) dst, sizeof(dst), 0));
+    ASSERT_TRUE(vm->setTaintTracking(false));
+    ran = vm->call(&retval, (QBDI::rword) maskBuffer, {(QBDI::rword) src, (QBDI::rword) dst, sizeof(src)});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(0, vm->getMemoryTaint((QBDI::rword) dst, sizeof(dst)));
+    EXPECT_EQ(0, vm->getRegisterTaint(QBDI::REG_RETURN));
+
+    SUCCEED();
+}
+#endif
+
+#if defined(QBDI_ARCH_X86_64)
+QBDI_NOINLINE QBDI::rword callStackInner(QBDI::rword x) {
+    return x * 3 + 1;
+}
+
+QBDI_NOINLINE QBDI::rword callStackMiddle(QBDI::rword x) {
+    return callStackInner(x + 1) + 2;
+}
+
+QBDI_NOINLINE QBDI::rword callStackOuter(QBDI::rword x) {
+    return callStackMiddle(x) ^ callStackInner(x);
+}
+
+struct CallStackInfo {
+    size_t entries;
+    size_t exits;
+    std::vector<QBDI::CallFrame> deepest;
+};
+
+QBDI::VMAction onFunctionEvent(QBDI::VMInstanceRef vm, const QBDI::VMState *state, QBDI::GPRState *gprState,
+                               QBDI::FPRState *fprState, void *data) {
+    CallStackInfo* info = (CallStackInfo*) data;
+    if(state->event & QBDI::FUNCTION_ENTRY) {
+        std::vector<QBDI::CallFrame> frames = vm->getCallStack();
+        info->entries++;
+        if(frames.size() > info->deepest.size()) {
+            info->deepest = frames;
+        }
+    }
+    if(state->event & QBDI::FUNCTION_EXIT) {
+        info->exits++;
+    }
+    return QBDI::VMAction::CONTINUE;
+}
+
+TEST_F(VMTest, CallStack) {
+    CallStackInfo info = {0, 0, {}};
+    QBDI::rword retval = 0;
+
+    EXPECT_EQ(0u, vm->getCallStack().size());
+    uint32_t id = vm->addVMEventCB(QBDI::FUNCTION_ENTRY | QBDI::FUNCTION_EXIT, onFunctionEvent, &info);
+    ASSERT_NE(id, QBDI::INVALID_EVENTID);
+
+    bool ran = vm->call(&retval, (QBDI::rword) callStackOuter, {5});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(callStackOuter(5), retval);
+    // The function started by the call is entered without a call instruction, only its exit is 
+    // signaled
+    EXPECT_EQ(3u, info.entries);
+    EXPECT_EQ(4u, info.exits);
+    ASSERT_EQ(2u, info.deepest.size());
+    EXPECT_EQ((QBDI::rword) callStackInner, info.deepest[0].target);
+    EXPECT_EQ((QBDI::rword) callStackMiddle, info.deepest[1].target);
+    EXPECT_EQ(info.deepest[0].callSite, info.deepest[0].returnAddress - 5);
+    EXPECT_LT(info.deepest[0].stackPointer, info.deepest[1].stackPointer);
+    EXPECT_EQ(0u, vm->getCallStack().size());
+
+    vm->deleteInstrumentation(id);
+    SUCCEED();
+}
+#endif
+
+#if defined(QBDI_ARCH_X86_64)
+QBDI_NOINLINE QBDI::rword branchTargetA(QBDI::rword x) {
+    return x + 1;
+}
+
+QBDI_NOINLINE QBDI::rword branchTargetB(QBDI::rword x) {
+    return x * 2;
+}
+
+QBDI_NOINLINE QBDI::rword indirectCalls(QBDI::rword n) {
+    QBDI::rword (* volatile targets[2])(QBDI::rword) = {branchTargetA, branchTargetB};
+    QBDI::rword sum = 0;
+    for(QBDI::rword i = 0; i < n; i++) {
+        sum += targets[i % 3 == 0](i);
+    }
+    return sum;
+}
+
+QBDI_NOINLINE QBDI::rword branchTargetC(QBDI::rword x) {
+    return x - 3;
+}
+
+QBDI_NOINLINE QBDI::rword branchTargetD(QBDI::rword x) {
+    return x ^ 4;
+}
+
+QBDI_NOINLINE QBDI::rword branchTargetE(QBDI::rword x) {
+    return x | 5;
+}
+
+QBDI_NOINLINE QBDI::rword branchTargetF(QBDI::rword x) {
+    return x * 6;
+}
+
+QBDI_NOINLINE QBDI::rword polymorphicCalls(QBDI::rword n) {
+    QBDI::rword (* volatile targets[6])(QBDI::rword) = {
+        branchTargetA, branchTargetB, branchTargetC, branchTargetD, branchTargetE, branchTargetF
+    };
+    QBDI::rword sum = 0;
+    for(QBDI::rword i = 0; i < n; i++) {
+        sum += targets[i % 6](i);
+    }
+    return sum;
+}
+
+TEST_F(VMTest, BranchProfiling) {
+    QBDI::rword retval = 0;
+    size_t profiled = 0;
+
+    ASSERT_TRUE(vm->setBranchProfiling(true));
+    bool ran = vm->call(&retval, (QBDI::rword) indirectCalls, {30});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(indirectCalls(30), retval);
+
+    for(QBDI::rword site : vm->getBranchSites()) {
+        std::vector<QBDI::BranchTarget> targets = vm->getBranchTargets(site);
+        ASSERT_NE(0u, targets.size());
+        if(targets[0].target != (QBDI::rword) branchTargetA) {
+            continue;
+        }
+        // The call alternates between the targets, most frequent first
+        ASSERT_EQ(2u, targets.size());
+        EXPECT_EQ((uint64_t) 20, targets[0].count);
+        EXPECT_EQ((QBDI::rword) branchTargetB, targets[1].target);
+        EXPECT_EQ((uint64_t) 10, targets[1].count);
+        profiled++;
+    }
+    EXPECT_EQ(1u, profiled);
+
+    // The targets which do not fit in the table of the site are counted by the host
+    ASSERT_TRUE(vm->setBranchProfiling(false));
+    ASSERT_TRUE(vm->setBranchProfiling(true));
+    ran = vm->call(&retval, (QBDI::rword) polymorphicCalls, {60});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(polymorphicCalls(60), retval);
+    profiled = 0;
+    for(QBDI::rword site : vm->getBranchSites()) {
+        std::vector<QBDI::BranchTarget> targets = vm->getBranchTargets(site);
+        if(targets.size() != 6u) {
+            continue;
+        }
+        for(const QBDI::BranchTarget& target : targets) {
+            EXPECT_EQ((uint64_t) 10, target.count);
+        }
+        profiled++;
+    }
+    EXPECT_EQ(1u, profiled);
+
+    // The profile is kept once disabled, and reset when enabled again
+    ASSERT_TRUE(vm->setBranchProfiling(false));
+    EXPECT_NE(0u, vm->getBranchSites().size());
+    ASSERT_TRUE(vm->setBranchProfiling(true));
+    EXPECT_EQ(0u, vm->getBranchSites().size());
+    ASSERT_TRUE(vm->setBranchProfiling(false));
+
+    SUCCEED();
+}
+#endif
+
+#if defined(QBDI_ARCH_X86_64) && defined(QBDI_OS_LINUX)
+QBDI_NOINLINE QBDI::rword rawGetpid(QBDI::rword n) {
+    QBDI::rword sum = 0;
+    for(QBDI::rword i = 0; i < n; i++) {
+        QBDI::rword ret;
+        // getpid, its first argument register carries the iteration
+        asm volatile("syscall" : "=a"(ret) : "a"((QBDI::rword) 39), "D"(i) : "rcx", "r11", "memory");
+        sum += ret;
+    }
+    return sum;
+}
+
+QBDI::VMAction logSyscallEvent(QBDI::VMInstanceRef vm, const QBDI::VMState *state, QBDI::GPRState *gprState,
+                               QBDI::FPRState *fprState, void *data) {
+    ((std::vector<QBDI::VMState>*) data)->push_back(*state);
+    return QBDI::VMAction::CONTINUE;
+}
+
+QBDI::VMAction logSyscallTrace(QBDI::VMInstanceRef vm, const QBDI::SyscallRecord *records, size_t size, void *data) {
+    std::vector<std::vector<QBDI::SyscallRecord>>* batches = (std::vector<std::vector<QBDI::SyscallRecord>>*) data;
+    batches->push_back(std::vector<QBDI::SyscallRecord>(records, records + size));
+    return QBDI::VMAction::CONTINUE;
+}
+
+TEST_F(VMTest, SyscallEvents) {
+    std::vector<QBDI::VMState> events;
+    std::vector<std::vector<QBDI::SyscallRecord>> batches;
+    QBDI::rword pid = (QBDI::rword) getpid();
+    QBDI::rword retval = 0;
+
+    uint32_t id = vm->addVMEventCB(QBDI::SYSCALL_ENTRY | QBDI::SYSCALL_EXIT, logSyscallEvent, &events);
+    ASSERT_NE(QBDI::INVALID_EVENTID, id);
+    ASSERT_TRUE(vm->setSyscallTrace(logSyscallTrace, &batches, 2));
+    bool ran = vm->call(&retval, (QBDI::rword) rawGetpid, {5});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(5 * pid, retval);
+
+    // The events alternate, with the number and arguments in both and the return value on exit
+    ASSERT_EQ(10u, events.size());
+    for(size_t i = 0; i < events.size(); i++) {
+        EXPECT_EQ((i % 2 == 0) ? QBDI::SYSCALL_ENTRY : QBDI::SYSCALL_EXIT, events[i].event);
+        EXPECT_EQ((QBDI::rword) 39, events[i].syscallNumber);
+        EXPECT_EQ((QBDI::rword) (i / 2), events[i].syscallArgs[0]);
+        EXPECT_EQ((i % 2 == 0) ? 0 : pid, events[i].syscallReturn);
+    }
+
+    // The trace is delivered once 2 records are pending, the remainder at the end of the run
+    size_t recorded = 0;
+    ASSERT_NE(0u, batches.size());
+    for(const auto& batch : batches) {
+        for(const QBDI::SyscallRecord& record : batch) {
+            EXPECT_EQ((QBDI::rword) 39, record.number);
+            EXPECT_EQ((QBDI::rword) recorded, record.args[0]);
+            EXPECT_EQ(pid, record.ret);
+            recorded++;
+        }
+    }
+    EXPECT_EQ(5u, recorded);
+    for(size_t i = 0; i + 1 < batches.size(); i++) {
+        EXPECT_LE(2u, batches[i].size());
+    }
+
+    ASSERT_TRUE(vm->setSyscallTrace(nullptr, nullptr, 0));
+    ASSERT_TRUE(vm->deleteInstrumentation(id));
+    SUCCEED();
+}
+
+QBDI_NOINLINE void rawExitGroup(QBDI::rword status) {
+    asm volatile("syscall" : : "a"((QBDI::rword) 231), "D"(status) : "rcx", "r11", "memory");
+}
+
+QBDI::VMAction writeSyscallTrace(QBDI::VMInstanceRef vm, const QBDI::SyscallRecord *records, size_t size, void *data) {
+    ssize_t written = write(*((int*) data), records, size * sizeof(QBDI::SyscallRecord));
+    return written == (ssize_t) (size * sizeof(QBDI::SyscallRecord)) ? QBDI::VMAction::CONTINUE : QBDI::VMAction::STOP;
+}
+
+TEST_F(VMTest, SyscallTraceNoReturn) {
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+
+    // The child delivers its trace through the pipe before exit_group ends it
+    pid_t child = fork();
+    ASSERT_NE(-1, child);
+    if(child == 0) {
+        close(fds[0]);
+        vm->setSyscallTrace(writeSyscallTrace, &fds[1], 16);
+        vm->call(nullptr, (QBDI::rword) rawExitGroup, {7});
+        _exit(1);
+    }
+    close(fds[1]);
+    std::vector<QBDI::SyscallRecord> records;
+    QBDI::SyscallRecord record;
+    while(read(fds[0], &record, sizeof(record)) == sizeof(record)) {
+        records.push_back(record);
+    }
+    close(fds[0]);
+    int status = 0;
+    ASSERT_EQ(child, waitpid(child, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(7, WEXITSTATUS(status));
+
+    // The record is delivered before its execution, without a return value
+    ASSERT_EQ(1u, records.size());
+    EXPECT_EQ((QBDI::rword) 231, records[0].number);
+    EXPECT_EQ((QBDI::rword) 7, records[0].args[0]);
+    EXPECT_EQ((QBDI::rword) 0, records[0].ret);
+    SUCCEED();
+}
+#endif
+
+QBDI_NOINLINE QBDI::rword interceptedTarget(QBDI::rword x) {
+    return x + 1;
+}
+
+QBDI_NOINLINE QBDI::rword interceptedReplacement(QBDI::rword x) {
+    return x * 10;
+}
+
+QBDI_NOINLINE QBDI::rword interceptedCalls(QBDI::rword n) {
+    QBDI::rword (* volatile target)(QBDI::rword) = interceptedTarget;
+    QBDI::rword sum = 0;
+    for(QBDI::rword i = 0; i < n; i++) {
+        sum += target(i);
+    }
+    return sum;
+}
+
+#if defined(QBDI_ARCH_X86_64)
+// The entry of the function is also the header of its loop
+extern "C" QBDI::rword interceptedLoop(QBDI::rword n, QBDI::rword acc);
+asm(
+    ".text\n"
+    "interceptedLoop:\n"
+    "inc %rsi\n"
+    "dec %rdi\n"
+    "jnz interceptedLoop\n"
+    "mov %rsi, %rax\n"
+    "ret\n"
+);
+#endif
+
+struct WrapCounts {
+    QBDI::rword entries;
+    QBDI::rword returns;
+    QBDI::rword returned;
+};
+
+QBDI::VMAction countWrappedEntry(QBDI::VMInstanceRef vm, QBDI::GPRState *gprState, QBDI::FPRState *fprState, void *data) {
+    ((WrapCounts*) data)->entries++;
+    return QBDI::VMAction::CONTINUE;
+}
+
+QBDI::VMAction countWrappedReturn(QBDI::VMInstanceRef vm, QBDI::GPRState *gprState, QBDI::FPRState *fprState, void *data) {
+    ((WrapCounts*) data)->returns++;
+    ((WrapCounts*) data)->returned += QBDI_GPR_GET(gprState, QBDI::REG_RETURN);
+    return QBDI::VMAction::CONTINUE;
+}
+
+TEST_F(VMTest, FunctionInterception) {
+    WrapCounts counts = {0, 0, 0};
+    QBDI::rword retval = 0;
+
+    // The replacement is called instead of the target
+    uint32_t id = vm->replaceFunction((QBDI::rword) interceptedTarget, (QBDI::rword) interceptedReplacement);
+    ASSERT_NE(QBDI::INVALID_EVENTID, id);
+    EXPECT_EQ(QBDI::INVALID_EVENTID, vm->wrapFunction((QBDI::rword) interceptedTarget, countWrappedEntry, nullptr, nullptr));
+    bool ran = vm->call(&retval, (QBDI::rword) interceptedCalls, {4});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((QBDI::rword) 60, retval);
+    ASSERT_TRUE(vm->deleteInstrumentation(id));
+
+    // The wrappers see each entry and each return value
+    id = vm->wrapFunction((QBDI::rword) interceptedTarget, countWrappedEntry, countWrappedReturn, &counts);
+    ASSERT_NE(QBDI::INVALID_EVENTID, id);
+    ran = vm->call(&retval, (QBDI::rword) interceptedCalls, {4});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((QBDI::rword) 10, retval);
+    EXPECT_EQ((QBDI::rword) 4, counts.entries);
+    EXPECT_EQ((QBDI::rword) 4, counts.returns);
+    EXPECT_EQ((QBDI::rword) 10, counts.returned);
+
+    // A function started by the run returns to the stop address
+    ran = vm->call(&retval, (QBDI::rword) interceptedTarget, {41});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((QBDI::rword) 42, retval);
+    EXPECT_EQ((QBDI::rword) 5, counts.entries);
+    EXPECT_EQ((QBDI::rword) 5, counts.returns);
+
+    // A disabled interception is ignored
+    ASSERT_EQ(QBDI::SwitchStatus::SWITCH_UPDATED, vm->setInstrumentationEnabled(id, false));
+    ran = vm->call(&retval, (QBDI::rword) interceptedCalls, {4});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((QBDI::rword) 5, counts.entries);
+    ASSERT_TRUE(vm->deleteInstrumentation(id));
+
+#if defined(QBDI_ARCH_X86_64)
+    // The back edges to the entry stay in the same call
+    counts = {0, 0, 0};
+    id = vm->wrapFunction((QBDI::rword) interceptedLoop, countWrappedEntry, countWrappedReturn, &counts);
+    ASSERT_NE(QBDI::INVALID_EVENTID, id);
+    ran = vm->call(&retval, (QBDI::rword) interceptedLoop, {8, 0});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ((QBDI::rword) 8, retval);
+    EXPECT_EQ((QBDI::rword) 1, counts.entries);
+    EXPECT_EQ((QBDI::rword) 1, counts.returns);
+    EXPECT_EQ((QBDI::rword) 8, counts.returned);
+    ASSERT_TRUE(vm->deleteInstrumentation(id));
+#endif
+
+    SUCCEED();
+}
+
 #define MNEM_CMP "CMP*"
 
 QBDI::VMAction evilMnemCbk(QBDI::VMInstanceRef vm, QBDI::GPRState *gprState, QBDI::FPRState *fprState, void *data) {
@@ -332,6 +1341,58 @@ TEST_F(VMTest, MnemCallback) {
     SUCCEED();
 }
 
+struct RuleOrderInfo {
+    std::vector<int>* log;
+    int tag;
+};
+
+QBDI::VMAction logCmpRule(QBDI::VMInstanceRef vm, QBDI::GPRState *gprState, QBDI::FPRState *fprState, void *data) {
+    RuleOrderInfo* info = (RuleOrderInfo*) data;
+    const QBDI::InstAnalysis* ana = vm->getInstAnalysis(QBDI::ANALYSIS_INSTRUCTION);
+    if (QBDI::String::startsWith(MNEM_CMP, ana->mnemonic)) {
+        info->log->push_back(info->tag);
+    }
+    return QBDI::VMAction::CONTINUE;
+}
+
+TEST_F(VMTest, RuleIndexOrder) {
+    std::vector<int> log;
+    RuleOrderInfo infos[4] = {{&log, 0}, {&log, 1}, {&log, 2}, {&log, 3}};
+    QBDI::rword retval = 0;
+
+    // Unrelated address rules, indexed away from the instrumented code
+    for (QBDI::rword i = 1; i <= 100; i++) {
+        vm->addCodeRangeCB(i * 0x1000, i * 0x1000 + 0x10, QBDI::InstPosition::PREINST, logCmpRule, &infos[0]);
+    }
+    // Rules indexed by address, by opcode and tested on every instruction keep their order
+    vm->addCodeRangeCB((QBDI::rword) satanicFun, ((QBDI::rword) satanicFun) + 100, QBDI::InstPosition::PREINST,
+                       logCmpRule, &infos[0]);
+    uint32_t mnemId = vm->addMnemonicCB(MNEM_CMP, QBDI::InstPosition::PREINST, logCmpRule, &infos[1]);
+    vm->addCodeCB(QBDI::InstPosition::PREINST, logCmpRule, &infos[2]);
+    vm->addMnemonicCB(MNEM_CMP, QBDI::InstPosition::PREINST, logCmpRule, &infos[3]);
+
+    bool ran = vm->call(&retval, (QBDI::rword) satanicFun, {42});
+    ASSERT_TRUE(ran);
+    EXPECT_EQ(retval, (QBDI::rword) satanicFun(42));
+    ASSERT_EQ((size_t) 0, log.size() % 4);
+    for (size_t i = 0; i < log.size(); i++) {
+        EXPECT_EQ((int) (i % 4), log[i]);
+    }
+
+    // The indexes are rebuilt when a rule is deleted
+    ASSERT_TRUE(vm->deleteInstrumentation(mnemId));
+    log.clear();
+    ran = vm->call(&retval, (QBDI::rword) satanicFun, {42});
+    ASSERT_TRUE(ran);
+    const int remaining[3] = {0, 2, 3};
+    ASSERT_EQ((size_t) 0, log.size() % 3);
+    for (size_t i = 0; i < log.size(); i++) {
+        EXPECT_EQ(remaining[i % 3], log[i]);
+    }
+
+    SUCCEED();
+}
+
 
 QBDI::VMAction checkTransfer(QBDI::VMInstanceRef vm, const QBDI::VMState *state, QBDI::GPRState *gprState, QBDI::FPRState *fprState, void *data) {
     int* s = (int*) data;
@@ -384,6 +1445,117 @@ TEST_F(VMTest, VMEvent_ExecTransfer) {
     vm->deleteAllInstrumentations();
 }
 
+TEST_F(VMTest, FastNativeCalls) {
+#if defined(QBDI_ARCH_X86_64)
+    int s = 0;
+    bool instrumented = vm->addInstrumentedModuleFromAddr((QBDI::rword)&dummyFunCall);
+    ASSERT_TRUE(instrumented);
+    ASSERT_TRUE(vm->setFastNativeCalls(true));
+    uint32_t id = vm->addVMEventCB(QBDI::VMEvent::EXEC_TRANSFER_CALL | QBDI::VMEvent::EXEC_TRANSFER_RETURN, 
+                                   checkTransfer, (void*) &s);
+    ASSERT_NE(id, QBDI::INVALID_EVENTID);
+    // A lazily bound PLT entry still leads into the module, the call is performed natively from 
+    // the module the entry binds to and the entry is resolved natively
+    QBDI::simulateCall(state, FAKE_RET_ADDR, {42});
+    bool ran = vm->run((QBDI::rword) dummyFunCall, (QBDI::rword) FAKE_RET_ADDR);
+    ASSERT_TRUE(ran);
+    ASSERT_EQ((QBDI::rword) 42, QBDI_GPR_GET(state, QBDI::REG_RETURN));
+    ASSERT_EQ(0, s);
+
+    // The translated calls read the bound entries and go on natively
+    s = 0;
+    QBDI::simulateCall(state, FAKE_RET_ADDR, {42});
+    ran = vm->run((QBDI::rword) dummyFunCall, (QBDI::rword) FAKE_RET_ADDR);
+    ASSERT_TRUE(ran);
+    ASSERT_EQ((QBDI::rword) 42, QBDI_GPR_GET(state, QBDI::REG_RETURN));
+    ASSERT_EQ(0, s);
+
+    // Disabling them brings the execution transfers back
+    ASSERT_TRUE(vm->setFastNativeCalls(false));
+    QBDI::simulateCall(state, FAKE_RET_ADDR, {42});
+    ran = vm->run((QBDI::rword) dummyFunCall, (QBDI::rword) FAKE_RET_ADDR);
+    ASSERT_TRUE(ran);
+    ASSERT_EQ((QBDI::rword) 42, QBDI_GPR_GET(state, QBDI::REG_RETURN));
+    ASSERT_EQ(4, s);
+    vm->deleteAllInstrumentations();
+#endif
+}
+
+#if defined(QBDI_OS_LINUX)
+QBDI_NOINLINE QBDI::rword loadAndUnload(QBDI::rword name) {
+    void* handle = dlopen((const char*) name, RTLD_NOW);
+    if(handle == nullptr) {
+        return 0;
+    }
+    dlclose(handle);
+    return 1;
+}
+
+QBDI::VMAction logModuleEvent(QBDI::VMInstanceRef vm, const QBDI::VMState *state, QBDI::GPRState *gprState,
+                              QBDI::FPRState *fprState, void *data) {
+    ((std::vector<QBDI::VMState>*) data)->push_back(*state);
+    return QBDI::VMAction::CONTINUE;
+}
+
+TEST_F(VMTest, ModuleEvents) {
+    std::vector<QBDI::VMState> events;
+    const char* name = nullptr;
+    QBDI::rword retval = 0;
+
+    // Find a library which is not loaded yet and can be unloaded
+    for(const char* candidate : {"libz.so.1", "libutil.so.1", "libresolv.so.2", "libanl.so.1"}) {
+        void* handle = dlopen(candidate, RTLD_NOW | RTLD_NOLOAD);
+        if(handle != nullptr) {
+            dlclose(handle);
+            continue;
+        }
+        handle = dlopen(candidate, RTLD_NOW);
+        if(handle != nullptr) {
+            dlclose(handle);
+            name = candidate;
+            break;
+        }
+    }
+    if(name == nullptr) {
+        SUCCEED();
+        return;
+    }
+    ASSERT_TRUE(vm->addInstrumentedModuleFromAddr((QBDI::rword) &loadAndUnload));
+    uint32_t id = vm->addVMEventCB(QBDI::MODULE_LOAD | QBDI::MODULE_UNLOAD, logModuleEvent, &events);
+    ASSERT_NE(QBDI::INVALID_EVENTID, id);
+
+    // The loader calls are noticed after their execution transfer, also with the native calls
+    for(bool fastNativeCalls : {false, true}) {
+        events.clear();
+        vm->setFastNativeCalls(fastNativeCalls);
+        bool ran = vm->call(&retval, (QBDI::rword) loadAndUnload, {(QBDI::rword) name});
+        ASSERT_TRUE(ran);
+        ASSERT_EQ((QBDI::rword) 1, retval);
+        ASSERT_EQ(2u, events.size());
+        EXPECT_EQ(QBDI::MODULE_LOAD, events[0].event);
+        EXPECT_EQ(QBDI::MODULE_UNLOAD, events[1].event);
+        EXPECT_LT(events[0].moduleStart, events[0].moduleEnd);
+        EXPECT_EQ(events[0].moduleStart, events[1].moduleStart);
+        EXPECT_EQ(events[0].moduleEnd, events[1].moduleEnd);
+    }
+
+    // The loaded module can be instrumented from its address
+    void* handle = dlopen(name, RTLD_NOW);
+    ASSERT_NE(nullptr, handle);
+    events.clear();
+    ASSERT_TRUE(vm->call(&retval, (QBDI::rword) dummyFunCall, {42}));
+    ASSERT_EQ(1u, events.size());
+    EXPECT_EQ(QBDI::MODULE_LOAD, events[0].event);
+    EXPECT_TRUE(vm->addInstrumentedModuleFromAddr(events[0].moduleStart));
+    EXPECT_TRUE(vm->removeInstrumentedModuleFromAddr(events[0].moduleStart));
+    dlclose(handle);
+
+    vm->setFastNativeCalls(false);
+    ASSERT_TRUE(vm->deleteInstrumentation(id));
+    SUCCEED();
+}
+#endif
+
 QBDI::VMAction countInstruction(QBDI::VMInstanceRef vm, QBDI::GPRState *gprState, QBDI::FPRState *fprState, void *data) {
     *((uint32_t*)data) += 1;
     return QBDI::VMAction::CONTINUE;
@@ -529,3 +1701,29 @@ TEST_F(VMTest, DelayedCacheFlush) {
     ASSERT_EQ(count, info.count);
 }
 
+#if defined(QBDI_ARCH_X86_64) && defined(QBDI_OS_LINUX)
+TEST_F(VMTest, PatchCacheModifiedCode) {
+    uint32_t count = 0;
+    QBDI::rword retval = 0;
+    // MOV EAX, imm32 ; RET
+    uint8_t code[] = {0xB8, 0x01, 0x00, 0x00, 0x00, 0xC3};
+    void* page = mmap(nullptr, 4096, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(MAP_FAILED, page);
+    memcpy(page, code, sizeof(code));
+
+    vm->addInstrumentedRange((QBDI::rword) page, (QBDI::rword) page + 4096);
+    ASSERT_TRUE(vm->call(&retval, (QBDI::rword) page, {}));
+    EXPECT_EQ((QBDI::rword) 1, retval);
+
+    // The code is modified without clearing the cache, the translation caused by the 
+    // instrumentation change does not reuse the previous patches
+    ((uint8_t*) page)[1] = 0x02;
+    ASSERT_NE(QBDI::INVALID_EVENTID, vm->addCodeCB(QBDI::PREINST, countInstruction, &count));
+    ASSERT_TRUE(vm->call(&retval, (QBDI::rword) page, {}));
+    EXPECT_EQ((QBDI::rword) 2, retval);
+    EXPECT_EQ((uint32_t) 2, count);
+
+    vm->removeInstrumentedRange((QBDI::rword) page, (QBDI::rword) page + 4096);
+    munmap(page, 4096);
+}
+#endif
@@ -0,0 +1,134 @@
+/*
+ * This file is part of QBDI.
+ *
+ * Copyright 2017 Quarkslab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <set>
+#include <vector>
+
+#include "QBDI.h"
+
+/* Measure the translation throughput of the engine: the basic blocks reached by a workload are
+ * collected once, then repeatedly translated from an empty cache using precacheBasicBlock,
+ * without any instrumentation rule. They are then instrumented again after each addition and 
+ * removal of a callback: precacheBasicBlock applies the flush queued by the change and the 
+ * blocks are rebuilt from their cached patches. The results are given in translated 
+ * instructions per second.
+ *
+ * Usage: QBDIBenchmark [iterations]
+ */
+
+#define DEFAULT_ITERATIONS 50
+
+static int compareDouble(const void* a, const void* b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+QBDI_NOINLINE QBDI::rword workload(QBDI::rword seed) {
+    double values[64];
+    char buffer[64];
+    QBDI::rword sum = 0;
+
+    for(int i = 0; i < 64; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        values[i] = (double) (seed >> 11) / 1024.0;
+    }
+    qsort(values, 64, sizeof(double), compareDouble);
+    for(int i = 0; i < 64; i += 8) {
+        snprintf(buffer, sizeof(buffer), "%f %e", values[i], values[i + 1]);
+        sum += strlen(buffer) + (QBDI::rword) strtod(buffer, nullptr);
+    }
+    return sum;
+}
+
+QBDI::VMAction collectBasicBlock(QBDI::VMInstanceRef vm, const QBDI::VMState *state, QBDI::GPRState *gprState,
+                                 QBDI::FPRState *fprState, void *data) {
+    ((std::set<QBDI::rword>*) data)->insert(state->basicBlockStart);
+    return QBDI::VMAction::CONTINUE;
+}
+
+QBDI::VMAction collectInstruction(QBDI::VMInstanceRef vm, QBDI::GPRState *gprState, QBDI::FPRState *fprState,
+                                  void *data) {
+    ((std::set<QBDI::rword>*) data)->insert(QBDI_GPR_GET(gprState, QBDI::REG_PC));
+    return QBDI::VMAction::CONTINUE;
+}
+
+QBDI::VMAction ignoreInstruction(QBDI::VMInstanceRef vm, QBDI::GPRState *gprState, QBDI::FPRState *fprState,
+                                 void *data) {
+    return QBDI::VMAction::CONTINUE;
+}
+
+static bool prepareVM(QBDI::VM& vm, uint8_t** fakestack) {
+    QBDI::allocateVirtualStack(vm.getGPRState(), 0x100000, fakestack);
+    return vm.addInstrumentedModuleFromAddr((QBDI::rword) &workload) &&
+           vm.addInstrumentedModuleFromAddr((QBDI::rword) &snprintf);
+}
+
+int main(int argc, char** argv) {
+    unsigned iterations = (argc > 1) ? (unsigned) atoi(argv[1]) : DEFAULT_ITERATIONS;
+    std::set<QBDI::rword> basicBlocks;
+    std::set<QBDI::rword> instructions;
+    uint8_t* fakestack = nullptr;
+    QBDI::rword retval;
+
+    // Collect the basic blocks of the workload and its instructions
+    {
+        QBDI::VM vm;
+        if(prepareVM(vm, &fakestack) == false) {
+            fprintf(stderr, "Failed to instrument the workload\n");
+            return 1;
+        }
+        vm.addVMEventCB(QBDI::BASIC_BLOCK_NEW, collectBasicBlock, &basicBlocks);
+        vm.addCodeCB(QBDI::PREINST, collectInstruction, &instructions);
+        vm.call(&retval, (QBDI::rword) workload, {42});
+        QBDI::alignedFree(fakestack);
+    }
+
+    // Translate them again and again from an empty cache
+    QBDI::VM vm;
+    prepareVM(vm, &fakestack);
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned i = 0; i < iterations; i++) {
+        vm.clearAllCache();
+        for(QBDI::rword address : basicBlocks) {
+            vm.precacheBasicBlock(address);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Instrument them again after every instrumentation change
+    start = std::chrono::steady_clock::now();
+    for(unsigned i = 0; i < iterations; i++) {
+        uint32_t id = vm.addCodeCB(QBDI::PREINST, ignoreInstruction, nullptr);
+        for(QBDI::rword address : basicBlocks) {
+            vm.precacheBasicBlock(address);
+        }
+        vm.deleteInstrumentation(id);
+    }
+    std::chrono::duration<double> reinstrumented = std::chrono::steady_clock::now() - start;
+    QBDI::alignedFree(fakestack);
+
+    double translated = (double) instructions.size() * iterations;
+    printf("%zu basic blocks, %zu instructions, %u iterations in %.3f s\n",
+           basicBlocks.size(), instructions.size(), iterations, elapsed.count());
+    printf("%.0f instructions translated per second\n", translated / elapsed.count());
+    printf("%.0f instructions instrumented again per second\n", translated / reinstrumented.count());
+    return 0;
+}
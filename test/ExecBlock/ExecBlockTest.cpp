@@ -71,3 +71,40 @@ TEST_F(ExecBlockTest, BasicBlockOverload) {
     }
     printf("Maximum basic block per exec block: %d\n", i);
 }
+
+TEST_F(ExecBlockTest, SharedContext) {
+    // Allocate a context shared by two ExecBlock
+    std::error_code ec;
+    llvm::sys::MemoryBlock contextBlock = QBDI::allocateMappedMemory(sizeof(QBDI::Context), nullptr, 
+        llvm::sys::Memory::MF_READ | llvm::sys::Memory::MF_WRITE, ec);
+    ASSERT_NE(nullptr, contextBlock.base());
+    QBDI::Context* context = (QBDI::Context*) contextBlock.base();
+    {
+        QBDI::ExecBlock execBlock1(*assembly, nullptr, context);
+        QBDI::ExecBlock execBlock2(*assembly, nullptr, context);
+#if defined(QBDI_ARCH_X86_64)
+        ASSERT_EQ(context, execBlock1.getContext());
+        ASSERT_EQ(context, execBlock2.getContext());
+#endif
+        // Jit a terminator in each block
+        QBDI::Patch::Vec terminator1;
+        QBDI::Patch::Vec terminator2;
+        terminator1.push_back(QBDI::Patch());
+        terminator2.push_back(QBDI::Patch());
+        terminator1[0].append(QBDI::getTerminator(0x42424242));
+        terminator2[0].append(QBDI::getTerminator(0x13371337));
+        QBDI::SeqWriteResult block1 = execBlock1.writeSequence(terminator1.begin(), terminator1.end(), QBDI::SeqType::Exit);
+        QBDI::SeqWriteResult block2 = execBlock2.writeSequence(terminator2.begin(), terminator2.end(), QBDI::SeqType::Exit);
+        // Both blocks should update the same context
+        execBlock1.selectSeq(block1.seqID);
+        execBlock1.execute();
+        ASSERT_EQ((QBDI::rword) 0x42424242, QBDI_GPR_GET(&execBlock1.getContext()->gprState, QBDI::REG_PC));
+        execBlock2.selectSeq(block2.seqID);
+        execBlock2.execute();
+        ASSERT_EQ((QBDI::rword) 0x13371337, QBDI_GPR_GET(&execBlock2.getContext()->gprState, QBDI::REG_PC));
+#if defined(QBDI_ARCH_X86_64)
+        ASSERT_EQ((QBDI::rword) 0x13371337, QBDI_GPR_GET(&context->gprState, QBDI::REG_PC));
+#endif
+    }
+    QBDI::releaseMappedMemory(contextBlock);
+}
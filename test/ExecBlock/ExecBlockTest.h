@@ -24,6 +24,7 @@
 #include "ExecBlock/ExecBlock.h"
 #include "Patch/PatchRule.h"
 #include "Patch/Patch.h"
+#include "Utility/System.h"
 
 class ExecBlockTest : public LLVMTestEnv {
 };
@@ -311,3 +311,24 @@ const char* StackTricks_s =
         "   mov 0x8(%rsp), %rax\n"
         "   ret $0x8\n"
         "end:\n";
+
+const char* FlagsLiveness_s =
+        "   mov $0xffffffffffffffff, %rdx\n"
+        "   add %rdx, %rax\n"
+        "   inc %rbx\n"
+        "   adc $0, %rcx\n"
+        "   cmp %rbx, %rax\n"
+        "   dec %rsi\n"
+        "   sbb %rdi, %rdi\n"
+        "   add %rax, %rax\n"
+        "   seto %r8b\n"
+        "   setc %r9b\n"
+        "   std\n"
+        "   jmp next\n"
+        "next:\n"
+        "   cmp %rcx, %rdx\n"
+        "   pushfq\n"
+        "   pop %r10\n"
+        "   cld\n"
+        "   shl $1, %rcx\n"
+        "   adc %rdx, %r11\n";
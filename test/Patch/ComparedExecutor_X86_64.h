@@ -32,6 +32,7 @@ extern const char* RelativeAddressing_s;
 extern const char* ConditionalBranching_s;
 extern const char* FibonacciRecursion_s;
 extern const char* StackTricks_s;
+extern const char* FlagsLiveness_s;
 
 class ComparedExecutor_X86_64 : public ShellcodeTester {
 
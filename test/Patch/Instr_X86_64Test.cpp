@@ -146,3 +146,39 @@ TEST_F(Instr_X86_64Test, StackTricks_IC) {
 
     printf("Took %" PRIu64 " instructions\n", count1);
 }
+
+TEST_F(Instr_X86_64Test, FlagsLiveness_IC) {
+    uint64_t count1 = 0;
+    uint64_t count2 = 0;
+
+    QBDI::Context inputState;
+    memset(&inputState, 0, sizeof(QBDI::Context));
+    inputState.gprState.rax = ((QBDI::rword)rand() << 32) | rand();
+    inputState.gprState.rbx = ((QBDI::rword)rand() << 32) | rand();
+    inputState.gprState.rcx = ((QBDI::rword)rand() << 32) | rand();
+    inputState.gprState.rsi = ((QBDI::rword)rand() << 32) | rand();
+
+    vm.deleteAllInstrumentations();
+    vm.addCodeCB(QBDI::PREINST, increment, (void*) &count1);
+    vm.addCodeCB(QBDI::POSTINST, increment, (void*) &count2);
+
+    comparedExec(FlagsLiveness_s, inputState, 4096);
+
+    ASSERT_LT((uint64_t) 0, count1);
+    ASSERT_EQ(count1, count2);
+
+    printf("Took %" PRIu64 " instructions\n", count1);
+}
+
+TEST_F(Instr_X86_64Test, FibonacciRecursion_MemoryRecording) {
+    QBDI::Context inputState;
+    memset(&inputState, 0, sizeof(QBDI::Context));
+    inputState.gprState.rax = (QBDI::rword) (rand() % 20) + 2;
+
+    // Memory recording does not break to the host: its temporaries are taken from the dead
+    // registers whenever possible.
+    vm.deleteAllInstrumentations();
+    ASSERT_TRUE(vm.recordMemoryAccess(QBDI::MEMORY_READ_WRITE));
+
+    comparedExec(FibonacciRecursion_s, inputState, 4096);
+}
@@ -75,3 +75,14 @@ TEST_F(Patch_X86_64Test, StackTricks) {
     inputState.gprState.rax = (QBDI::rword) (rand() % 20) + 2;
     comparedExec(StackTricks_s, inputState, 4096);
 }
+
+TEST_F(Patch_X86_64Test, FlagsLiveness) {
+    QBDI::Context inputState;
+
+    memset(&inputState, 0, sizeof(QBDI::Context));
+    inputState.gprState.rax = ((QBDI::rword)rand() << 32) | rand();
+    inputState.gprState.rbx = ((QBDI::rword)rand() << 32) | rand();
+    inputState.gprState.rcx = ((QBDI::rword)rand() << 32) | rand();
+    inputState.gprState.rsi = ((QBDI::rword)rand() << 32) | rand();
+    comparedExec(FlagsLiveness_s, inputState, 4096);
+}
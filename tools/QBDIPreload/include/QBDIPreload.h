@@ -120,6 +120,28 @@ extern int qbdipreload_on_main(int argc, char** argv);
  */
 extern int qbdipreload_on_run(VMInstanceRef vm, rword start, rword stop);
 
+/*! Function called when a thread created with `pthread_create` starts, once the main thread is
+ * run by the default handler (Linux only). It provides a new QBDI VM for this thread, with the 
+ * same instrumented ranges as the main thread one, on which the instrumentation of the thread 
+ * can be registered. This callback is optional, the threads run natively if it is not defined.
+  * @param[in]  vm          VM instance of the thread.
+  * @param[in]  start       Start routine of the thread.
+  * @param[in]  arg         Argument of the start routine.
+  * @return     int         QBDIPRELOAD_NO_ERROR to run the start routine with the VM, any other 
+  *                         state runs it natively.
+ */
+extern int qbdipreload_on_thread(VMInstanceRef vm, rword start, rword arg) __attribute__((weak));
+
+/*! Function called in the child process after a fork made by a thread running under a VM
+ * (Linux only). The child continues the execution with this VM, which keeps its instrumentation 
+ * and its translation cache through copy-on-write. The trace records pending in the parent are 
+ * delivered before the fork, by the parent only. This callback is optional and can be used to 
+ * reset the per-process data of the instrumentation (output files, coverage maps, ...).
+  * @param[in]  vm          VM instance of the forking thread.
+  * @return     int         QBDIPreload state
+ */
+extern int qbdipreload_on_fork(VMInstanceRef vm) __attribute__((weak));
+
 /*! Function called when process is exiting (using `_exit` or `exit`).
   * @param[in]  status  exit status
   * @return     int     QBDIPreload state
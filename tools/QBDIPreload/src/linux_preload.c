@@ -20,6 +20,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <dlfcn.h>
+#include <pthread.h>
 #include <unistd.h>
 #include <signal.h>
 #include <sys/mman.h>
@@ -40,7 +41,10 @@ static const long BRK_INS = 0xE7FFDEFE;
 #endif
 
 static const size_t STACK_SIZE = 8388608;
+static const size_t THREAD_STACK_SIZE = 1048576;
 static bool DEFAULT_HANDLER = false;
+static bool INSTRUMENT_THREADS = false;
+static __thread VMInstanceRef CURRENT_VM = NULL;
 GPRState ENTRY_GPR;
 FPRState ENTRY_FPR;
 
@@ -153,6 +157,43 @@ void unsetEntryBreakpoint() {
     mprotect((void*) base, pageSize, PROT_READ | PROT_EXEC);
 }
 
+static void setupInstrumentedRanges(VMInstanceRef vm) {
+    qbdi_instrumentAllExecutableMaps(vm);
+
+    size_t size = 0, i = 0;
+    char **modules = qbdi_getModuleNames(&size);
+
+    // Filter some modules to avoid conflicts
+    qbdi_removeInstrumentedModuleFromAddr(vm, (rword) &setupInstrumentedRanges);
+    for(i = 0; i < size; i++) {
+        if (strstr(modules[i], "libc-2.") ||
+            strstr(modules[i], "ld-2.") ||
+            strstr(modules[i], "libcofi")) {
+            qbdi_removeInstrumentedModule(vm, modules[i]);
+        }
+    }
+    for(i = 0; i < size; i++) {
+        free(modules[i]);
+    }
+    free(modules);
+}
+
+static void prepareFork(void) {
+    // The pending trace records are only delivered by the parent
+    if (CURRENT_VM != NULL) {
+        qbdi_flushMemoryTrace(CURRENT_VM);
+        qbdi_flushSyscallTrace(CURRENT_VM);
+    }
+}
+
+static void childAfterFork(void) {
+    // The child continues with the VM of the forking thread, whose translation cache is kept
+    // through copy-on-write
+    if (CURRENT_VM != NULL && qbdipreload_on_fork != NULL) {
+        qbdipreload_on_fork(CURRENT_VM);
+    }
+}
+
 void catchEntrypoint(int argc, char** argv) {
     int status = QBDIPRELOAD_NOT_HANDLED;
 
@@ -166,24 +207,11 @@ void catchEntrypoint(int argc, char** argv) {
 #endif
         VMInstanceRef vm;
         qbdi_initVM(&vm, NULL, NULL);
-        qbdi_instrumentAllExecutableMaps(vm);
-
-        size_t size = 0, i = 0;
-        char **modules = qbdi_getModuleNames(&size);
-
-        // Filter some modules to avoid conflicts
-        qbdi_removeInstrumentedModuleFromAddr(vm, (rword) &catchEntrypoint);
-        for(i = 0; i < size; i++) {
-            if (strstr(modules[i], "libc-2.") ||
-                strstr(modules[i], "ld-2.") ||
-                strstr(modules[i], "libcofi")) {
-                qbdi_removeInstrumentedModule(vm, modules[i]);
-            }
-        }
-        for(i = 0; i < size; i++) {
-            free(modules[i]);
-        }
-        free(modules);
+        setupInstrumentedRanges(vm);
+        // The threads created from now on are started under their own VM
+        INSTRUMENT_THREADS = (qbdipreload_on_thread != NULL);
+        CURRENT_VM = vm;
+        pthread_atfork(prepareFork, NULL, childAfterFork);
 
         // Set original states
         qbdi_setGPRState(vm, &ENTRY_GPR);
@@ -274,6 +302,120 @@ QBDI_EXPORT void _exit(int status) {
     __builtin_unreachable();
 }
 
+struct ThreadStart {
+    void* (*routine)(void*);
+    void* arg;
+};
+
+struct ThreadResources {
+    VMInstanceRef vm;
+    uint8_t* stack;
+    size_t stackMapSize;
+};
+
+static pthread_key_t THREAD_RESOURCES_KEY;
+static pthread_once_t THREAD_RESOURCES_ONCE = PTHREAD_ONCE_INIT;
+
+static void releaseThreadResources(void* data) {
+    struct ThreadResources* resources = (struct ThreadResources*) data;
+
+    CURRENT_VM = NULL;
+    if (resources->vm != NULL) {
+        qbdi_terminateVM(resources->vm);
+    }
+    if (resources->stack != NULL) {
+        munmap(resources->stack, resources->stackMapSize);
+    }
+    free(resources);
+}
+
+// The resources of a thread leaving through pthread_exit or a cancellation are released by the 
+// key destructor, once the thread is back on its own stack
+static void createThreadResourcesKey(void) {
+    pthread_key_create(&THREAD_RESOURCES_KEY, releaseThreadResources);
+}
+
+// The virtual stack has the size of the thread stack, with a guard page below it
+static bool allocateThreadStack(GPRState* gprState, struct ThreadResources* resources) {
+    size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    size_t stackSize = THREAD_STACK_SIZE;
+    pthread_attr_t attr;
+
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        pthread_attr_getstacksize(&attr, &stackSize);
+        pthread_attr_destroy(&attr);
+    }
+    stackSize = (stackSize + pageSize - 1) & ~(pageSize - 1);
+    uint8_t* stack = (uint8_t*) mmap(NULL, stackSize + pageSize, PROT_READ | PROT_WRITE, 
+                                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (stack == MAP_FAILED) {
+        return false;
+    }
+    resources->stack = stack;
+    resources->stackMapSize = stackSize + pageSize;
+    if (mprotect(stack, pageSize, PROT_NONE) != 0) {
+        return false;
+    }
+    QBDI_GPR_SET(gprState, REG_SP, (rword) stack + pageSize + stackSize);
+    QBDI_GPR_SET(gprState, REG_BP, QBDI_GPR_GET(gprState, REG_SP));
+    return true;
+}
+
+static void* instrumentThread(void* data) {
+    struct ThreadStart start = *((struct ThreadStart*) data);
+    struct ThreadResources* resources = NULL;
+    rword retval = 0;
+
+    free(data);
+    // The thread runs natively if its VM can not be set up
+    if (pthread_once(&THREAD_RESOURCES_ONCE, createThreadResourcesKey) == 0) {
+        resources = (struct ThreadResources*) calloc(1, sizeof(struct ThreadResources));
+    }
+    if (resources == NULL) {
+        return start.routine(start.arg);
+    }
+    qbdi_initVM(&resources->vm, NULL, NULL);
+    if (resources->vm == NULL || !allocateThreadStack(qbdi_getGPRState(resources->vm), resources) ||
+        pthread_setspecific(THREAD_RESOURCES_KEY, resources) != 0) {
+        releaseThreadResources(resources);
+        return start.routine(start.arg);
+    }
+    setupInstrumentedRanges(resources->vm);
+
+    // The thread runs natively if the callback does not set up its VM
+    if (qbdipreload_on_thread(resources->vm, (rword) start.routine, (rword) start.arg) == QBDIPRELOAD_NO_ERROR) {
+        CURRENT_VM = resources->vm;
+        qbdi_call(resources->vm, &retval, (rword) start.routine, 1, (rword) start.arg);
+        CURRENT_VM = NULL;
+    } else {
+        retval = (rword) start.routine(start.arg);
+    }
+
+    pthread_setspecific(THREAD_RESOURCES_KEY, NULL);
+    releaseThreadResources(resources);
+    return (void*) retval;
+}
+
+typedef int (*pthread_create_fn)(pthread_t*, const pthread_attr_t*, void* (*)(void*), void*);
+
+QBDI_EXPORT int pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*routine)(void*), void* arg) {
+    pthread_create_fn o_pthread_create = (pthread_create_fn) dlsym(RTLD_NEXT, "pthread_create");
+
+    if (INSTRUMENT_THREADS) {
+        struct ThreadStart* start = (struct ThreadStart*) malloc(sizeof(struct ThreadStart));
+        if (start != NULL) {
+            start->routine = routine;
+            start->arg = arg;
+            int status = o_pthread_create(thread, attr, instrumentThread, start);
+            if (status != 0) {
+                free(start);
+            }
+            return status;
+        }
+    }
+    return o_pthread_create(thread, attr, routine, arg);
+}
+
 typedef int (*start_main_fn)(int(*)(int, char**, char**), int, char**, void(*)(void), void(*)(void), void(*)(void), void*);
 
 QBDI_EXPORT int __libc_start_main(int (*main) (int, char**, char**), int argc, char** ubp_av, void (*init) (void), void (*fini) (void), void (*rtld_fini) (void), void (* stack_end)) {
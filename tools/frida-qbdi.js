@@ -493,6 +493,24 @@ var MemoryAccessType = Object.freeze({
     MEMORY_READ_WRITE : 3
 });
 
+/**data:MemoryAccessFlags
+  Memory access flags
+*/
+var MemoryAccessFlags = Object.freeze({
+    /**attribute:MemoryAccessFlags.MEMORY_NO_FLAGS
+      No flags.
+     */
+    MEMORY_NO_FLAGS : 0,
+    /**attribute:MemoryAccessFlags.MEMORY_UNKNOWN_VALUE
+      The value of the access was not captured (string operations).
+     */
+    MEMORY_UNKNOWN_VALUE : 1,
+    /**attribute:MemoryAccessFlags.MEMORY_PARTIAL_VALUE
+      The access is larger than a rword and the value only holds its first bytes.
+     */
+    MEMORY_PARTIAL_VALUE : 2
+});
+
 /**data:RegisterAccessType
   Register access type (read / write / rw)
 */
@@ -1084,7 +1102,7 @@ function QBDI() {
     this.addMemAddrCB = function(addr, type, cbk, data) {
         /**:QBDI.prototype.addMemAddrCB(addr, type, cbk, data)
             Add a virtual callback which is triggered for any memory access at a specific address matching the access type.
-            Virtual callbacks are called via callback forwarding by a gate callback triggered on every memory access. This incurs a high performance cost.
+            Virtual callbacks are called via callback forwarding by a gate callback, only triggered when an inline check finds the access may hit a range.
 
             :param addr:   Code address which will trigger the callback.
             :param type:   A mode bitfield: either MEMORY_READ, MEMORY_WRITE or both (MEMORY_READ_WRITE).
@@ -1102,7 +1120,7 @@ function QBDI() {
     this.addMemRangeCB = function(start, end, type, cbk, data) {
         /**:QBDI.prototype.addMemRangeCB(start, end, type, cbk, data)
           Add a virtual callback which is triggered for any memory access in a specific address range matching the access type.
-          Virtual callbacks are called via callback forwarding by a gate callback triggered on every memory access. This incurs a high performance cost.
+          Virtual callbacks are called via callback forwarding by a gate callback, only triggered when an inline check finds the access may hit a range.
 
           :param start:    Start of the address range which will trigger the callback.
           :param end:      End of the address range which will trigger the callback.
@@ -1339,9 +1357,11 @@ function QBDI() {
         p = ptr.add(memoryAccessDesc.offsets[2]);
         access.value = Memory.readRword(p);
         p = ptr.add(memoryAccessDesc.offsets[3]);
-        access.size = Memory.readU8(p);
+        access.size = Memory.readRword(p);
         p = ptr.add(memoryAccessDesc.offsets[4]);
         access.type = Memory.readU8(p);
+        p = ptr.add(memoryAccessDesc.offsets[5]);
+        access.flags = Memory.readU8(p);
         Object.freeze(access);
         return access;
     }
@@ -1632,6 +1652,7 @@ if (typeof(module) !== "undefined") {
         OperandType: OperandType,
         RegisterAccessType: RegisterAccessType,
         MemoryAccessType: MemoryAccessType,
+        MemoryAccessFlags: MemoryAccessFlags,
         SyncDirection: SyncDirection,
 
         // Allow automagic exposure of QBDI interface in nodejs GLOBAL
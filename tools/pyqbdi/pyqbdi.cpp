@@ -215,6 +215,12 @@ namespace QBDI {
       /* Garbage Collector for callback's data */
       GarbageCollector<uint32_t, PyObject**> GCData;
 
+      /* Function and data of the memory trace callback */
+      PyObject** MemoryTraceData = nullptr;
+
+      /* Function and data of the syscall trace callback */
+      PyObject** SyscallTraceData = nullptr;
+
 
       /* Returns a QBDI::rword from a PyLong object */
       QBDI::rword PyLong_AsRword(PyObject* vv) {
@@ -247,6 +253,52 @@ namespace QBDI {
       }
 
 
+      /* Returns a vector of QBDI::Predicate from a list of (combine, type, operand, mask, value, limit) tuples */
+      std::vector<QBDI::Predicate> PyList_AsPredicate(PyObject* list) {
+        std::vector<QBDI::Predicate> predicate;
+
+        if (list == nullptr || list == Py_None)
+          return predicate;
+
+        if (!PyList_Check(list))
+          throw std::runtime_error("QBDI::Bindings::Python::PyList_AsPredicate(): Expects a list of predicate terms.");
+
+        for (Py_ssize_t i = 0; i < PyList_Size(list); i++) {
+          PyObject* term = PyList_GetItem(list, i);
+          if (!PyTuple_Check(term) || PyTuple_Size(term) != 6)
+            throw std::runtime_error("QBDI::Bindings::Python::PyList_AsPredicate(): Expects (combine, type, operand, mask, value, limit) tuples.");
+          predicate.push_back(QBDI::Predicate {
+            static_cast<QBDI::PredicateCombine>(PyLong_AsRword(PyTuple_GetItem(term, 0))),
+            static_cast<QBDI::PredicateType>(PyLong_AsRword(PyTuple_GetItem(term, 1))),
+            static_cast<uint32_t>(PyLong_AsRword(PyTuple_GetItem(term, 2))),
+            PyLong_AsRword(PyTuple_GetItem(term, 3)),
+            PyLong_AsRword(PyTuple_GetItem(term, 4)),
+            PyLong_AsRword(PyTuple_GetItem(term, 5)),
+          });
+        }
+
+        return predicate;
+      }
+
+
+      /* Returns a set of ranges from a list of (start, end) tuples */
+      QBDI::RangeSet<QBDI::rword> PyList_AsRangeSet(PyObject* list) {
+        QBDI::RangeSet<QBDI::rword> ranges;
+
+        if (!PyList_Check(list))
+          throw std::runtime_error("QBDI::Bindings::Python::PyList_AsRangeSet(): Expects a list of ranges.");
+
+        for (Py_ssize_t i = 0; i < PyList_Size(list); i++) {
+          PyObject* range = PyList_GetItem(list, i);
+          if (!PyTuple_Check(range) || PyTuple_Size(range) != 2)
+            throw std::runtime_error("QBDI::Bindings::Python::PyList_AsRangeSet(): Expects (start, end) tuples.");
+          ranges.add(QBDI::Range<QBDI::rword>(PyLong_AsRword(PyTuple_GetItem(range, 0)), PyLong_AsRword(PyTuple_GetItem(range, 1))));
+        }
+
+        return ranges;
+      }
+
+
       /* PyOperandAnalysis destructor */
       static void OperandAnalysis_dealloc(PyObject* self) {
         std::cout << std::flush;
@@ -1553,6 +1605,9 @@ namespace QBDI {
 
           else if (std::string(PyString_AsString(name)) == "type")
             return PyLong_FromLong(PyMemoryAccess_AsMemoryAccess(self)->type);
+
+          else if (std::string(PyString_AsString(name)) == "flags")
+            return PyLong_FromLong(PyMemoryAccess_AsMemoryAccess(self)->flags);
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
@@ -1662,6 +1717,12 @@ namespace QBDI {
       }
 
 
+      /* Trampoline for python post callbacks of a wrapped function, stored after its pre callback */
+      static QBDI::VMAction postTrampoline(QBDI::VMInstanceRef vm, QBDI::GPRState* gprState, QBDI::FPRState* fprState, void* multipleData) {
+        return trampoline(vm, gprState, fprState, reinterpret_cast<PyObject**>(multipleData) + 2);
+      }
+
+
       /* Trampoline for python callbacks (VMCallback) */
       static QBDI::VMAction trampoline(QBDI::VMInstanceRef vm, const QBDI::VMState* vmState, QBDI::GPRState* gprState, QBDI::FPRState* fprState, void* multipleData) {
         Py_INCREF(reinterpret_cast<PyObject**>(multipleData)[1]);
@@ -1691,6 +1752,76 @@ namespace QBDI {
       }
 
 
+      /* Trampoline for python callbacks (MemoryTraceCallback) */
+      static QBDI::VMAction trampoline(QBDI::VMInstanceRef vm, const QBDI::MemoryAccess* accesses, size_t size, void* multipleData) {
+        Py_INCREF(reinterpret_cast<PyObject**>(multipleData)[1]);
+
+        /* Create function arguments */
+        PyObject* list = PyList_New(size);
+        for (size_t i = 0; i < size; i++)
+          PyList_SetItem(list, i, QBDI::Bindings::Python::PyMemoryAccess(accesses[i]));
+
+        PyObject* args = PyTuple_New(3);
+        PyTuple_SetItem(args, 0, QBDI::Bindings::Python::PyVMInstance(vm));
+        PyTuple_SetItem(args, 1, list);
+        PyTuple_SetItem(args, 2, reinterpret_cast<PyObject**>(multipleData)[1]);
+
+        /* Call the function and check the return value */
+        PyObject* ret = PyObject_CallObject(reinterpret_cast<PyObject**>(multipleData)[0], args);
+        Py_DECREF(args);
+        if (ret == nullptr) {
+          PyErr_Print();
+          exit(1);
+        }
+
+        /* Default: We continue the instrumentation */
+        if (!PyLong_Check(ret) && !PyInt_Check(ret))
+          return QBDI::CONTINUE;
+
+        /* Otherwise, return the user's value */
+        return static_cast<QBDI::VMAction>(PyLong_AsLong(ret));
+      }
+
+
+      /* Trampoline for python callbacks (SyscallTraceCallback) */
+      static QBDI::VMAction trampoline(QBDI::VMInstanceRef vm, const QBDI::SyscallRecord* records, size_t size, void* multipleData) {
+        Py_INCREF(reinterpret_cast<PyObject**>(multipleData)[1]);
+
+        /* Create function arguments, each record is a tuple (number, (args...), ret) */
+        PyObject* list = PyList_New(size);
+        for (size_t i = 0; i < size; i++) {
+          PyObject* sysArgs = PyTuple_New(6);
+          for (size_t j = 0; j < 6; j++)
+            PyTuple_SetItem(sysArgs, j, PyLong_FromUnsignedLongLong(records[i].args[j]));
+          PyObject* record = PyTuple_New(3);
+          PyTuple_SetItem(record, 0, PyLong_FromUnsignedLongLong(records[i].number));
+          PyTuple_SetItem(record, 1, sysArgs);
+          PyTuple_SetItem(record, 2, PyLong_FromUnsignedLongLong(records[i].ret));
+          PyList_SetItem(list, i, record);
+        }
+
+        PyObject* args = PyTuple_New(3);
+        PyTuple_SetItem(args, 0, QBDI::Bindings::Python::PyVMInstance(vm));
+        PyTuple_SetItem(args, 1, list);
+        PyTuple_SetItem(args, 2, reinterpret_cast<PyObject**>(multipleData)[1]);
+
+        /* Call the function and check the return value */
+        PyObject* ret = PyObject_CallObject(reinterpret_cast<PyObject**>(multipleData)[0], args);
+        Py_DECREF(args);
+        if (ret == nullptr) {
+          PyErr_Print();
+          exit(1);
+        }
+
+        /* Default: We continue the instrumentation */
+        if (!PyLong_Check(ret) && !PyInt_Check(ret))
+          return QBDI::CONTINUE;
+
+        /* Otherwise, return the user's value */
+        return static_cast<QBDI::VMAction>(PyLong_AsLong(ret));
+      }
+
+
       /* PyVMInstance destructor */
       static void VMInstance_dealloc(PyObject* self) {
         std::cout << std::flush;
@@ -1753,18 +1884,21 @@ namespace QBDI {
        * @param[in] pos       Relative position of the event callback (pyqbdi.PREINST / pyqbdi.POSTINST).
        * @param[in] cbk       A function pointer to the callback.
        * @param[in] data      User defined data passed to the callback.
+       * @param[in] predicate An inline predicate, a list of (combine, type, operand, mask, value, limit)
+       *                      tuples (optional).
        *
        * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
        * in case of failure).
        */
       static PyObject* vm_addCodeCB(PyObject* self, PyObject* args) {
-        PyObject* pos      = nullptr;
-        PyObject* function = nullptr;
-        PyObject* data     = nullptr;
-        uint32_t retValue  = QBDI::INVALID_EVENTID;
+        PyObject* pos       = nullptr;
+        PyObject* function  = nullptr;
+        PyObject* data      = nullptr;
+        PyObject* predicate = nullptr;
+        uint32_t retValue   = QBDI::INVALID_EVENTID;
 
         /* Extract arguments */
-        PyArg_ParseTuple(args, "|OOO", &pos, &function, &data);
+        PyArg_ParseTuple(args, "|OOOO", &pos, &function, &data, &predicate);
 
         if (pos == nullptr || (!PyLong_Check(pos) && !PyInt_Check(pos)))
           return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addCodeCB(): Expects an InstPosition as first argument.");
@@ -1776,12 +1910,14 @@ namespace QBDI {
           return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addCodeCB(): Expects a PyObject as third argument.");
 
         try {
+          std::vector<QBDI::Predicate> terms = QBDI::Bindings::Python::PyList_AsPredicate(predicate);
           PyObject** multipleData = (PyObject**)std::malloc(sizeof(PyObject*) * 2);
           multipleData[0] = function;
           multipleData[1] = data;
           retValue = PyVMInstance_AsVMInstance(self)->addCodeCB(static_cast<QBDI::InstPosition>(PyInt_AsLong(pos)),
                                                                 QBDI::Bindings::Python::trampoline,
-                                                                multipleData);
+                                                                multipleData,
+                                                                terms);
           QBDI::Bindings::Python::GCData.add(retValue, multipleData);
         }
         catch (const std::exception& e) {
@@ -1799,20 +1935,23 @@ namespace QBDI {
        * @param[in] pos       Relative position of the callback (pyqbdi.PREINST / pyqbdi.POSTINST).
        * @param[in] cbk       A function pointer to the callback.
        * @param[in] data      User defined data passed to the callback.
+       * @param[in] predicate An inline predicate, a list of (combine, type, operand, mask, value, limit)
+       *                      tuples (optional).
        *
        * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
        * in case of failure).
        */
       static PyObject* vm_addCodeRangeCB(PyObject* self, PyObject* args) {
-        PyObject* start    = nullptr;
-        PyObject* end      = nullptr;
-        PyObject* pos      = nullptr;
-        PyObject* function = nullptr;
-        PyObject* data     = nullptr;
-        uint32_t retValue  = QBDI::INVALID_EVENTID;
+        PyObject* start     = nullptr;
+        PyObject* end       = nullptr;
+        PyObject* pos       = nullptr;
+        PyObject* function  = nullptr;
+        PyObject* data      = nullptr;
+        PyObject* predicate = nullptr;
+        uint32_t retValue   = QBDI::INVALID_EVENTID;
 
         /* Extract arguments */
-        PyArg_ParseTuple(args, "|OOOOO", &start, &end, &pos, &function, &data);
+        PyArg_ParseTuple(args, "|OOOOOO", &start, &end, &pos, &function, &data, &predicate);
 
         if (start == nullptr || (!PyLong_Check(start) && !PyInt_Check(start)))
           return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addCodeRangeCB(): Expects an integer as first argument.");
@@ -1830,6 +1969,7 @@ namespace QBDI {
           return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addCodeRangeCB(): Expects a PyObject as fifth argument.");
 
         try {
+          std::vector<QBDI::Predicate> terms = QBDI::Bindings::Python::PyList_AsPredicate(predicate);
           PyObject** multipleData = (PyObject**)std::malloc(sizeof(PyObject*) * 2);
           multipleData[0] = function;
           multipleData[1] = data;
@@ -1837,7 +1977,8 @@ namespace QBDI {
                                                                      PyLong_AsRword(end),
                                                                      static_cast<QBDI::InstPosition>(PyInt_AsLong(pos)),
                                                                      QBDI::Bindings::Python::trampoline,
-                                                                     multipleData);
+                                                                     multipleData,
+                                                                     terms);
           QBDI::Bindings::Python::GCData.add(retValue, multipleData);
         }
         catch (const std::exception& e) {
@@ -1848,6 +1989,117 @@ namespace QBDI {
       }
 
 
+      /*! Register an inline counter incremented before every instruction executed.
+       *
+       * @param[in] counter   Address of a user allocated 64 bits counter.
+       * @param[in] atomic    Use an atomic increment (optional, default to False).
+       *
+       * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
+       * in case of failure).
+       */
+      static PyObject* vm_addCodeCounter(PyObject* self, PyObject* args) {
+        PyObject* counter  = nullptr;
+        PyObject* atomic   = nullptr;
+        uint32_t retValue  = QBDI::INVALID_EVENTID;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OO", &counter, &atomic);
+
+        if (counter == nullptr || (!PyLong_Check(counter) && !PyInt_Check(counter)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addCodeCounter(): Expects an integer as first argument.");
+
+        try {
+          retValue = PyVMInstance_AsVMInstance(self)->addCodeCounter(reinterpret_cast<uint64_t*>(PyLong_AsRword(counter)),
+                                                                     atomic != nullptr && PyObject_IsTrue(atomic));
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return PyLong_FromLong(retValue);
+      }
+
+
+      /*! Register an inline counter incremented each time a specific address is executed.
+       *
+       * @param[in] address   Code address which will increment the counter.
+       * @param[in] counter   Address of a user allocated 64 bits counter.
+       * @param[in] atomic    Use an atomic increment (optional, default to False).
+       *
+       * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
+       * in case of failure).
+       */
+      static PyObject* vm_addCodeAddrCounter(PyObject* self, PyObject* args) {
+        PyObject* addr     = nullptr;
+        PyObject* counter  = nullptr;
+        PyObject* atomic   = nullptr;
+        uint32_t retValue  = QBDI::INVALID_EVENTID;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OOO", &addr, &counter, &atomic);
+
+        if (addr == nullptr || (!PyLong_Check(addr) && !PyInt_Check(addr)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addCodeAddrCounter(): Expects an integer as first argument.");
+
+        if (counter == nullptr || (!PyLong_Check(counter) && !PyInt_Check(counter)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addCodeAddrCounter(): Expects an integer as second argument.");
+
+        try {
+          retValue = PyVMInstance_AsVMInstance(self)->addCodeAddrCounter(PyLong_AsRword(addr),
+                                                                         reinterpret_cast<uint64_t*>(PyLong_AsRword(counter)),
+                                                                         atomic != nullptr && PyObject_IsTrue(atomic));
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return PyLong_FromLong(retValue);
+      }
+
+
+      /*! Register an inline counter incremented for every instruction executed in an address range.
+       *
+       * @param[in] start     Start of the address range which will increment the counter.
+       * @param[in] end       End of the address range which will increment the counter.
+       * @param[in] counter   Address of a user allocated 64 bits counter.
+       * @param[in] atomic    Use an atomic increment (optional, default to False).
+       *
+       * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
+       * in case of failure).
+       */
+      static PyObject* vm_addCodeRangeCounter(PyObject* self, PyObject* args) {
+        PyObject* start    = nullptr;
+        PyObject* end      = nullptr;
+        PyObject* counter  = nullptr;
+        PyObject* atomic   = nullptr;
+        uint32_t retValue  = QBDI::INVALID_EVENTID;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OOOO", &start, &end, &counter, &atomic);
+
+        if (start == nullptr || (!PyLong_Check(start) && !PyInt_Check(start)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addCodeRangeCounter(): Expects an integer as first argument.");
+
+        if (end == nullptr || (!PyLong_Check(end) && !PyInt_Check(end)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addCodeRangeCounter(): Expects an integer as second argument.");
+
+        if (counter == nullptr || (!PyLong_Check(counter) && !PyInt_Check(counter)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addCodeRangeCounter(): Expects an integer as third argument.");
+
+        try {
+          retValue = PyVMInstance_AsVMInstance(self)->addCodeRangeCounter(PyLong_AsRword(start),
+                                                                          PyLong_AsRword(end),
+                                                                          reinterpret_cast<uint64_t*>(PyLong_AsRword(counter)),
+                                                                          atomic != nullptr && PyObject_IsTrue(atomic));
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return PyLong_FromLong(retValue);
+      }
+
+
       /*! Add the executable address ranges of a module to the set of instrumented address ranges.
        *
        * @param[in] name  The module's name.
@@ -1919,6 +2171,21 @@ namespace QBDI {
       }
 
 
+      /*! Add several address ranges to the set of instrumented address ranges at once.
+       *
+       * @param[in] ranges  A list of (start, end) tuples.
+       */
+      static PyObject* vm_addInstrumentedRanges(PyObject* self, PyObject* ranges) {
+        try {
+          PyVMInstance_AsVMInstance(self)->addInstrumentedRanges(PyList_AsRangeSet(ranges));
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+        Py_RETURN_NONE;
+      }
+
+
       /*! Register a callback event for every memory access matching the type bitfield made by an
        *  instruction.
        *
@@ -1966,7 +2233,7 @@ namespace QBDI {
 
       /*! Add a virtual callback which is triggered for any memory access at a specific address 
        *  matching the access type. Virtual callbacks are called via callback forwarding by a
-       *  gate callback triggered on every memory access. This incurs a high performance cost.
+       *  gate callback, only triggered when an inline check finds the access may hit a range.
        *
        * @param[in] address  Code address which will trigger the callback.
        * @param[in] type     A mode bitfield: either pyqbdi.MEMORY_READ, pyqbdi.MEMORY_WRITE or both (pyqbdi.MEMORY_READ_WRITE).
@@ -2018,7 +2285,7 @@ namespace QBDI {
 
       /*! Add a virtual callback which is triggered for any memory access in a specific address range
        *  matching the access type. Virtual callbacks are called via callback forwarding by a
-       *  gate callback triggered on every memory access. This incurs a high performance cost.
+       *  gate callback, only triggered when an inline check finds the access may hit a range.
        *
        * @param[in] start    Start of the address range which will trigger the callback.
        * @param[in] end      End of the address range which will trigger the callback.
@@ -2085,14 +2352,15 @@ namespace QBDI {
        * in case of failure).
        */
       static PyObject* vm_addMnemonicCB(PyObject* self, PyObject* args) {
-        PyObject* mnemonic = nullptr;
-        PyObject* pos      = nullptr;
-        PyObject* function = nullptr;
-        PyObject* data     = nullptr;
-        uint32_t retValue  = QBDI::INVALID_EVENTID;
+        PyObject* mnemonic  = nullptr;
+        PyObject* pos       = nullptr;
+        PyObject* function  = nullptr;
+        PyObject* data      = nullptr;
+        PyObject* predicate = nullptr;
+        uint32_t retValue   = QBDI::INVALID_EVENTID;
 
         /* Extract arguments */
-        PyArg_ParseTuple(args, "|OOOO", &mnemonic, &pos, &function, &data);
+        PyArg_ParseTuple(args, "|OOOOO", &mnemonic, &pos, &function, &data, &predicate);
 
         if (mnemonic == nullptr || !PyString_Check(mnemonic))
           return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addMnemonicCB(): Expects a string as first argument.");
@@ -2107,13 +2375,15 @@ namespace QBDI {
           return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addMnemonicCB(): Expects a PyObject as fourth argument.");
 
         try {
+          std::vector<QBDI::Predicate> terms = QBDI::Bindings::Python::PyList_AsPredicate(predicate);
           PyObject** multipleData = (PyObject**)std::malloc(sizeof(PyObject*) * 2);
           multipleData[0] = function;
           multipleData[1] = data;
           retValue = PyVMInstance_AsVMInstance(self)->addMnemonicCB(PyString_AsString(mnemonic),
                                                                     static_cast<QBDI::InstPosition>(PyInt_AsLong(pos)),
                                                                     QBDI::Bindings::Python::trampoline,
-                                                                    multipleData);
+                                                                    multipleData,
+                                                                    terms);
           QBDI::Bindings::Python::GCData.add(retValue, multipleData);
         }
         catch (const std::exception& e) {
@@ -2124,40 +2394,91 @@ namespace QBDI {
       }
 
 
-      /*! Register a callback event for a specific VM event.
+      /*! Register an inline counter incremented for every instruction executed matching the mnemonic.
        *
-       * @param[in] mask      A mask of VM event type which will trigger the callback.
-       * @param[in] cbk       A function pointer to the callback.
-       * @param[in] data      User defined data passed to the callback.
+       * @param[in] mnemonic  Mnemonic to match.
+       * @param[in] counter   Address of a user allocated 64 bits counter.
+       * @param[in] atomic    Use an atomic increment (optional, default to False).
        *
        * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
        * in case of failure).
        */
-      static PyObject* vm_addVMEventCB(PyObject* self, PyObject* args) {
-        PyObject* mask     = nullptr;
-        PyObject* function = nullptr;
-        PyObject* data     = nullptr;
+      static PyObject* vm_addMnemonicCounter(PyObject* self, PyObject* args) {
+        PyObject* mnemonic = nullptr;
+        PyObject* counter  = nullptr;
+        PyObject* atomic   = nullptr;
         uint32_t retValue  = QBDI::INVALID_EVENTID;
 
         /* Extract arguments */
-        PyArg_ParseTuple(args, "|OOO", &mask, &function, &data);
+        PyArg_ParseTuple(args, "|OOO", &mnemonic, &counter, &atomic);
 
-        if (mask == nullptr || (!PyLong_Check(mask) && !PyInt_Check(mask)))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addVMEventCB(): Expects a VMEvent as first argument.");
+        if (mnemonic == nullptr || !PyString_Check(mnemonic))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addMnemonicCounter(): Expects a string as first argument.");
+
+        if (counter == nullptr || (!PyLong_Check(counter) && !PyInt_Check(counter)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addMnemonicCounter(): Expects an integer as second argument.");
+
+        try {
+          retValue = PyVMInstance_AsVMInstance(self)->addMnemonicCounter(PyString_AsString(mnemonic),
+                                                                         reinterpret_cast<uint64_t*>(PyLong_AsRword(counter)),
+                                                                         atomic != nullptr && PyObject_IsTrue(atomic));
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return PyLong_FromLong(retValue);
+      }
+
+
+      /*! Register a sampled callback event for every instruction executed.
+       *
+       * @param[in] pos        Relative position of the event callback (pyqbdi.PREINST / pyqbdi.POSTINST).
+       * @param[in] cbk        A function pointer to the callback.
+       * @param[in] data       User defined data passed to the callback.
+       * @param[in] period     The sampling period, in executions.
+       * @param[in] randomized Randomize the sampling intervals (optional, default to False).
+       * @param[in] predicate  An inline predicate, a list of (combine, type, operand, mask, value, limit)
+       *                       tuples (optional).
+       *
+       * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
+       * in case of failure).
+       */
+      static PyObject* vm_addSampledCodeCB(PyObject* self, PyObject* args) {
+        PyObject* pos        = nullptr;
+        PyObject* function   = nullptr;
+        PyObject* data       = nullptr;
+        PyObject* period     = nullptr;
+        PyObject* randomized = nullptr;
+        PyObject* predicate  = nullptr;
+        uint32_t retValue    = QBDI::INVALID_EVENTID;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OOOOOO", &pos, &function, &data, &period, &randomized, &predicate);
+
+        if (pos == nullptr || (!PyLong_Check(pos) && !PyInt_Check(pos)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledCodeCB(): Expects an InstPosition as first argument.");
 
         if (function == nullptr || !PyCallable_Check(function))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addVMEventCB(): Expects a function as second argument.");
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledCodeCB(): Expects a function as second argument.");
 
         if (data == nullptr)
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addVMEventCB(): Expects a PyObject as third argument.");
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledCodeCB(): Expects a PyObject as third argument.");
+
+        if (period == nullptr || (!PyLong_Check(period) && !PyInt_Check(period)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledCodeCB(): Expects an integer as fourth argument.");
 
         try {
+          std::vector<QBDI::Predicate> terms = QBDI::Bindings::Python::PyList_AsPredicate(predicate);
           PyObject** multipleData = (PyObject**)std::malloc(sizeof(PyObject*) * 2);
           multipleData[0] = function;
           multipleData[1] = data;
-          retValue = PyVMInstance_AsVMInstance(self)->addVMEventCB(static_cast<QBDI::VMEvent>(PyInt_AsLong(mask)),
-                                                                   QBDI::Bindings::Python::trampoline,
-                                                                   multipleData);
+          retValue = PyVMInstance_AsVMInstance(self)->addSampledCodeCB(static_cast<QBDI::InstPosition>(PyInt_AsLong(pos)),
+                                                                       QBDI::Bindings::Python::trampoline,
+                                                                       multipleData,
+                                                                       static_cast<uint32_t>(PyLong_AsRword(period)),
+                                                                       randomized != nullptr && PyObject_IsTrue(randomized),
+                                                                       terms);
           QBDI::Bindings::Python::GCData.add(retValue, multipleData);
         }
         catch (const std::exception& e) {
@@ -2168,64 +2489,231 @@ namespace QBDI {
       }
 
 
-      /*! Call a function using the DBI (and its current state).
+      /*! Register a sampled callback for when a specific address range is executed.
        *
-       * @param[in] function   Address of the function start instruction.
-       * @param[in] args       The arguments as dictionary {0:arg0, 1:arg1, 2:arg2, ...}.
+       * @param[in] start      Start of the address range which will trigger the callback.
+       * @param[in] end        End of the address range which will trigger the callback.
+       * @param[in] pos        Relative position of the callback (pyqbdi.PREINST / pyqbdi.POSTINST).
+       * @param[in] cbk        A function pointer to the callback.
+       * @param[in] data       User defined data passed to the callback.
+       * @param[in] period     The sampling period, in executions.
+       * @param[in] randomized Randomize the sampling intervals (optional, default to False).
+       * @param[in] predicate  An inline predicate, a list of (combine, type, operand, mask, value, limit)
+       *                       tuples (optional).
        *
-       * @return (True, retValue) if at least one block has been executed.
+       * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
+       * in case of failure).
        */
-      static PyObject* vm_call(PyObject* self, PyObject* args) {
-        PyObject* function = nullptr;
-        PyObject* fargs    = nullptr;
-        PyObject* ret      = nullptr;
-        QBDI::rword retVal = 0;         /* return value of the called function */
-        bool retCall       = false;     /* return vaule of QBDI */
+      static PyObject* vm_addSampledCodeRangeCB(PyObject* self, PyObject* args) {
+        PyObject* start      = nullptr;
+        PyObject* end        = nullptr;
+        PyObject* pos        = nullptr;
+        PyObject* function   = nullptr;
+        PyObject* data       = nullptr;
+        PyObject* period     = nullptr;
+        PyObject* randomized = nullptr;
+        PyObject* predicate  = nullptr;
+        uint32_t retValue    = QBDI::INVALID_EVENTID;
 
         /* Extract arguments */
-        PyArg_ParseTuple(args, "|OO", &function, &fargs);
+        PyArg_ParseTuple(args, "|OOOOOOOO", &start, &end, &pos, &function, &data, &period, &randomized, &predicate);
 
-        if (function == nullptr || (!PyLong_Check(function) && !PyInt_Check(function)))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::call(): Expects an integer (function address) as first argument.");
+        if (start == nullptr || (!PyLong_Check(start) && !PyInt_Check(start)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledCodeRangeCB(): Expects an integer as first argument.");
 
-        if (fargs != nullptr && !PyList_Check(fargs))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::call(): Expects a list as second argument.");
+        if (end == nullptr || (!PyLong_Check(end) && !PyInt_Check(end)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledCodeRangeCB(): Expects an integer as second argument.");
 
-        std::vector<QBDI::rword> cfargs;
-        if (fargs != nullptr && PyList_Check(fargs)) {
-          for (Py_ssize_t i = 0; i < PyList_Size(fargs); i++) {
-            PyObject* item = PyList_GetItem(fargs, i);
+        if (pos == nullptr || (!PyLong_Check(pos) && !PyInt_Check(pos)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledCodeRangeCB(): Expects an InstPosition as third argument.");
 
-            if (!PyLong_Check(item) && !PyInt_Check(item))
-              return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::call(): Expects integers as list contents.");
+        if (function == nullptr || !PyCallable_Check(function))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledCodeRangeCB(): Expects a function as fourth argument.");
 
-            cfargs.push_back(PyLong_AsRword(item));
-          }
-        }
+        if (data == nullptr)
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledCodeRangeCB(): Expects a PyObject as fifth argument.");
+
+        if (period == nullptr || (!PyLong_Check(period) && !PyInt_Check(period)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledCodeRangeCB(): Expects an integer as sixth argument.");
 
         try {
-          retCall = PyVMInstance_AsVMInstance(self)->callA(&retVal,
-                                                           PyLong_AsRword(function),
-                                                           cfargs.size(),
-                                                           cfargs.data());
+          std::vector<QBDI::Predicate> terms = QBDI::Bindings::Python::PyList_AsPredicate(predicate);
+          PyObject** multipleData = (PyObject**)std::malloc(sizeof(PyObject*) * 2);
+          multipleData[0] = function;
+          multipleData[1] = data;
+          retValue = PyVMInstance_AsVMInstance(self)->addSampledCodeRangeCB(PyLong_AsRword(start),
+                                                                            PyLong_AsRword(end),
+                                                                            static_cast<QBDI::InstPosition>(PyInt_AsLong(pos)),
+                                                                            QBDI::Bindings::Python::trampoline,
+                                                                            multipleData,
+                                                                            static_cast<uint32_t>(PyLong_AsRword(period)),
+                                                                            randomized != nullptr && PyObject_IsTrue(randomized),
+                                                                            terms);
+          QBDI::Bindings::Python::GCData.add(retValue, multipleData);
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
         }
 
-        /* Return a tuple: (call status, ret value) */
-        ret = PyTuple_New(2);
-        PyTuple_SetItem(ret, 0, PyBool_FromLong(retCall));
-        PyTuple_SetItem(ret, 1, PyLong_FromLong(retVal));
-
-        return ret;
+        return PyLong_FromLong(retValue);
       }
 
 
-      /*! Clear the entire translation cache.
+      /*! Register a sampled callback event for a specific VM event.
        *
-       * @return None.
-       */
+       * @param[in] mask       A mask of VM event type which will trigger the callback.
+       * @param[in] cbk        A function pointer to the callback.
+       * @param[in] data       User defined data passed to the callback.
+       * @param[in] period     The sampling period, in events.
+       * @param[in] randomized Randomize the sampling intervals (optional, default to False).
+       *
+       * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
+       * in case of failure).
+       */
+      static PyObject* vm_addSampledVMEventCB(PyObject* self, PyObject* args) {
+        PyObject* mask       = nullptr;
+        PyObject* function   = nullptr;
+        PyObject* data       = nullptr;
+        PyObject* period     = nullptr;
+        PyObject* randomized = nullptr;
+        uint32_t retValue    = QBDI::INVALID_EVENTID;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OOOOO", &mask, &function, &data, &period, &randomized);
+
+        if (mask == nullptr || (!PyLong_Check(mask) && !PyInt_Check(mask)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledVMEventCB(): Expects a VMEvent as first argument.");
+
+        if (function == nullptr || !PyCallable_Check(function))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledVMEventCB(): Expects a function as second argument.");
+
+        if (data == nullptr)
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledVMEventCB(): Expects a PyObject as third argument.");
+
+        if (period == nullptr || (!PyLong_Check(period) && !PyInt_Check(period)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addSampledVMEventCB(): Expects an integer as fourth argument.");
+
+        try {
+          PyObject** multipleData = (PyObject**)std::malloc(sizeof(PyObject*) * 2);
+          multipleData[0] = function;
+          multipleData[1] = data;
+          retValue = PyVMInstance_AsVMInstance(self)->addSampledVMEventCB(static_cast<QBDI::VMEvent>(PyInt_AsLong(mask)),
+                                                                          QBDI::Bindings::Python::trampoline,
+                                                                          multipleData,
+                                                                          static_cast<uint32_t>(PyLong_AsRword(period)),
+                                                                          randomized != nullptr && PyObject_IsTrue(randomized));
+          QBDI::Bindings::Python::GCData.add(retValue, multipleData);
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return PyLong_FromLong(retValue);
+      }
+
+
+      /*! Register a callback event for a specific VM event.
+       *
+       * @param[in] mask      A mask of VM event type which will trigger the callback.
+       * @param[in] cbk       A function pointer to the callback.
+       * @param[in] data      User defined data passed to the callback.
+       *
+       * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
+       * in case of failure).
+       */
+      static PyObject* vm_addVMEventCB(PyObject* self, PyObject* args) {
+        PyObject* mask     = nullptr;
+        PyObject* function = nullptr;
+        PyObject* data     = nullptr;
+        uint32_t retValue  = QBDI::INVALID_EVENTID;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OOO", &mask, &function, &data);
+
+        if (mask == nullptr || (!PyLong_Check(mask) && !PyInt_Check(mask)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addVMEventCB(): Expects a VMEvent as first argument.");
+
+        if (function == nullptr || !PyCallable_Check(function))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addVMEventCB(): Expects a function as second argument.");
+
+        if (data == nullptr)
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::addVMEventCB(): Expects a PyObject as third argument.");
+
+        try {
+          PyObject** multipleData = (PyObject**)std::malloc(sizeof(PyObject*) * 2);
+          multipleData[0] = function;
+          multipleData[1] = data;
+          retValue = PyVMInstance_AsVMInstance(self)->addVMEventCB(static_cast<QBDI::VMEvent>(PyInt_AsLong(mask)),
+                                                                   QBDI::Bindings::Python::trampoline,
+                                                                   multipleData);
+          QBDI::Bindings::Python::GCData.add(retValue, multipleData);
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return PyLong_FromLong(retValue);
+      }
+
+
+      /*! Call a function using the DBI (and its current state).
+       *
+       * @param[in] function   Address of the function start instruction.
+       * @param[in] args       The arguments as dictionary {0:arg0, 1:arg1, 2:arg2, ...}.
+       *
+       * @return (True, retValue) if at least one block has been executed.
+       */
+      static PyObject* vm_call(PyObject* self, PyObject* args) {
+        PyObject* function = nullptr;
+        PyObject* fargs    = nullptr;
+        PyObject* ret      = nullptr;
+        QBDI::rword retVal = 0;         /* return value of the called function */
+        bool retCall       = false;     /* return vaule of QBDI */
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OO", &function, &fargs);
+
+        if (function == nullptr || (!PyLong_Check(function) && !PyInt_Check(function)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::call(): Expects an integer (function address) as first argument.");
+
+        if (fargs != nullptr && !PyList_Check(fargs))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::call(): Expects a list as second argument.");
+
+        std::vector<QBDI::rword> cfargs;
+        if (fargs != nullptr && PyList_Check(fargs)) {
+          for (Py_ssize_t i = 0; i < PyList_Size(fargs); i++) {
+            PyObject* item = PyList_GetItem(fargs, i);
+
+            if (!PyLong_Check(item) && !PyInt_Check(item))
+              return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::call(): Expects integers as list contents.");
+
+            cfargs.push_back(PyLong_AsRword(item));
+          }
+        }
+
+        try {
+          retCall = PyVMInstance_AsVMInstance(self)->callA(&retVal,
+                                                           PyLong_AsRword(function),
+                                                           cfargs.size(),
+                                                           cfargs.data());
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        /* Return a tuple: (call status, ret value) */
+        ret = PyTuple_New(2);
+        PyTuple_SetItem(ret, 0, PyBool_FromLong(retCall));
+        PyTuple_SetItem(ret, 1, PyLong_FromLong(retVal));
+
+        return ret;
+      }
+
+
+      /*! Clear the entire translation cache.
+       *
+       * @return None.
+       */
       static PyObject* vm_clearAllCache(PyObject* self, PyObject* noarg) {
         try {
           PyVMInstance_AsVMInstance(self)->clearAllCache();
@@ -2294,10 +2782,563 @@ namespace QBDI {
           return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::deleteInstrumentation(): Expects an integer as first argument.");
 
         try {
-          if (PyVMInstance_AsVMInstance(self)->deleteInstrumentation(PyLong_AsRword(id) & 0xffffffff) == true) {
-            QBDI::Bindings::Python::GCData.del(PyLong_AsRword(id) & 0xffffffff);
+          if (PyVMInstance_AsVMInstance(self)->deleteInstrumentation(PyLong_AsRword(id) & 0xffffffff) == true) {
+            QBDI::Bindings::Python::GCData.del(PyLong_AsRword(id) & 0xffffffff);
+            return PyBool_FromLong(true);
+          }
+          return PyBool_FromLong(false);
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Deliver immediately the pending memory trace records to the trace callback.
+       *
+       * @return None.
+       */
+      static PyObject* vm_flushMemoryTrace(PyObject* self, PyObject* noarg) {
+        try {
+          PyVMInstance_AsVMInstance(self)->flushMemoryTrace();
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+        Py_RETURN_NONE;
+      }
+
+
+      /*! Deliver immediately the pending syscall trace records to the trace callback.
+       *
+       * @return None.
+       */
+      static PyObject* vm_flushSyscallTrace(PyObject* self, PyObject* noarg) {
+        try {
+          PyVMInstance_AsVMInstance(self)->flushSyscallTrace();
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+        Py_RETURN_NONE;
+      }
+
+
+      /*! Obtain the memory accesses made by the last executed basic block.
+       *
+       * @return An array of memory accesses made by the basic block.
+       */
+      static PyObject* vm_getBBMemoryAccess(PyObject* self, PyObject* noarg) {
+        PyObject* ret = nullptr;
+        size_t index  = 0;
+
+        try {
+          std::vector<QBDI::MemoryAccess> memoryAccesses = PyVMInstance_AsVMInstance(self)->getBBMemoryAccess();
+
+          /* Otherwise, return a list of MemoryAccess */
+          ret = PyList_New(memoryAccesses.size());
+          for (auto& memoryAccess : memoryAccesses) {
+            PyList_SetItem(ret, index++, PyMemoryAccess(memoryAccess));
+          }
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return ret;
+      }
+
+
+      /*! Obtain the addresses of the indirect branch sites executed since the branch profiling was
+       * enabled.
+       *
+       * @return A list of branch instruction addresses.
+       */
+      static PyObject* vm_getBranchSites(PyObject* self, PyObject* noarg) {
+        PyObject* ret = nullptr;
+        size_t index  = 0;
+
+        try {
+          std::vector<QBDI::rword> sites = PyVMInstance_AsVMInstance(self)->getBranchSites();
+
+          ret = PyList_New(sites.size());
+          for (QBDI::rword site : sites) {
+            PyList_SetItem(ret, index++, PyLong_FromUnsignedLongLong(site));
+          }
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return ret;
+      }
+
+
+      /*! Obtain the targets observed at an indirect branch site.
+       *
+       * @param[in] site  The address of the branch instruction.
+       *
+       * @return A list of (target, count) tuples, from the most to the least frequent target.
+       */
+      static PyObject* vm_getBranchTargets(PyObject* self, PyObject* site) {
+        PyObject* ret = nullptr;
+        size_t index  = 0;
+
+        if (!PyLong_Check(site) && !PyInt_Check(site))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::getBranchTargets(): Expects an integer as first argument.");
+
+        try {
+          std::vector<QBDI::BranchTarget> targets = PyVMInstance_AsVMInstance(self)->getBranchTargets(PyLong_AsRword(site));
+
+          ret = PyList_New(targets.size());
+          for (auto& target : targets) {
+            PyObject* item = PyTuple_New(2);
+            PyTuple_SetItem(item, 0, PyLong_FromUnsignedLongLong(target.target));
+            PyTuple_SetItem(item, 1, PyLong_FromUnsignedLongLong(target.count));
+            PyList_SetItem(ret, index++, item);
+          }
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return ret;
+      }
+
+
+      /*! Obtain the current call stack, from the shadow call stack.
+       *
+       * @return A list of (callSite, returnAddress, target, stackPointer) tuples, from the 
+       *         innermost to the outermost frame.
+       */
+      static PyObject* vm_getCallStack(PyObject* self, PyObject* noarg) {
+        PyObject* ret = nullptr;
+        size_t index  = 0;
+
+        try {
+          std::vector<QBDI::CallFrame> frames = PyVMInstance_AsVMInstance(self)->getCallStack();
+
+          ret = PyList_New(frames.size());
+          for (auto& frame : frames) {
+            PyObject* item = PyTuple_New(4);
+            PyTuple_SetItem(item, 0, PyLong_FromUnsignedLongLong(frame.callSite));
+            PyTuple_SetItem(item, 1, PyLong_FromUnsignedLongLong(frame.returnAddress));
+            PyTuple_SetItem(item, 2, PyLong_FromUnsignedLongLong(frame.target));
+            PyTuple_SetItem(item, 3, PyLong_FromUnsignedLongLong(frame.stackPointer));
+            PyList_SetItem(ret, index++, item);
+          }
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return ret;
+      }
+
+
+      /*! Obtain a snapshot of the values of all the registered inline counters.
+       *
+       * @return A list of (id, value) tuples.
+       */
+      static PyObject* vm_getCounters(PyObject* self, PyObject* noarg) {
+        PyObject* ret = nullptr;
+        size_t index  = 0;
+
+        try {
+          std::vector<QBDI::CounterValue> counters = PyVMInstance_AsVMInstance(self)->getCounters();
+
+          ret = PyList_New(counters.size());
+          for (auto& counter : counters) {
+            PyObject* item = PyTuple_New(2);
+            PyTuple_SetItem(item, 0, PyLong_FromLong(counter.id));
+            PyTuple_SetItem(item, 1, PyLong_FromUnsignedLongLong(counter.value));
+            PyList_SetItem(ret, index++, item);
+          }
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return ret;
+      }
+
+
+      /*! Obtain the current floating point register state.
+       *
+       * @return A structure containing the FPR state.
+       */
+      static PyObject* vm_getFPRState(PyObject* self, PyObject* noarg) {
+        try {
+          return PyFPRState(PyVMInstance_AsVMInstance(self)->getFPRState());
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Obtain the current general purpose register state.
+       *
+       * @return A structure containing the General Purpose Registers state.
+       */
+      static PyObject* vm_getGPRState(PyObject* self, PyObject* noarg) {
+        try {
+          return PyGPRState(PyVMInstance_AsVMInstance(self)->getGPRState());
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Obtain the analysis of an instruction metadata. Analysis results are cached in the VM.
+      *  The validity of the returned pointer is only guaranteed until the end of the callback, else
+      *  a deepcopy of the structure is required.
+      *
+      * @param[in] type         Properties to retrieve during analysis.
+      *
+      * @return A InstAnalysis structure containing the analysis result.
+      */
+      static PyObject* vm_getInstAnalysis(PyObject* self, PyObject* args) {
+        PyObject* type = nullptr;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|O", &type);
+
+        try {
+          if (type == nullptr)
+            return PyInstAnalysis(PyVMInstance_AsVMInstance(self)->getInstAnalysis());
+
+          else if (PyLong_Check(type) || PyInt_Check(type))
+            return PyInstAnalysis(PyVMInstance_AsVMInstance(self)->getInstAnalysis(static_cast<QBDI::AnalysisType>(PyLong_AsLong(type))));
+
+          else
+            return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::getInstAnalysis(): Expects an AnalysisType as first argument or no argument.");
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Obtain the memory accesses made by the last executed instruction.
+       *
+       * @return An array of memory accesses made by the instruction.
+       */
+      static PyObject* vm_getInstMemoryAccess(PyObject* self, PyObject* noarg) {
+        PyObject* ret = nullptr;
+        size_t index  = 0;
+
+        try {
+          std::vector<QBDI::MemoryAccess> memoryAccesses = PyVMInstance_AsVMInstance(self)->getInstMemoryAccess();
+
+          /* Otherwise, return a list of MemoryAccess */
+          ret = PyList_New(memoryAccesses.size());
+          for (auto& memoryAccess : memoryAccesses) {
+            PyList_SetItem(ret, index++, PyMemoryAccess(memoryAccess));
+          }
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return ret;
+      }
+
+
+      /*! Obtain the complete value of a memory access of the current basic block which is larger
+       *  than a rword.
+       *
+       * @param[in] access  A MemoryAccess returned by getInstMemoryAccess or getBBMemoryAccess.
+       *
+       * @return The value as bytes, or None if it was not recorded.
+       */
+      static PyObject* vm_getMemoryAccessValue(PyObject* self, PyObject* access) {
+        if (access == nullptr || !PyMemoryAccess_Check(access))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::getMemoryAccessValue(): Expects a MemoryAccess as first argument.");
+
+        try {
+          const QBDI::MemoryAccess* memoryAccess = PyMemoryAccess_AsMemoryAccess(access);
+          std::vector<char> buffer(memoryAccess->size);
+          if (PyVMInstance_AsVMInstance(self)->getMemoryAccessValue(*memoryAccess, buffer.data(), buffer.size()) == false)
+            Py_RETURN_NONE;
+          return PyBytes_FromStringAndSize(buffer.data(), buffer.size());
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Get the taint of a memory range.
+       *
+       * @param[in] start  Start address of the range.
+       * @param[in] size   Size of the range in bytes.
+       *
+       * @return The union of the taint labels of the range bytes.
+       */
+      static PyObject* vm_getMemoryTaint(PyObject* self, PyObject* args) {
+        PyObject* start = nullptr;
+        PyObject* size  = nullptr;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OO", &start, &size);
+
+        if (start == nullptr || (!PyLong_Check(start) && !PyInt_Check(start)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::getMemoryTaint(): Expects an integer as first argument.");
+
+        if (size == nullptr || (!PyLong_Check(size) && !PyInt_Check(size)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::getMemoryTaint(): Expects an integer as second argument.");
+
+        try {
+          return PyInt_FromLong(PyVMInstance_AsVMInstance(self)->getMemoryTaint(PyLong_AsRword(start), PyLong_AsRword(size)));
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Get the taint of a general purpose register.
+       *
+       * @param[in] gpr  The GPR index.
+       *
+       * @return The union of the taint labels of the register bytes.
+       */
+      static PyObject* vm_getRegisterTaint(PyObject* self, PyObject* gpr) {
+        if (!PyLong_Check(gpr) && !PyInt_Check(gpr))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::getRegisterTaint(): Expects an integer as first argument.");
+
+        try {
+          return PyInt_FromLong(PyVMInstance_AsVMInstance(self)->getRegisterTaint(PyInt_AsLong(gpr)));
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Adds all the executable memory maps to the instrumented range set.
+       *
+       * @return  True if at least one range was added to the instrumented ranges.
+       */
+      static PyObject* vm_instrumentAllExecutableMaps(PyObject* self, PyObject* noarg) {
+        try {
+          if (PyVMInstance_AsVMInstance(self)->instrumentAllExecutableMaps() == true)
+            return PyBool_FromLong(true);
+          return PyBool_FromLong(false);
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Pre-cache a known basic block
+       *
+       *  @param[in]  pc           Start address of a basic block
+       *
+       * @return True if basic block has been inserted in cache.
+       */
+      static PyObject* vm_precacheBasicBlock(PyObject* self, PyObject* pc) {
+        if (!PyLong_Check(pc) && !PyInt_Check(pc))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::precacheBasicBlock(): Expects an integer as first argument.");
+
+        try {
+          if (PyVMInstance_AsVMInstance(self)->precacheBasicBlock(PyLong_AsRword(pc)) == true)
+            return PyBool_FromLong(true);
+          return PyBool_FromLong(false);
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Add instrumentation rules to log memory access using inline instrumentation and
+       *  instruction shadows.
+       *
+       * @param[in] type      Memory mode bitfield to activate the logging for: either pyqbdi.MEMORY_READ,
+       *                      pyqbdi.MEMORY_WRITE or both (pyqbdi.MEMORY_READ_WRITE).
+       *
+       * @return True if inline memory logging is supported, False if not or in case of error.
+       */
+      static PyObject* vm_recordMemoryAccess(PyObject* self, PyObject* type) {
+        if (!PyLong_Check(type) && !PyInt_Check(type))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::recordMemoryAccess(): Expects a MemoryAccessType as first argument.");
+
+        try {
+          if (PyVMInstance_AsVMInstance(self)->recordMemoryAccess(static_cast<QBDI::MemoryAccessType>(PyLong_AsLong(type))) == true)
+            return PyBool_FromLong(true);
+          return PyBool_FromLong(false);
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Remove all instrumented ranges.
+       *
+       * @return None
+       */
+      static PyObject* vm_removeAllInstrumentedRanges(PyObject* self, PyObject* noarg) {
+        try {
+          PyVMInstance_AsVMInstance(self)->removeAllInstrumentedRanges();
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+        Py_RETURN_NONE;
+      }
+
+
+      /*! Remove the executable address ranges of a module from the set of instrumented address ranges.
+       *
+       * @param[in] name      The module's name.
+       *
+       * @return  True if at least one range was removed from the instrumented ranges.
+       */
+      static PyObject* vm_removeInstrumentedModule(PyObject* self, PyObject* module) {
+        if (!PyString_Check(module))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::removeInstrumentedModule(): Expects a string as first argument.");
+
+        try {
+          if (PyVMInstance_AsVMInstance(self)->removeInstrumentedModule(PyString_AsString(module)) == true)
+            return PyBool_FromLong(true);
+          return PyBool_FromLong(false);
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Remove the executable address ranges of a module from the set of instrumented address ranges.
+       * using an address belonging to the module.
+       *
+       * @param[in] addr      An address contained by module's range.
+       *
+       * @return  True if at least one range was removed from the instrumented ranges.
+       */
+      static PyObject* vm_removeInstrumentedModuleFromAddr(PyObject* self, PyObject* addr) {
+        if (!PyLong_Check(addr) && !PyInt_Check(addr))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::removeInstrumentedModuleFromAddr(): Expects an integer as first argument.");
+
+        try {
+          if (PyVMInstance_AsVMInstance(self)->removeInstrumentedModuleFromAddr(PyLong_AsRword(addr)) == true)
+            return PyBool_FromLong(true);
+          return PyBool_FromLong(false);
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+      }
+
+
+      /*! Remove an address range from the set of instrumented address ranges.
+       *
+       * @param[in] start     Start address of the range (included).
+       * @param[in] end       End address of the range (excluded).
+       *
+       * @return None.
+       */
+      static PyObject* vm_removeInstrumentedRange(PyObject* self, PyObject* args) {
+        PyObject* start  = nullptr;
+        PyObject* end    = nullptr;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OO", &start, &end);
+
+        if (start == nullptr || (!PyLong_Check(start) && !PyInt_Check(start)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::removeInstrumentedRange(): Expects an integer as first argument.");
+
+        if (end == nullptr || (!PyLong_Check(end) && !PyInt_Check(end)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::removeInstrumentedRange(): Expects an integer as second argument.");
+
+        try {
+          PyVMInstance_AsVMInstance(self)->removeInstrumentedRange(PyLong_AsRword(start), PyLong_AsRword(end));
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+        Py_RETURN_NONE;
+      }
+
+
+      /*! Remove several address ranges from the set of instrumented address ranges at once.
+       *
+       * @param[in] ranges  A list of (start, end) tuples.
+       *
+       * @return None.
+       */
+      static PyObject* vm_removeInstrumentedRanges(PyObject* self, PyObject* ranges) {
+        try {
+          PyVMInstance_AsVMInstance(self)->removeInstrumentedRanges(PyList_AsRangeSet(ranges));
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+        Py_RETURN_NONE;
+      }
+
+
+      /*! Replace a function by another one, which receives its arguments and returns to its caller.
+       *
+       * @param[in] target       The entry address of the replaced function.
+       * @param[in] replacement  The address of the native replacement function.
+       *
+       * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
+       * in case of failure).
+       */
+      static PyObject* vm_replaceFunction(PyObject* self, PyObject* args) {
+        PyObject* target      = nullptr;
+        PyObject* replacement = nullptr;
+        uint32_t retValue     = QBDI::INVALID_EVENTID;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OO", &target, &replacement);
+
+        if (target == nullptr || (!PyLong_Check(target) && !PyInt_Check(target)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::replaceFunction(): Expects an integer as first argument.");
+
+        if (replacement == nullptr || (!PyLong_Check(replacement) && !PyInt_Check(replacement)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::replaceFunction(): Expects an integer as second argument.");
+
+        try {
+          retValue = PyVMInstance_AsVMInstance(self)->replaceFunction(PyLong_AsRword(target), PyLong_AsRword(replacement));
+        }
+        catch (const std::exception& e) {
+          return PyErr_Format(PyExc_TypeError, "%s", e.what());
+        }
+
+        return PyLong_FromLong(retValue);
+      }
+
+
+      /*! Start the execution by the DBI from a given address (and stop when another is reached).
+       *
+       * @param[in] start     Address of the first instruction to execute.
+       * @param[in] stop      Stop the execution when this instruction is reached.
+       *
+       * @return  True if at least one block has been executed.
+       */
+      static PyObject* vm_run(PyObject* self, PyObject* args) {
+        PyObject* start  = nullptr;
+        PyObject* end    = nullptr;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OO", &start, &end);
+
+        if (start == nullptr || (!PyLong_Check(start) && !PyInt_Check(start)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::run(): Expects an integer as first argument.");
+
+        if (end == nullptr || (!PyLong_Check(end) && !PyInt_Check(end)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::run(): Expects an integer as second argument.");
+
+        try {
+          if (PyVMInstance_AsVMInstance(self)->run(PyLong_AsRword(start), PyLong_AsRword(end)) == true)
             return PyBool_FromLong(true);
-          }
           return PyBool_FromLong(false);
         }
         catch (const std::exception& e) {
@@ -2306,38 +3347,70 @@ namespace QBDI {
       }
 
 
-      /*! Obtain the memory accesses made by the last executed basic block.
+      /*! Start the execution by the DBI and stop it once a budget of instructions or basic blocks
+       *  has been executed.
        *
-       * @return An array of memory accesses made by the basic block.
+       * @param[in] start     Address of the first instruction to execute.
+       * @param[in] stop      Stop the execution when this instruction is reached.
+       * @param[in] budget    The maximum number of instructions or basic blocks to execute.
+       * @param[in] type      The unit of the budget (optional, default to pyqbdi.BUDGET_INSTRUCTIONS).
+       *
+       * @return  A tuple (ran, executed): True if at least one block has been executed and the 
+       *          number of instructions or basic blocks executed.
        */
-      static PyObject* vm_getBBMemoryAccess(PyObject* self, PyObject* noarg) {
-        PyObject* ret = nullptr;
-        size_t index  = 0;
+      static PyObject* vm_runWithBudget(PyObject* self, PyObject* args) {
+        PyObject* start  = nullptr;
+        PyObject* end    = nullptr;
+        PyObject* budget = nullptr;
+        PyObject* type   = nullptr;
+        uint64_t executed = 0;
 
-        try {
-          std::vector<QBDI::MemoryAccess> memoryAccesses = PyVMInstance_AsVMInstance(self)->getBBMemoryAccess();
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OOOO", &start, &end, &budget, &type);
 
-          /* Otherwise, return a list of MemoryAccess */
-          ret = PyList_New(memoryAccesses.size());
-          for (auto& memoryAccess : memoryAccesses) {
-            PyList_SetItem(ret, index++, PyMemoryAccess(memoryAccess));
-          }
+        if (start == nullptr || (!PyLong_Check(start) && !PyInt_Check(start)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::runWithBudget(): Expects an integer as first argument.");
+
+        if (end == nullptr || (!PyLong_Check(end) && !PyInt_Check(end)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::runWithBudget(): Expects an integer as second argument.");
+
+        if (budget == nullptr || (!PyLong_Check(budget) && !PyInt_Check(budget)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::runWithBudget(): Expects an integer as third argument.");
+
+        if (type == Py_None)
+          type = nullptr;
+
+        if (type != nullptr && !PyLong_Check(type) && !PyInt_Check(type))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::runWithBudget(): Expects a BudgetType as fourth argument.");
+
+        try {
+          bool ran = PyVMInstance_AsVMInstance(self)->runWithBudget(PyLong_AsRword(start),
+                                                                    PyLong_AsRword(end),
+                                                                    static_cast<uint64_t>(PyLong_AsRword(budget)),
+                                                                    (type != nullptr) ? static_cast<QBDI::BudgetType>(PyInt_AsLong(type)) : QBDI::BUDGET_INSTRUCTIONS,
+                                                                    &executed);
+          PyObject* result = PyTuple_New(2);
+          PyTuple_SetItem(result, 0, PyBool_FromLong(ran));
+          PyTuple_SetItem(result, 1, PyLong_FromUnsignedLongLong(executed));
+          return result;
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
         }
-
-        return ret;
       }
 
 
-      /*! Obtain the current floating point register state.
+      /*! Enable or disable the profiling of the indirect branch and call targets.
        *
-       * @return A structure containing the FPR state.
+       * @param[in] enable  True to enable the branch profiling, False to disable it.
+       *
+       * @return True if the branch profiling has been enabled (or disabled).
        */
-      static PyObject* vm_getFPRState(PyObject* self, PyObject* noarg) {
+      static PyObject* vm_setBranchProfiling(PyObject* self, PyObject* enable) {
         try {
-          return PyFPRState(PyVMInstance_AsVMInstance(self)->getFPRState());
+          if (PyVMInstance_AsVMInstance(self)->setBranchProfiling(PyObject_IsTrue(enable) == 1) == true)
+            return PyBool_FromLong(true);
+          return PyBool_FromLong(false);
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
@@ -2345,13 +3418,17 @@ namespace QBDI {
       }
 
 
-      /*! Obtain the current general purpose register state.
+      /*! Enable or disable the shadow call stack.
        *
-       * @return A structure containing the General Purpose Registers state.
+       * @param[in] enable  True to enable the call stack tracking, False to disable it.
+       *
+       * @return True if the call stack tracking has been enabled (or disabled).
        */
-      static PyObject* vm_getGPRState(PyObject* self, PyObject* noarg) {
+      static PyObject* vm_setCallStackTracking(PyObject* self, PyObject* enable) {
         try {
-          return PyGPRState(PyVMInstance_AsVMInstance(self)->getGPRState());
+          if (PyVMInstance_AsVMInstance(self)->setCallStackTracking(PyObject_IsTrue(enable) == 1) == true)
+            return PyBool_FromLong(true);
+          return PyBool_FromLong(false);
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
@@ -2359,29 +3436,32 @@ namespace QBDI {
       }
 
 
-      /*! Obtain the analysis of an instruction metadata. Analysis results are cached in the VM.
-      *  The validity of the returned pointer is only guaranteed until the end of the callback, else
-      *  a deepcopy of the structure is required.
-      *
-      * @param[in] type         Properties to retrieve during analysis.
-      *
-      * @return A InstAnalysis structure containing the analysis result.
-      */
-      static PyObject* vm_getInstAnalysis(PyObject* self, PyObject* args) {
-        PyObject* type = nullptr;
+      /*! Enable an AFL style edge coverage instrumentation, computed inline at the start of every
+       * basic block.
+       *
+       * @param[in] bitmap  Address of the coverage bitmap, or 0 to disable the edge coverage.
+       * @param[in] size    The size of the bitmap in bytes, which must be a power of two.
+       *
+       * @return True if the edge coverage has been enabled (or disabled).
+       */
+      static PyObject* vm_setEdgeCoverage(PyObject* self, PyObject* args) {
+        PyObject* bitmap = nullptr;
+        PyObject* size   = nullptr;
 
         /* Extract arguments */
-        PyArg_ParseTuple(args, "|O", &type);
+        PyArg_ParseTuple(args, "|OO", &bitmap, &size);
 
-        try {
-          if (type == nullptr)
-            return PyInstAnalysis(PyVMInstance_AsVMInstance(self)->getInstAnalysis());
+        if (bitmap == nullptr || (!PyLong_Check(bitmap) && !PyInt_Check(bitmap)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setEdgeCoverage(): Expects an integer as first argument.");
 
-          else if (PyLong_Check(type) || PyInt_Check(type))
-            return PyInstAnalysis(PyVMInstance_AsVMInstance(self)->getInstAnalysis(static_cast<QBDI::AnalysisType>(PyLong_AsLong(type))));
+        if (size == nullptr || (!PyLong_Check(size) && !PyInt_Check(size)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setEdgeCoverage(): Expects an integer as second argument.");
 
-          else
-            return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::getInstAnalysis(): Expects an AnalysisType as first argument or no argument.");
+        try {
+          if (PyVMInstance_AsVMInstance(self)->setEdgeCoverage(reinterpret_cast<uint8_t*>(PyLong_AsRword(bitmap)),
+                                                               static_cast<size_t>(PyLong_AsRword(size))) == true)
+            return PyBool_FromLong(true);
+          return PyBool_FromLong(false);
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
@@ -2389,38 +3469,36 @@ namespace QBDI {
       }
 
 
-      /*! Obtain the memory accesses made by the last executed instruction.
+      /*! Set the FPR state.
        *
-       * @return An array of memory accesses made by the instruction.
+       * @param[in] fprState A structure containing the FPR state.
+       *
+       * @return None
        */
-      static PyObject* vm_getInstMemoryAccess(PyObject* self, PyObject* noarg) {
-        PyObject* ret = nullptr;
-        size_t index  = 0;
+      static PyObject* vm_setFPRState(PyObject* self, PyObject* arg) {
+        if (!PyFPRState_Check(arg))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setFPRState(): Expects a FPRState as first argument.");
 
         try {
-          std::vector<QBDI::MemoryAccess> memoryAccesses = PyVMInstance_AsVMInstance(self)->getInstMemoryAccess();
-
-          /* Otherwise, return a list of MemoryAccess */
-          ret = PyList_New(memoryAccesses.size());
-          for (auto& memoryAccess : memoryAccesses) {
-            PyList_SetItem(ret, index++, PyMemoryAccess(memoryAccess));
-          }
+          PyVMInstance_AsVMInstance(self)->setFPRState(PyFPRState_AsFPRState(arg));
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
         }
 
-        return ret;
+        Py_RETURN_NONE;
       }
 
 
-      /*! Adds all the executable memory maps to the instrumented range set.
+      /*! Enable or disable the native calls to the non instrumented code.
        *
-       * @return  True if at least one range was added to the instrumented ranges.
+       * @param[in] enable  True to enable the native calls, False to disable them.
+       *
+       * @return True if the native calls have been enabled (or disabled).
        */
-      static PyObject* vm_instrumentAllExecutableMaps(PyObject* self, PyObject* noarg) {
+      static PyObject* vm_setFastNativeCalls(PyObject* self, PyObject* enable) {
         try {
-          if (PyVMInstance_AsVMInstance(self)->instrumentAllExecutableMaps() == true)
+          if (PyVMInstance_AsVMInstance(self)->setFastNativeCalls(PyObject_IsTrue(enable) == 1) == true)
             return PyBool_FromLong(true);
           return PyBool_FromLong(false);
         }
@@ -2430,77 +3508,86 @@ namespace QBDI {
       }
 
 
-      /*! Pre-cache a known basic block
+      /*! Set the GPR state.
        *
-       *  @param[in]  pc           Start address of a basic block
+       * @param[in] gprState A structure containing the GPR state.
        *
-       * @return True if basic block has been inserted in cache.
+       * @return None
        */
-      static PyObject* vm_precacheBasicBlock(PyObject* self, PyObject* pc) {
-        if (!PyLong_Check(pc) && !PyInt_Check(pc))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::precacheBasicBlock(): Expects an integer as first argument.");
+      static PyObject* vm_setGPRState(PyObject* self, PyObject* arg) {
+        if (!PyGPRState_Check(arg))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setGPRState(): Expects a GPRState as first argument.");
 
         try {
-          if (PyVMInstance_AsVMInstance(self)->precacheBasicBlock(PyLong_AsRword(pc)) == true)
-            return PyBool_FromLong(true);
-          return PyBool_FromLong(false);
+          PyVMInstance_AsVMInstance(self)->setGPRState(PyGPRState_AsGPRState(arg));
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
         }
+
+        Py_RETURN_NONE;
       }
 
 
-      /*! Add instrumentation rules to log memory access using inline instrumentation and
-       *  instruction shadows.
+      /*! Enable or disable an instrumentation without flushing the translation cache.
        *
-       * @param[in] type      Memory mode bitfield to activate the logging for: either pyqbdi.MEMORY_READ,
-       *                      pyqbdi.MEMORY_WRITE or both (pyqbdi.MEMORY_READ_WRITE).
+       * @param[in] id      The id of the instrumentation.
+       * @param[in] enable  Whether the instrumentation should be enabled.
        *
-       * @return True if inline memory logging is supported, False if not or in case of error.
+       * @return The status of the switch (pyqbdi.SWITCH_UPDATED if the instrumentation has been updated).
        */
-      static PyObject* vm_recordMemoryAccess(PyObject* self, PyObject* type) {
-        if (!PyLong_Check(type) && !PyInt_Check(type))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::recordMemoryAccess(): Expects a MemoryAccessType as first argument.");
+      static PyObject* vm_setInstrumentationEnabled(PyObject* self, PyObject* args) {
+        PyObject* id     = nullptr;
+        PyObject* enable = nullptr;
 
-        try {
-          if (PyVMInstance_AsVMInstance(self)->recordMemoryAccess(static_cast<QBDI::MemoryAccessType>(PyLong_AsLong(type))) == true)
-            return PyBool_FromLong(true);
-          return PyBool_FromLong(false);
-        }
-        catch (const std::exception& e) {
-          return PyErr_Format(PyExc_TypeError, "%s", e.what());
-        }
-      }
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OO", &id, &enable);
 
+        if (id == nullptr || (!PyLong_Check(id) && !PyInt_Check(id)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setInstrumentationEnabled(): Expects an integer as first argument.");
+
+        if (enable == nullptr)
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setInstrumentationEnabled(): Expects a boolean as second argument.");
 
-      /*! Remove all instrumented ranges.
-       *
-       * @return None
-       */
-      static PyObject* vm_removeAllInstrumentedRanges(PyObject* self, PyObject* noarg) {
         try {
-          PyVMInstance_AsVMInstance(self)->removeAllInstrumentedRanges();
+          QBDI::SwitchStatus status = PyVMInstance_AsVMInstance(self)->setInstrumentationEnabled(PyLong_AsRword(id) & 0xffffffff,
+                                                                                                PyObject_IsTrue(enable) == 1);
+          return PyInt_FromLong(status);
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
         }
-        Py_RETURN_NONE;
       }
 
 
-      /*! Remove the executable address ranges of a module from the set of instrumented address ranges.
+      /*! Set the taint label of a memory range.
        *
-       * @param[in] name      The module's name.
+       * @param[in] start  Start address of the range.
+       * @param[in] size   Size of the range in bytes.
+       * @param[in] label  The taint label of the range bytes, 0 to untaint them.
        *
-       * @return  True if at least one range was removed from the instrumented ranges.
+       * @return True if the label has been set.
        */
-      static PyObject* vm_removeInstrumentedModule(PyObject* self, PyObject* module) {
-        if (!PyString_Check(module))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::removeInstrumentedModule(): Expects a string as first argument.");
+      static PyObject* vm_setMemoryTaint(PyObject* self, PyObject* args) {
+        PyObject* start = nullptr;
+        PyObject* size  = nullptr;
+        PyObject* label = nullptr;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OOO", &start, &size, &label);
+
+        if (start == nullptr || (!PyLong_Check(start) && !PyInt_Check(start)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setMemoryTaint(): Expects an integer as first argument.");
+
+        if (size == nullptr || (!PyLong_Check(size) && !PyInt_Check(size)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setMemoryTaint(): Expects an integer as second argument.");
+
+        if (label == nullptr || (!PyLong_Check(label) && !PyInt_Check(label)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setMemoryTaint(): Expects an integer as third argument.");
 
         try {
-          if (PyVMInstance_AsVMInstance(self)->removeInstrumentedModule(PyString_AsString(module)) == true)
+          if (PyVMInstance_AsVMInstance(self)->setMemoryTaint(PyLong_AsRword(start), PyLong_AsRword(size),
+                                                              static_cast<QBDI::TaintLabel>(PyInt_AsLong(label))) == true)
             return PyBool_FromLong(true);
           return PyBool_FromLong(false);
         }
@@ -2510,154 +3597,268 @@ namespace QBDI {
       }
 
 
-      /*! Remove the executable address ranges of a module from the set of instrumented address ranges.
-       * using an address belonging to the module.
+      /*! Stream the memory accesses to a callback, in batches.
        *
-       * @param[in] addr      An address contained by module's range.
+       * @param[in] type       Memory mode bitfield to trace, 0 disables the memory trace.
+       * @param[in] cbk        The callback receiving the lists of memory accesses.
+       * @param[in] data       User defined data passed to the callback.
+       * @param[in] batchSize  The number of records triggering a delivery (optional, default to 4096).
        *
-       * @return  True if at least one range was removed from the instrumented ranges.
+       * @return True if the memory trace has been enabled (or disabled).
        */
-      static PyObject* vm_removeInstrumentedModuleFromAddr(PyObject* self, PyObject* addr) {
-        if (!PyLong_Check(addr) && !PyInt_Check(addr))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::removeInstrumentedModuleFromAddr(): Expects an integer as first argument.");
+      static PyObject* vm_setMemoryTrace(PyObject* self, PyObject* args) {
+        PyObject* type      = nullptr;
+        PyObject* function  = nullptr;
+        PyObject* data      = nullptr;
+        PyObject* batchSize = nullptr;
+        bool retValue       = false;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OOOO", &type, &function, &data, &batchSize);
+
+        if (type == nullptr || (!PyLong_Check(type) && !PyInt_Check(type)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setMemoryTrace(): Expects a MemoryAccessType as first argument.");
+
+        if (PyInt_AsLong(type) != 0) {
+          if (function == nullptr || !PyCallable_Check(function))
+            return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setMemoryTrace(): Expects a function as second argument.");
+
+          if (data == nullptr)
+            return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setMemoryTrace(): Expects a PyObject as third argument.");
+        }
+
+        if (batchSize != nullptr && !PyLong_Check(batchSize) && !PyInt_Check(batchSize))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setMemoryTrace(): Expects an integer as fourth argument.");
 
         try {
-          if (PyVMInstance_AsVMInstance(self)->removeInstrumentedModuleFromAddr(PyLong_AsRword(addr)) == true)
-            return PyBool_FromLong(true);
-          return PyBool_FromLong(false);
+          PyObject** previous = QBDI::Bindings::Python::MemoryTraceData;
+          PyObject** multipleData = nullptr;
+          if (PyInt_AsLong(type) != 0) {
+            multipleData = (PyObject**)std::malloc(sizeof(PyObject*) * 2);
+            multipleData[0] = function;
+            multipleData[1] = data;
+            Py_INCREF(function);
+            Py_INCREF(data);
+          }
+          retValue = PyVMInstance_AsVMInstance(self)->setMemoryTrace(static_cast<QBDI::MemoryAccessType>(PyInt_AsLong(type)),
+                                                                     multipleData ? static_cast<QBDI::MemoryTraceCallback>(QBDI::Bindings::Python::trampoline) : nullptr,
+                                                                     multipleData,
+                                                                     batchSize ? static_cast<size_t>(PyLong_AsRword(batchSize)) : 4096);
+          /* The previous callback has received its last delivery */
+          QBDI::Bindings::Python::MemoryTraceData = multipleData;
+          if (previous != nullptr) {
+            Py_DECREF(previous[0]);
+            Py_DECREF(previous[1]);
+            std::free(previous);
+          }
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
         }
+
+        return PyBool_FromLong(retValue);
       }
 
 
-      /*! Remove an address range from the set of instrumented address ranges.
+      /*! Set the taint label of every byte of a general purpose register.
        *
-       * @param[in] start     Start address of the range (included).
-       * @param[in] end       End address of the range (excluded).
+       * @param[in] gpr    The GPR index.
+       * @param[in] label  The taint label of the register bytes, 0 to untaint them.
        *
-       * @return None.
+       * @return True if the label has been set.
        */
-      static PyObject* vm_removeInstrumentedRange(PyObject* self, PyObject* args) {
-        PyObject* start  = nullptr;
-        PyObject* end    = nullptr;
+      static PyObject* vm_setRegisterTaint(PyObject* self, PyObject* args) {
+        PyObject* gpr   = nullptr;
+        PyObject* label = nullptr;
 
         /* Extract arguments */
-        PyArg_ParseTuple(args, "|OO", &start, &end);
+        PyArg_ParseTuple(args, "|OO", &gpr, &label);
 
-        if (start == nullptr || (!PyLong_Check(start) && !PyInt_Check(start)))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::removeInstrumentedRange(): Expects an integer as first argument.");
+        if (gpr == nullptr || (!PyLong_Check(gpr) && !PyInt_Check(gpr)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setRegisterTaint(): Expects an integer as first argument.");
 
-        if (end == nullptr || (!PyLong_Check(end) && !PyInt_Check(end)))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::removeInstrumentedRange(): Expects an integer as second argument.");
+        if (label == nullptr || (!PyLong_Check(label) && !PyInt_Check(label)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setRegisterTaint(): Expects an integer as second argument.");
 
         try {
-          PyVMInstance_AsVMInstance(self)->removeInstrumentedRange(PyLong_AsRword(start), PyLong_AsRword(end));
+          if (PyVMInstance_AsVMInstance(self)->setRegisterTaint(PyInt_AsLong(gpr),
+                                                                static_cast<QBDI::TaintLabel>(PyInt_AsLong(label))) == true)
+            return PyBool_FromLong(true);
+          return PyBool_FromLong(false);
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
         }
-        Py_RETURN_NONE;
       }
 
 
-      /*! Start the execution by the DBI from a given address (and stop when another is reached).
+      /*! Stream the executed syscalls to a callback, in batches.
        *
-       * @param[in] start     Address of the first instruction to execute.
-       * @param[in] stop      Stop the execution when this instruction is reached.
+       * @param[in] cbk        The callback receiving the lists of syscalls, None disables the 
+       *                       syscall trace.
+       * @param[in] data       User defined data passed to the callback.
+       * @param[in] batchSize  The number of records triggering a delivery (optional, default to 256).
        *
-       * @return  True if at least one block has been executed.
+       * @return True if the syscall trace has been enabled (or disabled).
        */
-      static PyObject* vm_run(PyObject* self, PyObject* args) {
-        PyObject* start  = nullptr;
-        PyObject* end    = nullptr;
+      static PyObject* vm_setSyscallTrace(PyObject* self, PyObject* args) {
+        PyObject* function  = nullptr;
+        PyObject* data      = nullptr;
+        PyObject* batchSize = nullptr;
+        bool retValue       = false;
 
         /* Extract arguments */
-        PyArg_ParseTuple(args, "|OO", &start, &end);
+        PyArg_ParseTuple(args, "|OOO", &function, &data, &batchSize);
 
-        if (start == nullptr || (!PyLong_Check(start) && !PyInt_Check(start)))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::run(): Expects an integer as first argument.");
+        if (function == nullptr || (function != Py_None && !PyCallable_Check(function)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setSyscallTrace(): Expects a function or None as first argument.");
 
-        if (end == nullptr || (!PyLong_Check(end) && !PyInt_Check(end)))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::run(): Expects an integer as second argument.");
+        if (function != Py_None && data == nullptr)
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setSyscallTrace(): Expects a PyObject as second argument.");
+
+        if (batchSize != nullptr && !PyLong_Check(batchSize) && !PyInt_Check(batchSize))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setSyscallTrace(): Expects an integer as third argument.");
 
         try {
-          if (PyVMInstance_AsVMInstance(self)->run(PyLong_AsRword(start), PyLong_AsRword(end)) == true)
-            return PyBool_FromLong(true);
-          return PyBool_FromLong(false);
+          PyObject** previous = QBDI::Bindings::Python::SyscallTraceData;
+          PyObject** multipleData = nullptr;
+          if (function != Py_None) {
+            multipleData = (PyObject**)std::malloc(sizeof(PyObject*) * 2);
+            multipleData[0] = function;
+            multipleData[1] = data;
+            Py_INCREF(function);
+            Py_INCREF(data);
+          }
+          retValue = PyVMInstance_AsVMInstance(self)->setSyscallTrace(multipleData ? static_cast<QBDI::SyscallTraceCallback>(QBDI::Bindings::Python::trampoline) : nullptr,
+                                                                      multipleData,
+                                                                      batchSize ? static_cast<size_t>(PyLong_AsRword(batchSize)) : 256);
+          /* The previous callback has received its last delivery */
+          QBDI::Bindings::Python::SyscallTraceData = multipleData;
+          if (previous != nullptr) {
+            Py_DECREF(previous[0]);
+            Py_DECREF(previous[1]);
+            std::free(previous);
+          }
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
         }
+
+        return PyBool_FromLong(retValue);
       }
 
 
-      /*! Set the FPR state.
+      /*! Enable or disable the byte-level taint tracking.
        *
-       * @param[in] fprState A structure containing the FPR state.
+       * @param[in] enable  True to enable the taint tracking, False to disable it.
        *
-       * @return None
+       * @return True if the taint tracking has been enabled (or disabled).
        */
-      static PyObject* vm_setFPRState(PyObject* self, PyObject* arg) {
-        if (!PyFPRState_Check(arg))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setFPRState(): Expects a FPRState as first argument.");
-
+      static PyObject* vm_setTaintTracking(PyObject* self, PyObject* enable) {
         try {
-          PyVMInstance_AsVMInstance(self)->setFPRState(PyFPRState_AsFPRState(arg));
+          if (PyVMInstance_AsVMInstance(self)->setTaintTracking(PyObject_IsTrue(enable) == 1) == true)
+            return PyBool_FromLong(true);
+          return PyBool_FromLong(false);
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
         }
-
-        Py_RETURN_NONE;
       }
 
 
-      /*! Set the GPR state.
+      /*! Wrap a function with callbacks called on its entry and on its return.
        *
-       * @param[in] gprState A structure containing the GPR state.
+       * @param[in] target  The entry address of the wrapped function.
+       * @param[in] pre     The callback called on the entry of the function, or None.
+       * @param[in] post    The callback called on the return of the function, or None.
+       * @param[in] data    User defined data passed to the callbacks.
        *
-       * @return None
+       * @return The id of the registered instrumentation (or pyqbdi.INVALID_EVENTID
+       * in case of failure).
        */
-      static PyObject* vm_setGPRState(PyObject* self, PyObject* arg) {
-        if (!PyGPRState_Check(arg))
-          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::setGPRState(): Expects a GPRState as first argument.");
+      static PyObject* vm_wrapFunction(PyObject* self, PyObject* args) {
+        PyObject* target = nullptr;
+        PyObject* pre    = nullptr;
+        PyObject* post   = nullptr;
+        PyObject* data   = nullptr;
+        uint32_t retValue = QBDI::INVALID_EVENTID;
+
+        /* Extract arguments */
+        PyArg_ParseTuple(args, "|OOOO", &target, &pre, &post, &data);
+
+        if (target == nullptr || (!PyLong_Check(target) && !PyInt_Check(target)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::wrapFunction(): Expects an integer as first argument.");
+
+        if (pre == nullptr || (pre != Py_None && !PyCallable_Check(pre)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::wrapFunction(): Expects a function or None as second argument.");
+
+        if (post == nullptr || (post != Py_None && !PyCallable_Check(post)))
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::wrapFunction(): Expects a function or None as third argument.");
+
+        if (data == nullptr)
+          return PyErr_Format(PyExc_TypeError, "QBDI::Bindings::Python::VMInstance::wrapFunction(): Expects a PyObject as fourth argument.");
 
         try {
-          PyVMInstance_AsVMInstance(self)->setGPRState(PyGPRState_AsGPRState(arg));
+          /* The post callback and its data follow the pre callback ones */
+          PyObject** multipleData = (PyObject**)std::malloc(sizeof(PyObject*) * 4);
+          multipleData[0] = pre;
+          multipleData[1] = data;
+          multipleData[2] = post;
+          multipleData[3] = data;
+          retValue = PyVMInstance_AsVMInstance(self)->wrapFunction(PyLong_AsRword(target),
+                                                                   pre != Py_None ? QBDI::Bindings::Python::trampoline : nullptr,
+                                                                   post != Py_None ? QBDI::Bindings::Python::postTrampoline : nullptr,
+                                                                   multipleData);
+          QBDI::Bindings::Python::GCData.add(retValue, multipleData);
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
         }
 
-        Py_RETURN_NONE;
+        return PyLong_FromLong(retValue);
       }
 
 
       /* The VMInstance callbacks */
       PyMethodDef VMInstance_callbacks[] = {
         {"addCodeAddrCB",                     (PyCFunction)vm_addCodeAddrCB,                      METH_VARARGS,  "Register a callback for when a specific address is executed."},
+        {"addCodeAddrCounter",                (PyCFunction)vm_addCodeAddrCounter,                 METH_VARARGS,  "Register an inline counter incremented each time a specific address is executed."},
         {"addCodeCB",                         (PyCFunction)vm_addCodeCB,                          METH_VARARGS,  "Register a callback event for a specific instruction event."},
+        {"addCodeCounter",                    (PyCFunction)vm_addCodeCounter,                     METH_VARARGS,  "Register an inline counter incremented before every instruction executed."},
         {"addCodeRangeCB",                    (PyCFunction)vm_addCodeRangeCB,                     METH_VARARGS,  "Register a callback for when a specific address range is executed."},
+        {"addCodeRangeCounter",               (PyCFunction)vm_addCodeRangeCounter,                METH_VARARGS,  "Register an inline counter incremented for every instruction executed in an address range."},
         {"addInstrumentedModule",             (PyCFunction)vm_addInstrumentedModule,              METH_O,        "Add the executable address ranges of a module to the set of instrumented address ranges."},
         {"addInstrumentedModuleFromAddr",     (PyCFunction)vm_addInstrumentedModuleFromAddr,      METH_O,        "Add the executable address ranges of a module to the set of instrumented address ranges using an address belonging to the module."},
         {"addInstrumentedRange",              (PyCFunction)vm_addInstrumentedRange,               METH_VARARGS,  "Add an address range to the set of instrumented address ranges."},
+        {"addInstrumentedRanges",             (PyCFunction)vm_addInstrumentedRanges,              METH_O,        "Add several address ranges to the set of instrumented address ranges at once."},
         {"addMemAccessCB",                    (PyCFunction)vm_addMemAccessCB,                     METH_VARARGS,  "Register a callback event for every memory access matching the type bitfield made by an instruction."},
         {"addMemAddrCB",                      (PyCFunction)vm_addMemAddrCB,                       METH_VARARGS,  "Add a virtual callback which is triggered for any memory access at a specific address matching the access type."},
         {"addMemRangeCB",                     (PyCFunction)vm_addMemRangeCB,                      METH_VARARGS,  "Add a virtual callback which is triggered for any memory access in a specific address range matching the access type."},
         {"addMnemonicCB",                     (PyCFunction)vm_addMnemonicCB,                      METH_VARARGS,  "Register a callback event if the instruction matches the mnemonic."},
+        {"addMnemonicCounter",                (PyCFunction)vm_addMnemonicCounter,                 METH_VARARGS,  "Register an inline counter incremented for every instruction executed matching the mnemonic."},
+        {"addSampledCodeCB",                  (PyCFunction)vm_addSampledCodeCB,                   METH_VARARGS,  "Register a sampled callback event for every instruction executed."},
+        {"addSampledCodeRangeCB",             (PyCFunction)vm_addSampledCodeRangeCB,              METH_VARARGS,  "Register a sampled callback for when a specific address range is executed."},
+        {"addSampledVMEventCB",               (PyCFunction)vm_addSampledVMEventCB,                METH_VARARGS,  "Register a sampled callback event for a specific VM event."},
         {"addVMEventCB",                      (PyCFunction)vm_addVMEventCB,                       METH_VARARGS,  "Register a callback event for a specific VM event."},
         {"call",                              (PyCFunction)vm_call,                               METH_VARARGS,  "Call a function using the DBI (and its current state)."},
         {"clearAllCache",                     (PyCFunction)vm_clearAllCache,                      METH_NOARGS,   "Clear the entire translation cache."},
         {"clearCache",                        (PyCFunction)vm_clearCache,                         METH_VARARGS,  "Clear a specific address range from the translation cache."},
         {"deleteAllInstrumentations",         (PyCFunction)vm_deleteAllInstrumentations,          METH_NOARGS,   "Remove all the registered instrumentations."},
         {"deleteInstrumentation",             (PyCFunction)vm_deleteInstrumentation,              METH_O,        "Remove an instrumentation."},
+        {"flushMemoryTrace",                  (PyCFunction)vm_flushMemoryTrace,                   METH_NOARGS,   "Deliver immediately the pending memory trace records to the trace callback."},
+        {"flushSyscallTrace",                 (PyCFunction)vm_flushSyscallTrace,                  METH_NOARGS,   "Deliver immediately the pending syscall trace records to the trace callback."},
         {"getBBMemoryAccess",                 (PyCFunction)vm_getBBMemoryAccess,                  METH_NOARGS,   "Obtain the memory accesses made by the last executed basic block."},
+        {"getBranchSites",                    (PyCFunction)vm_getBranchSites,                     METH_NOARGS,   "Obtain the addresses of the indirect branch sites executed since the branch profiling was enabled."},
+        {"getBranchTargets",                  (PyCFunction)vm_getBranchTargets,                   METH_O,        "Obtain the targets observed at an indirect branch site."},
+        {"getCallStack",                      (PyCFunction)vm_getCallStack,                       METH_NOARGS,   "Obtain the current call stack, from the shadow call stack."},
+        {"getCounters",                       (PyCFunction)vm_getCounters,                        METH_NOARGS,   "Obtain a snapshot of the values of all the registered inline counters."},
         {"getFPRState",                       (PyCFunction)vm_getFPRState,                        METH_NOARGS,   "Obtain the current floating point register state."},
         {"getGPRState",                       (PyCFunction)vm_getGPRState,                        METH_NOARGS,   "Obtain the current general purpose register state."},
         {"getInstAnalysis",                   (PyCFunction)vm_getInstAnalysis,                    METH_VARARGS,  "Obtain the analysis of an instruction metadata."},
         {"getInstMemoryAccess",               (PyCFunction)vm_getInstMemoryAccess,                METH_NOARGS,   "Obtain the memory accesses made by the last executed instruction."},
+        {"getMemoryAccessValue",              (PyCFunction)vm_getMemoryAccessValue,               METH_O,        "Obtain the complete value of a memory access larger than a rword."},
+        {"getMemoryTaint",                    (PyCFunction)vm_getMemoryTaint,                     METH_VARARGS,  "Get the union of the taint labels of a memory range."},
+        {"getRegisterTaint",                  (PyCFunction)vm_getRegisterTaint,                   METH_O,        "Get the union of the taint labels of a general purpose register."},
         {"instrumentAllExecutableMaps",       (PyCFunction)vm_instrumentAllExecutableMaps,        METH_NOARGS,   "Adds all the executable memory maps to the instrumented range set."},
         {"precacheBasicBlock",                (PyCFunction)vm_precacheBasicBlock,                 METH_O,        "Pre-cache a known basic block"},
         {"recordMemoryAccess",                (PyCFunction)vm_recordMemoryAccess,                 METH_O,        "Add instrumentation rules to log memory access using inline instrumentation and instruction shadows."},
@@ -2665,9 +3866,23 @@ namespace QBDI {
         {"removeInstrumentedModule",          (PyCFunction)vm_removeInstrumentedModule,           METH_O,        "Remove the executable address ranges of a module from the set of instrumented address ranges."},
         {"removeInstrumentedModuleFromAddr",  (PyCFunction)vm_removeInstrumentedModuleFromAddr,   METH_O,        "Remove the executable address ranges of a module from the set of instrumented address ranges using an address belonging to the module."},
         {"removeInstrumentedRange",           (PyCFunction)vm_removeInstrumentedRange,            METH_VARARGS,  "Remove an address range from the set of instrumented address ranges."},
+        {"removeInstrumentedRanges",          (PyCFunction)vm_removeInstrumentedRanges,           METH_O,        "Remove several address ranges from the set of instrumented address ranges at once."},
+        {"replaceFunction",                   (PyCFunction)vm_replaceFunction,                    METH_VARARGS,  "Replace a function by another one, which receives its arguments and returns to its caller."},
         {"run",                               (PyCFunction)vm_run,                                METH_VARARGS,  "Start the execution by the DBI from a given address (and stop when another is reached)."},
+        {"runWithBudget",                     (PyCFunction)vm_runWithBudget,                      METH_VARARGS,  "Start the execution by the DBI and stop it once a budget of instructions or basic blocks has been executed."},
+        {"setBranchProfiling",                (PyCFunction)vm_setBranchProfiling,                 METH_O,        "Enable or disable the profiling of the indirect branch and call targets."},
+        {"setCallStackTracking",              (PyCFunction)vm_setCallStackTracking,               METH_O,        "Enable or disable the shadow call stack."},
+        {"setEdgeCoverage",                   (PyCFunction)vm_setEdgeCoverage,                    METH_VARARGS,  "Enable an AFL style edge coverage instrumentation, computed inline at the start of every basic block."},
         {"setFPRState",                       (PyCFunction)vm_setFPRState,                        METH_O,        "Obtain the current floating point register state."},
+        {"setFastNativeCalls",                (PyCFunction)vm_setFastNativeCalls,                 METH_O,        "Enable or disable the native calls to the non instrumented code."},
         {"setGPRState",                       (PyCFunction)vm_setGPRState,                        METH_O,        "Obtain the current general purpose register state."},
+        {"setInstrumentationEnabled",         (PyCFunction)vm_setInstrumentationEnabled,          METH_VARARGS,  "Enable or disable an instrumentation without flushing the translation cache."},
+        {"setMemoryTaint",                    (PyCFunction)vm_setMemoryTaint,                     METH_VARARGS,  "Set the taint label of a memory range."},
+        {"setMemoryTrace",                    (PyCFunction)vm_setMemoryTrace,                     METH_VARARGS,  "Stream the memory accesses to a callback, in batches."},
+        {"setRegisterTaint",                  (PyCFunction)vm_setRegisterTaint,                   METH_VARARGS,  "Set the taint label of every byte of a general purpose register."},
+        {"setSyscallTrace",                   (PyCFunction)vm_setSyscallTrace,                    METH_VARARGS,  "Stream the executed syscalls to a callback, in batches."},
+        {"setTaintTracking",                  (PyCFunction)vm_setTaintTracking,                   METH_O,        "Enable or disable the byte-level taint tracking."},
+        {"wrapFunction",                      (PyCFunction)vm_wrapFunction,                       METH_VARARGS,  "Wrap a function with callbacks called on its entry and on its return."},
         {nullptr,                             nullptr,                                            0,             nullptr}
       };
 
@@ -2765,6 +3980,25 @@ namespace QBDI {
 
           else if (std::string(PyString_AsString(name)) == "lastSignal")
             return PyLong_FromLong(PyVMState_AsVMState(self)->lastSignal);
+
+          else if (std::string(PyString_AsString(name)) == "syscallNumber")
+            return PyLong_FromUnsignedLongLong(PyVMState_AsVMState(self)->syscallNumber);
+
+          else if (std::string(PyString_AsString(name)) == "syscallArgs") {
+            PyObject* sysArgs = PyTuple_New(6);
+            for (size_t i = 0; i < 6; i++)
+              PyTuple_SetItem(sysArgs, i, PyLong_FromUnsignedLongLong(PyVMState_AsVMState(self)->syscallArgs[i]));
+            return sysArgs;
+          }
+
+          else if (std::string(PyString_AsString(name)) == "syscallReturn")
+            return PyLong_FromUnsignedLongLong(PyVMState_AsVMState(self)->syscallReturn);
+
+          else if (std::string(PyString_AsString(name)) == "moduleStart")
+            return PyLong_FromUnsignedLongLong(PyVMState_AsVMState(self)->moduleStart);
+
+          else if (std::string(PyString_AsString(name)) == "moduleEnd")
+            return PyLong_FromUnsignedLongLong(PyVMState_AsVMState(self)->moduleEnd);
         }
         catch (const std::exception& e) {
           return PyErr_Format(PyExc_TypeError, "%s", e.what());
@@ -3218,16 +4452,33 @@ namespace QBDI {
         PyModule_AddObject(QBDI::Bindings::Python::module, "BASIC_BLOCK_EXIT",      PyInt_FromLong(QBDI::BASIC_BLOCK_EXIT));
         PyModule_AddObject(QBDI::Bindings::Python::module, "BASIC_BLOCK_NEW",       PyInt_FromLong(QBDI::BASIC_BLOCK_NEW));
         PyModule_AddObject(QBDI::Bindings::Python::module, "BREAK_TO_VM",           PyInt_FromLong(QBDI::BREAK_TO_VM));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "BUDGET_BASIC_BLOCKS",   PyInt_FromLong(QBDI::BUDGET_BASIC_BLOCKS));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "BUDGET_INSTRUCTIONS",   PyInt_FromLong(QBDI::BUDGET_INSTRUCTIONS));
         PyModule_AddObject(QBDI::Bindings::Python::module, "CONTINUE",              PyInt_FromLong(QBDI::CONTINUE));
         PyModule_AddObject(QBDI::Bindings::Python::module, "EXEC_TRANSFER_CALL",    PyInt_FromLong(QBDI::EXEC_TRANSFER_CALL));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "FUNCTION_ENTRY",        PyInt_FromLong(QBDI::FUNCTION_ENTRY));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "FUNCTION_EXIT",         PyInt_FromLong(QBDI::FUNCTION_EXIT));
         PyModule_AddObject(QBDI::Bindings::Python::module, "INVALID_EVENTID",       PyInt_FromLong(QBDI::INVALID_EVENTID));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "MEMORY_NO_FLAGS",       PyInt_FromLong(QBDI::MEMORY_NO_FLAGS));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "MEMORY_PARTIAL_VALUE",  PyInt_FromLong(QBDI::MEMORY_PARTIAL_VALUE));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "MEMORY_READ",           PyInt_FromLong(QBDI::MEMORY_READ));
         PyModule_AddObject(QBDI::Bindings::Python::module, "MEMORY_READ_WRITE",     PyInt_FromLong(QBDI::MEMORY_READ_WRITE));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "MEMORY_UNKNOWN_VALUE",  PyInt_FromLong(QBDI::MEMORY_UNKNOWN_VALUE));
         PyModule_AddObject(QBDI::Bindings::Python::module, "MEMORY_WRITE",          PyInt_FromLong(QBDI::MEMORY_WRITE));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "MODULE_LOAD",           PyInt_FromLong(QBDI::MODULE_LOAD));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "MODULE_UNLOAD",         PyInt_FromLong(QBDI::MODULE_UNLOAD));
         PyModule_AddObject(QBDI::Bindings::Python::module, "OPERAND_GPR",           PyInt_FromLong(QBDI::OPERAND_GPR));
         PyModule_AddObject(QBDI::Bindings::Python::module, "OPERAND_IMM",           PyInt_FromLong(QBDI::OPERAND_IMM));
         PyModule_AddObject(QBDI::Bindings::Python::module, "OPERAND_INVALID",       PyInt_FromLong(QBDI::OPERAND_INVALID));
         PyModule_AddObject(QBDI::Bindings::Python::module, "OPERAND_PRED",          PyInt_FromLong(QBDI::OPERAND_PRED));
         PyModule_AddObject(QBDI::Bindings::Python::module, "POSTINST",              PyInt_FromLong(QBDI::POSTINST));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "PREDICATE_AND",         PyInt_FromLong(QBDI::PREDICATE_AND));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "PREDICATE_MEM_IN_RANGE", PyInt_FromLong(QBDI::PREDICATE_MEM_IN_RANGE));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "PREDICATE_MEM_MASK",    PyInt_FromLong(QBDI::PREDICATE_MEM_MASK));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "PREDICATE_OR",          PyInt_FromLong(QBDI::PREDICATE_OR));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "PREDICATE_REG_EQUAL",   PyInt_FromLong(QBDI::PREDICATE_REG_EQUAL));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "PREDICATE_REG_IN_RANGE", PyInt_FromLong(QBDI::PREDICATE_REG_IN_RANGE));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "PREDICATE_REG_NOT_EQUAL", PyInt_FromLong(QBDI::PREDICATE_REG_NOT_EQUAL));
         PyModule_AddObject(QBDI::Bindings::Python::module, "PREINST",               PyInt_FromLong(QBDI::PREINST));
         PyModule_AddObject(QBDI::Bindings::Python::module, "REGISTER_READ",         PyInt_FromLong(QBDI::REGISTER_READ));
         PyModule_AddObject(QBDI::Bindings::Python::module, "REGISTER_READ_WRITE",   PyInt_FromLong(QBDI::REGISTER_READ_WRITE));
@@ -3236,6 +4487,9 @@ namespace QBDI {
         PyModule_AddObject(QBDI::Bindings::Python::module, "SEQUENCE_EXIT",         PyInt_FromLong(QBDI::SEQUENCE_EXIT));
         PyModule_AddObject(QBDI::Bindings::Python::module, "SIGNAL",                PyInt_FromLong(QBDI::SIGNAL));
         PyModule_AddObject(QBDI::Bindings::Python::module, "STOP",                  PyInt_FromLong(QBDI::STOP));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "SWITCH_INVALID_ID",     PyInt_FromLong(QBDI::SWITCH_INVALID_ID));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "SWITCH_UNSUPPORTED",    PyInt_FromLong(QBDI::SWITCH_UNSUPPORTED));
+        PyModule_AddObject(QBDI::Bindings::Python::module, "SWITCH_UPDATED",        PyInt_FromLong(QBDI::SWITCH_UPDATED));
         PyModule_AddObject(QBDI::Bindings::Python::module, "SYSCALL_ENTRY",         PyInt_FromLong(QBDI::SYSCALL_ENTRY));
         PyModule_AddObject(QBDI::Bindings::Python::module, "SYSCALL_EXIT",          PyInt_FromLong(QBDI::SYSCALL_EXIT));
         PyModule_AddObject(QBDI::Bindings::Python::module, "VERSION_MAJOR",         PyInt_FromLong(QBDI_VERSION_MAJOR));